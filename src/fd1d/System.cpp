@@ -249,6 +249,11 @@ namespace Fd1d
             Log::file() << "  " << Str(filename, 20) << std::endl;
             fieldIo.readFields(wFields(), filename);  
          } else
+         if (command == "READ_W_BIN") {
+            inBuffer >> filename;
+            Log::file() << "  " << Str(filename, 20) << std::endl;
+            fieldIo.readFieldsBinary(wFields(), filename);  
+         } else
          if (command == "ITERATE") {
             Log::file() << std::endl;
             iterator().solve();
@@ -279,6 +284,16 @@ namespace Fd1d
             Log::file() << "  " << Str(filename, 20) << std::endl;
             fieldIo.writeFields(cFields(), filename);  
          } else
+         if (command == "WRITE_W_BIN") {
+            inBuffer >> filename;
+            Log::file() << "  " << Str(filename, 20) << std::endl;
+            fieldIo.writeFieldsBinary(wFields(), filename);  
+         } else
+         if (command == "WRITE_C_BIN") {
+            inBuffer >> filename;
+            Log::file() << "  " << Str(filename, 20) << std::endl;
+            fieldIo.writeFieldsBinary(cFields(), filename);  
+         } else
          if (command == "WRITE_BLOCK_C") {
             inBuffer >> filename;
             Log::file() << "  " << Str(filename, 20) << std::endl;
@@ -10,6 +10,7 @@
 #include <pscf/inter/Interaction.h>
 #include <pscf/inter/ChiInteraction.h>
 #include <pscf/homogeneous/Clump.h>
+#include <pscf/math/FieldFile.h>
 
 #include <util/format/Str.h>
 #include <util/format/Int.h>
@@ -107,6 +108,57 @@ namespace Fd1d
       }
    }
 
+   /*
+   * Read fields from a memory-mapped binary file.
+   */
+   void FieldIo::readFieldsBinary(Array<Field> &  fields, 
+                                  std::string const & filename)
+   {
+      FieldFile file;
+      file.open(fileMaster().inputPrefix() + filename);
+      FieldFileHeader const & header = file.header();
+      if (header.type != FieldFile::RGrid || header.dimension != 1) {
+         UTIL_THROW("Binary field file is not a 1D r-grid field file");
+      }
+      int nx = header.nValue;
+      int nm = header.nMonomer;
+      UTIL_CHECK(header.meshDimensions[0] == nx);
+      UTIL_CHECK(nx == domain().nx());
+      UTIL_CHECK(nm == mixture().nMonomer());
+
+      int i, j;
+      double const * data;
+      for (j = 0; j < nm; ++j) {
+         data = file.data(j);
+         for (i = 0; i < nx; ++i) {
+            fields[j][i] = data[i];
+         }
+      }
+      file.close();
+   }
+
+   /*
+   * Write fields to a binary file.
+   */
+   void FieldIo::writeFieldsBinary(Array<Field> const &  fields, 
+                                   std::string const & filename)
+   {
+      int nx = domain().nx();
+      int nm = mixture().nMonomer();
+
+      std::ofstream out;
+      fileMaster().openOutputFile(filename, out, 
+                                  std::ios::out | std::ios::binary);
+      FieldFileHeader header;
+      FieldFile::initHeader(header, FieldFile::RGrid, 1, nm, nx);
+      header.meshDimensions[0] = nx;
+      FieldFile::writeHeader(out, header);
+      for (int j = 0; j < nm; ++j) {
+         FieldFile::writeData(out, fields[j].cArray(), nx);
+      }
+      out.close();
+   }
+
    void FieldIo::writeBlockCFields(std::string const & filename)
    {
       std::ofstream out;
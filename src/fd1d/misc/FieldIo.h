@@ -85,6 +85,28 @@ namespace Fd1d {
       void writeFields(Array<Field> const &  fields, 
                        std::string const & filename);
 
+      /**
+      * Read a set of fields, one per monomer type, from a binary file.
+      *
+      * The file is mapped into memory (see Pscf::FieldFile), and must
+      * contain r-grid fields with the current number of grid points
+      * and monomer types.
+      *
+      * \param fields  array of fields to read, indexed by monomer id.
+      * \param filename  name of input file
+      */
+      void readFieldsBinary(Array<Field> &  fields, 
+                            std::string const & filename);
+
+      /**
+      * Write a set of fields, one per monomer type, to a binary file.
+      *
+      * \param fields  array of fields to write, indexed by monomer id
+      * \param filename  output filename
+      */
+      void writeFieldsBinary(Array<Field> const &  fields, 
+                             std::string const & filename);
+
       /**
       * Write block concentration fields for all blocks.
       *
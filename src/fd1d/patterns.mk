@@ -21,6 +21,20 @@ LIBS=$(PSCF_LIBS)
 INCLUDES+=$(GSL_INC)
 LIBS+=$(GSL_LIB) 
 
+# Add compiler and linker flags for OpenMP multithreading
+ifdef FD1D_OPENMP
+CXXFLAGS+=$(OPENMP_FLAGS)
+TESTFLAGS+=$(OPENMP_FLAGS)
+LDFLAGS+=$(OPENMP_FLAGS)
+endif
+
+# Link with OpenMP if the pscf library is multithreaded
+ifdef PSCF_OPENMP
+ifndef FD1D_OPENMP
+LDFLAGS+=$(OPENMP_FLAGS)
+endif
+endif
+
 # Preprocessor macro definitions needed in src/fd1d
 DEFINES=$(PSCF_DEFS) $(UTIL_DEFS)
 
@@ -20,7 +20,8 @@ namespace Fd1d
    Block::Block()
     : domainPtr_(0),
       ds_(0.0),
-      ns_(0)
+      ns_(0),
+      streamDirectionId_(-1)
    {
       propagator(0).setBlock(*this);
       propagator(1).setBlock(*this);
@@ -58,11 +59,21 @@ namespace Fd1d
       lB_.allocate(nx - 1);
       v_.allocate(nx);
       solver_.allocate(nx);
-      propagator(0).allocate(ns_, nx);
-      propagator(1).allocate(ns_, nx);
+      propagator(0).allocate(ns_, nx, streamDirectionId_ == 0);
+      propagator(1).allocate(ns_, nx, streamDirectionId_ == 1);
       cField().allocate(nx);
    }
 
+   /*
+   * Choose a propagator to be streamed, or none.
+   */
+   void Block::setStreamDirection(int directionId)
+   {
+      UTIL_CHECK(directionId >= -1 && directionId < 2);
+      UTIL_CHECK(!propagator(0).isAllocated());
+      streamDirectionId_ = directionId;
+   }
+
    void Block::setLength(double length)
    {
       BlockDescriptor::setLength(length);  
@@ -236,9 +247,20 @@ namespace Fd1d
       UTIL_CHECK(propagator(1).isAllocated());
       UTIL_CHECK(cField().capacity() == domain().nx()) 
 
-      // Initialize cField to zero at all points
       int i;
       int nx = domain().nx();
+
+      // Integral was accumulated while solving a streamed propagator
+      if (streamDirectionId_ >= 0) {
+         UTIL_CHECK(propagator(streamDirectionId_).isSolved());
+         prefactor *= ds_;
+         for (i = 0; i < nx; ++i) {
+            cField()[i] *= prefactor;
+         }
+         return;
+      }
+
+      // Initialize cField to zero at all points
       for (i = 0; i < nx; ++i) {
          cField()[i] = 0.0;
       }
@@ -267,6 +289,29 @@ namespace Fd1d
 
    }
 
+   /*
+   * Add one slice of a streamed propagator to the concentration integral.
+   */
+   void Block::accumulateConcentration(int directionId, int i, 
+                                       QField const & q)
+   {
+      UTIL_CHECK(directionId == streamDirectionId_);
+      Propagator const & partner = propagator(1 - directionId);
+      UTIL_CHECK(partner.isSolved());
+      QField const & qp = partner.q(ns_ - 1 - i);
+      int nx = domain().nx();
+      int k;
+      if (i == 0) {
+         for (k = 0; k < nx; ++k) {
+            cField()[k] = 0.0;
+         }
+      }
+      double weight = (i == 0 || i == ns_ - 1) ? 0.5 : 1.0;
+      for (k = 0; k < nx; ++k) {
+         cField()[k] += weight*q[k]*qp[k];
+      }
+   }
+
    /*
    * Propagate solution by one step.
    *
@@ -68,6 +68,19 @@ namespace Fd1d
       */
       void setDiscretization(Domain const & domain, double ds);
 
+      /**
+      * Choose a propagator to be streamed, or none.
+      *
+      * If directionId is 0 or 1, propagator(directionId) is allocated
+      * as a streamed propagator (see Propagator), which must always be
+      * solved after its partner. If directionId is -1 (the default), 
+      * both propagators store all slices. This must be called before
+      * setDiscretization.
+      *
+      * \param directionId  direction id of streamed propagator, or -1
+      */
+      void setStreamDirection(int directionId);
+
       /**
       * Set length and readjust ds_ accordingly.
       */
@@ -88,10 +101,28 @@ namespace Fd1d
       * a contour variable that is integrated over the domain 
       * 0 < s < length(), where length() is the block length.
       *
+      * If one propagator is streamed, the integral has already been 
+      * accumulated by accumulateConcentration, and is only multiplied
+      * by the prefactor.
+      *
       * \param prefactor multiplying integral
       */ 
       void computeConcentration(double prefactor);
 
+      /**
+      * Add the contribution of one slice of a streamed propagator.
+      *
+      * Adds the trapezoidal rule weighted product of slice i of the
+      * streamed propagator(directionId) and slice ns-1-i of its partner
+      * to the unnormalized integral in cField(), which is zeroed when
+      * i == 0. Called by Propagator for i = 0, ..., ns-1 in order.
+      *
+      * \param directionId  direction id of streamed propagator
+      * \param i  contour step index of slice q
+      * \param q  slice i of propagator(directionId)
+      */
+      void accumulateConcentration(int directionId, int i, QField const & q);
+
       /**
       * Compute step of integration loop, from i to i+1.
       */
@@ -147,6 +178,9 @@ namespace Fd1d
       /// Number of contour length steps = # grid points - 1.
       int ns_;
 
+      /// Direction id of streamed propagator, or -1 if none.
+      int streamDirectionId_;
+
    };
 
    // Inline member functions
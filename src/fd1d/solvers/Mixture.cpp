@@ -17,6 +17,7 @@ namespace Fd1d
    Mixture::Mixture()
     : vMonomer_(1.0),
       ds_(-1.0),
+      isSingleStorage_(false),
       domainPtr_(0)
    {  setClassName("Mixture"); }
 
@@ -29,6 +30,8 @@ namespace Fd1d
       vMonomer_ = 1.0; // Default value
       readOptional(in, "vMonomer", vMonomer_);
       read(in, "ds", ds_);
+      isSingleStorage_ = false; // Default value
+      readOptional(in, "isSingleStorage", isSingleStorage_);
 
       UTIL_CHECK(nMonomer() > 0);
       UTIL_CHECK(nPolymer()+ nSolvent() > 0);
@@ -47,6 +50,10 @@ namespace Fd1d
       int i, j;
       for (i = 0; i < nPolymer(); ++i) {
          for (j = 0; j < polymer(i).nBlock(); ++j) {
+            if (isSingleStorage_) {
+               polymer(i).block(j)
+                  .setStreamDirection(polymer(i).streamDirectionId(j));
+            }
             polymer(i).block(j).setDiscretization(domain, ds_);
          }
       }
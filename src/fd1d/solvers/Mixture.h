@@ -72,7 +72,10 @@ namespace Fd1d
       *
       * This function reads in a complete description of
       * the chemical composition and structure of all species,
-      * as well as the target contour length step size ds.
+      * as well as the target contour length step size ds, and
+      * an optional flag isSingleStorage (default false) that
+      * enables streaming of one propagator per block, where
+      * possible (see PolymerTmpl::streamDirectionId).
       *
       * \param in input parameter stream
       */
@@ -116,6 +119,11 @@ namespace Fd1d
       */
       double vMonomer() const;
 
+      /**
+      * Is one propagator of each block streamed, where possible?
+      */
+      bool isSingleStorage() const;
+
    private:
 
       /// Monomer reference volume (set to 1.0 by default).
@@ -124,6 +132,9 @@ namespace Fd1d
       /// Optimal contour length step size.
       double ds_;
 
+      /// If true, stream one propagator of each block, where possible.
+      bool isSingleStorage_;
+
       /// Pointer to associated Domain object.
       Domain const * domainPtr_;
 
@@ -140,6 +151,12 @@ namespace Fd1d
    inline double Mixture::vMonomer() const
    {  return vMonomer_; }
 
+   /*
+   * Is one propagator of each block streamed, where possible? (public).
+   */
+   inline bool Mixture::isSingleStorage() const
+   {  return isSingleStorage_; }
+
    /*
    * Get Domain by constant reference (private).
    */
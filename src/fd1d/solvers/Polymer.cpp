@@ -12,7 +12,10 @@ namespace Fd1d
 { 
 
    Polymer::Polymer()
-   {  setClassName("Polymer"); }
+   {  
+      setClassName("Polymer"); 
+      setIsAliasEnabled(true);
+   }
 
    Polymer::~Polymer()
    {}
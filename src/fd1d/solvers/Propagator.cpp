@@ -22,6 +22,7 @@ namespace Fd1d
     : blockPtr_(0),
       ns_(0),
       nx_(0),
+      isStreamed_(false),
       isAllocated_(false)
    {}
 
@@ -31,13 +32,34 @@ namespace Fd1d
    Propagator::~Propagator()
    {}
 
-   void Propagator::allocate(int ns, int nx)
+   void Propagator::allocate(int ns, int nx, bool isStreamed)
    {
       ns_ = ns;
       nx_ = nx;
-      qFields_.allocate(ns);
-      for (int i = 0; i < ns; ++i) {
-         qFields_[i].allocate(nx);
+      isStreamed_ = isStreamed;
+
+      if (isStreamed_) {
+         // Head, tail and a rolling pair of slices
+         UTIL_CHECK(!isAlias());
+         qFields_.allocate(1);
+         qFields_[0].allocate(nx);
+         tail_.allocate(nx);
+         buffer_.allocate(2);
+         for (int i = 0; i < 2; ++i) {
+            buffer_[i].allocate(nx);
+         }
+      } else
+      if (isAlias()) {
+         // Slices of an alias are stored by the aliased propagator
+         if (alias().isAllocated()) {
+            UTIL_CHECK(alias().ns_ == ns);
+            UTIL_CHECK(alias().nx_ == nx);
+         }
+      } else {
+         qFields_.allocate(ns);
+         for (int i = 0; i < ns; ++i) {
+            qFields_[i].allocate(nx);
+         }
       }
       isAllocated_ = true;
    }
@@ -77,10 +99,9 @@ namespace Fd1d
    */
    void Propagator::solve()
    {
+      UTIL_CHECK(!isAlias());
       computeHead();
-      for (int iStep = 0; iStep < ns_ - 1; ++iStep) {
-         block().step(qFields_[iStep], qFields_[iStep + 1]);
-      }
+      propagate();
       setIsSolved(true);
    }
 
@@ -89,19 +110,43 @@ namespace Fd1d
    */
    void Propagator::solve(const Propagator::QField& head) 
    {
+      UTIL_CHECK(!isAlias());
+
       // Initialize initial (head) field
       QField& qh = qFields_[0];
       for (int i = 0; i < nx_; ++i) {
          qh[i] = head[i];
       }
 
-      // Setup solver and solve
-      for (int iStep = 0; iStep < ns_ - 1; ++iStep) {
-         block().step(qFields_[iStep], qFields_[iStep + 1]);
-      }
+      propagate();
       setIsSolved(true);
    }
 
+   /*
+   * Integrate from head to tail, storing all slices or, if streamed,
+   * passing each slice to the block as soon as it is computed.
+   */
+   void Propagator::propagate()
+   {
+      if (!isStreamed_) {
+         for (int iStep = 0; iStep < ns_ - 1; ++iStep) {
+            block().step(qFields_[iStep], qFields_[iStep + 1]);
+         }
+         return;
+      }
+      Block& b = block();
+      int directionId = (&b.propagator(0) == this) ? 0 : 1;
+      b.accumulateConcentration(directionId, 0, qFields_[0]);
+      QField const * qPtr = &qFields_[0];
+      QField* qNewPtr;
+      for (int i = 1; i < ns_; ++i) {
+         qNewPtr = (i == ns_ - 1) ? &tail_ : &buffer_[i % 2];
+         b.step(*qPtr, *qNewPtr);
+         b.accumulateConcentration(directionId, i, *qNewPtr);
+         qPtr = qNewPtr;
+      }
+   }
+
    /*
    * Integrate to calculate monomer concentration for this block
    */
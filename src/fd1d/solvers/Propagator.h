@@ -21,6 +21,16 @@ namespace Fd1d
    /**
    * MDE solver for one-direction of one block.
    *
+   * A Propagator that is an alias of an equivalent propagator (see
+   * PropagatorTmpl::setAlias) stores no slices, and returns slices of
+   * the aliased propagator from head(), tail() and q().
+   *
+   * A "streamed" Propagator (see allocate) stores only its head, its
+   * tail and a rolling pair of slices, and passes each slice to the
+   * Block::accumulateConcentration function as soon as it is computed.
+   * This requires that the partner propagator already be solved. The
+   * q() function may not be used for a streamed propagator.
+   *
    * \ingroup Fd1d_Solver_Module
    */
    class Propagator : public PropagatorTmpl<Propagator>
@@ -70,12 +80,13 @@ namespace Fd1d
       void setBlock(Block& block);
 
       /**
-      * Associate this propagator with a block.
+      * Allocate memory used by this propagator.
       * 
       * \param ns number of contour length steps
       * \param nx number of spatial steps
+      * \param isStreamed store only the head, tail and two other slices
       */ 
-      void allocate(int ns, int nx);
+      void allocate(int ns, int nx, bool isStreamed = false);
 
       /**
       * Solve the modified diffusion equation (MDE) for this block.
@@ -137,6 +148,11 @@ namespace Fd1d
       */
       bool isAllocated() const;
 
+      /**
+      * Is this a streamed propagator?
+      */
+      bool isStreamed() const;
+
    protected:
 
       /**
@@ -146,9 +162,15 @@ namespace Fd1d
 
    private:
      
-      // Array of statistical weight fields 
+      // Array of statistical weight fields (only the head if streamed)
       DArray<QField> qFields_;
 
+      // Tail slice (used only if isStreamed_)
+      QField tail_;
+
+      // Rolling pair of slices (used only if isStreamed_)
+      DArray<QField> buffer_;
+
       // Workspace
       QField work_;
 
@@ -161,9 +183,17 @@ namespace Fd1d
       /// Number of spatial grid points.
       int nx_;
 
+      /// Is this a streamed propagator?
+      bool isStreamed_;
+
       /// Is this propagator allocated?
       bool isAllocated_;
 
+      /**
+      * Integrate the MDE from the head slice to the tail.
+      */
+      void propagate();
+
    };
 
    // Inline member functions
@@ -172,19 +202,31 @@ namespace Fd1d
    * Return q-field at beginning of block.
    */
    inline Propagator::QField const& Propagator::head() const
-   {  return qFields_[0]; }
+   {  return isAlias() ? alias().head() : qFields_[0]; }
 
    /*
    * Return q-field at end of block, after solution.
    */
    inline Propagator::QField const& Propagator::tail() const
-   {  return qFields_[ns_-1]; }
+   {
+      if (isAlias()) return alias().tail();
+      return isStreamed_ ? tail_ : qFields_[ns_-1]; 
+   }
 
    /*
    * Return q-field at specified step.
    */
    inline Propagator::QField const& Propagator::q(int i) const
-   {  return qFields_[i]; }
+   {
+      UTIL_ASSERT(!isStreamed_);
+      return isAlias() ? alias().q(i) : qFields_[i]; 
+   }
+
+   /*
+   * Is this a streamed propagator?
+   */
+   inline bool Propagator::isStreamed() const
+   {  return isStreamed_; }
 
    /*
    * Get the associated Block object.
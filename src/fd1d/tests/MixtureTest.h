@@ -103,12 +103,72 @@ public:
       std::cout << "Volume fraction of block 1 = " << sum1 << "\n";
       
    }
+
+   void testSingleStorage()
+   {
+      printMethod(TEST_FUNC);
+
+      std::ifstream in;
+      openInputFile("in/Mixture", in);
+      Mixture mix;
+      Domain domain;
+      mix.readParam(in);
+      domain.readParam(in);
+      in.close();
+      mix.setDomain(domain);
+
+      // Identical mixture, with one streamed propagator per block
+      openInputFile("in/MixtureSingleStorage", in);
+      Mixture mixS;
+      Domain domainS;
+      mixS.readParam(in);
+      domainS.readParam(in);
+      in.close();
+      mixS.setDomain(domainS);
+      TEST_ASSERT(mixS.isSingleStorage());
+      for (int j = 0; j < mixS.polymer(0).nBlock(); ++j) {
+         int k = mixS.polymer(0).streamDirectionId(j);
+         TEST_ASSERT(k >= 0);
+         TEST_ASSERT(mixS.polymer(0).block(j).propagator(k).isStreamed());
+      }
+
+      int nMonomer = mix.nMonomer();
+      int nx = domain.nx();
+      DArray<Mixture::WField> wFields;
+      DArray<Mixture::CField> cFields;
+      DArray<Mixture::CField> cFieldsS;
+      wFields.allocate(nMonomer);
+      cFields.allocate(nMonomer);
+      cFieldsS.allocate(nMonomer);
+      int i;
+      for (i = 0; i < nMonomer; ++i) {
+         wFields[i].allocate(nx);
+         cFields[i].allocate(nx);
+         cFieldsS[i].allocate(nx);
+      }
+      double cs;
+      for (i = 0; i < nx; ++i) {
+         cs = cos(2.0*Constants::Pi*double(i)/double(nx-1));
+         wFields[0][i] = 0.5 + cs;
+         wFields[1][i] = 0.5 - cs;
+      }
+      mix.compute(wFields, cFields);
+      mixS.compute(wFields, cFieldsS);
+
+      for (int j = 0; j < nMonomer; ++j) {
+         for (i = 0; i < nx; ++i) {
+            TEST_ASSERT(eq(cFields[j][i], cFieldsS[j][i]));
+         }
+      }
+   }
+
 };
 
 TEST_BEGIN(MixtureTest)
 TEST_ADD(MixtureTest, testConstructor)
 TEST_ADD(MixtureTest, testReadParameters)
 TEST_ADD(MixtureTest, testSolve)
+TEST_ADD(MixtureTest, testSingleStorage)
 TEST_END(MixtureTest)
 
 #endif
@@ -11,13 +11,19 @@
 #include <pscf/mesh/Mesh.h>
 #include <pscf/crystal/UnitCell.h>
 #include <pscf/crystal/SpaceGroup.h>
+#include <pscf/crystal/MinimumImage.h>
 #include <util/containers/DArray.h>
 #include <util/containers/GArray.h>
+#include <string>
+#include <vector>
 
 namespace Pscf { 
 
    using namespace Util;
 
+   template <int D> struct TWave;
+   struct BasisCacheHeader;
+
    /**
    * Symmetry-adapted basis for pseudo-spectral scft.
    *
@@ -160,6 +166,71 @@ namespace Pscf {
       void makeBasis(const Mesh<D>& mesh, const UnitCell<D>& unitCell, 
                      const SpaceGroup<D>& group);
 
+      /**
+      * Construct basis, using a directory of binary basis cache files.
+      *
+      * If directory cacheDir contains a cache file for this group, 
+      * mesh and unit cell (see cacheFileName), the basis is read from 
+      * that file. Otherwise, the basis is constructed and written to a
+      * new cache file in that directory.
+      *
+      * \param mesh  spatial discretization mesh
+      * \param unitCell  crystallographic unit cell
+      * \param groupName  name of space group
+      * \param cacheDir  path to cache directory 
+      * \return true if the basis was read from a cache file
+      */
+      bool makeBasis(const Mesh<D>& mesh, const UnitCell<D>& unitCell, 
+                     std::string groupName, std::string cacheDir);
+
+      /**
+      * Read basis from a binary cache file, if it matches.
+      *
+      * The file is mapped into memory read-only, so that processes
+      * that read the same file share its pages. If the file does not
+      * exist, or was created for a different space group, mesh or 
+      * lattice system, or a different shape of unit cell, this function 
+      * returns false and leaves the basis unchanged. Otherwise, it 
+      * reads the basis, calls update() if the unit cell parameters
+      * differ from those used to create the file, and returns true.
+      *
+      * \param filename  name of cache file
+      * \param mesh  spatial discretization mesh
+      * \param unitCell  crystallographic unit cell
+      * \param groupName  name of space group
+      * \return true if the basis was read, false otherwise
+      */
+      bool readCache(std::string filename, const Mesh<D>& mesh, 
+                     const UnitCell<D>& unitCell, std::string groupName);
+
+      /**
+      * Write basis to a binary cache file.
+      *
+      * The file is written under a temporary name and then renamed, so
+      * that other processes never read a partially written file.
+      *
+      * \param filename  name of cache file
+      * \param groupName  name of space group used to make this basis
+      * \return true if the file was written, false otherwise
+      */
+      bool writeCache(std::string filename, std::string groupName) const;
+
+      /**
+      * Get the name of the cache file for a group, mesh and unit cell.
+      *
+      * The name contains the dimension, group name, mesh dimensions 
+      * and lattice system. For lattice systems with more than one 
+      * parameter, the order of stars depends on the shape of the unit
+      * cell, and the name also contains the values of the parameters.
+      *
+      * \param mesh  spatial discretization mesh
+      * \param unitCell  crystallographic unit cell
+      * \param groupName  name of space group
+      */
+      static std::string cacheFileName(const Mesh<D>& mesh, 
+                                       const UnitCell<D>& unitCell, 
+                                       std::string groupName);
+
       /**
       * Update values after change in unit cell parameters.
       */
@@ -252,6 +323,9 @@ namespace Pscf {
       /// Pointer to associated Mesh<D>
       Mesh<D> const * meshPtr_;
 
+      /// Finder of minimum images, set up for the mesh and unit cell
+      MinimumImage<D> minimumImage_;
+
       /**
       * Construct array of ordered waves.
       */
@@ -262,6 +336,33 @@ namespace Pscf {
       */
       void makeStars(const SpaceGroup<D>& group);
 
+      /**
+      * Identify stars within one list of waves of equal norm.
+      *
+      * \param group  space group
+      * \param twaves  all waves, with each list sorted by indicesDft
+      * \param listBegin  index of first wave in the list
+      * \param listEnd  index of last wave in the list, plus one
+      * \param stars  stars of this list, in order (output)
+      */
+      void makeListStars(const SpaceGroup<D>& group, 
+                         std::vector< TWave<D> > const & twaves,
+                         int listBegin, int listEnd, 
+                         std::vector<Star>& stars);
+
+      /**
+      * Set the key fields of a cache file header.
+      *
+      * \param header  header to be set (output)
+      * \param mesh  spatial discretization mesh
+      * \param unitCell  crystallographic unit cell
+      * \param groupName  name of space group
+      */
+      static void makeCacheHeader(BasisCacheHeader& header,
+                                  const Mesh<D>& mesh, 
+                                  const UnitCell<D>& unitCell, 
+                                  std::string groupName);
+
       /**
       * Access associated Mesh<D> as reference.
       */
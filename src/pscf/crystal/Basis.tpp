@@ -9,14 +9,27 @@
 */
 
 #include "Basis.h"
+#include "BasisCache.h"
 #include "TWave.h"
-#include "groupFile.h"
-#include <pscf/crystal/shiftToMinimum.h>
 #include <pscf/mesh/MeshIterator.h>
 #include <algorithm>
 #include <vector>
-#include <set>
 #include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <cmath>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef PSCF_OPENMP
+#include <omp.h>
+#endif
 
 namespace Pscf {
 
@@ -48,35 +61,7 @@ namespace Pscf {
                             std::string groupName)
    {
       SpaceGroup<D> group;
-      if (groupName == "I") {
-         // Create identity group by default
-         group.makeCompleteGroup();
-      } else {
-         bool foundFile = false;
-         {
-            std::ifstream in;
-            in.open(groupName);
-            if (in.is_open()) {
-               in >> group;
-               UTIL_CHECK(group.isValid());
-               foundFile = true;
-            }
-         }
-         if (!foundFile) {
-            std::string fileName = makeGroupFileName(D, groupName);
-            std::ifstream in;
-            in.open(fileName);
-            if (in.is_open()) {
-               in >> group;
-               UTIL_CHECK(group.isValid());
-            } else {
-               Log::file() << "\nFailed to open group file: " 
-                           << fileName << "\n";
-               Log::file() << "\n Error: Unknown space group\n";
-               UTIL_THROW("Unknown space group");
-            }
-         } 
-      }
+      readGroup(groupName, group);
       makeBasis(mesh, unitCell, group);
    }
 
@@ -91,6 +76,7 @@ namespace Pscf {
       // Save pointers to mesh and unit cell
       meshPtr_ = &mesh;
       unitCellPtr_ = &unitCell;
+      minimumImage_.setup(mesh.dimensions(), unitCell);
 
       // Allocate arrays
       nWave_ = mesh.size();
@@ -122,27 +108,58 @@ namespace Pscf {
    template <int D>
    void Basis<D>::makeWaves()
    {
-      IntVec<D> meshDimensions = mesh().dimensions();
-      std::vector< TWave<D> > twaves;
-      twaves.reserve(nWave_);
+      std::vector< TWave<D> > twaves(nWave_);
 
       // Loop over dft mesh to generate all waves, add to twaves
-      TWave<D> w;
-      IntVec<D> v;
-      MeshIterator<D> itr(mesh().dimensions());
-      for (itr.begin(); !itr.atEnd(); ++itr) {
-         w.indicesDft = itr.position();
-         v = shiftToMinimum(w.indicesDft, meshDimensions, *unitCellPtr_);
-         w.indicesBz = v;
-         w.sqNorm = unitCell().ksq(v);
-         twaves.push_back(w);
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for schedule(static)
+      #endif
+      for (int i = 0; i < nWave_; ++i) {
+         TWave<D>& w = twaves[i];
+         w.indicesDft = mesh().position(i);
+         w.indicesBz = minimumImage_.shift(w.indicesDft);
+         w.sqNorm = unitCell().ksq(w.indicesBz);
       }
 
       // Sort temporary array twaves
       TWaveNormComp<D> comp;
+      #ifdef PSCF_OPENMP
+      // Sort contiguous blocks concurrently, then repeatedly merge 
+      // pairs of neighboring blocks. As for std::sort, waves of equal 
+      // sqNorm may appear in any order: makeStars does not depend on 
+      // the order of waves of equal norm.
+      int nBlock = omp_get_max_threads();
+      if (nBlock > 1 && nWave_ > nBlock) {
+         typename std::vector< TWave<D> >::iterator first;
+         first = twaves.begin();
+         std::vector<int> bounds(nBlock + 1);
+         for (int b = 0; b <= nBlock; ++b) {
+            bounds[b] = (int)((long(nWave_)*long(b))/long(nBlock));
+         }
+         #pragma omp parallel for schedule(static)
+         for (int b = 0; b < nBlock; ++b) {
+            std::sort(first + bounds[b], first + bounds[b+1], comp);
+         }
+         for (int width = 1; width < nBlock; width *= 2) {
+            #pragma omp parallel for schedule(static)
+            for (int b = 0; b < nBlock - width; b += 2*width) {
+               int e = std::min(b + 2*width, nBlock);
+               std::inplace_merge(first + bounds[b], 
+                                  first + bounds[b + width], 
+                                  first + bounds[e], comp);
+            }
+         }
+      } else {
+         std::sort(twaves.begin(), twaves.end(), comp);
+      }
+      #else
       std::sort(twaves.begin(), twaves.end(), comp);
+      #endif
 
       // Copy temporary array twaves into member variable waves_
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for schedule(static)
+      #endif
       for (int i = 0; i < nWave_; ++i) {
          waves_[i].sqNorm = twaves[i].sqNorm;
          waves_[i].indicesDft = twaves[i].indicesDft;
@@ -151,331 +168,107 @@ namespace Pscf {
 
    }
 
+   /*
+   * Identify stars of waves that are related by symmetry.
+   *
+   * Waves are processed in lists of waves of equal norm. Stars in 
+   * different lists are independent, and so lists are processed 
+   * concurrently if PSCF_OPENMP is defined. Within each list, symmetry
+   * related waves are located with the table waveIds_, rather than by
+   * searching sets of waves.
+   */
    template <int D>
    void Basis<D>::makeStars(const SpaceGroup<D>& group)
    {
-      /* 
-      * Local containers that hold TWave<D> objects:
-      * list - set of waves of equal norm, compared by indicesDft
-      * star - set of symmetry-related waves, compared by indicesDft
-      * tempStar - temporary star, sorted by descending indicesBz
-      * tempList - temporary list, ordered by star
-      */
-      std::set< TWave<D>, TWaveDftComp<D> > list;  
-      std::set< TWave<D>, TWaveDftComp<D> > star;  
-      std::vector< TWave<D> > tempStar;  
-      GArray< TWave<D> > tempList;            
-
-      typename std::set< TWave<D>, TWaveDftComp<D> >::iterator rootItr;
-      typename std::set< TWave<D>, TWaveDftComp<D> >::iterator setItr;
-      TWave<D> wave;
-      Basis<D>::Star newStar;
-
-      std::complex<double> coeff;
-      double Gsq;
-      double Gsq_max;
-      double phase_diff;
-      const double twoPi = 2.0*Constants::Pi;
       const double epsilon = 1.0E-8;
       IntVec<D> meshDimensions = mesh().dimensions();
-      IntVec<D> rootVecBz;
       IntVec<D> vec;
       IntVec<D> nVec;
-      int listId = 0;      // id for this list
-      int listBegin = 0;   // id of first wave in this list
-      int listEnd = 0;     // (id of last wave in this list) + 1
-      int starId = 0;      // id for this star
-      int starBegin = 0;   // id of first wave in this star
-      int i, j, k;
-      bool cancel;
-
-      // Loop over all waves
-      nBasis_ = 0;
-      nBasisWave_ = 0;
-      Gsq_max = waves_[0].sqNorm;
-      for (i = 1; i <= nWave_; ++i) {
-
-         // Determine if this wave begins a new list
-         bool newList = false;
-         if (i == nWave_) {
-            listEnd = i;
-            newList = true;
-         } else {
-            Gsq = waves_[i].sqNorm;
-            if (Gsq > Gsq_max + epsilon) {
-               Gsq_max = Gsq;
-               listEnd = i;
-               newList = true;
-            }
+      int i, j;
+
+      // Identify lists of waves of equal norm. List i contains waves
+      // with indices listBegins[i] <= id < listBegins[i+1].
+      std::vector<int> listBegins;
+      listBegins.push_back(0);
+      double Gsq_max = waves_[0].sqNorm;
+      for (i = 1; i < nWave_; ++i) {
+         if (waves_[i].sqNorm > Gsq_max + epsilon) {
+            Gsq_max = waves_[i].sqNorm;
+            listBegins.push_back(i);
          }
+      }
+      listBegins.push_back(nWave_);
+      int nList = listBegins.size() - 1;
+
+      // Copy waves into twaves, sort each list in ascending order of 
+      // indicesDft, and use waveIds_ to store the index in twaves of 
+      // each wave, indexed by the rank of indicesDft.
+      std::vector< TWave<D> > twaves(nWave_);
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for schedule(dynamic)
+      #endif
+      for (int il = 0; il < nList; ++il) {
+         int begin = listBegins[il];
+         int end = listBegins[il+1];
+         int k;
+         for (k = begin; k < end; ++k) {
+            twaves[k].indicesDft = waves_[k].indicesDft;
+            twaves[k].indicesBz = waves_[k].indicesBz;
+            twaves[k].sqNorm = waves_[k].sqNorm;
+         }
+         TWaveDftComp<D> waveDftComp;
+         std::sort(twaves.begin() + begin, twaves.begin() + end, 
+                   waveDftComp);
+         for (k = begin; k < end; ++k) {
+            waveIds_[mesh().rank(twaves[k].indicesDft)] = k;
+         }
+      }
 
-         // Process completed list of wavectors of equal norm
-         if (newList && listEnd > 0) {
-
-            // Copy waves of equal norm into std::set "list"
-            list.clear();
-            tempList.clear();
-            for (j = listBegin; j < listEnd; ++j) {
-               wave.indicesDft = waves_[j].indicesDft;
-               wave.indicesBz = waves_[j].indicesBz;
-               wave.sqNorm = waves_[j].sqNorm;
-               if (j > listBegin) {
-                  UTIL_CHECK( abs(wave.sqNorm-waves_[j].sqNorm) 
-                                 < 2.0*epsilon ); 
+      // Identify stars within each list 
+      std::vector< std::vector<Star> > listStars(nList);
+      // Exceptions cannot leave a parallel region, so the message of
+      // the first failure is kept and rethrown after the loop.
+      int nFail = 0;
+      std::string failMessage;
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for schedule(dynamic) reduction(+:nFail)
+      #endif
+      for (int il = 0; il < nList; ++il) {
+         try {
+            makeListStars(group, twaves, listBegins[il], 
+                          listBegins[il+1], listStars[il]);
+         } catch (Exception& e) {
+            #ifdef PSCF_OPENMP
+            #pragma omp critical
+            #endif
+            {
+               if (failMessage.empty()) {
+                  failMessage = e.message();
                }
-               list.insert(wave);
             }
+            ++nFail;
+         }
+      }
+      if (nFail > 0) {
+         UTIL_THROW(("Failure to identify stars: " + failMessage).c_str());
+      }
 
-            // On entry to each iteration of the loop over stars,
-            // rootItr and nextInvert are known. The iterator rootItr 
-            // points to the wave in the remaining list that will be 
-            // used as the root of the next star. The flag nextInvert 
-            // is equal to -1 iff the previous star was the first of
-            // a pair that are open under inversion, and is equal to +1 
-            // otherwise.
-
-            // Initial values for first star in this list
-            rootItr = list.begin();
-            int nextInvert = 1;
-
-            // Loop over stars with a list of waves of equal norm,
-            // removing each star from the list as it is identified.
-            // The root of the next star must have been chosen on
-            // entry to each iteration of this loop.
-
-            while (list.size() > 0) {
-
-               rootVecBz = rootItr->indicesBz;
-               Gsq = rootItr->sqNorm;
-               cancel = false;
-               star.clear();
-
-               // Construct a star from root vector, by applying every
-               // symmetry operation in the group to the root wavevector.
-               for (j = 0; j < group.size(); ++j) {
-
-                  // Apply symmetry (i.e., multiply by rotation matrix)
-                  // vec = rotated wavevector.
-                  vec = rootVecBz*group[j];
-
-                  // Check that rotated vector has same norm as root.
-                  UTIL_CHECK(abs(Gsq - unitCell().ksq(vec)) < epsilon);
-
-                  // Initialize TWave object associated with rotated wave
-                  wave.sqNorm = Gsq;
-                  wave.indicesBz = shiftToMinimum(vec, meshDimensions, 
-                                                  *unitCellPtr_);
-                  wave.indicesDft = vec;
-                  mesh().shift(wave.indicesDft);
-
-                  // Compute phase for coeff. of wave in basis function.
-                  // Convention -pi < phase <= pi.
-                  wave.phase = 0.0;
-                  for (k = 0; k < D; ++k) {
-                     wave.phase += rootVecBz[k]*(group[j].t(k));
-                  }
-                  while (wave.phase > 0.5) {
-                     wave.phase -= 1.0;
-                  }
-                  while (wave.phase <= -0.5) {
-                     wave.phase += 1.0;
-                  }
-                  wave.phase *= twoPi;
-
-                  // Check for cancellation of star: The star is
-                  // cancelled if application of any symmetry operation
-                  // in the group to the root vector yields a rotated 
-                  // vector equivalent to the root vector but with a 
-                  // nonzero phase, creating a contradiction.
-
-                  if (wave.indicesDft == rootItr->indicesDft) {
-                     if (abs(wave.phase) > 1.0E-6) {
-                        cancel = true;
-                     }
-                  }
-
-                  // Search for an equivalent wave already in the star.
-                  // Note: Equivalent waves have equal DFT indices.
-                  setItr = star.find(wave);
-
-                  if (setItr == star.end()) {
-
-                     // If no equivalent wave is found in the star,
-                     // then add this wave to the star
-                     star.insert(wave);
-
-                  } else {
-
-                     // If an equivalent wave is found, check if the
-                     // phases are equivalent. If not, the star is
-                     // cancelled.
-
-                     phase_diff = setItr->phase - wave.phase;
-                     while (phase_diff > 0.5) {
-                        phase_diff -= 1.0;
-                     }
-                     while (phase_diff <= -0.5) {
-                        phase_diff += 1.0;
-                     }
-                     if (abs(phase_diff) > 1.0E-6) {
-                        cancel = true;
-                     }
-
-                  }
-
-               }
-
-               // Copy all waves from set star to std::vector tempStar
-               tempStar.clear();
-               setItr = star.begin(); 
-               for ( ; setItr != star.end(); ++setItr) {
-                  tempStar.push_back(*setItr);
-               }
-
-               // Sort tempStar, in descending order by indicesBz.
-               TWaveBzComp<D> waveBzComp;
-               std::sort(tempStar.begin(), tempStar.end(), waveBzComp);
-               
-               // Append contents of tempStar to tempList, erase from list
-               int tempStarSize = tempStar.size();
-               for (j = 0; j < tempStarSize; ++j) {
-                  list.erase(tempStar[j]);
-                  tempList.append(tempStar[j]);
-               }
-               UTIL_CHECK((int)(tempList.size()+list.size())==listEnd-listBegin);
-
-               // If this star is not cancelled, increment the number
-               // of basis functions (nBasis_) and waves (nBasisWave_)
-               if (!cancel) {
-                  ++nBasis_;
-                  nBasisWave_ += star.size();
-               }
-
-               // Initialize a Star object 
-               newStar.eigen = Gsq;
-               newStar.beginId = starBegin;
-               newStar.endId = newStar.beginId + star.size();
-               newStar.size = star.size();
-               newStar.cancel = cancel;
-               // Note: newStar.starInvert is not yet known
-
-               // Determine invertFlag, rootItr and nextInvert
-               if (nextInvert == -1) {
-
-                  // If this star is 2nd of a pair related by inversion,
-                  // set root of next star to 1st wave of remaining list.
-
-                  newStar.invertFlag = -1;
-                  rootItr = list.begin();
-                  nextInvert = 1;
-
-               } else {
-
-                  // If this star is not the 2nd of a pair of partners,
-                  // then determine if it is closed under inversion.
-
-                  // Compute negation nVec of root vector in FBZ
-                  nVec.negate(rootVecBz);
-
-                  // Shift negation nVec to a DFT mesh
-                  (*meshPtr_).shift(nVec);
-       
-                  // Search for negation of root vector within this star
-                  bool negationFound = false;
-                  setItr = star.begin(); 
-                  for ( ; setItr != star.end(); ++setItr) {
-                     if (nVec == setItr->indicesDft) {
-                        negationFound = true;
-                        break;
-                     }
-                  }
-
-                  if (negationFound) {
-
-                     // If this star is closed under inversion, the root
-                     // of next star is the 1st vector of remaining list.
-
-                     newStar.invertFlag = 0;
-                     rootItr = list.begin();
-                     nextInvert = 1;
-
-                  } else {
-
-                     newStar.invertFlag = 1;
-                     nextInvert = -1;
-
-                     // If star is not closed, find negation of root in
-                     // the remaining list, and use this negation as the
-                     // root of the next star.
-
-                     setItr = list.begin();
-                     for ( ; setItr != list.end(); ++setItr) {
-                        if (nVec == setItr->indicesDft) {
-                           negationFound = true;
-                           rootItr = setItr;
-                           break;
-                        }
-                     }
-                     // If negationFound, then rootItr->indicesDft = nVec
-
-                     // Failure to find the negation here is an error:
-                     // It should be either in this star or remaining list
-
-                     if (!negationFound) {
-                        std::cout << "Negation not found for: " << "\n";
-                        std::cout << " vec (ft):" 
-                                  << rootItr->indicesDft <<"\n"; 
-                        std::cout << " vec (bz):" 
-                                  << rootItr->indicesBz <<"\n"; 
-                        std::cout << "-vec (dft):" << nVec << "\n";
-                        UTIL_CHECK(negationFound);
-                     }
-
-                  }
-
-               }
-
-               stars_.append(newStar);
-               ++starId;
-               starBegin = newStar.endId;
-
-            } 
-            // End loop over stars within a list.
-            // Processing of list is now complete.
-
-            UTIL_CHECK(list.size() == 0);
-            UTIL_CHECK(tempList.size() == listEnd - listBegin);
-
-            // Copy tempList into corresponding section of waves_,
-            // overwriting the section of waves_ used to create the list.
-            // Compute a complex coefficient of unit norm for each wave.
-            for (j = 0; j < tempList.size(); ++j) {
-               k = j + listBegin;
-               waves_[k].indicesDft = tempList[j].indicesDft;
-               waves_[k].indicesBz = tempList[j].indicesBz;
-               waves_[k].sqNorm = tempList[j].sqNorm;
-               coeff = std::complex<double>(0.0, tempList[j].phase);
-               coeff = exp(coeff);
-               if (abs(imag(coeff)) < 1.0E-6) {
-                  coeff = std::complex<double>(real(coeff), 0.0);
-               }
-               if (abs(real(coeff)) < 1.0E-6) {
-                  coeff = std::complex<double>(0.0, imag(coeff));
-               }
-               waves_[k].coeff = coeff;
+      // Append stars of all lists to stars_, in order of increasing norm
+      nBasis_ = 0;
+      nBasisWave_ = 0;
+      for (i = 0; i < nList; ++i) {
+         for (j = 0; j < (int)listStars[i].size(); ++j) {
+            Star const & star = listStars[i][j];
+            stars_.append(star);
+
+            // If this star is not cancelled, increment the number
+            // of basis functions (nBasis_) and waves (nBasisWave_)
+            if (!star.cancel) {
+               ++nBasis_;
+               nBasisWave_ += star.size;
             }
-
-            // At this point, waves_[k].coeff has unit absolute magnitude,
-            // and correct relative phases for waves within a star, but
-            // the coeff may not be unity for the first or last wave in
-            // the star.
-
-            ++listId;
-            listBegin = listEnd;
-         } 
-         // Finished processing a list of waves of equal norm
-
-      } // End loop over all waves
+         }
+      }
       nStar_ = stars_.size();
       // Complete initial processing of all lists and stars
 
@@ -608,13 +401,16 @@ namespace Pscf {
       } // end loop over stars
 
       // Final processing of waves in stars
-      for (i = 0; i < nStar_; ++i) {
+      #ifdef PSCF_OPENMP
+      #pragma omp parallel for schedule(static)
+      #endif
+      for (int is = 0; is < nStar_; ++is) {
 
          // Set starId and normalize coefficients for associated waves
-         double snorm = 1.0/sqrt(double(stars_[i].size));
-         for (j = stars_[i].beginId; j < stars_[i].endId; ++j) {
-            waves_[j].starId = i;
-            waves_[j].coeff *= snorm;
+         double snorm = 1.0/sqrt(double(stars_[is].size));
+         for (int iw = stars_[is].beginId; iw < stars_[is].endId; ++iw) {
+            waves_[iw].starId = is;
+            waves_[iw].coeff *= snorm;
          }
 
       }
@@ -642,6 +438,289 @@ namespace Pscf {
 
    }
 
+   /*
+   * Identify stars within one list of waves of equal norm.
+   *
+   * On entry, elements listBegin <= id < listEnd of twaves contain the
+   * waves of this list, sorted in ascending order of indicesDft, and
+   * waveIds_[rank] is the index in twaves of the wave with indicesDft 
+   * of the specified rank. On exit, the same elements of waves_ contain
+   * these waves ordered by star, with indicesDft, indicesBz, sqNorm and
+   * a coefficient of unit magnitude, and array stars contains the stars
+   * of this list, for which all members except waveBz are set.
+   */
+   template <int D>
+   void Basis<D>::makeListStars(const SpaceGroup<D>& group,
+                                std::vector< TWave<D> > const & twaves,
+                                int listBegin, int listEnd,
+                                std::vector<Star>& stars)
+   {
+      /* 
+      * Local containers, indexed by id - listBegin for wave id:
+      * starIds - index of star containing each wave, or -1 if the wave
+      *           is not yet in a star (i.e., is in the remaining list)
+      * phases - phase of each wave that has been added to a star
+      *
+      * tempStar - temporary star, sorted by descending indicesBz
+      */
+      int listSize = listEnd - listBegin;
+      std::vector<int> starIds(listSize, -1);
+      std::vector<double> phases(listSize, 0.0);
+      std::vector< TWave<D> > tempStar;  
+
+      TWave<D> wave;
+      Basis<D>::Star newStar;
+
+      std::complex<double> coeff;
+      double Gsq;
+      double phase_diff;
+      const double twoPi = 2.0*Constants::Pi;
+      const double epsilon = 1.0E-8;
+      IntVec<D> rootVecBz;
+      IntVec<D> rootVecDft;
+      IntVec<D> vec;
+      IntVec<D> nVec;
+      int nRemaining = listSize; // number of waves not yet in a star
+      int firstId = 0;     // local index of first remaining wave
+      int rootId = 0;      // local index of root of next star
+      int starId = 0;      // local index of this star 
+      int starBegin = listBegin;  // id of first wave in this star
+      int id, i, j, k;
+      bool cancel;
+
+      // Copy rotation matrices and translations of all symmetry 
+      // operations into local arrays. Translations are stored as 
+      // numerators and denominators of rational numbers.
+      int nOp = group.size();
+      std::vector<int> rotations(nOp*D*D);
+      std::vector<int> tNum(nOp*D);
+      std::vector<int> tDen(nOp*D);
+      for (j = 0; j < nOp; ++j) {
+         for (k = 0; k < D; ++k) {
+            for (i = 0; i < D; ++i) {
+               rotations[(j*D + k)*D + i] = group[j].R(k, i);
+            }
+            tNum[j*D + k] = group[j].t(k).num();
+            tDen[j*D + k] = group[j].t(k).den();
+         }
+      }
+
+      // On entry to each iteration of the loop over stars, rootId and
+      // nextInvert are known. The root of the next star is the wave 
+      // with local index rootId. The flag nextInvert is equal to -1 iff
+      // the previous star was the first of a pair that are open under 
+      // inversion, and is equal to +1 otherwise.
+      int nextInvert = 1;
+
+      // Loop over stars with a list of waves of equal norm. The root 
+      // of the next star must have been chosen on entry to each 
+      // iteration of this loop.
+
+      while (nRemaining > 0) {
+
+         rootVecBz = twaves[listBegin + rootId].indicesBz;
+         rootVecDft = twaves[listBegin + rootId].indicesDft;
+         Gsq = twaves[listBegin + rootId].sqNorm;
+         cancel = false;
+         tempStar.clear();
+
+         // Construct a star from root vector, by applying every
+         // symmetry operation in the group to the root wavevector.
+         for (j = 0; j < nOp; ++j) {
+
+            // Apply symmetry (i.e., multiply by rotation matrix)
+            // vec = rotated wavevector.
+            for (i = 0; i < D; ++i) {
+               vec[i] = 0;
+               for (k = 0; k < D; ++k) {
+                  vec[i] += rootVecBz[k]*rotations[(j*D + k)*D + i];
+               }
+            }
+
+            // Check that rotated vector has same norm as root.
+            UTIL_CHECK(abs(Gsq - unitCell().ksq(vec)) < epsilon);
+
+            // Initialize TWave object associated with rotated wave
+            wave.sqNorm = Gsq;
+            wave.indicesDft = vec;
+            mesh().shift(wave.indicesDft);
+
+            // Compute phase for coeff. of wave in basis function.
+            // Convention -pi < phase <= pi.
+            wave.phase = 0.0;
+            for (k = 0; k < D; ++k) {
+               wave.phase += double(rootVecBz[k]*tNum[j*D + k])
+                             / double(tDen[j*D + k]);
+            }
+            // Shift phase into -0.5 < phase <= 0.5, by subtracting an 
+            // integer. Both subtractions are exact, and so equivalent 
+            // to repeatedly adding or subtracting 1.0.
+            wave.phase -= std::ceil(wave.phase - 0.5);
+            wave.phase *= twoPi;
+
+            // Check for cancellation of star: The star is
+            // cancelled if application of any symmetry operation
+            // in the group to the root vector yields a rotated 
+            // vector equivalent to the root vector but with a 
+            // nonzero phase, creating a contradiction.
+
+            if (wave.indicesDft == rootVecDft) {
+               if (abs(wave.phase) > 1.0E-6) {
+                  cancel = true;
+               }
+            }
+
+            // Find local index of the rotated wave in this list. 
+            // Equivalent waves have equal DFT indices.
+            id = waveIds_[mesh().rank(wave.indicesDft)] - listBegin;
+            UTIL_CHECK(id >= 0 && id < listSize);
+
+            if (starIds[id] < 0) {
+
+               // If this wave is not yet in the star, add it. Its 
+               // minimum image was computed by makeWaves.
+               wave.indicesBz = twaves[listBegin + id].indicesBz;
+               starIds[id] = starId;
+               phases[id] = wave.phase;
+               tempStar.push_back(wave);
+
+            } else {
+
+               // A wave can only be in one star 
+               UTIL_CHECK(starIds[id] == starId);
+
+               // If an equivalent wave is found, check if the
+               // phases are equivalent. If not, the star is
+               // cancelled.
+
+               phase_diff = phases[id] - wave.phase;
+               while (phase_diff > 0.5) {
+                  phase_diff -= 1.0;
+               }
+               while (phase_diff <= -0.5) {
+                  phase_diff += 1.0;
+               }
+               if (abs(phase_diff) > 1.0E-6) {
+                  cancel = true;
+               }
+
+            }
+
+         }
+
+         // Sort tempStar, in descending order by indicesBz.
+         TWaveBzComp<D> waveBzComp;
+         std::sort(tempStar.begin(), tempStar.end(), waveBzComp);
+         int starSize = tempStar.size();
+         nRemaining -= starSize;
+
+         // Copy tempStar into corresponding section of waves_.
+         // Compute a complex coefficient of unit norm for each wave.
+         for (j = 0; j < starSize; ++j) {
+            k = j + starBegin;
+            waves_[k].indicesDft = tempStar[j].indicesDft;
+            waves_[k].indicesBz = tempStar[j].indicesBz;
+            waves_[k].sqNorm = tempStar[j].sqNorm;
+            coeff = std::complex<double>(0.0, tempStar[j].phase);
+            coeff = exp(coeff);
+            if (abs(imag(coeff)) < 1.0E-6) {
+               coeff = std::complex<double>(real(coeff), 0.0);
+            }
+            if (abs(real(coeff)) < 1.0E-6) {
+               coeff = std::complex<double>(0.0, imag(coeff));
+            }
+            waves_[k].coeff = coeff;
+         }
+
+         // At this point, waves_[k].coeff has unit absolute magnitude,
+         // and correct relative phases for waves within a star, but
+         // the coeff may not be unity for the first or last wave in
+         // the star.
+
+         // Initialize a Star object 
+         newStar.eigen = Gsq;
+         newStar.beginId = starBegin;
+         newStar.endId = newStar.beginId + starSize;
+         newStar.size = starSize;
+         newStar.cancel = cancel;
+         newStar.waveBz = rootVecBz;
+         // Note: newStar.starInvert is not yet known, and waveBz is
+         // reset by makeStars if this star is the 2nd of a pair
+
+         // Find first wave of remaining list
+         while (firstId < listSize && starIds[firstId] >= 0) {
+            ++firstId;
+         }
+
+         // Determine invertFlag, rootId and nextInvert
+         if (nextInvert == -1) {
+
+            // If this star is 2nd of a pair related by inversion,
+            // set root of next star to 1st wave of remaining list.
+
+            newStar.invertFlag = -1;
+            rootId = firstId;
+            nextInvert = 1;
+
+         } else {
+
+            // If this star is not the 2nd of a pair of partners,
+            // then determine if it is closed under inversion.
+
+            // Compute negation nVec of root vector in FBZ
+            nVec.negate(rootVecBz);
+
+            // Shift negation nVec to a DFT mesh
+            mesh().shift(nVec);
+
+            // Find local index of negation in this list
+            id = waveIds_[mesh().rank(nVec)] - listBegin;
+            bool negationFound = (id >= 0 && id < listSize);
+
+            if (negationFound && starIds[id] == starId) {
+
+               // If this star is closed under inversion, the root
+               // of next star is the 1st vector of remaining list.
+
+               newStar.invertFlag = 0;
+               rootId = firstId;
+               nextInvert = 1;
+
+            } else {
+
+               newStar.invertFlag = 1;
+               nextInvert = -1;
+
+               // If star is not closed, the negation of the root must
+               // be in the remaining list, and is used as the root of 
+               // the next star.
+
+               if (negationFound) {
+                  negationFound = (starIds[id] < 0);
+               }
+               if (!negationFound) {
+                  std::stringstream msg;
+                  msg << "Negation not found for vec (dft) " << rootVecDft
+                      << ", vec (bz) " << rootVecBz 
+                      << ", -vec (dft) " << nVec;
+                  UTIL_THROW(msg.str().c_str());
+               }
+               rootId = id;
+
+            }
+
+         }
+
+         stars.push_back(newStar);
+         ++starId;
+         starBegin = newStar.endId;
+
+      } 
+      // End loop over stars within a list.
+
+      UTIL_CHECK(starBegin == listEnd);
+   }
+
   
    template <int D>
    void Basis<D>::update()
@@ -662,6 +741,319 @@ namespace Pscf {
 
    }
 
+   /*
+   * Construct basis, reading or writing a binary cache file.
+   */
+   template <int D>
+   bool Basis<D>::makeBasis(const Mesh<D>& mesh, 
+                            const UnitCell<D>& unitCell,
+                            std::string groupName, 
+                            std::string cacheDir)
+   {
+      std::string filename = cacheDir;
+      if (!filename.empty() && filename[filename.size()-1] != '/') {
+         filename += "/";
+      }
+      filename += cacheFileName(mesh, unitCell, groupName);
+
+      if (readCache(filename, mesh, unitCell, groupName)) {
+         return true;
+      }
+      makeBasis(mesh, unitCell, groupName);
+      writeCache(filename, groupName);
+      return false;
+   }
+
+   /*
+   * Read basis from a binary cache file, if the file matches.
+   */
+   template <int D>
+   bool Basis<D>::readCache(std::string filename, 
+                            const Mesh<D>& mesh, 
+                            const UnitCell<D>& unitCell,
+                            std::string groupName)
+   {
+      // Map file into memory, read-only and shared
+      int fd = open(filename.c_str(), O_RDONLY);
+      if (fd < 0) {
+         return false;
+      }
+      struct stat status;
+      if (fstat(fd, &status) != 0 
+          || status.st_size < (off_t) sizeof(BasisCacheHeader)) {
+         close(fd);
+         return false;
+      }
+      size_t length = status.st_size;
+      void* map = mmap(0, length, PROT_READ, MAP_SHARED, fd, 0);
+      close(fd);
+      if (map == MAP_FAILED) {
+         return false;
+      }
+      char const * data = (char const *) map;
+
+      // Compare key fields of header to those expected
+      BasisCacheHeader const & header = *((BasisCacheHeader const *) data);
+      BasisCacheHeader key;
+      makeCacheHeader(key, mesh, unitCell, groupName);
+      bool match = true;
+      if (strncmp(header.magic, key.magic, 8) != 0) match = false;
+      if (header.version != key.version) match = false;
+      if (header.byteOrder != key.byteOrder) match = false;
+      if (header.starSize != key.starSize) match = false;
+      if (header.waveSize != key.waveSize) match = false;
+      if (header.dimension != key.dimension) match = false;
+      for (int i = 0; i < 3; ++i) {
+         if (header.meshDimensions[i] != key.meshDimensions[i]) {
+            match = false;
+         }
+      }
+      if (header.nParameter != key.nParameter) match = false;
+      if (strncmp(header.lattice, key.lattice, 32) != 0) match = false;
+      if (strncmp(header.groupName, key.groupName, 64) != 0) {
+         match = false;
+      }
+      if (match && key.nParameter > 1) {
+         for (int i = 0; i < key.nParameter; ++i) {
+            if (header.parameters[i] != key.parameters[i]) match = false;
+         }
+      }
+      if (match) {
+         size_t expected = sizeof(BasisCacheHeader);
+         expected += header.nStar*sizeof(BasisCacheStar);
+         expected += header.nWave*(sizeof(BasisCacheWave) + sizeof(int));
+         if (header.nWave != mesh.size() || header.nStar <= 0 
+             || length != expected) {
+            match = false;
+         }
+      }
+      if (!match) {
+         munmap(map, length);
+         return false;
+      }
+
+      // Save pointers to mesh and unit cell
+      meshPtr_ = &mesh;
+      unitCellPtr_ = &unitCell;
+      minimumImage_.setup(mesh.dimensions(), unitCell);
+
+      // Copy stars
+      BasisCacheStar const * starRecords;
+      starRecords = (BasisCacheStar const *)(data + sizeof(BasisCacheHeader));
+      Star star;
+      int i, j;
+      nStar_ = header.nStar;
+      stars_.clear();
+      for (i = 0; i < nStar_; ++i) {
+         BasisCacheStar const & record = starRecords[i];
+         star.eigen = record.eigen;
+         star.size = record.size;
+         star.beginId = record.beginId;
+         star.endId = record.endId;
+         star.invertFlag = record.invertFlag;
+         star.cancel = (record.cancel != 0);
+         for (j = 0; j < D; ++j) {
+            star.waveBz[j] = record.waveBz[j];
+         }
+         stars_.append(star);
+      }
+
+      // Copy waves 
+      BasisCacheWave const * waveRecords;
+      waveRecords = (BasisCacheWave const *)(starRecords + nStar_);
+      nWave_ = header.nWave;
+      waves_.allocate(nWave_);
+      for (i = 0; i < nWave_; ++i) {
+         BasisCacheWave const & record = waveRecords[i];
+         Wave& wave = waves_[i];
+         wave.coeff = std::complex<double>(record.coeff[0], record.coeff[1]);
+         wave.sqNorm = record.sqNorm;
+         for (j = 0; j < D; ++j) {
+            wave.indicesDft[j] = record.indicesDft[j];
+            wave.indicesBz[j] = record.indicesBz[j];
+         }
+         wave.starId = record.starId;
+         wave.implicit = (record.implicit != 0);
+      }
+
+      // Copy look up table for waves
+      int const * ids = (int const *)(waveRecords + nWave_);
+      waveIds_.allocate(nWave_);
+      for (i = 0; i < nWave_; ++i) {
+         waveIds_[i] = ids[i];
+      }
+
+      nBasis_ = header.nBasis;
+      nBasisWave_ = header.nBasisWave;
+
+      // Recompute norms if the unit cell parameters differ
+      bool isSameCell = true;
+      for (i = 0; i < key.nParameter; ++i) {
+         if (header.parameters[i] != key.parameters[i]) {
+            isSameCell = false;
+         }
+      }
+      munmap(map, length);
+      if (!isSameCell) {
+         update();
+      }
+
+      if (!isValid()) {
+         UTIL_THROW("Basis read from cache file failed validity check");
+      }
+      return true;
+   }
+
+   /*
+   * Write basis to a binary cache file.
+   */
+   template <int D>
+   bool Basis<D>::writeCache(std::string filename, 
+                             std::string groupName) const
+   {
+      UTIL_CHECK(nWave_ > 0);
+
+      BasisCacheHeader header;
+      makeCacheHeader(header, mesh(), unitCell(), groupName);
+      if (groupName.size() >= sizeof(header.groupName)) {
+         return false;
+      }
+      header.nWave = nWave_;
+      header.nStar = nStar_;
+      header.nBasis = nBasis_;
+      header.nBasisWave = nBasisWave_;
+
+      // Write to a temporary file, unique to this process
+      std::ostringstream tempName;
+      tempName << filename << "." << getpid() << ".tmp";
+      std::ofstream out(tempName.str().c_str(), std::ios::binary);
+      if (!out.is_open()) {
+         return false;
+      }
+      out.write((char const *) &header, sizeof(header));
+
+      // Write stars
+      BasisCacheStar starRecord;
+      int i, j;
+      for (i = 0; i < nStar_; ++i) {
+         memset(&starRecord, 0, sizeof(starRecord));
+         starRecord.eigen = stars_[i].eigen;
+         starRecord.size = stars_[i].size;
+         starRecord.beginId = stars_[i].beginId;
+         starRecord.endId = stars_[i].endId;
+         starRecord.invertFlag = stars_[i].invertFlag;
+         starRecord.cancel = stars_[i].cancel ? 1 : 0;
+         for (j = 0; j < D; ++j) {
+            starRecord.waveBz[j] = stars_[i].waveBz[j];
+         }
+         out.write((char const *) &starRecord, sizeof(starRecord));
+      }
+
+      // Write waves
+      BasisCacheWave waveRecord;
+      for (i = 0; i < nWave_; ++i) {
+         memset(&waveRecord, 0, sizeof(waveRecord));
+         waveRecord.coeff[0] = waves_[i].coeff.real();
+         waveRecord.coeff[1] = waves_[i].coeff.imag();
+         waveRecord.sqNorm = waves_[i].sqNorm;
+         for (j = 0; j < D; ++j) {
+            waveRecord.indicesDft[j] = waves_[i].indicesDft[j];
+            waveRecord.indicesBz[j] = waves_[i].indicesBz[j];
+         }
+         waveRecord.starId = waves_[i].starId;
+         waveRecord.implicit = waves_[i].implicit ? 1 : 0;
+         out.write((char const *) &waveRecord, sizeof(waveRecord));
+      }
+
+      // Write look up table for waves
+      int id;
+      for (i = 0; i < nWave_; ++i) {
+         id = waveIds_[i];
+         out.write((char const *) &id, sizeof(int));
+      }
+      out.close();
+
+      // Rename temporary file. On POSIX systems, this atomically 
+      // replaces any file of the same name written concurrently.
+      if (out.fail() || rename(tempName.str().c_str(), filename.c_str())) {
+         remove(tempName.str().c_str());
+         return false;
+      }
+      return true;
+   }
+
+   /*
+   * Get the name of the cache file for a group, mesh and unit cell.
+   */
+   template <int D>
+   std::string Basis<D>::cacheFileName(const Mesh<D>& mesh, 
+                                       const UnitCell<D>& unitCell,
+                                       std::string groupName)
+   {
+      BasisCacheHeader header;
+      makeCacheHeader(header, mesh, unitCell, groupName);
+
+      // Replace characters that are not safe in file names
+      std::string group = groupName;
+      for (size_t k = 0; k < group.size(); ++k) {
+         char c = group[k];
+         if (!(isalnum(c) || c == '_' || c == '-')) {
+            group[k] = '.';
+         }
+      }
+
+      std::ostringstream name;
+      name << "basis_" << D << "d_" << group << "_";
+      for (int i = 0; i < D; ++i) {
+         if (i > 0) name << "x";
+         name << mesh.dimension(i);
+      }
+      name << "_" << header.lattice;
+      if (header.nParameter > 1) {
+         name << std::setprecision(17);
+         for (int i = 0; i < header.nParameter; ++i) {
+            name << "_" << header.parameters[i];
+         }
+      }
+      name << ".bin";
+      return name.str();
+   }
+
+   /*
+   * Set the key fields of a cache file header.
+   */
+   template <int D>
+   void Basis<D>::makeCacheHeader(BasisCacheHeader& header,
+                                  const Mesh<D>& mesh, 
+                                  const UnitCell<D>& unitCell,
+                                  std::string groupName)
+   {
+      memset(&header, 0, sizeof(header));
+      strncpy(header.magic, "PSCFBAS", 8);
+      header.version = 1;
+      header.byteOrder = 0x01020304;
+      header.starSize = sizeof(BasisCacheStar);
+      header.waveSize = sizeof(BasisCacheWave);
+      header.dimension = D;
+      for (int i = 0; i < D; ++i) {
+         header.meshDimensions[i] = mesh.dimension(i);
+      }
+      header.nParameter = unitCell.nParameter();
+      for (int i = 0; i < header.nParameter; ++i) {
+         header.parameters[i] = unitCell.parameter(i);
+      }
+
+      // Name of lattice system: first item in unit cell output
+      std::ostringstream cellStream;
+      cellStream << unitCell;
+      std::istringstream latticeStream(cellStream.str());
+      std::string lattice;
+      latticeStream >> lattice;
+      strncpy(header.lattice, lattice.c_str(), sizeof(header.lattice)-1);
+      strncpy(header.groupName, groupName.c_str(), 
+              sizeof(header.groupName)-1);
+   }
+
    template <int D>
    int Basis<D>::nBasis() const
    {  return nBasis_; }
@@ -875,16 +1267,11 @@ namespace Pscf {
             for (iw = begin; iw < end; ++iw) {
                v.negate(waves_[iw].indicesBz);
                mesh().shift(v);
-               negationFound = false;
-               for (iwp = begin; iw < end; ++iwp) {
-                  if (waves_[iwp].indicesDft == v) {
-                     negationFound = true;
-                     if (!cancel) {
-                        cdel = conj(waves_[iwp].coeff);
-                        cdel -= waves_[iw].coeff;
-                     }
-                     break;
-                  }
+               iwp = waveIds_[mesh().rank(v)];
+               negationFound = (iwp >= begin && iwp < end);
+               if (negationFound && !cancel) {
+                  cdel = conj(waves_[iwp].coeff);
+                  cdel -= waves_[iw].coeff;
                }
                if (!negationFound) {
                   std::cout << "+G = " << waves_[iw].indicesBz
@@ -940,22 +1327,17 @@ namespace Pscf {
             for (iw = stars_[is].beginId; iw < stars_[is].endId; ++iw) {
                v.negate(waves_[iw].indicesBz);
                mesh().shift(v);
-               negationFound = false;
-               // Loop over second star, searching for negation
-               for (iwp = begin; iw < end; ++iwp) {
-                  if (waves_[iwp].indicesDft == v) {
-                     negationFound = true;
-                     if (!cancel) {
-                        cdel = conj(waves_[iwp].coeff);
-                        cdel -= waves_[iw].coeff;
-                        if (abs(cdel) > 1.0E-8) {
-                           std::cout  << 
-                             "Coefficients not conjugates in open star"
-                             << std::endl;
-                           return false;
-                        }
-                     }
-                     break;
+               // Look up negation, check that it is in second star
+               iwp = waveIds_[mesh().rank(v)];
+               negationFound = (iwp >= begin && iwp < end);
+               if (negationFound && !cancel) {
+                  cdel = conj(waves_[iwp].coeff);
+                  cdel -= waves_[iw].coeff;
+                  if (abs(cdel) > 1.0E-8) {
+                     std::cout  << 
+                       "Coefficients not conjugates in open star"
+                       << std::endl;
+                     return false;
                   }
                }
                if (!negationFound) {
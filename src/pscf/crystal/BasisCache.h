@@ -0,0 +1,95 @@
+#ifndef PSCF_BASIS_CACHE_H
+#define PSCF_BASIS_CACHE_H
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+namespace Pscf {
+
+   /**
+   * Header of a binary Basis cache file.
+   *
+   * A basis cache file contains a BasisCacheHeader, followed by an
+   * array of nStar BasisCacheStar records, an array of nWave
+   * BasisCacheWave records, and an array of nWave int values of
+   * Basis::waveId, indexed by the rank of each wave on the DFT mesh.
+   * All records have sizes that are multiples of 8 bytes, so every
+   * section of a file that is mapped into memory (e.g., with mmap) is
+   * correctly aligned. Data are stored in the native binary format of
+   * the machine that wrote the file. See Basis::readCache and
+   * Basis::writeCache.
+   *
+   * \ingroup Pscf_Crystal_Module
+   */
+   struct BasisCacheHeader
+   {
+      /// Identifier "PSCFBAS" (null terminated).
+      char magic[8];
+      /// Unit cell parameters.
+      double parameters[6];
+      /// File format version.
+      int version;
+      /// Known integer constant, used to check byte order.
+      int byteOrder;
+      /// Size of BasisCacheStar, in bytes.
+      int starSize;
+      /// Size of BasisCacheWave, in bytes.
+      int waveSize;
+      /// Dimension of space.
+      int dimension;
+      /// Mesh dimensions (unused elements are zero).
+      int meshDimensions[3];
+      /// Number of unit cell parameters.
+      int nParameter;
+      /// Number of waves.
+      int nWave;
+      /// Number of stars.
+      int nStar;
+      /// Number of basis functions (uncancelled stars).
+      int nBasis;
+      /// Number of waves in uncancelled stars.
+      int nBasisWave;
+      /// Padding (unused).
+      int pad;
+      /// Name of lattice system (null terminated).
+      char lattice[32];
+      /// Name of space group (null terminated).
+      char groupName[64];
+   };
+
+   /**
+   * Record for one star in a binary Basis cache file.
+   *
+   * \ingroup Pscf_Crystal_Module
+   */
+   struct BasisCacheStar
+   {
+      double eigen;
+      int size;
+      int beginId;
+      int endId;
+      int invertFlag;
+      int cancel;
+      int waveBz[3];
+   };
+
+   /**
+   * Record for one wave in a binary Basis cache file.
+   *
+   * \ingroup Pscf_Crystal_Module
+   */
+   struct BasisCacheWave
+   {
+      double coeff[2];
+      double sqNorm;
+      int indicesDft[3];
+      int indicesBz[3];
+      int starId;
+      int implicit;
+   };
+
+} // namespace Pscf
+#endif
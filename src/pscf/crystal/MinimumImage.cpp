@@ -0,0 +1,16 @@
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "MinimumImage.tpp"
+
+namespace Pscf {
+
+   template class MinimumImage<1>;
+   template class MinimumImage<2>;
+   template class MinimumImage<3>;
+
+}
@@ -0,0 +1,171 @@
+#ifndef PSCF_MINIMUM_IMAGE_H
+#define PSCF_MINIMUM_IMAGE_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <pscf/crystal/UnitCell.h>
+#include <pscf/math/IntVec.h>
+#include <pscf/math/RealVec.h>
+#include <util/containers/FArray.h>
+#include <util/containers/FMatrix.h>
+
+namespace Pscf
+{
+
+   using namespace Util;
+
+   /**
+   * Finds minimum magnitude images of DFT wavevectors.
+   *
+   * A MinimumImage<D> returns the same image of a wavevector as the
+   * function shiftToMinimum, i.e., the image of minimum magnitude
+   * |G|^2 among those that differ by multiples of the DFT mesh
+   * dimensions, with ties within a tolerance of 1.0E-6 resolved by
+   * choosing the image with the greatest indices (using operator <).
+   * It is faster because work that depends only on the mesh and unit
+   * cell is done once, by setup, rather than for each wavevector:
+   *
+   *  - If the reciprocal basis vectors are mutually orthogonal, |G|^2
+   *    is a sum of independent contributions from each index, and the
+   *    minimum image is found by shifting each index independently.
+   *
+   *  - Otherwise, setup computes an LLL-reduced basis for the lattice
+   *    of shifts, and the closest shifted vector is found by a bounded
+   *    enumeration (Fincke-Pohst) of lattice points, beginning from
+   *    the rounded coordinates of the wavevector in the reduced basis.
+   *    For typical cells, this evaluates a few candidate images, rather
+   *    than the 5^D images checked by shiftToMinimum. Unlike the latter,
+   *    it is exact for arbitrarily distorted cells.
+   *
+   * Images depend on the unit cell only through the angles between
+   * reciprocal basis vectors and their ratios. Results for orthogonal
+   * cells thus remain valid when the cell parameters change.
+   *
+   * \ingroup Pscf_Crystal_Module
+   */
+   template <int D>
+   class MinimumImage
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      */
+      MinimumImage();
+
+      /**
+      * Prepare to find images for a mesh and unit cell.
+      *
+      * \param meshDimensions  dimensions of the DFT mesh
+      * \param cell  unit cell
+      */
+      void setup(IntVec<D> const & meshDimensions,
+                 UnitCell<D> const & cell);
+
+      /**
+      * Return the minimum image of a wavevector.
+      *
+      * \param v  integer indices of wavevector
+      */
+      IntVec<D> shift(IntVec<D> const & v) const;
+
+      /**
+      * Are the reciprocal basis vectors mutually orthogonal?
+      */
+      bool isOrthogonal() const;
+
+      /**
+      * Has setup been called?
+      */
+      bool isSetup() const;
+
+   private:
+
+      // Reciprocal lattice basis vectors (copy from the unit cell).
+      FArray<RealVec<D>, D> kBasis_;
+
+      // Dimensions of DFT mesh.
+      IntVec<D> meshDimensions_;
+
+      // Reduced basis vectors for the lattice of shifts (index space).
+      FArray<IntVec<D>, D> basis_;
+
+      // Inverse of matrix with columns basis_[k]: element (k, i).
+      FMatrix<double, D, D> inverse_;
+
+      // Gram-Schmidt coefficients mu_(i, j), for j < i.
+      FMatrix<double, D, D> mu_;
+
+      // Squared norms of Gram-Schmidt vectors.
+      FArray<double, D> bStarSq_;
+
+      // Are the reciprocal basis vectors mutually orthogonal?
+      bool isOrthogonal_;
+
+      // Has setup been called?
+      bool isSetup_;
+
+      /**
+      * Return |G|^2 of wavevector v, evaluated as in UnitCell::ksq.
+      */
+      double ksq(IntVec<D> const & v) const;
+
+      /**
+      * Return the scalar product of two index-space vectors.
+      */
+      double dot(IntVec<D> const & a, IntVec<D> const & b) const;
+
+      /**
+      * Compute mu_ and bStarSq_ for the current basis_.
+      */
+      void computeGramSchmidt();
+
+      /**
+      * Reduce basis_ by the LLL algorithm.
+      */
+      void reduceBasis();
+
+      /**
+      * Recursively enumerate lattice points, from index i downwards.
+      *
+      * \param i  index of basis vector to enumerate
+      * \param c  coordinates of target in reduced basis
+      * \param t  integer coordinates of the current point (in/out)
+      * \param partial  partial squared distance for indices > i
+      * \param v  wavevector to be shifted
+      * \param bound  squared distance bound (in/out)
+      * \param minSq  minimum |G|^2 found (in/out)
+      * \param isFinal  if true, select a final image within bound
+      * \param image  selected image (out)
+      */
+      void enumerate(int i, double const * c, int* t, double partial,
+                     IntVec<D> const & v, double& bound, double& minSq,
+                     bool isFinal, IntVec<D>& image) const;
+
+   };
+
+   // Inline member functions
+
+   template <int D>
+   inline bool MinimumImage<D>::isOrthogonal() const
+   {  return isOrthogonal_; }
+
+   template <int D>
+   inline bool MinimumImage<D>::isSetup() const
+   {  return isSetup_; }
+
+   #ifndef PSCF_MINIMUM_IMAGE_TPP
+   // Suppress implicit instantiation
+   extern template class MinimumImage<1>;
+   extern template class MinimumImage<2>;
+   extern template class MinimumImage<3>;
+   #endif
+
+}
+#endif
@@ -0,0 +1,323 @@
+#ifndef PSCF_MINIMUM_IMAGE_TPP
+#define PSCF_MINIMUM_IMAGE_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "MinimumImage.h"
+#include <util/global.h>
+#include <cmath>
+#include <limits>
+
+namespace Pscf
+{
+
+   using namespace Util;
+
+   /*
+   * Constructor.
+   */
+   template <int D>
+   MinimumImage<D>::MinimumImage()
+    : isOrthogonal_(false),
+      isSetup_(false)
+   {}
+
+   /*
+   * Copy unit cell data, and reduce the basis for the lattice of shifts.
+   */
+   template <int D>
+   void MinimumImage<D>::setup(IntVec<D> const & meshDimensions,
+                               UnitCell<D> const & cell)
+   {
+      int i, j;
+      meshDimensions_ = meshDimensions;
+      for (i = 0; i < D; ++i) {
+         UTIL_CHECK(meshDimensions_[i] > 0);
+         kBasis_[i] = cell.kBasis(i);
+      }
+
+      // Check for mutually orthogonal reciprocal basis vectors
+      isOrthogonal_ = true;
+      double product;
+      int k;
+      for (i = 0; i < D; ++i) {
+         for (j = i + 1; j < D; ++j) {
+            product = 0.0;
+            for (k = 0; k < D; ++k) {
+               product += kBasis_[i][k]*kBasis_[j][k];
+            }
+            if (product != 0.0) {
+               isOrthogonal_ = false;
+            }
+         }
+      }
+
+      if (!isOrthogonal_) {
+
+         // Initial basis: shifts by one mesh dimension along each axis
+         for (i = 0; i < D; ++i) {
+            for (j = 0; j < D; ++j) {
+               basis_[i][j] = 0;
+            }
+            basis_[i][i] = meshDimensions_[i];
+         }
+         reduceBasis();
+
+         // Invert the matrix with columns basis_[k], by Gauss-Jordan
+         // elimination with partial pivoting
+         FMatrix<double, D, D> a;
+         int p;
+         double factor, temp;
+         for (i = 0; i < D; ++i) {
+            for (k = 0; k < D; ++k) {
+               a(i, k) = double(basis_[k][i]);
+               inverse_(i, k) = (i == k) ? 1.0 : 0.0;
+            }
+         }
+         for (k = 0; k < D; ++k) {
+            p = k;
+            for (i = k + 1; i < D; ++i) {
+               if (std::abs(a(i, k)) > std::abs(a(p, k))) p = i;
+            }
+            UTIL_CHECK(std::abs(a(p, k)) > 0.5);
+            if (p != k) {
+               for (j = 0; j < D; ++j) {
+                  temp = a(k, j); a(k, j) = a(p, j); a(p, j) = temp;
+                  temp = inverse_(k, j);
+                  inverse_(k, j) = inverse_(p, j);
+                  inverse_(p, j) = temp;
+               }
+            }
+            factor = 1.0/a(k, k);
+            for (j = 0; j < D; ++j) {
+               a(k, j) *= factor;
+               inverse_(k, j) *= factor;
+            }
+            for (i = 0; i < D; ++i) {
+               if (i == k) continue;
+               factor = a(i, k);
+               if (factor == 0.0) continue;
+               for (j = 0; j < D; ++j) {
+                  a(i, j) -= factor*a(k, j);
+                  inverse_(i, j) -= factor*inverse_(k, j);
+               }
+            }
+         }
+
+      }
+      isSetup_ = true;
+   }
+
+   /*
+   * Return the minimum image of wavevector v.
+   */
+   template <int D>
+   IntVec<D> MinimumImage<D>::shift(IntVec<D> const & v) const
+   {
+      UTIL_ASSERT(isSetup_);
+      IntVec<D> u;
+      int i, d;
+
+      // Orthogonal cells: shift each index to the range (-d/2, d/2]
+      if (isOrthogonal_) {
+         for (i = 0; i < D; ++i) {
+            d = meshDimensions_[i];
+            u[i] = v[i] % d;
+            if (u[i] < 0) u[i] += d;
+            if (u[i] > d/2) u[i] -= d;
+         }
+         return u;
+      }
+
+      // Coordinates c of target -v in the reduced basis, and the
+      // nearest lattice point t, obtained by rounding c
+      double c[D];
+      int t[D];
+      for (int k = 0; k < D; ++k) {
+         c[k] = 0.0;
+         for (i = 0; i < D; ++i) {
+            c[k] -= inverse_(k, i)*double(v[i]);
+         }
+         t[k] = (int) std::floor(c[k] + 0.5);
+      }
+      u = v;
+      for (int k = 0; k < D; ++k) {
+         for (i = 0; i < D; ++i) {
+            u[i] += t[k]*basis_[k][i];
+         }
+      }
+
+      // Find the minimum |G|^2, then choose the greatest image within
+      // a tolerance epsilon of this minimum, as in shiftToMinimum.
+      // Bounds used to prune the enumeration are slightly enlarged to
+      // guard against round-off in the Gram-Schmidt decomposition.
+      const double epsilon = 1.0E-6;
+      double minSq = ksq(u);
+      double bound = minSq*(1.0 + 1.0E-9) + 1.0E-12;
+      enumerate(D-1, c, t, 0.0, v, bound, minSq, false, u);
+      bound = (minSq + epsilon)*(1.0 + 1.0E-9) + 1.0E-12;
+      for (i = 0; i < D; ++i) {
+         u[i] = std::numeric_limits<int>::min();
+      }
+      enumerate(D-1, c, t, 0.0, v, bound, minSq, true, u);
+      return u;
+   }
+
+   /*
+   * Enumerate lattice points t within a bound, from index i downwards.
+   */
+   template <int D>
+   void MinimumImage<D>::enumerate(int i, double const * c, int* t,
+                                   double partial, IntVec<D> const & v,
+                                   double& bound, double& minSq,
+                                   bool isFinal, IntVec<D>& image) const
+   {
+      // Center and half-width of allowed range of t[i]
+      double center = c[i];
+      for (int j = i + 1; j < D; ++j) {
+         center -= mu_(j, i)*(double(t[j]) - c[j]);
+      }
+      double range = bound - partial;
+      if (range < 0.0) return;
+      range = std::sqrt(range/bStarSq_[i]);
+      int tMin = (int) std::ceil(center - range);
+      int tMax = (int) std::floor(center + range);
+
+      const double epsilon = 1.0E-6;
+      IntVec<D> u;
+      double diff, q;
+      for (t[i] = tMin; t[i] <= tMax; ++t[i]) {
+         diff = double(t[i]) - center;
+         if (i > 0) {
+            enumerate(i - 1, c, t, partial + bStarSq_[i]*diff*diff,
+                      v, bound, minSq, isFinal, image);
+         } else {
+            u = v;
+            for (int k = 0; k < D; ++k) {
+               for (int j = 0; j < D; ++j) {
+                  u[j] += t[k]*basis_[k][j];
+               }
+            }
+            q = ksq(u);
+            if (isFinal) {
+               if (q < minSq + epsilon && image < u) {
+                  image = u;
+               }
+            } else
+            if (q < minSq) {
+               minSq = q;
+               bound = q*(1.0 + 1.0E-9) + 1.0E-12;
+            }
+         }
+      }
+   }
+
+   /*
+   * Compute |G|^2, using the same operations as UnitCellBase::ksq.
+   */
+   template <int D>
+   double MinimumImage<D>::ksq(IntVec<D> const & k) const
+   {
+      RealVec<D> g(0.0);
+      RealVec<D> p;
+      for (int i = 0; i < D; ++i) {
+         p.multiply(kBasis_[i], k[i]);
+         g += p;
+      }
+      double value = 0.0;
+      for (int i = 0; i < D; ++i) {
+         value += g[i]*g[i];
+      }
+      return value;
+   }
+
+   /*
+   * Scalar product of wavevectors a and b in the reciprocal metric.
+   */
+   template <int D>
+   double
+   MinimumImage<D>::dot(IntVec<D> const & a, IntVec<D> const & b) const
+   {
+      RealVec<D> ga(0.0);
+      RealVec<D> gb(0.0);
+      RealVec<D> p;
+      for (int i = 0; i < D; ++i) {
+         p.multiply(kBasis_[i], double(a[i]));
+         ga += p;
+         p.multiply(kBasis_[i], double(b[i]));
+         gb += p;
+      }
+      double value = 0.0;
+      for (int i = 0; i < D; ++i) {
+         value += ga[i]*gb[i];
+      }
+      return value;
+   }
+
+   /*
+   * Compute Gram-Schmidt coefficients and squared norms of basis_.
+   */
+   template <int D>
+   void MinimumImage<D>::computeGramSchmidt()
+   {
+      int i, j, k;
+      for (i = 0; i < D; ++i) {
+         for (j = 0; j < i; ++j) {
+            mu_(i, j) = dot(basis_[i], basis_[j]);
+            for (k = 0; k < j; ++k) {
+               mu_(i, j) -= mu_(j, k)*mu_(i, k)*bStarSq_[k];
+            }
+            mu_(i, j) /= bStarSq_[j];
+         }
+         bStarSq_[i] = dot(basis_[i], basis_[i]);
+         for (k = 0; k < i; ++k) {
+            bStarSq_[i] -= mu_(i, k)*mu_(i, k)*bStarSq_[k];
+         }
+         UTIL_CHECK(bStarSq_[i] > 0.0);
+      }
+   }
+
+   /*
+   * LLL reduction of basis_, with parameter delta = 0.99.
+   */
+   template <int D>
+   void MinimumImage<D>::reduceBasis()
+   {
+      const double delta = 0.99;
+      IntVec<D> temp;
+      int j, k, m;
+      computeGramSchmidt();
+      k = 1;
+      while (k < D) {
+
+         // Size reduction of basis_[k]
+         for (j = k - 1; j >= 0; --j) {
+            m = (int) std::floor(mu_(k, j) + 0.5);
+            if (m != 0) {
+               temp.multiply(basis_[j], m);
+               basis_[k] -= temp;
+               computeGramSchmidt();
+            }
+         }
+
+         // Lovasz condition
+         if (bStarSq_[k] >= (delta - mu_(k, k-1)*mu_(k, k-1))
+                            *bStarSq_[k-1]) {
+            ++k;
+         } else {
+            temp = basis_[k];
+            basis_[k] = basis_[k-1];
+            basis_[k-1] = temp;
+            computeGramSchmidt();
+            if (k > 1) --k;
+         }
+      }
+   }
+
+}
+#endif
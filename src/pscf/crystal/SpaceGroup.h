@@ -10,10 +10,14 @@
 
 #include <pscf/crystal/SpaceSymmetry.h>
 #include <pscf/crystal/SymmetryGroup.h>
+#include <pscf/crystal/groupFile.h>
 #include <pscf/math/IntVec.h>
 #include <util/containers/FSArray.h>
 #include <util/param/Label.h>
+#include <util/misc/Log.h>
 #include <iostream>
+#include <fstream>
+#include <string>
 
 namespace Pscf
 {
@@ -76,6 +80,52 @@ namespace Pscf
       return in;
    }
 
+   /**
+   * Read a space group, identified by name or file name.
+   *
+   * The name "I" denotes the identity group. Otherwise, groupName is
+   * first interpreted as the path to a group file, and then as the
+   * standard name of a group in the data directory.
+   *
+   * \param groupName  group name or group file name
+   * \param group  space group (output)
+   *
+   * \ingroup Pscf_Crystal_Module
+   */ 
+   template <int D>
+   void readGroup(std::string groupName, SpaceGroup<D>& group)
+   {
+      if (groupName == "I") {
+         // Create identity group by default
+         group.makeCompleteGroup();
+      } else {
+         bool foundFile = false;
+         {
+            std::ifstream in;
+            in.open(groupName);
+            if (in.is_open()) {
+               in >> group;
+               UTIL_CHECK(group.isValid());
+               foundFile = true;
+            }
+         }
+         if (!foundFile) {
+            std::string fileName = makeGroupFileName(D, groupName);
+            std::ifstream in;
+            in.open(fileName);
+            if (in.is_open()) {
+               in >> group;
+               UTIL_CHECK(group.isValid());
+            } else {
+               Log::file() << "\nFailed to open group file: " 
+                           << fileName << "\n";
+               Log::file() << "\n Error: Unknown space group\n";
+               UTIL_THROW("Unknown space group");
+            }
+         } 
+      }
+   }
+
    #ifndef PSCF_SPACE_GROUP_CPP
    extern template class SpaceGroup<1>;
    extern template class SpaceGroup<2>;
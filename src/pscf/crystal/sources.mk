@@ -3,6 +3,7 @@ pscf_crystal_= \
   pscf/crystal/UnitCell2.cpp \
   pscf/crystal/UnitCell3.cpp \
   pscf/crystal/shiftToMinimum.cpp \
+  pscf/crystal/MinimumImage.cpp \
   pscf/crystal/SpaceSymmetry.cpp \
   pscf/crystal/SymmetryGroup.cpp \
   pscf/crystal/Basis.cpp \
@@ -35,7 +35,25 @@ namespace Pscf {
       chiInverse_.allocate(nMonomer(), nMonomer());
       idemp_.allocate(nMonomer(), nMonomer());
       readDSymmMatrix(in, "chi", chi_, nMonomer());
+      updateMembers();
+   }
 
+   /*
+   * Set one element of the chi matrix.
+   */
+   void ChiInteraction::setChi(int i, int j, double chi)
+   {
+      UTIL_CHECK(chi_.isAllocated());
+      chi_(i, j) = chi;
+      chi_(j, i) = chi;
+      updateMembers();
+   }
+
+   /*
+   * Compute inverse and idempotent matrices from chi matrix.
+   */
+   void ChiInteraction::updateMembers()
+   {
       if (nMonomer() == 2) {
          double det = chi_(0,0)*chi_(1, 1) - chi_(0,1)*chi_(1,0);
          double norm = chi_(0,0)*chi_(0, 0) + chi_(1,1)*chi_(1,1)
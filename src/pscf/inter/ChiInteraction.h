@@ -105,6 +105,17 @@ namespace Pscf {
       */
       double chi(int i, int j);
 
+      /**
+      * Set one element of the chi matrix, and its symmetric partner.
+      *
+      * The inverse and idempotent matrices are recomputed.
+      *
+      * \param i row index
+      * \param j column index
+      * \param chi  new value of chi(i, j) and chi(j, i)
+      */
+      void setChi(int i, int j, double chi);
+
       /**
       * Return one element of the inverse chi matrix.
       *
@@ -132,6 +143,11 @@ namespace Pscf {
 
       double sum_inv_;
 
+      /**
+      * Compute chiInverse_, idemp_ and sum_inv_ from chi_.
+      */
+      void updateMembers();
+
    };
 
    // Inline function
@@ -0,0 +1,148 @@
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "FieldFile.h"
+#include <util/global.h>
+
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Pscf
+{
+
+   using namespace Util;
+
+   // Known constant, used to check byte order
+   static const int FieldFileByteOrder = 0x01020304;
+
+   /*
+   * Constructor.
+   */
+   FieldFile::FieldFile()
+    : begin_(0),
+      length_(0),
+      nStar_(0)
+   {}
+
+   /*
+   * Destructor.
+   */
+   FieldFile::~FieldFile()
+   {  close(); }
+
+   /*
+   * Map file into memory and validate header.
+   */
+   void FieldFile::open(std::string const & filename)
+   {
+      UTIL_CHECK(!isOpen());
+
+      int fd = ::open(filename.c_str(), O_RDONLY);
+      if (fd < 0) {
+         UTIL_THROW(("Cannot open binary field file " + filename).c_str());
+      }
+      struct stat status;
+      if (fstat(fd, &status) != 0
+          || status.st_size < (off_t) sizeof(FieldFileHeader)) {
+         ::close(fd);
+         UTIL_THROW(("Invalid binary field file " + filename).c_str());
+      }
+      length_ = status.st_size;
+      void* map = mmap(0, length_, PROT_READ, MAP_SHARED, fd, 0);
+      ::close(fd);
+      if (map == MAP_FAILED) {
+         length_ = 0;
+         UTIL_THROW(("Cannot map binary field file " + filename).c_str());
+      }
+      begin_ = (char const *) map;
+
+      // Validate header
+      FieldFileHeader const & h = header();
+      bool isValid = true;
+      if (strncmp(h.magic, "PSCFFLD", 8) != 0) isValid = false;
+      if (h.byteOrder != FieldFileByteOrder) isValid = false;
+      if (h.version != Version) isValid = false;
+      if (h.type < Basis || h.type > KGrid) isValid = false;
+      if (h.dimension < 1 || h.dimension > 3) isValid = false;
+      if (h.nMonomer <= 0 || h.nValue <= 0) isValid = false;
+      if (!isValid) {
+         close();
+         UTIL_THROW(("Invalid binary field file " + filename).c_str());
+      }
+
+      // Check file length
+      nStar_ = (h.type == Basis) ? h.nValue : 0;
+      size_t expected = sizeof(FieldFileHeader) + 4*sizeof(int)*nStar_
+                      + sizeof(double)*h.nMonomer*h.nValue;
+      if (length_ != expected) {
+         close();
+         UTIL_THROW(("Truncated binary field file " + filename).c_str());
+      }
+   }
+
+   /*
+   * Unmap file.
+   */
+   void FieldFile::close()
+   {
+      if (begin_) {
+         munmap((void*) begin_, length_);
+         begin_ = 0;
+         length_ = 0;
+         nStar_ = 0;
+      }
+   }
+
+   /*
+   * Initialize a header.
+   */
+   void FieldFile::initHeader(FieldFileHeader& header, Type type,
+                              int dimension, int nMonomer, int nValue)
+   {
+      memset(&header, 0, sizeof(header));
+      strncpy(header.magic, "PSCFFLD", 8);
+      header.version = Version;
+      header.byteOrder = FieldFileByteOrder;
+      header.type = type;
+      header.dimension = dimension;
+      header.nMonomer = nMonomer;
+      header.nValue = nValue;
+   }
+
+   /*
+   * Write header.
+   */
+   void FieldFile::writeHeader(std::ostream& out,
+                               FieldFileHeader const & header)
+   {  out.write((char const *) &header, sizeof(header)); }
+
+   /*
+   * Write characteristic wave and size of one star.
+   */
+   void FieldFile::writeStar(std::ostream& out, int const * wave,
+                             int dimension, int size)
+   {
+      int record[4] = {0, 0, 0, 0};
+      for (int i = 0; i < dimension; ++i) {
+         record[i] = wave[i];
+      }
+      record[3] = size;
+      out.write((char const *) record, sizeof(record));
+   }
+
+   /*
+   * Write values of one field.
+   */
+   void FieldFile::writeData(std::ostream& out, double const * data,
+                             int nValue)
+   {  out.write((char const *) data, sizeof(double)*nValue); }
+
+}
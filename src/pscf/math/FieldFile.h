@@ -0,0 +1,232 @@
+#ifndef PSCF_FIELD_FILE_H
+#define PSCF_FIELD_FILE_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <iostream>
+#include <string>
+#include <stddef.h>
+
+namespace Pscf
+{
+
+   /**
+   * Header of a binary field file.
+   *
+   * Contains the same information as the header of the corresponding
+   * text field file, plus the record type and the number of values per
+   * monomer field. All strings are null terminated. Unused elements
+   * of meshDimensions and parameters are zero.
+   *
+   * \ingroup Pscf_Math_Module
+   */
+   struct FieldFileHeader
+   {
+      /// Identifier "PSCFFLD" (null terminated).
+      char magic[8];
+      /// Unit cell parameters.
+      double parameters[6];
+      /// File format version.
+      int version;
+      /// Known integer constant, used to check byte order.
+      int byteOrder;
+      /// Type of field data (a FieldFile::Type value).
+      int type;
+      /// Dimension of space.
+      int dimension;
+      /// Mesh dimensions (number of grid points, for 1D fd1d fields).
+      int meshDimensions[3];
+      /// Number of unit cell parameters.
+      int nParameter;
+      /// Number of monomer types (number of fields).
+      int nMonomer;
+      /// Number of double values per field.
+      int nValue;
+      /// Name of lattice system (empty if none).
+      char lattice[32];
+      /// Name of space group (empty if none).
+      char groupName[64];
+   };
+
+   /**
+   * Binary field file, mapped into memory for reading.
+   *
+   * A binary field file contains a FieldFileHeader, followed (for
+   * fields in symmetry-adapted basis format only) by 4 int values for
+   * each star, giving the characteristic wave of the star and its
+   * size, as in the text basis format. This is followed by nMonomer
+   * contiguous arrays of nValue double values, one per monomer type.
+   *
+   * Values of r-grid and k-grid fields are stored in the order of
+   * rank in the corresponding mesh, with the last index varying most
+   * rapidly, which is the order used in memory by the FFT. Each
+   * k-grid value is stored as a (real, imaginary) pair. Data are
+   * stored in the native format of the machine that wrote the file,
+   * and a file written on a machine with different byte order is
+   * rejected when it is opened.
+   *
+   * Files are written by the static functions writeHeader, writeStar
+   * and writeData. They are read by calling open(), which maps the
+   * whole file read-only into memory and validates its header, after
+   * which header(), star() and data() give direct access to the
+   * mapped file contents until close() is called.
+   *
+   * \ingroup Pscf_Math_Module
+   */
+   class FieldFile
+   {
+
+   public:
+
+      /**
+      * Types of field data.
+      */
+      enum Type {Basis = 0, RGrid = 1, KGrid = 2};
+
+      /**
+      * Current file format version.
+      */
+      static const int Version = 1;
+
+      /**
+      * Constructor.
+      */
+      FieldFile();
+
+      /**
+      * Destructor (unmaps file, if open).
+      */
+      ~FieldFile();
+
+      /**
+      * Map a binary field file into memory and validate its header.
+      *
+      * Throws an Exception if the file cannot be opened, is not a
+      * binary field file of a supported version and byte order, or
+      * has a length inconsistent with its header.
+      *
+      * \param filename  path to file
+      */
+      void open(std::string const & filename);
+
+      /**
+      * Unmap file, if open.
+      */
+      void close();
+
+      /**
+      * Get the header of an open file.
+      */
+      FieldFileHeader const & header() const;
+
+      /**
+      * Get characteristic wave and size of star i (basis files only).
+      *
+      * Returns a pointer to 4 int values: 3 components of the
+      * characteristic wave (unused components are zero) and the
+      * number of waves in the star.
+      *
+      * \param i  index of star, in the order written
+      */
+      int const * star(int i) const;
+
+      /**
+      * Get the field values for one monomer type.
+      *
+      * \param monomerId  index of monomer type
+      * \return pointer to array of nValue values
+      */
+      double const * data(int monomerId) const;
+
+      /**
+      * Is a file mapped into memory?
+      */
+      bool isOpen() const;
+
+      /**
+      * Initialize a header, setting all fields that identify the format.
+      *
+      * Sets all strings and arrays to zero, sets the identifier,
+      * version and byte order, and sets the remaining arguments.
+      *
+      * \param header  header (output)
+      * \param type  type of field data
+      * \param dimension  dimension of space
+      * \param nMonomer  number of monomer types
+      * \param nValue  number of double values per monomer
+      */
+      static void initHeader(FieldFileHeader& header, Type type,
+                             int dimension, int nMonomer, int nValue);
+
+      /**
+      * Write a header to a binary output stream.
+      *
+      * \param out  output stream, opened in binary mode
+      * \param header  header, initialized by initHeader
+      */
+      static void writeHeader(std::ostream& out,
+                              FieldFileHeader const & header);
+
+      /**
+      * Write the characteristic wave and size of one star.
+      *
+      * \param out  output stream, opened in binary mode
+      * \param wave  pointer to dimension integer wave components
+      * \param dimension  dimension of space
+      * \param size  number of waves in star
+      */
+      static void writeStar(std::ostream& out, int const * wave,
+                            int dimension, int size);
+
+      /**
+      * Write the field values for one monomer type.
+      *
+      * \param out  output stream, opened in binary mode
+      * \param data  pointer to array of nValue values
+      * \param nValue  number of values
+      */
+      static void writeData(std::ostream& out, double const * data,
+                            int nValue);
+
+   private:
+
+      /// Pointer to start of mapped file.
+      char const * begin_;
+
+      /// Length of mapped file, in bytes.
+      size_t length_;
+
+      /// Number of stars (basis files only).
+      int nStar_;
+
+   };
+
+   // Inline member functions
+
+   inline
+   FieldFileHeader const & FieldFile::header() const
+   {  return *((FieldFileHeader const *) begin_); }
+
+   inline
+   int const * FieldFile::star(int i) const
+   {  return (int const *)(begin_ + sizeof(FieldFileHeader)) + 4*i; }
+
+   inline
+   double const * FieldFile::data(int monomerId) const
+   {
+      char const * ptr = begin_ + sizeof(FieldFileHeader)
+                       + 4*sizeof(int)*nStar_;
+      return ((double const *) ptr) + monomerId*header().nValue;
+   }
+
+   inline
+   bool FieldFile::isOpen() const
+   {  return (begin_ != 0); }
+
+}
+#endif
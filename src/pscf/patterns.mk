@@ -21,6 +21,13 @@ LIBS=$(PSCF_LIBS)
 INCLUDES+=$(GSL_INC)
 LIBS+=$(GSL_LIB) 
 
+# Add compiler and linker flags for OpenMP multithreading
+ifdef PSCF_OPENMP
+CXXFLAGS+=$(OPENMP_FLAGS)
+TESTFLAGS+=$(OPENMP_FLAGS)
+LDFLAGS+=$(OPENMP_FLAGS)
+endif
+
 # Preprocessor macro definitions needed in src/pscf
 DEFINES=$(PSCF_DEFS) $(UTIL_DEFS)
 
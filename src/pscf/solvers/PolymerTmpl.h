@@ -16,8 +16,10 @@
 #include <util/containers/Pair.h>        // member template
 #include <util/containers/DArray.h>      // member template
 #include <util/containers/DMatrix.h>
+#include <util/containers/GArray.h>   // member template
 
 #include <cmath>
+#include <string>
 
 namespace Pscf
 { 
@@ -34,6 +36,38 @@ namespace Pscf
    * equation (MDE) for the entire molecule and computes monomer
    * concentration fields for all blocks.
    *
+   * Propagators are solved in an order (or "plan") that is computed
+   * by makePlan. The plan is divided into a sequence of levels, such 
+   * that all sources of every propagator are in earlier levels, and 
+   * the two propagators of each block are in different levels. The 
+   * propagators within each level are thus independent. If level 
+   * parallelism is enabled (see setIsLevelParallel) and the code that
+   * instantiates this template is compiled with OpenMP enabled (i.e., 
+   * if the _OPENMP macro is defined), they are solved concurrently by 
+   * OpenMP threads. This requires that propagators of different blocks
+   * do not share any mutable data. It is disabled by default, because
+   * OpenMP regions nested within a propagator solution (e.g., loops 
+   * over grid points and threaded FFTs) then run on a single thread.
+   *
+   * If aliases are enabled by the concrete Polymer class (by calling 
+   * setIsAliasEnabled(true) in its constructor), makePlan also finds 
+   * sets of equivalent propagators, which have the same monomer type 
+   * and block length and equivalent sources, i.e., isomorphic subtrees 
+   * of the molecular graph on the side of their root vertex. Examples
+   * are the two propagators of a homopolymer, the two end blocks of an
+   * ABA triblock, or the identical arms of a star polymer. Only one 
+   * propagator of each such set is solved, and the others are declared
+   * aliases of it (see PropagatorTmpl::setAlias). This requires that 
+   * the concrete Propagator class return the solution of the aliased 
+   * propagator from its accessors when isAlias() is true.
+   *
+   * Because the two propagators of a block are in different levels, 
+   * one of them is always solved after the other is complete. If this
+   * propagator is neither an alias nor aliased by another, it may be
+   * "streamed", i.e., solved without storing all of its slices, by 
+   * accumulating the block concentration while it is solved. Such a
+   * propagator is identified by streamDirectionId().
+   *
    * \ingroup Pscf_Solver_Module
    */
    template <class Block>
@@ -136,6 +170,24 @@ namespace Pscf
       */
       const Pair<int>& propagatorId(int i) const;
 
+      /**
+      * Index of the first propagator in a level of the plan.
+      *
+      * Propagators with computation order indices i in the range
+      * levelBegin(level) <= i < levelEnd(level) may be solved 
+      * concurrently.
+      *
+      * \param level  level index, 0 <= level < nLevel()
+      */
+      int levelBegin(int level) const;
+
+      /**
+      * One more than the index of the last propagator in a level.
+      *
+      * \param level  level index, 0 <= level < nLevel()
+      */
+      int levelEnd(int level) const;
+
       //@}
       /// \name Accessors (by value)
       //@{
@@ -155,6 +207,50 @@ namespace Pscf
       */
       int nPropagator() const;  //
 
+      /**
+      * Number of levels of mutually independent propagators.
+      */
+      int nLevel() const;
+
+      /**
+      * Number of propagators that are aliases of equivalent ones.
+      */
+      int nAlias() const;
+
+      /**
+      * Direction id of the propagator of a block that may be streamed.
+      *
+      * Returns the direction id of the propagator of the block that is 
+      * solved after its partner, if it is neither an alias nor aliased 
+      * by another propagator, or -1 otherwise.
+      *
+      * \param blockId  integer index of block
+      */
+      int streamDirectionId(int blockId) const;
+
+      /**
+      * Are aliases of equivalent propagators enabled?
+      */
+      bool isAliasEnabled() const;
+
+      /**
+      * Are propagators within each level solved concurrently?
+      */
+      bool isLevelParallel() const;
+
+      /**
+      * Enable or disable concurrent solution of propagators in a level.
+      *
+      * If enabled, and OpenMP is enabled, each thread solves a different
+      * propagator, and so all OpenMP regions within the solution of one 
+      * propagator run on one thread (unless nested parallelism is 
+      * enabled). This is faster only if levels contain at least as many
+      * propagators as there are threads. Disabled by default.
+      *
+      * \param isLevelParallel  true to solve levels concurrently
+      */
+      void setIsLevelParallel(bool isLevelParallel);
+
       /**
       * Total length of all blocks = volume / reference volume.
       */
@@ -166,6 +262,16 @@ namespace Pscf
 
       virtual void makePlan();
 
+      /**
+      * Enable or disable aliases of equivalent propagators.
+      *
+      * This must be called before readParameters, and should be called
+      * only by subclasses whose Propagator class supports aliases.
+      *
+      * \param isAliasEnabled  true to enable aliases
+      */
+      void setIsAliasEnabled(bool isAliasEnabled);
+
    private:
 
       /// Array of Block objects in this polymer.
@@ -177,6 +283,12 @@ namespace Pscf
       /// Propagator ids, indexed in order of computation.
       DArray< Pair<int> > propagatorIds_;
 
+      /// Index of first propagator in each level, plus nPropagator_.
+      GArray<int> levelOffsets_;
+
+      /// Direction id of the streamable propagator of each block, or -1.
+      DArray<int> streamDirectionIds_;
+
       /// Number of blocks in this polymer
       int nBlock_;
 
@@ -186,6 +298,27 @@ namespace Pscf
       /// Number of propagators (two per block).
       int nPropagator_;
 
+      /// Number of propagators that are aliases.
+      int nAlias_;
+
+      /// Are aliases of equivalent propagators enabled?
+      bool isAliasEnabled_;
+
+      /// Are propagators within each level solved concurrently?
+      bool isLevelParallel_;
+
+      /**
+      * Get sorted equivalence class ids of the sources of a propagator.
+      *
+      * \param blockId  block index of propagator
+      * \param directionId  direction index of propagator
+      * \param classIds  class id of each propagator, by block and direction
+      * \param ids  output array of class ids of sources, sorted
+      */
+      void getSourceClassIds(int blockId, int directionId, 
+                             DMatrix<int> const & classIds,
+                             GArray<int>& ids) const;
+
    };
 
    /*
@@ -209,6 +342,55 @@ namespace Pscf
    inline int PolymerTmpl<Block>::nPropagator() const
    {  return nPropagator_; }
 
+   /*
+   * Number of levels in the computation plan.
+   */
+   template <class Block>
+   inline int PolymerTmpl<Block>::nLevel() const
+   {  return levelOffsets_.size() - 1; }
+
+   /*
+   * Number of propagators that are aliases.
+   */
+   template <class Block>
+   inline int PolymerTmpl<Block>::nAlias() const
+   {  return nAlias_; }
+
+   /*
+   * Are aliases of equivalent propagators enabled?
+   */
+   template <class Block>
+   inline bool PolymerTmpl<Block>::isAliasEnabled() const
+   {  return isAliasEnabled_; }
+
+   /*
+   * Are propagators within each level solved concurrently?
+   */
+   template <class Block>
+   inline bool PolymerTmpl<Block>::isLevelParallel() const
+   {  return isLevelParallel_; }
+
+   /*
+   * Direction id of the propagator of a block that may be streamed.
+   */
+   template <class Block>
+   inline int PolymerTmpl<Block>::streamDirectionId(int blockId) const
+   {  return streamDirectionIds_[blockId]; }
+
+   /*
+   * Index of first propagator in a level.
+   */
+   template <class Block>
+   inline int PolymerTmpl<Block>::levelBegin(int level) const
+   {  return levelOffsets_[level]; }
+
+   /*
+   * One more than the index of the last propagator in a level.
+   */
+   template <class Block>
+   inline int PolymerTmpl<Block>::levelEnd(int level) const
+   {  return levelOffsets_[level + 1]; }
+
    /*
    * Total length of all blocks = volume / reference volume
    */
@@ -296,9 +478,14 @@ namespace Pscf
       blocks_(),
       vertices_(),
       propagatorIds_(),
+      levelOffsets_(),
+      streamDirectionIds_(),
       nBlock_(0),
       nVertex_(0),
-      nPropagator_(0)
+      nPropagator_(0),
+      nAlias_(0),
+      isAliasEnabled_(false),
+      isLevelParallel_(false)
    {  setClassName("PolymerTmpl"); }
 
    /*
@@ -308,6 +495,23 @@ namespace Pscf
    PolymerTmpl<Block>::~PolymerTmpl()
    {}
 
+   /*
+   * Enable or disable aliases of equivalent propagators.
+   */
+   template <class Block>
+   void PolymerTmpl<Block>::setIsAliasEnabled(bool isAliasEnabled)
+   {
+      UTIL_CHECK(nPropagator_ == 0);
+      isAliasEnabled_ = isAliasEnabled; 
+   }
+
+   /*
+   * Enable or disable concurrent solution of propagators in a level.
+   */
+   template <class Block>
+   void PolymerTmpl<Block>::setIsLevelParallel(bool isLevelParallel)
+   {  isLevelParallel_ = isLevelParallel; }
+
    template <class Block>
    void PolymerTmpl<Block>::readParameters(std::istream& in)
    {
@@ -422,6 +626,172 @@ namespace Pscf
          }
       }
 
+      // Find classes of equivalent propagators, in the above order, in
+      // which all sources precede each propagator. Each class is 
+      // identified by the plan index of its first member, and later
+      // members become aliases of the first.
+      DMatrix<int> classIds;
+      classIds.allocate(nBlock_, 2);
+      GArray<int> ids, otherIds;
+      int iBlock, iDirection, jBlock, jDirection;
+      nAlias_ = 0;
+      for (int i = 0; i < nPropagator_; ++i) {
+         iBlock = propagatorIds_[i][0];
+         iDirection = propagatorIds_[i][1];
+         classIds(iBlock, iDirection) = i;
+         if (!isAliasEnabled_) continue;
+         Block const & blockI = blocks_[iBlock];
+         getSourceClassIds(iBlock, iDirection, classIds, ids);
+         for (int j = 0; j < i; ++j) {
+            jBlock = propagatorIds_[j][0];
+            jDirection = propagatorIds_[j][1];
+            if (classIds(jBlock, jDirection) != j) continue;
+            Block const & blockJ = blocks_[jBlock];
+            if (blockJ.monomerId() != blockI.monomerId()) continue;
+            if (blockJ.length() != blockI.length()) continue;
+            getSourceClassIds(jBlock, jDirection, classIds, otherIds);
+            if (otherIds.size() != ids.size()) continue;
+            bool isEqual = true;
+            for (int k = 0; k < ids.size(); ++k) {
+               if (ids[k] != otherIds[k]) {
+                  isEqual = false;
+                  break;
+               }
+            }
+            if (isEqual) {
+               classIds(iBlock, iDirection) = j;
+               blocks_[iBlock].propagator(iDirection)
+                       .setAlias(blocks_[jBlock].propagator(jDirection));
+               ++nAlias_;
+               break;
+            }
+         }
+      }
+
+      // Assign a level to each propagator, in the above order. The
+      // level is one more than the maximum level of any source, and 
+      // is incremented if necessary to differ from that of the partner
+      // propagator, because both propagators of a block use the same 
+      // Block work space. An alias is given a level no lower than that
+      // of the propagator that it aliases.
+      DMatrix<int> level;
+      level.allocate(nBlock_, 2);
+      for (int iBlock = 0; iBlock < nBlock_; ++iBlock) {
+         level(iBlock, 0) = -1;
+         level(iBlock, 1) = -1;
+      }
+      int iLevel, iClass;
+      int nLevel = 0;
+      for (int i = 0; i < nPropagator_; ++i) {
+         iBlock = propagatorIds_[i][0];
+         iDirection = propagatorIds_[i][1];
+         inVertexPtr = &vertices_[blocks_[iBlock].vertexId(iDirection)];
+         iLevel = 0;
+         for (int j = 0; j < inVertexPtr->size(); ++j) {
+            propagatorId = inVertexPtr->inPropagatorId(j);
+            if (propagatorId[0] != iBlock) {
+               UTIL_CHECK(level(propagatorId[0], propagatorId[1]) >= 0);
+               if (level(propagatorId[0], propagatorId[1]) >= iLevel) {
+                  iLevel = level(propagatorId[0], propagatorId[1]) + 1;
+               }
+            }
+         }
+         iClass = classIds(iBlock, iDirection);
+         if (iClass != i) {
+            jBlock = propagatorIds_[iClass][0];
+            jDirection = propagatorIds_[iClass][1];
+            UTIL_CHECK(level(jBlock, jDirection) >= 0);
+            if (level(jBlock, jDirection) > iLevel) {
+               iLevel = level(jBlock, jDirection);
+            }
+         }
+         if (level(iBlock, 1 - iDirection) == iLevel) {
+            ++iLevel;
+         }
+         level(iBlock, iDirection) = iLevel;
+         if (iLevel >= nLevel) {
+            nLevel = iLevel + 1;
+         }
+      }
+
+      // Find the propagator of each block that is solved last, and 
+      // accept it for streaming unless it is or has an alias
+      DArray<bool> isAliased;
+      isAliased.allocate(nPropagator_);
+      for (int i = 0; i < nPropagator_; ++i) {
+         isAliased[i] = false;
+      }
+      for (int i = 0; i < nPropagator_; ++i) {
+         iClass = classIds(propagatorIds_[i][0], propagatorIds_[i][1]);
+         if (iClass != i) {
+            isAliased[iClass] = true;
+         }
+      }
+      streamDirectionIds_.allocate(nBlock_);
+      for (iBlock = 0; iBlock < nBlock_; ++iBlock) {
+         streamDirectionIds_[iBlock] = -1;
+      }
+      for (int i = 0; i < nPropagator_; ++i) {
+         iBlock = propagatorIds_[i][0];
+         iDirection = propagatorIds_[i][1];
+         if (classIds(iBlock, iDirection) != i) continue;
+         if (isAliased[i]) continue;
+         if (level(iBlock, iDirection) > level(iBlock, 1 - iDirection)) {
+            streamDirectionIds_[iBlock] = iDirection;
+         }
+      }
+
+      // Reorder propagatorIds_ by level, preserving the above order
+      // within each level, and record the first index in each level
+      DArray< Pair<int> > tempIds;
+      tempIds.allocate(nPropagator_);
+      for (int i = 0; i < nPropagator_; ++i) {
+         tempIds[i] = propagatorIds_[i];
+      }
+      levelOffsets_.clear();
+      int k = 0;
+      for (iLevel = 0; iLevel < nLevel; ++iLevel) {
+         levelOffsets_.append(k);
+         for (int i = 0; i < nPropagator_; ++i) {
+            if (level(tempIds[i][0], tempIds[i][1]) == iLevel) {
+               propagatorIds_[k] = tempIds[i];
+               ++k;
+            }
+         }
+      }
+      UTIL_CHECK(k == nPropagator_);
+      levelOffsets_.append(k);
+
+   }
+
+   /*
+   * Get sorted equivalence class ids of the sources of a propagator.
+   */
+   template <class Block>
+   void 
+   PolymerTmpl<Block>::getSourceClassIds(int blockId, int directionId, 
+                                         DMatrix<int> const & classIds,
+                                         GArray<int>& ids) const
+   {
+      ids.clear();
+      int vertexId = blocks_[blockId].vertexId(directionId);
+      Vertex const & inVertex = vertices_[vertexId];
+      Pair<int> propagatorId;
+      int i, j, id;
+      for (i = 0; i < inVertex.size(); ++i) {
+         propagatorId = inVertex.inPropagatorId(i);
+         if (propagatorId[0] != blockId) {
+            // Insertion sort
+            id = classIds(propagatorId[0], propagatorId[1]);
+            ids.append(id);
+            j = ids.size() - 1;
+            while (j > 0 && ids[j-1] > id) {
+               ids[j] = ids[j-1];
+               --j;
+            }
+            ids[j] = id;
+         }
+      }
    }
 
    /*
@@ -436,10 +806,50 @@ namespace Pscf
          propagator(j).setIsSolved(false);
       }
 
-      // Solve modified diffusion equation for all propagators
-      for (int j = 0; j < nPropagator(); ++j) {
-         UTIL_CHECK(propagator(j).isReady());
-         propagator(j).solve();
+      // Solve modified diffusion equation for all propagators, one 
+      // level at a time. Propagators within a level are independent.
+      // Exceptions cannot leave a parallel region, so the message of
+      // the first failure is kept and rethrown after each level.
+      int begin, end, j, nFail;
+      std::string failMessage;
+      for (int k = 0; k < nLevel(); ++k) {
+         begin = levelBegin(k);
+         end = levelEnd(k);
+         nFail = 0;
+         #ifdef _OPENMP
+         #pragma omp parallel for schedule(dynamic) reduction(+:nFail) \
+                 if (isLevelParallel_ && end - begin > 1)
+         #endif
+         for (j = begin; j < end; ++j) {
+            if (!propagator(j).isAlias()) {
+               try {
+                  UTIL_CHECK(propagator(j).isReady());
+                  propagator(j).solve();
+               } catch (Exception& e) {
+                  #ifdef _OPENMP
+                  #pragma omp critical
+                  #endif
+                  {
+                     if (failMessage.empty()) {
+                        failMessage = e.message();
+                     }
+                  }
+                  ++nFail;
+               }
+            }
+         }
+         if (nFail > 0) {
+            UTIL_THROW(("Failure to solve propagator: " 
+                        + failMessage).c_str());
+         }
+
+         // Aliases are solved once their equivalent propagator is
+         for (j = begin; j < end; ++j) {
+            if (propagator(j).isAlias()) {
+               UTIL_CHECK(propagator(j).alias().isSolved());
+               propagator(j).setIsSolved(true);
+            }
+         }
       }
 
       // Compute molecular partition function
@@ -117,6 +117,20 @@ namespace Pscf
       * Set the isSolved flag to true or false.
       */
       void setIsSolved(bool isSolved);
+
+      /**
+      * Declare this propagator to be an alias of an equivalent one.
+      *
+      * An alias is never solved. Instead, a concrete propagator class 
+      * that supports aliases returns the solution of the propagator 
+      * passed to this function, which must have the same monomer type, 
+      * block length and (recursively) equivalent sources. Aliases are
+      * set by PolymerTmpl::makePlan only if the concrete Polymer class
+      * enables them.
+      *
+      * \param other  equivalent propagator that is actually solved
+      */
+      void setAlias(const TP& other);
  
       //@}
       /// \name Accessors
@@ -158,6 +172,16 @@ namespace Pscf
       * Are all source propagators are solved?
       */
       bool isReady() const;
+
+      /**
+      * Is this an alias of an equivalent propagator?
+      */
+      bool isAlias() const;
+
+      /**
+      * Get the equivalent propagator of which this is an alias.
+      */
+      const TP& alias() const;
  
       //@}
 
@@ -174,6 +198,9 @@ namespace Pscf
 
       /// Set true after solving modified diffusion equation.
       bool isSolved_;
+
+      /// Pointer to equivalent propagator, if this is an alias.
+      TP const * aliasPtr_;
   
    };
 
@@ -216,6 +243,20 @@ namespace Pscf
    inline bool PropagatorTmpl<TP>::isSolved() const
    {  return isSolved_; }
 
+   /*
+   * Is this an alias of an equivalent propagator?
+   */
+   template <class TP>
+   inline bool PropagatorTmpl<TP>::isAlias() const
+   {  return aliasPtr_; }
+
+   /*
+   * Get the equivalent propagator of which this is an alias.
+   */
+   template <class TP>
+   inline const TP& PropagatorTmpl<TP>::alias() const
+   {  return *aliasPtr_; }
+
    // Noninline member functions
 
    /*
@@ -226,7 +267,8 @@ namespace Pscf
     : directionId_(-1),
       partnerPtr_(0),
       sourcePtrs_(),
-      isSolved_(false)
+      isSolved_(false),
+      aliasPtr_(0)
    {}
 
    /*
@@ -250,6 +292,16 @@ namespace Pscf
    void PropagatorTmpl<TP>::addSource(const TP& source)
    {  sourcePtrs_.append(&source); }
 
+   /*
+   * Declare this an alias of an equivalent propagator.
+   */
+   template <class TP>
+   void PropagatorTmpl<TP>::setAlias(const TP& other)
+   {
+      UTIL_CHECK(!other.isAlias());
+      aliasPtr_ = &other; 
+   }
+
    /*
    * Get partner propagator.
    */
@@ -21,6 +21,7 @@
 
 #include <iostream>
 #include <fstream>
+#include <cmath>
 
 using namespace Util;
 using namespace Pscf;
@@ -38,6 +39,63 @@ public:
    void tearDown()
    {}
 
+   /*
+   * Compare a basis to reference data, in the format:
+   *
+   * nStar, then for each star: size beginId endId invertFlag cancel 
+   * waveBz eigen; nWave, then for each wave: indicesDft indicesBz 
+   * starId implicit coeff (real and imaginary parts) sqNorm.
+   */
+   template <int D>
+   bool isBasisEqual(Basis<D> const & basis, std::string filename)
+   {
+      std::ifstream in;
+      openInputFile(filename, in);
+      IntVec<D> vec;
+      double eigen, re, im;
+      int nStar, nWave, size, beginId, endId, invertFlag, starId, i, j;
+      bool cancel, implicit;
+
+      in >> nStar;
+      if (nStar != basis.nStar()) return false;
+      for (i = 0; i < nStar; ++i) {
+         typename Basis<D>::Star const & star = basis.star(i);
+         in >> size >> beginId >> endId >> invertFlag >> cancel;
+         for (j = 0; j < D; ++j) {
+            in >> vec[j];
+         }
+         in >> eigen;
+         if (size != star.size) return false;
+         if (beginId != star.beginId) return false;
+         if (endId != star.endId) return false;
+         if (invertFlag != star.invertFlag) return false;
+         if (cancel != star.cancel) return false;
+         if (vec != star.waveBz) return false;
+         if (std::abs(eigen - star.eigen) > 1.0E-8) return false;
+      }
+
+      in >> nWave;
+      if (nWave != basis.nWave()) return false;
+      for (i = 0; i < nWave; ++i) {
+         typename Basis<D>::Wave const & wave = basis.wave(i);
+         for (j = 0; j < D; ++j) {
+            in >> vec[j];
+         }
+         if (vec != wave.indicesDft) return false;
+         for (j = 0; j < D; ++j) {
+            in >> vec[j];
+         }
+         if (vec != wave.indicesBz) return false;
+         in >> starId >> implicit >> re >> im >> eigen;
+         if (starId != wave.starId) return false;
+         if (implicit != wave.implicit) return false;
+         if (std::abs(re - wave.coeff.real()) > 1.0E-8) return false;
+         if (std::abs(im - wave.coeff.imag()) > 1.0E-8) return false;
+         if (std::abs(eigen - wave.sqNorm) > 1.0E-8) return false;
+      }
+      return true;
+   }
+
    void testConstructor()
    {
       printMethod(TEST_FUNC);
@@ -351,6 +409,135 @@ public:
 
    }
 
+   void testMake2DBasis_hex_reference()
+   {
+      printMethod(TEST_FUNC);
+
+      // Read UnitCell
+      UnitCell<2> unitCell;
+      std::ifstream in;
+      openInputFile("in/Hexagonal", in);
+      in >> unitCell;
+      in.close();
+
+      // Make Mesh object
+      IntVec<2> d;
+      d[0] = 12;
+      d[1] = 12;
+      Mesh<2> mesh(d);
+
+      // Read space group
+      SpaceGroup<2> group;
+      openInputFile("in/p_6_m_m", in);
+      in >> group;
+      in.close();
+
+      // Make basis, compare to reference stars and waves
+      Basis<2> basis;
+      basis.makeBasis(mesh, unitCell, group);
+      TEST_ASSERT(basis.isValid());
+      TEST_ASSERT(isBasisEqual(basis, "in/Basis_hex_p_6_m_m"));
+   }
+
+   void testMake3DBasis_I_a_3b_d_reference()
+   {
+      printMethod(TEST_FUNC);
+
+      // Make unitcell
+      UnitCell<3> unitCell;
+      std::ifstream in;
+      openInputFile("in/Cubic", in);
+      in >> unitCell;
+      in.close();
+
+      // Make mesh object
+      IntVec<3> d;
+      d[0] = 8;
+      d[1] = 8;
+      d[2] = 8;
+      Mesh<3> mesh(d);
+
+      // Read group
+      SpaceGroup<3> group;
+      openInputFile("in/I_a_-3_d", in);
+      in >> group;
+      in.close();
+
+      // Make basis, compare to reference stars and waves
+      Basis<3> basis;
+      basis.makeBasis(mesh, unitCell, group);
+      TEST_ASSERT(basis.isValid());
+      TEST_ASSERT(isBasisEqual(basis, "in/Basis_cubic_I_a_-3_d"));
+   }
+
+
+   void testCache()
+   {
+      printMethod(TEST_FUNC);
+
+      // Read UnitCell
+      UnitCell<2> unitCell;
+      std::ifstream in;
+      openInputFile("in/Hexagonal", in);
+      in >> unitCell;
+      in.close();
+
+      // Make Mesh object
+      IntVec<2> d;
+      d[0] = 12;
+      d[1] = 12;
+      Mesh<2> mesh(d);
+
+      // Read space group
+      SpaceGroup<2> group;
+      openInputFile("in/p_6_m_m", in);
+      in >> group;
+      in.close();
+
+      // Make basis, write cache file
+      Basis<2> basis;
+      basis.makeBasis(mesh, unitCell, group);
+      std::string filename = filePrefix() + "tempBasisCache";
+      TEST_ASSERT(basis.writeCache(filename, "p_6_m_m"));
+
+      // Read cache file, compare to reference stars and waves
+      Basis<2> basis2;
+      TEST_ASSERT(basis2.readCache(filename, mesh, unitCell, "p_6_m_m"));
+      TEST_ASSERT(basis2.isValid());
+      TEST_ASSERT(isBasisEqual(basis2, "in/Basis_hex_p_6_m_m"));
+
+      // Reject file for a different group or mesh
+      Basis<2> basis3;
+      TEST_ASSERT(!basis3.readCache(filename, mesh, unitCell, "p_6"));
+      d[1] = 15;
+      Mesh<2> mesh2(d);
+      TEST_ASSERT(!basis3.readCache(filename, mesh2, unitCell, "p_6_m_m"));
+      TEST_ASSERT(basis3.nWave() == 0);
+
+      // Read file for a hexagonal cell of different size
+      FSArray<double, 6> parameters;
+      parameters.append(1.5*unitCell.parameter(0));
+      UnitCell<2> unitCell2;
+      openInputFile("in/Hexagonal", in);
+      in >> unitCell2;
+      in.close();
+      unitCell2.setParameters(parameters);
+      TEST_ASSERT(basis3.readCache(filename, mesh, unitCell2, "p_6_m_m"));
+      TEST_ASSERT(basis3.isValid());
+      TEST_ASSERT(basis3.nStar() == basis.nStar());
+      double ratio;
+      for (int i = 1; i < basis.nStar(); ++i) {
+         ratio = basis3.star(i).eigen/basis.star(i).eigen;
+         TEST_ASSERT(std::abs(ratio*2.25 - 1.0) < 1.0E-10);
+      }
+
+      // Check that cache file names include the group and mesh
+      std::string name = Basis<2>::cacheFileName(mesh, unitCell, "p_6_m_m");
+      TEST_ASSERT(name.find("p_6_m_m") != std::string::npos);
+      TEST_ASSERT(name.find("12x12") != std::string::npos);
+      TEST_ASSERT(name != 
+                  Basis<2>::cacheFileName(mesh2, unitCell, "p_6_m_m"));
+   }
 };
 
 TEST_BEGIN(BasisTest)
@@ -363,6 +550,9 @@ TEST_ADD(BasisTest, testMake2DBasis_hex)
 TEST_ADD(BasisTest, testMake3DBasis_I)
 TEST_ADD(BasisTest, testMake3DBasis_I_m_3b_m)
 TEST_ADD(BasisTest, testMake3DBasis_I_a_3b_d) 
+TEST_ADD(BasisTest, testMake2DBasis_hex_reference)
+TEST_ADD(BasisTest, testMake3DBasis_I_a_3b_d_reference)
+TEST_ADD(BasisTest, testCache)
 TEST_END(BasisTest)
 
 #endif
@@ -6,11 +6,14 @@
 
 #include <pscf/crystal/UnitCell.h>
 #include <pscf/crystal/shiftToMinimum.h>
+#include <pscf/crystal/MinimumImage.h>
+#include <pscf/mesh/MeshIterator.h>
 #include <util/math/Constants.h>
 #include <util/format/Int.h>
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
 
 using namespace Util;
 using namespace Pscf;
@@ -72,6 +75,39 @@ public:
       return true;
    }
 
+   /*
+   * Do MinimumImage and shiftToMinimum agree for all waves of a mesh?
+   *
+   * If isShifted, each wave is also tested after a shift by -d along 
+   * each axis. (The 1D shiftToMinimum only accepts -d < v < d).
+   */
+   template <int D>
+   bool isMinimumImageValid(UnitCell<D> const & cell, IntVec<D> d,
+                            bool isShifted = true)
+   {
+      MinimumImage<D> image;
+      image.setup(d, cell);
+      MeshIterator<D> iter(d);
+      IntVec<D> v, x, y, z;
+      for (iter.begin(); !iter.atEnd(); ++iter) {
+         v = iter.position();
+         for (int k = -1; k < D; ++k) {
+            x = v;
+            if (k >= 0) {
+               if (!isShifted) break;
+               x[k] -= d[k];
+            }
+            y = image.shift(x);
+            z = shiftToMinimum(x, d, cell);
+            if (!(y == z)) {
+               std::cout << std::endl << x << " : " << y << "  " << z;
+               return false;
+            }
+         }
+      }
+      return true;
+   }
+
    void test1DLamellar() 
    {
       printMethod(TEST_FUNC);
@@ -342,6 +378,65 @@ public:
 
    }
 
+   void testMinimumImage() 
+   {
+      printMethod(TEST_FUNC);
+
+      UnitCell<1> lamellar;
+      std::ifstream in;
+      openInputFile("in/Lamellar", in);
+      in >> lamellar;
+      in.close();
+      IntVec<1> d1;
+      d1[0] = 9;
+      TEST_ASSERT(isMinimumImageValid(lamellar, d1, false));
+      d1[0] = 10;
+      TEST_ASSERT(isMinimumImageValid(lamellar, d1, false));
+
+      UnitCell<2> square;
+      openInputFile("in/Square", in);
+      in >> square;
+      in.close();
+      IntVec<2> d2;
+      d2[0] = 8;
+      d2[1] = 8;
+      TEST_ASSERT(isMinimumImageValid(square, d2));
+
+      UnitCell<2> hex;
+      openInputFile("in/Hexagonal", in);
+      in >> hex;
+      in.close();
+      TEST_ASSERT(isMinimumImageValid(hex, d2));
+      d2[0] = 9;
+      d2[1] = 12;
+      TEST_ASSERT(isMinimumImageValid(hex, d2));
+      MinimumImage<2> image2;
+      image2.setup(d2, hex);
+      TEST_ASSERT(!image2.isOrthogonal());
+
+      UnitCell<3> ortho;
+      openInputFile("in/Orthorhombic", in);
+      in >> ortho;
+      in.close();
+      IntVec<3> d3;
+      d3[0] = 6;
+      d3[1] = 7;
+      d3[2] = 8;
+      TEST_ASSERT(isMinimumImageValid(ortho, d3));
+      MinimumImage<3> image3;
+      image3.setup(d3, ortho);
+      TEST_ASSERT(image3.isOrthogonal());
+
+      UnitCell<3> hex3;
+      std::istringstream buffer("hexagonal   1.5   2.5");
+      buffer >> hex3;
+      TEST_ASSERT(isMinimumImageValid(hex3, d3));
+      d3[0] = 8;
+      d3[1] = 8;
+      d3[2] = 5;
+      TEST_ASSERT(isMinimumImageValid(hex3, d3));
+   }
+
 };
 
 TEST_BEGIN(UnitCellTest)
@@ -350,6 +445,7 @@ TEST_ADD(UnitCellTest, test2DSquare)
 TEST_ADD(UnitCellTest, test2DHexagonal)
 TEST_ADD(UnitCellTest, test3DOrthorhombic)
 TEST_ADD(UnitCellTest, test3DCubic)
+TEST_ADD(UnitCellTest, testMinimumImage)
 TEST_END(UnitCellTest)
 
 #endif
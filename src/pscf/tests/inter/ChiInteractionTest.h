@@ -83,12 +83,32 @@ public:
       TEST_ASSERT(eq(0.4, xi));
    }
 
+   void testSetChi() 
+   {
+      printMethod(TEST_FUNC);
+
+      ChiInteraction v;
+      v.setNMonomer(2);
+      std::ifstream in;
+      openInputFile("in/ChiInteraction", in);
+      v.readParam(in);
+
+      v.setChi(1, 0, 2.0);
+      TEST_ASSERT(eq(v.chi(1,0), 2.0));
+      TEST_ASSERT(eq(v.chi(0,1), 2.0));
+      TEST_ASSERT(eq(v.chiInverse(0,0), 0.0));
+      TEST_ASSERT(eq(v.chiInverse(1,1), 0.0));
+      TEST_ASSERT(eq(v.chiInverse(0,1), 0.5));
+      TEST_ASSERT(eq(v.chiInverse(1,0), 0.5));
+   }
+
 };
 
 TEST_BEGIN(ChiInteractionTest)
 TEST_ADD(ChiInteractionTest, testConstructor)
 TEST_ADD(ChiInteractionTest, testReadWrite)
 TEST_ADD(ChiInteractionTest, testComputeW)
+TEST_ADD(ChiInteractionTest, testSetChi)
 TEST_END(ChiInteractionTest)
 
 #endif
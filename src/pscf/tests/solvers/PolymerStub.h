@@ -19,8 +19,11 @@ namespace Pscf
 
    public:
 
-      PolymerStub()
-      {  setClassName("Polymer"); }
+      PolymerStub(bool isAliasEnabled = false)
+      {  
+         setClassName("Polymer"); 
+         setIsAliasEnabled(isAliasEnabled);
+      }
 
    };
 
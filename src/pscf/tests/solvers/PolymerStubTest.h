@@ -141,12 +141,139 @@ public:
  
    }
 
+   void testStarLevels() 
+   {
+      printMethod(TEST_FUNC);
+
+      std::ifstream in;
+      openInputFile("in/Polymer2", in);
+
+      PolymerStub p;
+      p.readParam(in);
+
+      // Three arm star: Arms are solved inward, then outward
+      TEST_ASSERT(p.nLevel() == 2);
+      TEST_ASSERT(p.levelBegin(0) == 0);
+      TEST_ASSERT(p.levelEnd(0) == 3);
+      TEST_ASSERT(p.levelBegin(1) == 3);
+      TEST_ASSERT(p.levelEnd(p.nLevel() - 1) == p.nPropagator());
+
+      for (int i = 0; i < p.nPropagator(); ++i) {
+         p.propagator(i).setIsSolved(false);
+      }
+
+      // Check that propagators in each level are independent, and 
+      // that the two propagators of a block are in different levels
+      int begin, end, i, j;
+      for (int k = 0; k < p.nLevel(); ++k) {
+         begin = p.levelBegin(k);
+         end = p.levelEnd(k);
+         TEST_ASSERT(end > begin);
+         for (i = begin; i < end; ++i) {
+            TEST_ASSERT(p.propagator(i).isReady());
+            for (j = begin; j < i; ++j) {
+               TEST_ASSERT(p.propagatorId(i)[0] != p.propagatorId(j)[0]);
+            }
+         }
+         for (i = begin; i < end; ++i) {
+            p.propagator(i).setIsSolved(true);
+         }
+      }
+ 
+   }
+
+   void testAliases() 
+   {
+      printMethod(TEST_FUNC);
+
+      std::ifstream in;
+
+      // Diblock copolymer: No equivalent propagators
+      openInputFile("in/Polymer", in);
+      PolymerStub p1(true);
+      p1.readParam(in);
+      in.close();
+      TEST_ASSERT(p1.isAliasEnabled());
+      TEST_ASSERT(p1.nAlias() == 0);
+      TEST_ASSERT(p1.streamDirectionId(0) == 1);
+      TEST_ASSERT(p1.streamDirectionId(1) == 0);
+
+      // Asymmetric star: No equivalent propagators
+      openInputFile("in/Polymer2", in);
+      PolymerStub p2(true);
+      p2.readParam(in);
+      in.close();
+      TEST_ASSERT(p2.nAlias() == 0);
+
+      // ABA triblock: Ends, middle, and inner end propagators are pairs
+      openInputFile("in/PolymerABA", in);
+      PolymerStub p3(true);
+      p3.readParam(in);
+      in.close();
+      TEST_ASSERT(p3.nAlias() == 3);
+      TEST_ASSERT(p3.propagator(2, 0).isAlias());
+      TEST_ASSERT(&p3.propagator(2, 0).alias() == &p3.propagator(0, 0));
+      TEST_ASSERT(p3.propagator(1, 0).isAlias() 
+                  != p3.propagator(1, 1).isAlias());
+
+      // Every propagator solved last is, or has, an alias
+      for (int i = 0; i < p3.nBlock(); ++i) {
+         TEST_ASSERT(p3.streamDirectionId(i) == -1);
+      }
+
+      // Star with 4 identical arms: One inward and one outward class
+      openInputFile("in/PolymerStar", in);
+      PolymerStub p4(true);
+      p4.readParam(in);
+      in.close();
+      TEST_ASSERT(p4.nPropagator() == 8);
+      TEST_ASSERT(p4.nAlias() == 6);
+
+      // Aliases are disabled by default
+      openInputFile("in/PolymerStar", in);
+      PolymerStub p5;
+      p5.readParam(in);
+      in.close();
+      TEST_ASSERT(p5.nAlias() == 0);
+
+      // Without aliases, propagators from the junction are streamed
+      for (int i = 0; i < p5.nBlock(); ++i) {
+         TEST_ASSERT(p5.streamDirectionId(i) == 1);
+      }
+
+      // Check that every alias is in the same or a later level than 
+      // the propagator it aliases, and that all sources of every 
+      // propagator are in earlier levels.
+      for (int i = 0; i < p4.nPropagator(); ++i) {
+         p4.propagator(i).setIsSolved(false);
+      }
+      int begin, end, i;
+      for (int k = 0; k < p4.nLevel(); ++k) {
+         begin = p4.levelBegin(k);
+         end = p4.levelEnd(k);
+         for (i = begin; i < end; ++i) {
+            if (!p4.propagator(i).isAlias()) {
+               TEST_ASSERT(p4.propagator(i).isReady());
+               p4.propagator(i).setIsSolved(true);
+            }
+         }
+         for (i = begin; i < end; ++i) {
+            if (p4.propagator(i).isAlias()) {
+               TEST_ASSERT(p4.propagator(i).alias().isSolved());
+               p4.propagator(i).setIsSolved(true);
+            }
+         }
+      }
+   }
+
 };
 
 TEST_BEGIN(PolymerStubTest)
 TEST_ADD(PolymerStubTest, testConstructor)
 TEST_ADD(PolymerStubTest, testReadParam)
 TEST_ADD(PolymerStubTest, testReadStarParam)
+TEST_ADD(PolymerStubTest, testStarLevels)
+TEST_ADD(PolymerStubTest, testAliases)
 TEST_END(PolymerStubTest)
 
 #endif
@@ -29,9 +29,10 @@ namespace Pscf { class ChiInteraction; }
 namespace Pscf {
 namespace Pspc
 {
-   template <int D> class AmIterator;
-   class Sweep;
-   class SweepFactory;
+   template <int D> class Iterator;
+   template <int D> class IteratorFactory;
+   template <int D> class Sweep;
+   template <int D> class SweepFactory;
 
    using namespace Util;
 
@@ -74,6 +75,17 @@ namespace Pspc
 
       /**
       * Process command line options.
+      *
+      * Option -t nThread sets the number of threads used by FFTW plans
+      * and multithreaded loops (if compiled with PSPC_OPENMP defined).
+      * Option -f rigor sets the FFTW planner rigor, option -a enables
+      * autotuning of the number of threads per FFTW plan, and option
+      * -w file names a file in the output directory from which FFTW
+      * wisdom is read, if it exists, and to which it is written by the
+      * FINISH command (see planCache.h). Option -b dir names a
+      * directory of binary basis cache files, from which the basis is
+      * read if a matching file exists, and to which it is otherwise
+      * written (see Basis::makeBasis).
       */
       void setOptions(int argc, char **argv);
 
@@ -263,8 +275,17 @@ namespace Pspc
       /**
       * Get the Iterator by reference.
       */
-      //temporarily changed to allow testing on member functions
-      AmIterator<D>& iterator();
+      Iterator<D>& iterator();
+
+      /**
+      * Does this system have a Sweep object?
+      */
+      bool hasSweep() const;
+
+      /**
+      * Get the Sweep by reference (if hasSweep).
+      */
+      Sweep<D>& sweep();
 
       /**
       * Get associated Basis object by reference.
@@ -291,11 +312,36 @@ namespace Pspc
       */
       FileMaster& fileMaster();
 
+      /**
+      * Set the stream used for log output by this System.
+      *
+      * By default, log output is written to Log::file(). Each System
+      * that is solved concurrently with others in the same process
+      * needs a separate log stream (see SystemSet).
+      *
+      * \param out  output stream for log output
+      */
+      void setLogFile(std::ostream& out);
+
+      /**
+      * Get the stream used for log output.
+      */
+      std::ostream& log();
+
       /** 
       * Get group name.
       */  
       std::string groupName() const;
 
+      /** 
+      * Has a symmetry-adapted basis been constructed?
+      *
+      * This is true iff the optional groupName parameter was given.
+      * Commands that read, write or convert fields in basis format
+      * may only be used if it is true.
+      */  
+      bool hasBasis() const;
+
       /** 
       * Have monomer chemical potential fields (w fields) been set?
       *
@@ -303,7 +349,8 @@ namespace Pspc
       * set for both components in a symmetry-adapated basis (wFields) and 
       * for values on a regular real space grid (wFieldsRGrid). Commands 
       * that read w fields from file in either of these formats must 
-      * immediately convert to the other.
+      * immediately convert to the other. If hasSymmetricFields() is 
+      * false, only the values on a grid are set.
       */
       bool hasWFields() const;
 
@@ -320,6 +367,17 @@ namespace Pspc
       */  
       bool hasCFields() const;
 
+      /** 
+      * Are fields in basis format kept consistent with fields on a grid?
+      *
+      * Returns true if the system has a basis and the iterator preserves
+      * space group symmetry (Iterator::isSymmetric). If false, fields in
+      * basis format (wFields and cFields) are not updated by ITERATE, 
+      * SWEEP, SOLVE_MDE or READ_W_RGRID, and commands that write w or 
+      * c fields in basis format are rejected.
+      */
+      bool hasSymmetricFields() const;
+
       //@}
 
    private:
@@ -366,6 +424,21 @@ namespace Pspc
       */
       FieldIo<D> fieldIo_;
 
+      /**
+      * Pointer to log output stream (null if Log::file() is used).
+      */
+      std::ostream* logPtr_;
+
+      /**
+      * Name of FFTW wisdom file (empty if wisdom is not saved).
+      */
+      std::string wisdomFileName_;
+
+      /**
+      * Directory of binary basis cache files (empty if not used).
+      */
+      std::string basisCacheDir_;
+
       /**
       * Homogeneous mixture, for reference.
       */
@@ -379,19 +452,22 @@ namespace Pspc
       /**
       * Pointer to an iterator.
       */
-      AmIterator<D>* iteratorPtr_;
+      Iterator<D>* iteratorPtr_;
+
+      /**
+      * Pointer to factory for Iterator objects.
+      */
+      IteratorFactory<D>* iteratorFactoryPtr_;
 
-      #if 0
       /**
-      * Pointer to an Sweep object
+      * Pointer to a Sweep object (null if hasSweep_ is false).
       */
-      Sweep* sweepPtr_;
+      Sweep<D>* sweepPtr_;
 
       /**
-      * Pointer to SweepFactory object
+      * Pointer to factory for Sweep objects.
       */
-      SweepFactory* sweepFactoryPtr_;
-      #endif
+      SweepFactory<D>* sweepFactoryPtr_;
 
       /**
       * Array of chemical potential fields for monomer types.
@@ -468,6 +544,11 @@ namespace Pspc
       */
       bool hasMesh_;
 
+      /**
+      * Has a symmetry-adapted basis been constructed?
+      */
+      bool hasBasis_;
+
       /**
       * Has memory been allocated for fields?
       */
@@ -487,12 +568,10 @@ namespace Pspc
       */
       bool hasCFields_;
 
-      #if 0
       /**
       * Does this system have a Sweep object?
       */
       bool hasSweep_;
-      #endif
 
       // Private member functions
 
@@ -549,6 +628,11 @@ namespace Pspc
    inline std::string System<D>::groupName() const
    { return groupName_; }
 
+   // Has a basis been constructed?
+   template <int D>
+   inline bool System<D>::hasBasis() const
+   { return hasBasis_; }
+
    // Get the Basis<D> object.
    template <int D>
    inline Basis<D>& System<D>::basis()
@@ -564,6 +648,11 @@ namespace Pspc
    inline FileMaster& System<D>::fileMaster()
    {  return fileMaster_; }
 
+   // Get the log output stream.
+   template <int D>
+   inline std::ostream& System<D>::log()
+   {  return logPtr_ ? *logPtr_ : Log::file(); }
+
    // Get the Homogeneous::Mixture object.
    template <int D>
    inline Homogeneous::Mixture& System<D>::homogeneous()
@@ -579,12 +668,25 @@ namespace Pspc
 
    // Get the Iterator.
    template <int D>
-   inline AmIterator<D>& System<D>::iterator()
+   inline Iterator<D>& System<D>::iterator()
    {
       UTIL_ASSERT(iteratorPtr_);
       return *iteratorPtr_;
    }
 
+   // Does this system have a Sweep object?
+   template <int D>
+   inline bool System<D>::hasSweep() const
+   {  return hasSweep_; }
+
+   // Get the Sweep.
+   template <int D>
+   inline Sweep<D>& System<D>::sweep()
+   {
+      UTIL_ASSERT(sweepPtr_);
+      return *sweepPtr_;
+   }
+
    template <int D>
    inline
    DArray<DArray <double> >& System<D>::wFields()
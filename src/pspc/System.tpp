@@ -10,12 +10,12 @@
 
 #include "System.h"
 
-#if 0
 #include <pspc/sweep/Sweep.h>
 #include <pspc/sweep/SweepFactory.h>
-#endif
-
-#include <pspc/iterator/AmIterator.h>
+#include <pspc/iterator/Iterator.h>
+#include <pspc/iterator/IteratorFactory.h>
+#include <pspc/field/threads.h>
+#include <pspc/field/planCache.h>
 
 #include <pscf/mesh/MeshIterator.h>
 #include <pscf/crystal/shiftToMinimum.h>
@@ -27,6 +27,7 @@
 #include <util/format/Int.h>
 #include <util/format/Dbl.h>
 
+#include <cstdlib>
 #include <ctime>
 #include <iomanip>
 #include <sstream>
@@ -52,11 +53,15 @@ namespace Pspc
       basis_(),
       fileMaster_(),
       fieldIo_(),
+      logPtr_(0),
+      wisdomFileName_(),
+      basisCacheDir_(),
       homogeneous_(),
       interactionPtr_(0),
       iteratorPtr_(0),
-      // sweepPtr_(0),
-      // sweepFactoryPtr_(0),
+      iteratorFactoryPtr_(0),
+      sweepPtr_(0),
+      sweepFactoryPtr_(0),
       wFields_(),
       cFields_(),
       f_(),
@@ -65,10 +70,11 @@ namespace Pspc
       pressure_(0.0),
       hasMixture_(false),
       hasUnitCell_(false),
+      hasBasis_(false),
       isAllocated_(false),
       hasWFields_(false),
-      hasCFields_(false)
-      //hasSweep_(false)
+      hasCFields_(false),
+      hasSweep_(false)
    {  
       setClassName("System"); 
 
@@ -76,9 +82,9 @@ namespace Pspc
                          basis_, fileMaster_);
 
       interactionPtr_ = new ChiInteraction(); 
-      iteratorPtr_ = new AmIterator<D>(this); 
+      iteratorFactoryPtr_ = new IteratorFactory<D>(*this); 
 
-      // sweepFactoryPtr_ = new SweepFactory(*this);
+      sweepFactoryPtr_ = new SweepFactory<D>(*this);
    }
 
    /*
@@ -93,6 +99,15 @@ namespace Pspc
       if (iteratorPtr_) {
          delete iteratorPtr_;
       }
+      if (iteratorFactoryPtr_) {
+         delete iteratorFactoryPtr_;
+      }
+      if (sweepPtr_) {
+         delete sweepPtr_;
+      }
+      if (sweepFactoryPtr_) {
+         delete sweepFactoryPtr_;
+      }
    }
 
    /*
@@ -106,15 +121,24 @@ namespace Pspc
       bool cFlag = false;  // command file 
       bool iFlag = false;  // input prefix
       bool oFlag = false;  // output prefix
+      bool tFlag = false;  // number of threads
+      bool fFlag = false;  // FFTW planner rigor
+      bool wFlag = false;  // FFTW wisdom file
+      bool aFlag = false;  // autotune threads per FFTW plan
+      bool bFlag = false;  // basis cache directory
       char* pArg = 0;
       char* cArg = 0;
       char* iArg = 0;
       char* oArg = 0;
+      int tArg = 0;
+      char* fArg = 0;
+      char* wArg = 0;
+      char* bArg = 0;
    
       // Read program arguments
       int c;
       opterr = 0;
-      while ((c = getopt(argc, argv, "er:p:c:i:o:f")) != -1) {
+      while ((c = getopt(argc, argv, "er:p:c:i:o:f:t:w:ab:")) != -1) {
          switch (c) {
          case 'e':
             eflag = true;
@@ -132,11 +156,30 @@ namespace Pspc
             iArg  = optarg;
             break;
          case 'o': // output prefix
-            iFlag = true;
+            oFlag = true;
             oArg  = optarg;
             break;
+         case 't': // number of threads
+            tFlag = true;
+            tArg  = atoi(optarg);
+            break;
+         case 'f': // FFTW planner rigor
+            fFlag = true;
+            fArg  = optarg;
+            break;
+         case 'w': // FFTW wisdom file
+            wFlag = true;
+            wArg  = optarg;
+            break;
+         case 'a': // autotune threads per FFTW plan
+            aFlag = true;
+            break;
+         case 'b': // basis cache directory
+            bFlag = true;
+            bArg  = optarg;
+            break;
          case '?':
-           Log::file() << "Unknown option -" << optopt << std::endl;
+           log() << "Unknown option -" << optopt << std::endl;
            UTIL_THROW("Invalid command line option");
          }
       }
@@ -166,8 +209,50 @@ namespace Pspc
          fileMaster().setOutputPrefix(std::string(oArg));
       }
 
+      // If option -t, set number of threads for loops and FFTs
+      if (tFlag) {
+         if (tArg <= 0) {
+            UTIL_THROW("Number of threads (option -t) must be positive");
+         }
+         setNThread(tArg);
+      }
+
+      // If option -f, set rigor of the FFTW planner
+      if (fFlag) {
+         setPlanRigor(std::string(fArg));
+      }
+
+      // If option -a, autotune the number of threads per FFTW plan
+      if (aFlag) {
+         setPlanAutotune(true);
+      }
+
+      // If option -w, read FFTW wisdom from the output directory, if any
+      if (wFlag) {
+         wisdomFileName_ = std::string(wArg);
+         std::ifstream wisdomFile;
+         std::string path = fileMaster().outputPrefix() + wisdomFileName_;
+         wisdomFile.open(path.c_str());
+         if (wisdomFile.is_open()) {
+            readWisdom(wisdomFile);
+            wisdomFile.close();
+         }
+      }
+
+      // If option -b, set directory of binary basis cache files
+      if (bFlag) {
+         basisCacheDir_ = std::string(bArg);
+      }
+
    }
 
+   /*
+   * Set the log output stream.
+   */
+   template <int D>
+   void System<D>::setLogFile(std::ostream& out)
+   {  logPtr_ = &out; }
+
    /*
    * Read parameters and initialize.
    */
@@ -196,33 +281,47 @@ namespace Pspc
       read(in, "mesh", mesh_);
       hasMesh_ = true;
 
-      read(in, "groupName", groupName_);
+      groupName_ = ""; // Default value (no basis)
+      readOptional(in, "groupName", groupName_);
 
       mixture().setMesh(mesh());
       mixture().setupUnitCell(unitCell());
-      basis().makeBasis(mesh(), unitCell(), groupName_);
+      if (!groupName_.empty()) {
+         if (basisCacheDir_.empty()) {
+            basis().makeBasis(mesh(), unitCell(), groupName_);
+         } else {
+            basis().makeBasis(mesh(), unitCell(), groupName_, 
+                              basisCacheDir_);
+         }
+         hasBasis_ = true;
+
+         // Fields are symmetric, so reduce stress sums over stars
+         mixture().setBasis(basis());
+      }
 
       allocate();
       isAllocated_ = true;
 
-      // Initialize iterator
-      readParamComposite(in, iterator());
+      // Initialize iterator (any subclass known to the factory)
+      std::string className;
+      bool isEnd;
+      iteratorPtr_ = 
+         iteratorFactoryPtr_->readObject(in, *this, className, isEnd);
+      if (!iteratorPtr_) {
+         UTIL_THROW("Unrecognized Iterator subclass name");
+      }
       iterator().allocate();
 
-      #if 0
       // Optionally instantiate a Sweep object
+      hasSweep_ = false; // Default value
       readOptional<bool>(in, "hasSweep", hasSweep_);
       if (hasSweep_) {
-         std::string className;
-         bool isEnd;
          sweepPtr_ = 
             sweepFactoryPtr_->readObject(in, *this, className, isEnd);
          if (!sweepPtr_) {
             UTIL_THROW("Unrecognized Sweep subclass name");
          }
-         sweepPtr_->setSystem(*this);
       }
-      #endif
    }
 
    /*
@@ -264,13 +363,14 @@ namespace Pspc
       cFieldsKGrid_.allocate(nMonomer);
       
       for (int i = 0; i < nMonomer; ++i) {
-         wField(i).allocate(basis().nStar());
          wFieldRGrid(i).allocate(mesh().dimensions());
          wFieldKGrid(i).allocate(mesh().dimensions());
-
-         cField(i).allocate(basis().nStar());
          cFieldRGrid(i).allocate(mesh().dimensions());
          cFieldKGrid(i).allocate(mesh().dimensions());
+         if (hasBasis_) {
+            wField(i).allocate(basis().nStar());
+            cField(i).allocate(basis().nStar());
+         }
       }
       isAllocated_ = true;
    }
@@ -291,15 +391,22 @@ namespace Pspc
       while (readNext) {
 
          in >> command;
-         Log::file() << command <<std::endl;
+         log() << command <<std::endl;
 
          if (command == "FINISH") {
-            Log::file() << std::endl;
+            log() << std::endl;
+            if (!wisdomFileName_.empty()) {
+               std::ofstream wisdomFile;
+               fileMaster().openOutputFile(wisdomFileName_, wisdomFile);
+               writeWisdom(wisdomFile);
+               wisdomFile.close();
+            }
             readNext = false;
          } else
          if (command == "READ_W_BASIS") {
+            UTIL_CHECK(hasBasis_);
             in >> filename;
-            Log::file() << " " << Str(filename, 20) <<std::endl;
+            log() << " " << Str(filename, 20) <<std::endl;
             fieldIo().readFieldsBasis(filename, wFields());
             fieldIo().convertBasisToRGrid(wFields(), wFieldsRGrid());
             hasWFields_ = true;
@@ -307,21 +414,43 @@ namespace Pspc
          } else
          if (command == "READ_W_RGRID") {
             in >> filename;
-            Log::file() << " " << Str(filename, 20) <<std::endl;
+            log() << " " << Str(filename, 20) <<std::endl;
             fieldIo().readFieldsRGrid(filename, wFieldsRGrid());
-            fieldIo().convertRGridToBasis(wFieldsRGrid(), wFields());
+            if (hasSymmetricFields()) {
+               fieldIo().convertRGridToBasis(wFieldsRGrid(), wFields());
+            }
+            hasWFields_ = true;
+            hasCFields_ = false;
+         } else
+         if (command == "READ_W_BASIS_BIN") {
+            UTIL_CHECK(hasBasis_);
+            in >> filename;
+            log() << " " << Str(filename, 20) <<std::endl;
+            fieldIo().readFieldsBasisBinary(filename, wFields());
+            fieldIo().convertBasisToRGrid(wFields(), wFieldsRGrid());
+            hasWFields_ = true;
+            hasCFields_ = false;
+         } else
+         if (command == "READ_W_RGRID_BIN") {
+            in >> filename;
+            log() << " " << Str(filename, 20) <<std::endl;
+            fieldIo().readFieldsRGridBinary(filename, wFieldsRGrid());
+            if (hasSymmetricFields()) {
+               fieldIo().convertRGridToBasis(wFieldsRGrid(), wFields());
+            }
             hasWFields_ = true;
             hasCFields_ = false;
          } else
          if (command == "ITERATE") {
 
-            Log::file() << std::endl;
-            Log::file() << std::endl;
+            log() << std::endl;
+            log() << std::endl;
 
             // Read w (chemical potential fields) if not done previously 
             if (!hasWFields_) {
+               UTIL_CHECK(hasBasis_);
                in >> filename;
-               Log::file() << " " << Str(filename, 20) <<std::endl;
+               log() << " " << Str(filename, 20) <<std::endl;
                fieldIo().readFieldsBasis(filename, wFields());
                fieldIo().convertBasisToRGrid(wFields(), wFieldsRGrid());
                hasWFields_ = true;
@@ -332,21 +461,34 @@ namespace Pspc
             hasCFields_ = true;
 
             if (fail) {
-               Log::file() << "Iterator failed to converge\n";
+               log() << "Iterator failed to converge\n";
             } else {
                computeFreeEnergy();
-               outputThermo(Log::file());
+               outputThermo(log());
             }
 
+         } else
+         if (command == "SWEEP") {
+
+            log() << std::endl;
+            log() << std::endl;
+            UTIL_CHECK(hasSweep_);
+            UTIL_CHECK(hasWFields_);
+
+            // Solve a sequence of states, from the current w fields
+            sweep().solve();
+            hasCFields_ = true;
+
          } else
          if (command == "SOLVE_MDE") {
-            Log::file() << std::endl;
-            Log::file() << std::endl;
+            log() << std::endl;
+            log() << std::endl;
            
             // Read w (chemical potential fields) if not done previously 
             if (!hasWFields_) {
+               UTIL_CHECK(hasBasis_);
                in >> filename;
-               Log::file() << " " << Str(filename, 20) <<std::endl;
+               log() << " " << Str(filename, 20) <<std::endl;
                fieldIo().readFieldsBasis(filename, wFields());
                fieldIo().convertBasisToRGrid(wFields(), wFieldsRGrid());
                hasWFields_ = true;
@@ -356,35 +498,66 @@ namespace Pspc
             mixture().compute(wFieldsRGrid(), cFieldsRGrid());
 
             // Convert c fields from r-grid to basis
-            fieldIo().convertRGridToBasis(cFieldsRGrid(), cFields());
+            if (hasSymmetricFields()) {
+               fieldIo().convertRGridToBasis(cFieldsRGrid(), cFields());
+            }
             hasCFields_ = true;
 
          } else
          if (command == "WRITE_W_BASIS") {
+            UTIL_CHECK(hasSymmetricFields());
             UTIL_CHECK(hasWFields_);
             in >> filename;
-            Log::file() << "  " << Str(filename, 20) << std::endl;
+            log() << "  " << Str(filename, 20) << std::endl;
             fieldIo().writeFieldsBasis(filename, wFields());
          } else 
          if (command == "WRITE_W_RGRID") {
             UTIL_CHECK(hasWFields_);
             in >> filename;
-            Log::file() << "  " << Str(filename, 20) << std::endl;
+            log() << "  " << Str(filename, 20) << std::endl;
             fieldIo().writeFieldsRGrid(filename, wFieldsRGrid());
          } else 
          if (command == "WRITE_C_BASIS") {
+            UTIL_CHECK(hasSymmetricFields());
             UTIL_CHECK(hasCFields_);
             in >> filename;
-            Log::file() << "  " << Str(filename, 20) << std::endl;
+            log() << "  " << Str(filename, 20) << std::endl;
             fieldIo().writeFieldsBasis(filename, cFields());
          } else
          if (command == "WRITE_C_RGRID") {
             UTIL_CHECK(hasCFields_);
             in >> filename;
-            Log::file() << "  " << Str(filename, 20) << std::endl;
+            log() << "  " << Str(filename, 20) << std::endl;
             fieldIo().writeFieldsRGrid(filename, cFieldsRGrid());
          } else
+         if (command == "WRITE_W_BASIS_BIN") {
+            UTIL_CHECK(hasSymmetricFields());
+            UTIL_CHECK(hasWFields_);
+            in >> filename;
+            log() << "  " << Str(filename, 20) << std::endl;
+            fieldIo().writeFieldsBasisBinary(filename, wFields());
+         } else 
+         if (command == "WRITE_W_RGRID_BIN") {
+            UTIL_CHECK(hasWFields_);
+            in >> filename;
+            log() << "  " << Str(filename, 20) << std::endl;
+            fieldIo().writeFieldsRGridBinary(filename, wFieldsRGrid());
+         } else 
+         if (command == "WRITE_C_BASIS_BIN") {
+            UTIL_CHECK(hasSymmetricFields());
+            UTIL_CHECK(hasCFields_);
+            in >> filename;
+            log() << "  " << Str(filename, 20) << std::endl;
+            fieldIo().writeFieldsBasisBinary(filename, cFields());
+         } else
+         if (command == "WRITE_C_RGRID_BIN") {
+            UTIL_CHECK(hasCFields_);
+            in >> filename;
+            log() << "  " << Str(filename, 20) << std::endl;
+            fieldIo().writeFieldsRGridBinary(filename, cFieldsRGrid());
+         } else
          if (command == "BASIS_TO_RGRID") {
+            UTIL_CHECK(hasBasis_);
 
             // Note: This and other conversions use the c-field arrays
             // for storage, and thus corrupt previously stored values.
@@ -393,7 +566,7 @@ namespace Pspc
             // Read in basis format
             std::string inFileName;
             in >> inFileName;
-            Log::file() << " " << Str(inFileName, 20) <<std::endl;
+            log() << " " << Str(inFileName, 20) <<std::endl;
             fieldIo().readFieldsBasis(inFileName, cFields());
 
             // Convert
@@ -402,17 +575,18 @@ namespace Pspc
             // Write in r-grid format
             std::string outFileName;
             in >> outFileName;
-            Log::file() << " " << Str(outFileName, 20) <<std::endl;
+            log() << " " << Str(outFileName, 20) <<std::endl;
             fieldIo().writeFieldsRGrid(outFileName, cFieldsRGrid());
 
          } else 
          if (command == "RGRID_TO_BASIS") {
+            UTIL_CHECK(hasBasis_);
             hasCFields_ = false;
 
             // Read in r-grid format
             std::string inFileName;
             in >> inFileName;
-            Log::file() << " " << Str(inFileName, 20) <<std::endl;
+            log() << " " << Str(inFileName, 20) <<std::endl;
             fieldIo().readFieldsRGrid(inFileName, cFieldsRGrid());
 
             // Convert from r-grid to basis
@@ -421,7 +595,7 @@ namespace Pspc
             // Write in basis format
             std::string outFileName;
             in >> outFileName;
-            Log::file() << " " << Str(outFileName, 20) <<std::endl;
+            log() << " " << Str(outFileName, 20) <<std::endl;
             fieldIo().writeFieldsBasis(outFileName, cFields());
 
          } else
@@ -430,7 +604,7 @@ namespace Pspc
 
             std::string inFileName;
             in >> inFileName;
-            Log::file() << " " << Str(inFileName, 20) <<std::endl;
+            log() << " " << Str(inFileName, 20) <<std::endl;
 
 
             fieldIo().readFieldsKGrid(inFileName, cFieldsKGrid());
@@ -440,7 +614,7 @@ namespace Pspc
 
             std::string outFileName;
             in >> outFileName;
-            Log::file() << " " << Str(outFileName, 20) <<std::endl;
+            log() << " " << Str(outFileName, 20) <<std::endl;
             fieldIo().writeFieldsRGrid(outFileName, cFieldsRGrid());
 
          } else
@@ -449,7 +623,7 @@ namespace Pspc
 
             std::string inFileName;
             in >> inFileName;
-            Log::file() << " " << Str(inFileName, 20) <<std::endl;
+            log() << " " << Str(inFileName, 20) <<std::endl;
 
             fieldIo().readFieldsRGrid(inFileName, cFieldsRGrid());
             for (int i = 0; i < mixture().nMonomer(); ++i) {
@@ -458,18 +632,47 @@ namespace Pspc
 
             std::string outFileName;
             in >> outFileName;
-            Log::file() << " " << Str(outFileName, 20) <<std::endl;
+            log() << " " << Str(outFileName, 20) <<std::endl;
+            fieldIo().writeFieldsKGrid(outFileName, cFieldsKGrid());
+
+         } else
+         if (command == "KGRID_BIN_TO_KGRID") {
+            hasCFields_ = false;
+
+            std::string inFileName;
+            in >> inFileName;
+            log() << " " << Str(inFileName, 20) <<std::endl;
+            fieldIo().readFieldsKGridBinary(inFileName, cFieldsKGrid());
+
+            std::string outFileName;
+            in >> outFileName;
+            log() << " " << Str(outFileName, 20) <<std::endl;
             fieldIo().writeFieldsKGrid(outFileName, cFieldsKGrid());
 
+         } else
+         if (command == "KGRID_TO_KGRID_BIN") {
+            hasCFields_ = false;
+
+            std::string inFileName;
+            in >> inFileName;
+            log() << " " << Str(inFileName, 20) <<std::endl;
+            fieldIo().readFieldsKGrid(inFileName, cFieldsKGrid());
+
+            std::string outFileName;
+            in >> outFileName;
+            log() << " " << Str(outFileName, 20) <<std::endl;
+            fieldIo().writeFieldsKGridBinary(outFileName, cFieldsKGrid());
+
          } else
          if (command == "RHO_TO_OMEGA") {
+            UTIL_CHECK(hasBasis_);
             hasCFields_ = false;
             hasWFields_ = false;
 
             // Open input file
             std::string inFileName;
             in >> inFileName;
-            Log::file() << " " << Str(inFileName, 20) <<std::endl;
+            log() << " " << Str(inFileName, 20) <<std::endl;
             std::ifstream inFile;
             fileMaster().openInputFile(inFileName, inFile);
 
@@ -507,16 +710,17 @@ namespace Pspc
             // Write w field
             std::string outFileName;
             in >> outFileName;
-            Log::file() << " " << Str(outFileName, 20) << std::endl;
+            log() << " " << Str(outFileName, 20) << std::endl;
             fieldIo().writeFieldsBasis(outFileName, wFields());
             hasWFields_ = true;
 
          } else
          if (command == "OUTPUT_STARS") {
+            UTIL_CHECK(hasBasis_);
 
             std::string outFileName;
             in >> outFileName;
-            Log::file() << " " << Str(outFileName, 20) << std::endl;
+            log() << " " << Str(outFileName, 20) << std::endl;
 
             std::ofstream outFile;
             fileMaster().openOutputFile(outFileName, outFile);
@@ -525,10 +729,11 @@ namespace Pspc
 
          } else
          if (command == "OUTPUT_WAVES") {
+            UTIL_CHECK(hasBasis_);
 
             std::string outFileName;
             in >> outFileName;
-            Log::file() << " " << Str(outFileName, 20) << std::endl;
+            log() << " " << Str(outFileName, 20) << std::endl;
 
             std::ofstream outFile;
             fileMaster().openOutputFile(outFileName, outFile);
@@ -536,13 +741,23 @@ namespace Pspc
             basis().outputWaves(outFile);
 
          } else {
-            Log::file() << "Error: Unknown command  " 
-                        << command << std::endl;
+            log() << "Error: Unknown command  " 
+                  << command << std::endl;
             readNext = false;
          }
       }
    }
 
+   /*
+   * Are fields in basis format kept consistent with fields on a grid?
+   */
+   template <int D>
+   bool System<D>::hasSymmetricFields() const
+   {
+      UTIL_ASSERT(iteratorPtr_);
+      return (hasBasis_ && iteratorPtr_->isSymmetric()); 
+   }
+
    /*
    * Read and execute commands from the default command file.
    */
@@ -578,20 +793,45 @@ namespace Pspc
       }
 
       int nm  = mixture().nMonomer();
-      int nStar = basis().nStar();
       double temp = 0;
 
-      for (int i = 0; i < nm; ++i) {
-         
-         for (int j = i + 1; j < nm; ++j) {
-            for (int k = 0; k < nStar; ++k) {
-               fHelmholtz_+=
-                  cFields_[i][k] * interaction().chi(i,j) * cFields_[j][k];
+      if (hasSymmetricFields()) {
+
+         // Sums over basis functions
+         int nStar = basis().nStar();
+         for (int i = 0; i < nm; ++i) {
+            for (int j = i + 1; j < nm; ++j) {
+               for (int k = 0; k < nStar; ++k) {
+                  fHelmholtz_+=
+                     cFields_[i][k] * interaction().chi(i,j) * cFields_[j][k];
+               }
+            }
+            for (int j = 0; j < nStar; ++j) {
+               temp += wFields_[i][j] * cFields_[i][j];
             }
          }
 
-         for (int j = 0; j < nStar; ++j) {
-            temp += wFields_[i][j] * cFields_[i][j];
+      } else {
+
+         // Spatial averages over grid points
+         int nx = mesh().size();
+         double sum;
+         for (int i = 0; i < nm; ++i) {
+            CField const & ci = cFieldsRGrid_[i];
+            for (int j = i + 1; j < nm; ++j) {
+               CField const & cj = cFieldsRGrid_[j];
+               sum = 0.0;
+               for (int k = 0; k < nx; ++k) {
+                  sum += ci[k] * cj[k];
+               }
+               fHelmholtz_ += interaction().chi(i,j) * sum / double(nx);
+            }
+            WField const & wi = wFieldsRGrid_[i];
+            sum = 0.0;
+            for (int k = 0; k < nx; ++k) {
+               sum += wi[k] * ci[k];
+            }
+            temp += sum / double(nx);
          }
 
       }
@@ -0,0 +1,19 @@
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "SystemSet.tpp"
+
+namespace Pscf {
+namespace Pspc
+{
+
+   template class SystemSet<1>;
+   template class SystemSet<2>;
+   template class SystemSet<3>;
+
+} // namespace Pspc
+} // namespace Pscf
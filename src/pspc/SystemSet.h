@@ -0,0 +1,143 @@
+#ifndef PSPC_SYSTEM_SET_H
+#define PSPC_SYSTEM_SET_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <util/containers/GArray.h>        // member
+
+#include <fstream>
+#include <string>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   template <int D> class System;
+
+   using namespace Util;
+
+   /**
+   * A set of independent systems solved concurrently in one process.
+   *
+   * Each System is created by addSystem, which reads its parameter file
+   * and directs its log output to a separate file. The run function
+   * then executes the command file of every System. If the code is
+   * compiled with OpenMP (PSPC_OPENMP defined), systems are assigned
+   * to threads dynamically, one System at a time, so that each thread
+   * solves one System with single-threaded loops and FFTs until no
+   * unsolved systems remain. Otherwise, systems are solved in sequence.
+   *
+   * FFTW plans for meshes of equal dimensions are shared by all systems
+   * (see planCache.h). Output to Log::file() that does not pass through
+   * System::log(), such as echoed parameters, is only generated while
+   * parameter files are read, which is done sequentially.
+   *
+   * \ingroup Pscf_Pspc_Module
+   */
+   template <int D>
+   class SystemSet
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      */
+      SystemSet();
+
+      /**
+      * Destructor.
+      *
+      * Deletes all systems and closes their log files.
+      */
+      ~SystemSet();
+
+      /**
+      * Create a System and read its parameter file.
+      *
+      * Log output of the new System is written to a file named "log"
+      * with the output prefix. The parameter file is read using
+      * single-threaded FFTW plans.
+      *
+      * \param paramFileName  name of parameter file
+      * \param commandFileName  name of command file
+      * \param inputPrefix  path prefix for input field files
+      * \param outputPrefix  path prefix for output files
+      * \return new System, by reference
+      */
+      System<D>& addSystem(std::string const & paramFileName,
+                           std::string const & commandFileName,
+                           std::string const & inputPrefix,
+                           std::string const & outputPrefix);
+
+      /**
+      * Execute the command file of every System.
+      *
+      * An Exception thrown by one System is reported to its log, and
+      * does not prevent the solution of other systems.
+      *
+      * \return number of systems that threw an Exception
+      */
+      int run();
+
+      /**
+      * Get the number of systems.
+      */
+      int nSystem() const;
+
+      /**
+      * Get a System by reference.
+      *
+      * \param id  index of System, in order of creation
+      */
+      System<D>& system(int id);
+
+      /**
+      * Did the last run fail for a specific System?
+      *
+      * \param id  index of System, in order of creation
+      */
+      bool isFailed(int id) const;
+
+   private:
+
+      /// Pointers to systems, in order of creation.
+      GArray< System<D>* > systemPtrs_;
+
+      /// Pointers to log files, indexed like systemPtrs_.
+      GArray< std::ofstream* > logPtrs_;
+
+      /// Did the last run throw an Exception? (1 true, 0 false).
+      GArray<int> isFailed_;
+
+   };
+
+   // Inline functions
+
+   template <int D>
+   inline int SystemSet<D>::nSystem() const
+   {  return systemPtrs_.size(); }
+
+   template <int D>
+   inline System<D>& SystemSet<D>::system(int id)
+   {  return *systemPtrs_[id]; }
+
+   template <int D>
+   inline bool SystemSet<D>::isFailed(int id) const
+   {  return (isFailed_[id] != 0); }
+
+   #ifndef PSPC_SYSTEM_SET_TPP
+   // Suppress implicit instantiation
+   extern template class SystemSet<1>;
+   extern template class SystemSet<2>;
+   extern template class SystemSet<3>;
+   #endif
+
+} // namespace Pspc
+} // namespace Pscf
+#endif
@@ -0,0 +1,107 @@
+#ifndef PSPC_SYSTEM_SET_TPP
+#define PSPC_SYSTEM_SET_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "SystemSet.h"
+#include "System.h"
+#include <pspc/field/threads.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /*
+   * Constructor.
+   */
+   template <int D>
+   SystemSet<D>::SystemSet()
+    : systemPtrs_(),
+      logPtrs_(),
+      isFailed_()
+   {}
+
+   /*
+   * Destructor.
+   */
+   template <int D>
+   SystemSet<D>::~SystemSet()
+   {
+      for (int i = 0; i < systemPtrs_.size(); ++i) {
+         delete systemPtrs_[i];
+         logPtrs_[i]->close();
+         delete logPtrs_[i];
+      }
+   }
+
+   /*
+   * Create a System, open its log file, and read its parameter file.
+   */
+   template <int D>
+   System<D>& SystemSet<D>::addSystem(std::string const & paramFileName,
+                                      std::string const & commandFileName,
+                                      std::string const & inputPrefix,
+                                      std::string const & outputPrefix)
+   {
+      System<D>* systemPtr = new System<D>();
+      std::ofstream* logPtr = new std::ofstream();
+      systemPtrs_.append(systemPtr);
+      logPtrs_.append(logPtr);
+      isFailed_.append(0);
+
+      FileMaster& fileMaster = systemPtr->fileMaster();
+      fileMaster.setParamFileName(paramFileName);
+      fileMaster.setCommandFileName(commandFileName);
+      fileMaster.setInputPrefix(inputPrefix);
+      fileMaster.setOutputPrefix(outputPrefix);
+      fileMaster.openOutputFile("log", *logPtr);
+      systemPtr->setLogFile(*logPtr);
+
+      // Read parameters, creating single-threaded FFTW plans
+      int n = nThread();
+      setNThread(1);
+      systemPtr->readParam();
+      setNThread(n);
+
+      return *systemPtr;
+   }
+
+   /*
+   * Execute the command files of all systems.
+   */
+   template <int D>
+   int SystemSet<D>::run()
+   {
+      int nFail = 0;
+      int n = systemPtrs_.size();
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel for schedule(dynamic, 1) reduction(+:nFail)
+      #endif
+      for (int i = 0; i < n; ++i) {
+         System<D>& system = *systemPtrs_[i];
+         setNThread(1);
+         isFailed_[i] = 0;
+         try {
+            system.readCommands();
+         } catch (Exception& e) {
+            system.log() << "Exception: " << e.message() << std::endl;
+            isFailed_[i] = 1;
+         } catch (...) {
+            system.log() << "Unknown exception" << std::endl;
+            isFailed_[i] = 1;
+         }
+         nFail += isFailed_[i];
+      }
+      return nFail;
+   }
+
+} // namespace Pspc
+} // namespace Pscf
+#endif
@@ -13,7 +13,7 @@
 #include <pscf/math/IntVec.h>
 #include <util/global.h>
 
-#include <fftw3.h>
+#include "precision.h"
 
 namespace Pscf {
 namespace Pspc {
@@ -24,6 +24,10 @@ namespace Pspc {
    /**
    * Fourier transform wrapper for real data.
    *
+   * Plans are obtained from a process-wide cache (see planCache.h), so
+   * FFT objects for meshes of equal dimensions share plans. Plans are
+   * always executed with the FFTW new-array execute functions.
+   *
    * \ingroup Pspc_Field_Module
    */
    template <int D>
@@ -58,6 +62,21 @@ namespace Pspc {
       */
       void forwardTransform(RField<D>& in, RFieldDft<D>& out);
 
+      /**
+      * Compute forward transform without normalization or copying.
+      *
+      * The FFTW plan is executed directly on the input array, which an
+      * out-of-place real-to-complex transform does not modify. Output
+      * values are larger than those of forwardTransform by a factor
+      * equal to the number of grid points. Callers normalize the result
+      * by scaling the input within a loop that already writes it, or
+      * by scaling coefficients applied to the output.
+      *
+      * \param in  array of real values on r-space grid (unmodified)
+      * \param out  array of complex values on k-space grid
+      */
+      void forwardTransformUnscaled(RField<D>& in, RFieldDft<D>& out);
+
       /**
       * Compute inverse (complex-to-real) Fourier transform.
       *
@@ -85,33 +104,17 @@ namespace Pspc {
       // Number of points in k-space grid
       int kSize_;
 
-      // Pointer to a plan for a forward transform.
-      fftw_plan fPlan_;
+      // Pointer to a shared plan for a forward transform.
+      FftwPlan fPlan_;
 
-      // Pointer to a plan for an inverse transform.
-      fftw_plan iPlan_;
+      // Pointer to a shared plan for an inverse transform.
+      FftwPlan iPlan_;
 
       // Have array dimension and plan been initialized?
       bool isSetup_;
 
-      /**
-      * Make FFTW plans for transform and inverse transform.
-      */
-      void makePlans(RField<D>& rField, RFieldDft<D>& kField);
-
    };
 
-   // Declarations of explicit specializations
-
-   template <>
-   void FFT<1>::makePlans(RField<1>& rField, RFieldDft<1>& kField);
-
-   template <>
-   void FFT<2>::makePlans(RField<2>& rField, RFieldDft<2>& kField);
-
-   template <>
-   void FFT<3>::makePlans(RField<3>& rField, RFieldDft<3>& kField);
-
    /*
    * Return the dimensions of the grid for which this was allocated.
    */
@@ -9,6 +9,8 @@
 */
 
 #include "FFT.h"
+#include "planCache.h"
+#include "threads.h"
 
 namespace Pscf {
 namespace Pspc
@@ -37,10 +39,10 @@ namespace Pspc
    FFT<D>::~FFT()
    {
       if (fPlan_) {
-         fftw_destroy_plan(fPlan_);
+         releasePlan(fPlan_);
       }
       if (iPlan_) {
-         fftw_destroy_plan(iPlan_);
+         releasePlan(iPlan_);
       }
    }
 
@@ -82,8 +84,13 @@ namespace Pspc
       }
       UTIL_CHECK(work_.capacity() == rSize_);
 
-      // Make FFTW plans (explicit specializations)
-      makePlans(rField, kField);
+      // Get shared FFTW plans for a single field
+      int n[D];
+      for (int i = 0; i < D; ++i) {
+         n[i] = meshDimensions_[i];
+      }
+      fPlan_ = acquireR2cPlan(D, n, 1);
+      iPlan_ = acquireC2rPlan(D, n, 1);
 
       isSetup_ = true;
    }
@@ -104,13 +111,29 @@ namespace Pspc
       }
 
       // Copy rescaled input data prior to work array
-      double scale = 1.0/double(rSize_);
+      Real scale = 1.0/double(rSize_);
+      PSPC_OMP_PARALLEL_FOR
       for (int i = 0; i < rSize_; ++i) {
          work_[i] = rField[i]*scale;
       }
       
-      //Are there any instances where the original array is important?
-      fftw_execute_dft_r2c(fPlan_, &work_[0], &kField[0]);
+      PSPC_FFTW(execute_dft_r2c)(fPlan_, &work_[0], &kField[0]);
+   }
+
+   /*
+   * Execute forward transform directly on input, without rescaling.
+   */
+   template <int D>
+   void 
+   FFT<D>::forwardTransformUnscaled(RField<D>& rField, RFieldDft<D>& kField)
+   {
+      if (isSetup_) {
+         UTIL_CHECK(rField.capacity() == rSize_);
+         UTIL_CHECK(kField.capacity() == kSize_);
+      } else {
+         setup(rField, kField);
+      }
+      PSPC_FFTW(execute_dft_r2c)(fPlan_, &rField[0], &kField[0]);
    }
 
    /*
@@ -121,10 +144,8 @@ namespace Pspc
    {
       if (!isSetup_) {
          setup(rField, kField);
-         fftw_execute(iPlan_);
-      } else {
-         fftw_execute_dft_c2r(iPlan_, &kField[0], &rField[0]);
       }
+      PSPC_FFTW(execute_dft_c2r)(iPlan_, &kField[0], &rField[0]);
    }
 
 }
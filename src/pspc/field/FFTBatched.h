@@ -0,0 +1,188 @@
+#ifndef PSPC_FFT_BATCHED_H
+#define PSPC_FFT_BATCHED_H
+
+/*
+* PSCF++ Package 
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <pspc/field/Field.h>
+#include <pscf/math/IntVec.h>
+#include <util/global.h>
+
+#include "precision.h"
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+   using namespace Pscf;
+
+   /**
+   * Fourier transform wrapper for a batch of real fields.
+   *
+   * An FFTBatched<D> object transforms several real fields on the same
+   * mesh with a single FFTW plan (created by fftw_plan_many_dft_r2c and
+   * fftw_plan_many_dft_c2r, and shared through the plan cache declared
+   * in planCache.h). The r-grid fields of a batch are stored
+   * contiguously in one Field<Real> of capacity batchSize*rSize, with
+   * field b starting at element b*rSize. The k-grid fields are stored
+   * in the same way in one Field<FftwComplex> of capacity batchSize*kSize.
+   * This is the CPU analog of Pspg::FFTBatched.
+   *
+   * As for FFT<D>, the forward transform is normalized by a factor 
+   * 1/rSize, so that an inverse transform recovers the original fields.
+   * Unlike FFT<D>, which copies and rescales its input into a private 
+   * work array, FFTBatched<D> rescales the input fields in place, as
+   * does Pspg::FFTBatched.
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   template <int D>
+   class FFTBatched 
+   {
+
+   public:
+
+      /**
+      * Default constructor.
+      */
+      FFTBatched();
+
+      /**
+      * Destructor.
+      */
+      virtual ~FFTBatched();
+
+      /**
+      * Create FFTW plans for a batch of fields.
+      *
+      * The rFields and kFields arrays are used only to create plans, and
+      * their contents are not modified. Later transforms may use any 
+      * arrays of the same capacities allocated by the Field class.
+      *
+      * \param meshDimensions dimensions of the r-grid mesh
+      * \param batchSize number of fields in a batch
+      * \param rFields array of r-grid fields (capacity batchSize*rSize)
+      * \param kFields array of k-grid fields (capacity batchSize*kSize)
+      */
+      void setup(IntVec<D> const & meshDimensions, int batchSize,
+                 Field<Real>& rFields, Field<FftwComplex>& kFields);
+
+      /**
+      * Compute forward (real-to-complex) transforms of all fields.
+      *
+      * On return, the input array contains the input fields multiplied
+      * by the normalization factor 1/rSize.
+      *
+      * \param in  array of real fields on r-space grid (input)
+      * \param out  array of complex fields on k-space grid (output)
+      */
+      void forwardTransform(Field<Real>& in, Field<FftwComplex>& out);
+
+      /**
+      * Compute forward transforms of all fields, without normalization.
+      *
+      * The input array is not modified. Output values are larger than
+      * those of forwardTransform by a factor of rSize.
+      *
+      * \param in  array of real fields on r-space grid (input)
+      * \param out  array of complex fields on k-space grid (output)
+      */
+      void 
+      forwardTransformUnscaled(Field<Real>& in, Field<FftwComplex>& out);
+
+      /**
+      * Compute inverse (complex-to-real) transforms of all fields.
+      *
+      * The input array is overwritten (destroyed).
+      *
+      * \param in  array of complex fields on k-space grid (input)
+      * \param out  array of real fields on r-space grid (output)
+      */
+      void inverseTransform(Field<FftwComplex>& in, Field<Real>& out);
+
+      /**
+      * Return the dimensions of the r-grid mesh.
+      */
+      const IntVec<D>& meshDimensions() const;
+
+      /**
+      * Number of fields in a batch.
+      */
+      int batchSize() const;
+
+      /**
+      * Number of points in the r-grid of one field.
+      */
+      int rSize() const;
+
+      /**
+      * Number of points in the k-grid of one field.
+      */
+      int kSize() const;
+
+      /**
+      * Have plans been created?
+      */
+      bool isSetup() const;
+
+   private:
+
+      // Vector containing number of grid points in each direction.
+      IntVec<D> meshDimensions_;
+
+      // Number of fields in a batch
+      int batchSize_;
+
+      // Number of points in r-space grid
+      int rSize_;
+
+      // Number of points in k-space grid
+      int kSize_;
+
+      // Plan for forward transforms.
+      FftwPlan fPlan_;
+
+      // Plan for inverse transforms.
+      FftwPlan iPlan_;
+
+      // Have array dimension and plans been initialized?
+      bool isSetup_;
+
+   };
+
+   // Inline member functions
+
+   template <int D>
+   inline const IntVec<D>& FFTBatched<D>::meshDimensions() const
+   {  return meshDimensions_; }
+
+   template <int D>
+   inline int FFTBatched<D>::batchSize() const
+   {  return batchSize_; }
+
+   template <int D>
+   inline int FFTBatched<D>::rSize() const
+   {  return rSize_; }
+
+   template <int D>
+   inline int FFTBatched<D>::kSize() const
+   {  return kSize_; }
+
+   template <int D>
+   inline bool FFTBatched<D>::isSetup() const
+   {  return isSetup_; }
+
+   #ifndef PSPC_FFT_BATCHED_TPP
+   // Suppress implicit instantiation
+   extern template class FFTBatched<1>;
+   extern template class FFTBatched<2>;
+   extern template class FFTBatched<3>;
+   #endif
+
+} // namespace Pscf::Pspc
+} // namespace Pscf
+#endif
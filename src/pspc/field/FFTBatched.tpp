@@ -0,0 +1,139 @@
+#ifndef PSPC_FFT_BATCHED_TPP
+#define PSPC_FFT_BATCHED_TPP
+
+/*
+* PSCF++ Package 
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "FFTBatched.h"
+#include "planCache.h"
+#include "threads.h"
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /*
+   * Default constructor.
+   */
+   template <int D>
+   FFTBatched<D>::FFTBatched()
+    : meshDimensions_(0),
+      batchSize_(0),
+      rSize_(0),
+      kSize_(0),
+      fPlan_(0),
+      iPlan_(0),
+      isSetup_(false)
+   {}
+
+   /*
+   * Destructor.
+   */
+   template <int D>
+   FFTBatched<D>::~FFTBatched()
+   {
+      if (fPlan_) {
+         releasePlan(fPlan_);
+      }
+      if (iPlan_) {
+         releasePlan(iPlan_);
+      }
+   }
+
+   /*
+   * Set dimensions and create plans.
+   */
+   template <int D>
+   void FFTBatched<D>::setup(IntVec<D> const & meshDimensions, 
+                             int batchSize,
+                             Field<Real>& rFields, 
+                             Field<FftwComplex>& kFields)
+   {
+      // Preconditions
+      UTIL_CHECK(!isSetup_);
+      UTIL_CHECK(batchSize > 0);
+
+      // Set and check mesh dimensions
+      int n[D];
+      rSize_ = 1;
+      kSize_ = 1;
+      for (int i = 0; i < D; ++i) {
+         UTIL_CHECK(meshDimensions[i] > 0);
+         meshDimensions_[i] = meshDimensions[i];
+         n[i] = meshDimensions[i];
+         rSize_ *= meshDimensions[i];
+         if (i < D - 1) {
+            kSize_ *= meshDimensions[i];
+         } else {
+            kSize_ *= (meshDimensions[i]/2 + 1);
+         }
+      }
+      batchSize_ = batchSize;
+      UTIL_CHECK(rFields.capacity() == batchSize_*rSize_);
+      UTIL_CHECK(kFields.capacity() == batchSize_*kSize_);
+
+      // Get shared FFTW plans, with contiguous fields of unit stride
+      fPlan_ = acquireR2cPlan(D, n, batchSize_);
+      iPlan_ = acquireC2rPlan(D, n, batchSize_);
+
+      isSetup_ = true;
+   }
+
+   /*
+   * Normalize input in place, then execute forward transforms.
+   */
+   template <int D>
+   void 
+   FFTBatched<D>::forwardTransform(Field<Real>& in, Field<FftwComplex>& out)
+   {
+      UTIL_CHECK(isSetup_);
+      UTIL_CHECK(in.capacity() == batchSize_*rSize_);
+      UTIL_CHECK(out.capacity() == batchSize_*kSize_);
+
+      // Rescale input in place, rather than copying to a work array
+      Real scale = 1.0/double(rSize_);
+      int size = batchSize_*rSize_;
+      PSPC_OMP_PARALLEL_FOR
+      for (int i = 0; i < size; ++i) {
+         in[i] *= scale;
+      }
+
+      PSPC_FFTW(execute_dft_r2c)(fPlan_, &in[0], &out[0]);
+   }
+
+   /*
+   * Execute forward transforms, without rescaling.
+   */
+   template <int D>
+   void FFTBatched<D>::forwardTransformUnscaled(Field<Real>& in, 
+                                               Field<FftwComplex>& out)
+   {
+      UTIL_CHECK(isSetup_);
+      UTIL_CHECK(in.capacity() == batchSize_*rSize_);
+      UTIL_CHECK(out.capacity() == batchSize_*kSize_);
+      PSPC_FFTW(execute_dft_r2c)(fPlan_, &in[0], &out[0]);
+   }
+
+   /*
+   * Execute inverse (complex-to-real) transforms.
+   */
+   template <int D>
+   void 
+   FFTBatched<D>::inverseTransform(Field<FftwComplex>& in, Field<Real>& out)
+   {
+      UTIL_CHECK(isSetup_);
+      UTIL_CHECK(in.capacity() == batchSize_*kSize_);
+      UTIL_CHECK(out.capacity() == batchSize_*rSize_);
+
+      PSPC_FFTW(execute_dft_c2r)(iPlan_, &in[0], &out[0]);
+   }
+
+}
+}
+#endif
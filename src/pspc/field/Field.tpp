@@ -11,7 +11,7 @@
 #include "Field.h"
 #include <util/misc/Memory.h>
 
-#include <fftw3.h>
+#include "precision.h"
 
 namespace Pscf {
 namespace Pspc
@@ -35,7 +35,7 @@ namespace Pspc
    Field<Data>::~Field()
    {
       if (isAllocated()) {
-         fftw_free(data_);
+         PSPC_FFTW(free)(data_);
          capacity_ = 0;
       }
    }
@@ -56,7 +56,7 @@ namespace Pspc
       if (!other.isAllocated()) {
          UTIL_THROW("Other Field must be allocated.");
       }
-      data_ = (Data*) fftw_malloc(sizeof(Data)*other.capacity_);
+      data_ = (Data*) PSPC_FFTW(malloc)(sizeof(Data)*other.capacity_);
       capacity_ = other.capacity_;
       for (int i = 0; i < capacity_; ++i) {
          data_[i] = other.data_[i];
@@ -115,7 +115,7 @@ namespace Pspc
       if (capacity <= 0) {
          UTIL_THROW("Attempt to allocate with capacity <= 0");
       }
-      data_ = (Data*) fftw_malloc(sizeof(Data)*capacity);
+      data_ = (Data*) PSPC_FFTW(malloc)(sizeof(Data)*capacity);
       capacity_ = capacity;
    }
 
@@ -130,7 +130,7 @@ namespace Pspc
       if (!isAllocated()) {
          UTIL_THROW("Array is not allocated");
       }
-      fftw_free(data_);
+      PSPC_FFTW(free)(data_);
       capacity_ = 0;
    }
 
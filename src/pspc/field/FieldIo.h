@@ -15,11 +15,15 @@
 #include <pscf/crystal/Basis.h>            // member
 #include <pscf/crystal/UnitCell.h>         // member
 #include <pscf/mesh/Mesh.h>                // member
+#include <pscf/math/FieldFile.h>           // function parameter
 
 #include <util/misc/FileMaster.h>          // member
 #include <util/containers/DArray.h>        // function parameter
+#include <util/containers/GArray.h>        // member
 #include <util/containers/Array.h>         // function parameter
 
+#include <complex>
+
 namespace Pscf {
 namespace Pspc
 {
@@ -232,6 +236,66 @@ namespace Pspc
       */
       void writeFieldHeader(std::ostream& out, int nMonomer) const;
 
+      /**
+      * Read field components in symmetry-adapted form from binary file.
+      *
+      * The file is mapped into memory (see Pscf::FieldFile). Stars are
+      * identified by their characteristic waves, as for text files, so
+      * the file may have been written with a different basis ordering.
+      * As for readFieldsBasis, this sets the unit cell parameters to
+      * those given in the file.
+      *
+      * \param filename  name of input file
+      * \param fields  array of fields (symmetry adapted basis components)
+      */
+      void readFieldsBasisBinary(std::string filename, 
+                                 DArray< DArray <double> >& fields);
+
+      /**
+      * Write field components in symmetry-adapted form to binary file.
+      *
+      * \param filename  name of output file
+      * \param fields  array of fields (symmetry adapted basis components)
+      */
+      void writeFieldsBasisBinary(std::string filename, 
+                                  DArray< DArray <double> > const & fields);
+
+      /**
+      * Read array of RField objects (r-space grid) from binary file.
+      *
+      * \param filename  name of input file
+      * \param fields  array of RField fields (r-space grid)
+      */
+      void readFieldsRGridBinary(std::string filename, 
+                                 DArray< RField<D> >& fields);
+
+      /**
+      * Write array of RField objects (r-space grid) to binary file.
+      *
+      * \param filename  name of output file
+      * \param fields  array of RField fields (r-space grid)
+      */
+      void writeFieldsRGridBinary(std::string filename, 
+                                  DArray< RField<D> > const& fields);
+
+      /**
+      * Read array of RFieldDft objects (k-space grid) from binary file.
+      *
+      * \param filename  name of input file
+      * \param fields  array of RFieldDft fields (k-space grid)
+      */
+      void readFieldsKGridBinary(std::string filename, 
+                                 DArray< RFieldDft<D> >& fields);
+
+      /**
+      * Write array of RFieldDft objects (k-space grid) to binary file.
+      *
+      * \param filename  name of output file
+      * \param fields  array of RFieldDft fields (k-space grid)
+      */
+      void writeFieldsKGridBinary(std::string filename, 
+                                  DArray< RFieldDft<D> > const& fields);
+
       //@}
       /// \name Field Format Conversion
       //@{
@@ -260,10 +324,17 @@ namespace Pspc
       /**
       * Convert field from Fourier transform (k-grid) to symmetrized basis.
       *
+      * Every output coefficient is multiplied by the optional factor
+      * scale, which allows a normalization factor omitted from the
+      * Fourier transform (see FFT::forwardTransformUnscaled) to be 
+      * applied to the nStar coefficients, rather than to the grid.
+      *
       * \param in  complex DFT (k-grid) representation of a field.
       * \param out  coefficients of symmetry-adapted basis functions.
+      * \param scale  factor applied to all coefficients (default 1.0)
       */
-      void convertKGridToBasis(RFieldDft<D> const& in, DArray<double>& out);
+      void convertKGridToBasis(RFieldDft<D> const& in, DArray<double>& out,
+                               double scale = 1.0);
 
       /**
       * Convert fields from Fourier transform (kgrid) to symmetrized basis.
@@ -273,9 +344,11 @@ namespace Pspc
       *
       * \param in  fields defined as discrete Fourier transforms (k-grid)
       * \param out  components of fields in symmetry adapted basis 
+      * \param scale  factor applied to all coefficients (default 1.0)
       */
       void convertKGridToBasis(DArray< RFieldDft<D> > & in,
-                               DArray< DArray <double> > & out);
+                               DArray< DArray <double> > & out,
+                               double scale = 1.0);
 
       /**
       * Convert fields from symmetrized basis to spatial grid (rgrid).
@@ -299,8 +372,66 @@ namespace Pspc
 
    private:
 
-      // DFT work array for two-step conversion basis <-> kgrid <-> rgrid.
-      RFieldDft<D> workDft_;
+      // DFT work arrays for two-step conversion basis <-> kgrid <-> rgrid.
+      DArray< RFieldDft<D> > workDfts_;
+
+      // Gather/scatter maps for conversion between basis and k-grid.
+      //
+      // Wave maps, used by convertBasisToKGrid, contain one element 
+      // for each explicit wave (i.e., each point of the k-grid), in
+      // separate segments for closed stars, pairs of open stars and 
+      // cancelled stars. Star maps, used by convertKGridToBasis, 
+      // contain one element for each closed star or pair of open stars, 
+      // identifying the characteristic wave from which its coefficient
+      // is computed. See makeMaps().
+
+      /// Rank in k-grid of each explicit wave of an uncancelled closed star.
+      GArray<int> closedWaveRanks_;
+
+      /// Index of star containing each such wave.
+      GArray<int> closedWaveStars_;
+
+      /// Coefficient of each such wave.
+      GArray< std::complex<double> > closedWaveCoeffs_;
+
+      /// Rank in k-grid of each explicit wave of a pair of open stars.
+      GArray<int> openWaveRanks_;
+
+      /// Index of first star of the pair containing each such wave.
+      GArray<int> openWaveStars_;
+
+      /// Sign of imaginary part of star coefficient (-1 or +1 for 2nd star).
+      GArray<double> openWaveSigns_;
+
+      /// Coefficient of each such wave.
+      GArray< std::complex<double> > openWaveCoeffs_;
+
+      /// Rank in k-grid of each explicit wave of a cancelled star.
+      GArray<int> cancelledWaveRanks_;
+
+      /// Index of each uncancelled closed star.
+      GArray<int> closedStarIds_;
+
+      /// Rank in k-grid of characteristic wave of each closed star.
+      GArray<int> closedStarRanks_;
+
+      /// Coefficient of characteristic wave of each closed star.
+      GArray< std::complex<double> > closedStarCoeffs_;
+
+      /// Index of first star of each pair of open stars.
+      GArray<int> openStarIds_;
+
+      /// Rank in k-grid of characteristic wave of each pair.
+      GArray<int> openStarRanks_;
+
+      /// Coefficient of characteristic wave of each pair.
+      GArray< std::complex<double> > openStarCoeffs_;
+
+      /// Index of each cancelled star.
+      GArray<int> cancelledStarIds_;
+
+      /// Have the maps been constructed?
+      bool hasMaps_;
 
       // Pointers to associated objects.
 
@@ -396,9 +527,67 @@ namespace Pspc
       void readFieldHeader(std::istream& in);
 
       /**
-      * Check state of work array, allocate if necessary.
+      * Initialize header of a binary field file.
+      *
+      * \param header  header (output)
+      * \param type  type of field data
+      * \param nMonomer  number of monomer types
+      * \param nValue  number of double values per monomer
+      */
+      void makeBinaryHeader(FieldFileHeader& header, FieldFile::Type type,
+                            int nMonomer, int nValue) const;
+
+      /**
+      * Check header of binary field file, and set unit cell parameters.
+      *
+      * \param file  binary field file, after a call to open()
+      * \param type  expected type of field data
+      * \param nMonomer  expected number of monomer types
+      */
+      void readBinaryHeader(FieldFile const & file, FieldFile::Type type,
+                            int nMonomer);
+
+      /**
+      * Construct gather/scatter maps from the associated Basis.
+      *
+      * Called on the first conversion between basis and k-grid after
+      * a call to associate. The Basis must be constructed before this
+      * and not reconstructed afterwards.
+      */
+      void makeMaps();
+
+      /**
+      * Scatter basis components of one field onto the k-grid.
+      *
+      * Loops are OpenMP worksharing constructs without a barrier, for 
+      * use within an enclosing parallel region. Every element of out 
+      * is written by exactly one iteration.
+      *
+      * \param in  coefficients of symmetry-adapted basis functions
+      * \param out  discrete Fourier transform of a real field
+      */
+      void basisToKGrid(DArray<double> const& in, RFieldDft<D>& out);
+
+      /**
+      * Gather basis components of one field from the k-grid.
+      *
+      * Loops are worksharing constructs without a barrier, as for 
+      * basisToKGrid. 
+      *
+      * \param in  complex DFT (k-grid) representation of a field
+      * \param out  coefficients of symmetry-adapted basis functions
+      * \param scale  factor applied to all coefficients
+      * \return number of closed stars with non-real coefficients
+      */
+      int kGridToBasis(RFieldDft<D> const& in, DArray<double>& out,
+                       double scale);
+
+      /**
+      * Check state of work arrays, allocate if necessary.
+      *
+      * \param nField  number of work arrays required
       */
-      void checkWorkDft();
+      void checkWorkDft(int nField);
 
    };
 
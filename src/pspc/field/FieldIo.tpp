@@ -13,13 +13,16 @@
 #include <pscf/crystal/shiftToMinimum.h>
 #include <pscf/mesh/MeshIterator.h>
 #include <pscf/math/IntVec.h>
+#include <pspc/field/threads.h>
 
 #include <util/format/Str.h>
 #include <util/format/Int.h>
 #include <util/format/Dbl.h>
 
 #include <iomanip>
+#include <sstream>
 #include <string>
+#include <cstring>
 
 namespace Pscf {
 namespace Pspc
@@ -32,7 +35,8 @@ namespace Pspc
    */
    template <int D>
    FieldIo<D>::FieldIo()
-    : unitCellPtr_(0),
+    : hasMaps_(false),
+      unitCellPtr_(0),
       meshPtr_(0),
       fftPtr_(0),
       groupNamePtr_(0),
@@ -64,6 +68,7 @@ namespace Pspc
       basisPtr_ = &basis;
       fftPtr_ = &fft;
       fileMasterPtr_ = &fileMaster;
+      hasMaps_ = false;
    }
   
    template <int D>
@@ -404,9 +409,9 @@ namespace Pspc
       in >> nGrid;
       UTIL_CHECK(nGrid == mesh().dimensions());
 
-      // Read Fields;
+      // Read Fields (one row per wavevector in the DFT k-grid)
       int idum;
-      MeshIterator<D> itr(mesh().dimensions());
+      MeshIterator<D> itr(fields[0].dftDimensions());
       for (itr.begin(); !itr.atEnd(); ++itr) {
          in >> idum;
          for (int i = 0; i < nMonomer; ++i) {
@@ -439,8 +444,8 @@ namespace Pspc
       out << "ngrid" << std::endl 
           << "               " << mesh().dimensions() << std::endl;
 
-      // Write fields
-      MeshIterator<D> itr(mesh().dimensions());
+      // Write fields (one row per wavevector in the DFT k-grid)
+      MeshIterator<D> itr(fields[0].dftDimensions());
       for (itr.begin(); !itr.atEnd(); ++itr) {
          out << Int(itr.rank(), 5);
          for (int j = 0; j < nMonomer; ++j) {
@@ -498,130 +503,314 @@ namespace Pspc
       out << "dim" <<  std::endl 
           << "          " << D << std::endl;
       writeUnitCellHeader(out, unitCell()); 
+      // Without a group name, label fields with the identity group "I"
       out << "group_name" << std::endl 
-          << "          " << groupName() <<  std::endl;
+          << "          " 
+          << (groupName().empty() ? std::string("I") : groupName()) 
+          << std::endl;
       out << "N_monomer"  << std::endl 
           << "          " << nMonomer << std::endl;
    }
 
    template <int D>
-   void FieldIo<D>::convertBasisToKGrid(DArray<double> const& in, 
-                                        RFieldDft<D>& out)
+   void FieldIo<D>::readFieldsBasisBinary(std::string filename, 
+                                          DArray< DArray<double> >& fields)
    {
-      // Create Mesh<D> with dimensions of DFT Fourier grid.
-      Mesh<D> dftMesh(out.dftDimensions());
+      int nMonomer = fields.capacity();
+      UTIL_CHECK(nMonomer > 0);
 
-      typename Basis<D>::Star const* starPtr; // pointer to current star
-      typename Basis<D>::Wave const* wavePtr; // pointer to current wave
-      std::complex<double> component;         // coefficient for star
-      std::complex<double> coeff;             // coefficient for wave
-      IntVec<D> indices;                      // dft grid indices of wave
-      int rank;                               // dft grid rank of wave
-      int is;                                 // star index
-      int iw;                                 // wave index
+      FieldFile file;
+      file.open(fileMaster().inputPrefix() + filename);
+      readBinaryHeader(file, FieldFile::Basis, nMonomer);
+      int nStarIn = file.header().nValue;
 
-      // Initialize all dft coponents to zero
-      for (rank = 0; rank < dftMesh.size(); ++rank) {
-         out[rank][0] = 0.0;
-         out[rank][1] = 0.0;
+      // Initialize all field array elements to zero
+      int i, j;
+      for (j = 0; j < nMonomer; ++j) {
+         UTIL_CHECK(fields[j].capacity() >= nStarIn);
+         for (i = 0; i < fields[j].capacity(); ++i) {
+            fields[j][i] = 0.0;
+         }
       }
 
-      // Loop over stars, skipping cancelled stars
-      is = 0;
-      while (is < basis().nStar()) {
-         starPtr = &(basis().star(is));
+      // Loop over stars, identified by characteristic waves
+      IntVec<D> waveIn, waveBz, waveDft;
+      int waveId, starId;
+      for (i = 0; i < nStarIn; ++i) {
+         for (j = 0; j < D; ++j) {
+            waveIn[j] = file.star(i)[j];
+         }
 
-         if (starPtr->cancel) {
-            ++is;
-            continue;
+         // If wave is in FBZ, find in basis and set field components
+         waveBz = shiftToMinimum(waveIn, mesh().dimensions(), unitCell());
+         if (waveIn == waveBz) {
+            waveDft = waveBz;
+            mesh().shift(waveDft);
+            waveId = basis().waveId(waveDft);
+            starId = basis().wave(waveId).starId;
+            UTIL_CHECK(basis().star(starId).waveBz == waveBz);
+            if (!basis().star(starId).cancel) {
+               for (j = 0; j < nMonomer; ++j) {
+                  fields[j][starId] = file.data(j)[i];
+               }
+            }
          }
+      }
+      file.close();
+   }
 
-         if (starPtr->invertFlag == 0) {
+   template <int D>
+   void 
+   FieldIo<D>::writeFieldsBasisBinary(std::string filename, 
+                                      DArray< DArray<double> > const& fields)
+   {
+      int nMonomer = fields.capacity();
+      UTIL_CHECK(nMonomer > 0);
+      int nStar = basis().nStar();
+      int nBasis = basis().nBasis();
 
-            // Make complex coefficient for star basis function
-            component = std::complex<double>(in[is], 0.0);
+      std::ofstream out;
+      fileMaster().openOutputFile(filename, out, 
+                                  std::ios::out | std::ios::binary);
+      FieldFileHeader header;
+      makeBinaryHeader(header, FieldFile::Basis, nMonomer, nBasis);
+      FieldFile::writeHeader(out, header);
+
+      // Write characteristic waves of uncancelled stars
+      int i, j, k;
+      int wave[D];
+      for (i = 0; i < nStar; ++i) {
+         typename Basis<D>::Star const & star = basis().star(i);
+         if (!star.cancel) {
+            for (j = 0; j < D; ++j) {
+               wave[j] = star.waveBz[j];
+            }
+            FieldFile::writeStar(out, wave, D, star.size);
+         }
+      }
 
-            // Loop over waves in closed star
-            for (iw = starPtr->beginId; iw < starPtr->endId; ++iw) {
-               wavePtr = &basis().wave(iw);
-               if (!wavePtr->implicit) {
-                  coeff = component*(wavePtr->coeff);
-                  indices = wavePtr->indicesDft;    
-                  rank = dftMesh.rank(indices);
-                  out[rank][0] = coeff.real();
-                  out[rank][1] = coeff.imag();
-               }
+      // Write components of uncancelled stars, for each monomer
+      DArray<double> temp;
+      temp.allocate(nBasis);
+      for (j = 0; j < nMonomer; ++j) {
+         k = 0;
+         for (i = 0; i < nStar; ++i) {
+            if (!basis().star(i).cancel) {
+               temp[k] = fields[j][i];
+               ++k;
             }
-            ++is;
+         }
+         FieldFile::writeData(out, temp.cArray(), nBasis);
+      }
+      out.close();
+   }
 
-         } else
-         if (starPtr->invertFlag == 1) {
+   template <int D>
+   void FieldIo<D>::readFieldsRGridBinary(std::string filename, 
+                                          DArray< RField<D> >& fields)
+   {
+      int nMonomer = fields.capacity();
+      UTIL_CHECK(nMonomer > 0);
 
-            // Make complex component for first star
-            component = std::complex<double>(in[is], -in[is+1]);
-            component /= sqrt(2.0);
+      FieldFile file;
+      file.open(fileMaster().inputPrefix() + filename);
+      readBinaryHeader(file, FieldFile::RGrid, nMonomer);
+      int nx = mesh().size();
+      UTIL_CHECK(file.header().nValue == nx);
 
-            // Loop over waves in first star
-            starPtr = &(basis().star(is));
-            for (iw = starPtr->beginId; iw < starPtr->endId; ++iw) {
-               wavePtr = &basis().wave(iw);
-               if (!(wavePtr->implicit)) {
-                  coeff = component*(wavePtr->coeff);
-                  indices = wavePtr->indicesDft;    
-                  rank = dftMesh.rank(indices);
-                  out[rank][0] = coeff.real();
-                  out[rank][1] = coeff.imag();
-               }
-            }
+      // Values are stored as double, in order of mesh rank
+      double const * data;
+      int i, j;
+      for (i = 0; i < nMonomer; ++i) {
+         UTIL_CHECK(fields[i].capacity() == nx);
+         data = file.data(i);
+         for (j = 0; j < nx; ++j) {
+            fields[i][j] = data[j];
+         }
+      }
+      file.close();
+   }
 
-            // Loop over waves in second star
-            starPtr = &(basis().star(is+1));
-            UTIL_CHECK(starPtr->invertFlag == -1);
-            component = conj(component);
-            for (iw = starPtr->beginId; iw < starPtr->endId; ++iw) {
-               wavePtr = &basis().wave(iw);
-               if (!(wavePtr->implicit)) {
-                  coeff = component*(wavePtr->coeff);
-                  indices = wavePtr->indicesDft;
-                  rank = dftMesh.rank(indices);
-                  out[rank][0] = coeff.real();
-                  out[rank][1] = coeff.imag();
-               }
-            }
+   template <int D>
+   void 
+   FieldIo<D>::writeFieldsRGridBinary(std::string filename, 
+                                      DArray< RField<D> > const& fields)
+   {
+      int nMonomer = fields.capacity();
+      UTIL_CHECK(nMonomer > 0);
+      int nx = mesh().size();
 
-            // Increment is by 2 (two stars were processed)
-            is += 2;
+      std::ofstream out;
+      fileMaster().openOutputFile(filename, out, 
+                                  std::ios::out | std::ios::binary);
+      FieldFileHeader header;
+      makeBinaryHeader(header, FieldFile::RGrid, nMonomer, nx);
+      FieldFile::writeHeader(out, header);
 
-         } else {
- 
-            UTIL_THROW("Invalid invertFlag value");
-  
+      // Copy to a double buffer, since RField may store float values
+      DArray<double> temp;
+      temp.allocate(nx);
+      int i, j;
+      for (i = 0; i < nMonomer; ++i) {
+         UTIL_CHECK(fields[i].capacity() == nx);
+         for (j = 0; j < nx; ++j) {
+            temp[j] = fields[i][j];
          }
+         FieldFile::writeData(out, temp.cArray(), nx);
+      }
+      out.close();
+   }
+
+   template <int D>
+   void FieldIo<D>::readFieldsKGridBinary(std::string filename, 
+                                          DArray< RFieldDft<D> >& fields)
+   {
+      int nMonomer = fields.capacity();
+      UTIL_CHECK(nMonomer > 0);
 
+      FieldFile file;
+      file.open(fileMaster().inputPrefix() + filename);
+      readBinaryHeader(file, FieldFile::KGrid, nMonomer);
+
+      // Each value is a (real, imaginary) pair of doubles, in order of rank
+      double const * data;
+      int i, j, nk;
+      for (i = 0; i < nMonomer; ++i) {
+         nk = fields[i].capacity();
+         UTIL_CHECK(file.header().nValue == 2*nk);
+         data = file.data(i);
+         for (j = 0; j < nk; ++j) {
+            fields[i][j][0] = data[2*j];
+            fields[i][j][1] = data[2*j+1];
+         }
       }
+      file.close();
+   }
 
+   template <int D>
+   void 
+   FieldIo<D>::writeFieldsKGridBinary(std::string filename, 
+                                      DArray< RFieldDft<D> > const& fields)
+   {
+      int nMonomer = fields.capacity();
+      UTIL_CHECK(nMonomer > 0);
+      int nk = fields[0].capacity();
+
+      std::ofstream out;
+      fileMaster().openOutputFile(filename, out, 
+                                  std::ios::out | std::ios::binary);
+      FieldFileHeader header;
+      makeBinaryHeader(header, FieldFile::KGrid, nMonomer, 2*nk);
+      FieldFile::writeHeader(out, header);
+
+      // Copy to a double buffer, since RFieldDft may store float values
+      DArray<double> temp;
+      temp.allocate(2*nk);
+      int i, j;
+      for (i = 0; i < nMonomer; ++i) {
+         UTIL_CHECK(fields[i].capacity() == nk);
+         for (j = 0; j < nk; ++j) {
+            temp[2*j] = fields[i][j][0];
+            temp[2*j+1] = fields[i][j][1];
+         }
+         FieldFile::writeData(out, temp.cArray(), 2*nk);
+      }
+      out.close();
    }
 
+   /*
+   * Initialize header of a binary field file.
+   */
    template <int D>
-   void FieldIo<D>::convertKGridToBasis(RFieldDft<D> const& in, 
-                                        DArray<double>& out)
+   void FieldIo<D>::makeBinaryHeader(FieldFileHeader& header, 
+                                     FieldFile::Type type,
+                                     int nMonomer, int nValue) const
    {
-      // Create Mesh<D> with dimensions of DFT Fourier grid.
-      Mesh<D> dftMesh(in.dftDimensions());
-
-      typename Basis<D>::Star const* starPtr;  // pointer to current star
-      typename Basis<D>::Wave const* wavePtr;  // pointer to current wave
-      std::complex<double> component;          // coefficient for star
-      IntVec<D> indices;                       // dft grid indices of wave
-      int rank;                                // dft grid rank of wave
-      int is;                                  // star index
-      int iw;                                  // wave id, within star 
-      bool isImplicit;
+      FieldFile::initHeader(header, type, D, nMonomer, nValue);
+      for (int i = 0; i < D; ++i) {
+         header.meshDimensions[i] = mesh().dimension(i);
+      }
+
+      // Name of lattice system: first item in unit cell output
+      std::ostringstream cellStream;
+      cellStream << unitCell();
+      std::istringstream latticeStream(cellStream.str());
+      std::string lattice;
+      latticeStream >> lattice;
+      strncpy(header.lattice, lattice.c_str(), sizeof(header.lattice)-1);
+      header.nParameter = unitCell().nParameter();
+      for (int i = 0; i < header.nParameter; ++i) {
+         header.parameters[i] = unitCell().parameter(i);
+      }
+
+      // Without a group name, label fields with the identity group "I"
+      std::string group = groupName().empty() ? "I" : groupName();
+      UTIL_CHECK(group.size() < sizeof(header.groupName));
+      strncpy(header.groupName, group.c_str(), sizeof(header.groupName)-1);
+   }
+
+   /*
+   * Check header of binary field file, and set unit cell parameters.
+   */
+   template <int D>
+   void FieldIo<D>::readBinaryHeader(FieldFile const & file, 
+                                     FieldFile::Type type, int nMonomer)
+   {
+      FieldFileHeader const & header = file.header();
+      UTIL_CHECK(header.type == type);
+      UTIL_CHECK(header.dimension == D);
+      UTIL_CHECK(header.nMonomer == nMonomer);
+      if (type != FieldFile::Basis) {
+         for (int i = 0; i < D; ++i) {
+            UTIL_CHECK(header.meshDimensions[i] == mesh().dimension(i));
+         }
+      }
 
-      // Initialize all components to zero
-      for (is = 0; is < basis().nStar(); ++is) {
-         out[is] = 0.0;
+      // Set unit cell, with the same checks as for a text file header
+      std::ostringstream cellStream;
+      cellStream << "crystal_system " << header.lattice << std::endl
+                 << "N_cell_param " << header.nParameter << std::endl
+                 << "cell_param " << std::setprecision(17);
+      for (int i = 0; i < header.nParameter; ++i) {
+         cellStream << " " << header.parameters[i];
       }
+      std::istringstream in(cellStream.str());
+      readUnitCellHeader(in, unitCell());
+   }
+
+   /*
+   * Construct gather/scatter maps for basis <-> k-grid conversion.
+   */
+   template <int D>
+   void FieldIo<D>::makeMaps()
+   {
+      // Create Mesh<D> with dimensions of DFT Fourier grid.
+      IntVec<D> dftDimensions = mesh().dimensions();
+      dftDimensions[D-1] = mesh().dimension(D-1)/2 + 1;
+      Mesh<D> dftMesh(dftDimensions);
+
+      closedWaveRanks_.clear();
+      closedWaveStars_.clear();
+      closedWaveCoeffs_.clear();
+      openWaveRanks_.clear();
+      openWaveStars_.clear();
+      openWaveSigns_.clear();
+      openWaveCoeffs_.clear();
+      cancelledWaveRanks_.clear();
+      closedStarIds_.clear();
+      closedStarRanks_.clear();
+      closedStarCoeffs_.clear();
+      openStarIds_.clear();
+      openStarRanks_.clear();
+      openStarCoeffs_.clear();
+      cancelledStarIds_.clear();
+
+      typename Basis<D>::Star const* starPtr; // pointer to current star
+      typename Basis<D>::Wave const* wavePtr; // pointer to current wave
+      int rank;                               // dft grid rank of wave
+      int is;                                 // star index
+      int iw;                                 // wave index
+      bool isImplicit;
 
       // Loop over stars
       is = 0;
@@ -629,12 +818,31 @@ namespace Pspc
          starPtr = &(basis().star(is));
 
          if (starPtr->cancel) {
+            for (iw = starPtr->beginId; iw < starPtr->endId; ++iw) {
+               wavePtr = &basis().wave(iw);
+               if (!wavePtr->implicit) {
+                  rank = dftMesh.rank(wavePtr->indicesDft);
+                  cancelledWaveRanks_.append(rank);
+               }
+            }
+            cancelledStarIds_.append(is);
             ++is;
             continue;
          }
 
          if (starPtr->invertFlag == 0) {
 
+            // Waves of closed star
+            for (iw = starPtr->beginId; iw < starPtr->endId; ++iw) {
+               wavePtr = &basis().wave(iw);
+               if (!wavePtr->implicit) {
+                  rank = dftMesh.rank(wavePtr->indicesDft);
+                  closedWaveRanks_.append(rank);
+                  closedWaveStars_.append(is);
+                  closedWaveCoeffs_.append(wavePtr->coeff);
+               }
+            }
+
             // Choose a characteristic wave that is not implicit.
             // Start with the first, alternately searching from
             // the beginning and end of star.
@@ -650,45 +858,200 @@ namespace Pspc
                 ++iw;
             }
             UTIL_CHECK(wavePtr->starId == is);
-            indices = wavePtr->indicesDft;
-            rank = dftMesh.rank(indices);
-
-            // Compute component value
-            component = std::complex<double>(in[rank][0], in[rank][1]);
-            component /= wavePtr->coeff;
-            UTIL_CHECK(abs(component.imag()) < 1.0E-8);
-            out[is] = component.real();
+            closedStarIds_.append(is);
+            closedStarRanks_.append(dftMesh.rank(wavePtr->indicesDft));
+            closedStarCoeffs_.append(wavePtr->coeff);
             ++is;
 
          } else
          if (starPtr->invertFlag == 1) {
 
+            // Waves of first star
+            for (iw = starPtr->beginId; iw < starPtr->endId; ++iw) {
+               wavePtr = &basis().wave(iw);
+               if (!wavePtr->implicit) {
+                  rank = dftMesh.rank(wavePtr->indicesDft);
+                  openWaveRanks_.append(rank);
+                  openWaveStars_.append(is);
+                  openWaveSigns_.append(-1.0);
+                  openWaveCoeffs_.append(wavePtr->coeff);
+               }
+            }
+
+            // Waves of second star, with complex conjugate component
+            starPtr = &(basis().star(is+1));
+            UTIL_CHECK(starPtr->invertFlag == -1);
+            for (iw = starPtr->beginId; iw < starPtr->endId; ++iw) {
+               wavePtr = &basis().wave(iw);
+               if (!wavePtr->implicit) {
+                  rank = dftMesh.rank(wavePtr->indicesDft);
+                  openWaveRanks_.append(rank);
+                  openWaveStars_.append(is);
+                  openWaveSigns_.append(1.0);
+                  openWaveCoeffs_.append(wavePtr->coeff);
+               }
+            }
+
             // Identify a characteristic wave that is not implicit:
             // Either first wave of 1st star or last wave of 2nd star.
+            starPtr = &(basis().star(is));
             wavePtr = &basis().wave(starPtr->beginId);
             if (wavePtr->implicit) {
                starPtr = &(basis().star(is+1));
-               UTIL_CHECK(starPtr->invertFlag == -1);
                wavePtr = &basis().wave(starPtr->endId-1);
                UTIL_CHECK(!(wavePtr->implicit));
             } 
-            indices = wavePtr->indicesDft;
-            rank = dftMesh.rank(indices);
-
-            // Compute component value
-            component = std::complex<double>(in[rank][0], in[rank][1]);
             UTIL_CHECK(abs(wavePtr->coeff) > 1.0E-8);
-            component /= wavePtr->coeff;
-            component *= sqrt(2.0);
-            out[is] = component.real();
-            out[is+1] = -component.imag();
+            openStarIds_.append(is);
+            openStarRanks_.append(dftMesh.rank(wavePtr->indicesDft));
+            openStarCoeffs_.append(wavePtr->coeff);
 
+            // Increment is by 2 (two stars were processed)
             is += 2;
+
          } else {
             UTIL_THROW("Invalid invertFlag value");
          }
 
-      } //  loop over star index is
+      }
+
+      // Check that the wave maps write every point of the k-grid once
+      int nWave = closedWaveRanks_.size() + openWaveRanks_.size() 
+                + cancelledWaveRanks_.size();
+      UTIL_CHECK(nWave == dftMesh.size());
+
+      hasMaps_ = true;
+   }
+
+   /*
+   * Scatter basis components of one field onto k-grid (worksharing).
+   */
+   template <int D>
+   void FieldIo<D>::basisToKGrid(DArray<double> const& in, 
+                                 RFieldDft<D>& out)
+   {
+      const double sqrt2 = sqrt(2.0);
+      int n;
+
+      // Waves of closed stars
+      n = closedWaveRanks_.size();
+      PSPC_OMP_FOR_NOWAIT
+      for (int k = 0; k < n; ++k) {
+         double a = in[closedWaveStars_[k]];
+         std::complex<double> const & c = closedWaveCoeffs_[k];
+         FftwComplex& z = out[closedWaveRanks_[k]];
+         z[0] = a*c.real();
+         z[1] = a*c.imag();
+      }
+
+      // Waves of pairs of open stars. The component for the first
+      // star is (a - ib)/sqrt(2), and its conjugate for the second.
+      n = openWaveRanks_.size();
+      PSPC_OMP_FOR_NOWAIT
+      for (int k = 0; k < n; ++k) {
+         int is = openWaveStars_[k];
+         double x = in[is]/sqrt2;
+         double y = openWaveSigns_[k]*(in[is+1]/sqrt2);
+         std::complex<double> const & c = openWaveCoeffs_[k];
+         FftwComplex& z = out[openWaveRanks_[k]];
+         z[0] = c.real()*x - c.imag()*y;
+         z[1] = c.real()*y + c.imag()*x;
+      }
+
+      // Waves of cancelled stars
+      n = cancelledWaveRanks_.size();
+      PSPC_OMP_FOR_NOWAIT
+      for (int k = 0; k < n; ++k) {
+         FftwComplex& z = out[cancelledWaveRanks_[k]];
+         z[0] = 0.0;
+         z[1] = 0.0;
+      }
+   }
+
+   /*
+   * Gather basis components of one field from k-grid (worksharing).
+   */
+   template <int D>
+   int FieldIo<D>::kGridToBasis(RFieldDft<D> const& in, 
+                                DArray<double>& out,
+                                double scale)
+   {
+      const double factor = sqrt(2.0)*scale;
+      int nFail = 0;
+      int n;
+
+      // Closed stars, for which components must be real
+      n = closedStarIds_.size();
+      PSPC_OMP_FOR_NOWAIT
+      for (int k = 0; k < n; ++k) {
+         FftwComplex const & z = in[closedStarRanks_[k]];
+         std::complex<double> component(z[0], z[1]);
+         component /= closedStarCoeffs_[k];
+         component *= scale;
+         if (!(abs(component.imag()) < 1.0E-8)) {
+            ++nFail;
+         }
+         out[closedStarIds_[k]] = component.real();
+      }
+
+      // Pairs of open stars
+      n = openStarIds_.size();
+      PSPC_OMP_FOR_NOWAIT
+      for (int k = 0; k < n; ++k) {
+         FftwComplex const & z = in[openStarRanks_[k]];
+         std::complex<double> component(z[0], z[1]);
+         component /= openStarCoeffs_[k];
+         component *= factor;
+         int is = openStarIds_[k];
+         out[is] = component.real();
+         out[is+1] = -component.imag();
+      }
+
+      // Cancelled stars
+      n = cancelledStarIds_.size();
+      PSPC_OMP_FOR_NOWAIT
+      for (int k = 0; k < n; ++k) {
+         out[cancelledStarIds_[k]] = 0.0;
+      }
+
+      return nFail;
+   }
+
+   template <int D>
+   void FieldIo<D>::convertBasisToKGrid(DArray<double> const& in, 
+                                        RFieldDft<D>& out)
+   {
+      UTIL_CHECK(out.meshDimensions() == mesh().dimensions());
+      if (!hasMaps_) {
+         makeMaps();
+      }
+
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel
+      #endif
+      {
+         basisToKGrid(in, out);
+      }
+   }
+
+   template <int D>
+   void FieldIo<D>::convertKGridToBasis(RFieldDft<D> const& in, 
+                                        DArray<double>& out,
+                                        double scale)
+   {
+      UTIL_CHECK(in.meshDimensions() == mesh().dimensions());
+      if (!hasMaps_) {
+         makeMaps();
+      }
+
+      int nFail = 0;
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel reduction(+:nFail)
+      #endif
+      {
+         nFail += kGridToBasis(in, out, scale);
+      }
+      UTIL_CHECK(nFail == 0);
    }
 
    template <int D>
@@ -698,19 +1061,49 @@ namespace Pspc
       UTIL_ASSERT(in.capacity() == out.capacity());
       int n = in.capacity();
       for (int i = 0; i < n; ++i) {
-         convertBasisToKGrid(in[i], out[i]);
+         UTIL_CHECK(out[i].meshDimensions() == mesh().dimensions());
+      }
+      if (!hasMaps_) {
+         makeMaps();
+      }
+
+      // Convert all fields within one parallel region. Each element
+      // is written once, so no barrier is needed between fields.
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel
+      #endif
+      {
+         for (int i = 0; i < n; ++i) {
+            basisToKGrid(in[i], out[i]);
+         }
       }
    }
 
    template <int D>
    void FieldIo<D>::convertKGridToBasis(DArray< RFieldDft<D> >& in,
-                                        DArray< DArray <double> > & out)
+                                        DArray< DArray <double> > & out,
+                                        double scale)
    {
       UTIL_ASSERT(in.capacity() == out.capacity());
       int n = in.capacity();
       for (int i = 0; i < n; ++i) {
-         convertKGridToBasis(in[i], out[i]);
+         UTIL_CHECK(in[i].meshDimensions() == mesh().dimensions());
+      }
+      if (!hasMaps_) {
+         makeMaps();
+      }
+
+      // Convert all fields within one parallel region
+      int nFail = 0;
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel reduction(+:nFail)
+      #endif
+      {
+         for (int i = 0; i < n; ++i) {
+            nFail += kGridToBasis(in[i], out[i], scale);
+         }
       }
+      UTIL_CHECK(nFail == 0);
    }
 
    template <int D>
@@ -719,12 +1112,12 @@ namespace Pspc
                                    DArray< RField<D> >& out)
    {
       UTIL_ASSERT(in.capacity() == out.capacity());
-      checkWorkDft();
-
       int n = in.capacity();
+      checkWorkDft(n);
+
+      convertBasisToKGrid(in, workDfts_);
       for (int i = 0; i < n; ++i) {
-         convertBasisToKGrid(in[i], workDft_);
-         fft().inverseTransform(workDft_, out[i]);
+         fft().inverseTransform(workDfts_[i], out[i]);
       }
    }
 
@@ -734,22 +1127,33 @@ namespace Pspc
                                    DArray< DArray <double> > & out)
    {
       UTIL_ASSERT(in.capacity() == out.capacity());
-      checkWorkDft();
-
       int n = in.capacity();
+      checkWorkDft(n);
+
+      // Normalize the nStar coefficients, rather than the r-grid input
+      double scale = 1.0/double(mesh().size());
       for (int i = 0; i < n; ++i) {
-         fft().forwardTransform(in[i], workDft_);
-         convertKGridToBasis(workDft_, out[i]);
+         fft().forwardTransformUnscaled(in[i], workDfts_[i]);
       }
+      convertKGridToBasis(workDfts_, out, scale);
    }
 
    template <int D>
-   void FieldIo<D>::checkWorkDft()
+   void FieldIo<D>::checkWorkDft(int nField)
    {
-      if (!workDft_.isAllocated()) {
-         workDft_.allocate(mesh().dimensions());
+      if (workDfts_.isAllocated() && workDfts_.capacity() != nField) {
+         workDfts_.deallocate();
+      }
+      if (!workDfts_.isAllocated()) {
+         workDfts_.allocate(nField);
+         for (int i = 0; i < nField; ++i) {
+            workDfts_[i].allocate(mesh().dimensions());
+         }
       } else {
-         UTIL_CHECK(workDft_.meshDimensions() == fft().meshDimensions());
+         for (int i = 0; i < nField; ++i) {
+            UTIL_CHECK(workDfts_[i].meshDimensions() 
+                       == fft().meshDimensions());
+         }
       }
    }
 
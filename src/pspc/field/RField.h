@@ -9,6 +9,7 @@
 */
 
 #include "Field.h"
+#include "precision.h"
 #include <pscf/math/IntVec.h>
 #include <util/global.h>
 
@@ -20,12 +21,12 @@ namespace Pspc
    using namespace Pscf;
 
    /**
-   * Field of real double precision values on an FFT mesh.
+   * Field of real values (of type Real) on an FFT mesh.
    * 
    * \ingroup Pspc_Field_Module 
    */
    template <int D>
-   class RField : public Field<double>
+   class RField : public Field<Real>
    {
 
    public:
@@ -63,7 +64,7 @@ namespace Pspc
       */
       RField& operator = (const RField& other);
 
-      using Field<double>::allocate;
+      using Field<Real>::allocate;
 
       /**
       * Allocate the underlying C array for an FFT grid.
@@ -109,7 +110,7 @@ namespace Pspc
    template <class Archive>
    void RField<D>::serialize(Archive& ar, const unsigned int version)
    {
-      Field<double>::serialize(ar, version);
+      Field<Real>::serialize(ar, version);
       ar & meshDimensions_;
    }
 
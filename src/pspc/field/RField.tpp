@@ -21,7 +21,7 @@ namespace Pspc
    */
    template <int D>
    RField<D>::RField()
-    : Field<double>()
+    : Field<Real>()
    {}
 
    /*
@@ -40,13 +40,13 @@ namespace Pspc
    */
    template <int D>
    RField<D>::RField(const RField<D>& other)
-    : Field<double>(),
+    : Field<Real>(),
       meshDimensions_(0)
    {
       if (!other.isAllocated()) {
          UTIL_THROW("Other Field must be allocated.");
       }
-      data_ = (double*) fftw_malloc(sizeof(double)*other.capacity_);
+      data_ = (Real*) PSPC_FFTW(malloc)(sizeof(Real)*other.capacity_);
       capacity_ = other.capacity_;
       for (int i = 0; i < capacity_; ++i) {
          data_[i] = other.data_[i];
@@ -102,7 +102,7 @@ namespace Pspc
          meshDimensions_[i] = meshDimensions[i];
          size *= meshDimensions[i];
       }
-      Field<double>::allocate(size);
+      Field<Real>::allocate(size);
    }
 
 }
@@ -12,7 +12,7 @@
 #include <pscf/math/IntVec.h>
 #include <util/global.h>
 
-#include <fftw3.h>
+#include "precision.h"
 
 namespace Pscf {
 namespace Pspc
@@ -27,7 +27,7 @@ namespace Pspc
    * \ingroup Pspc_Field_Module
    */
    template <int D>
-   class RFieldDft : public Field<fftw_complex>
+   class RFieldDft : public Field<FftwComplex>
    {
 
    public:
@@ -65,7 +65,7 @@ namespace Pspc
       */
       RFieldDft<D>& operator = (const RFieldDft<D>& other);
 
-      using Field<fftw_complex>::allocate;
+      using Field<FftwComplex>::allocate;
 
       /**
       * Allocate the underlying C array for an FFT grid.
@@ -127,7 +127,7 @@ namespace Pspc
             size *= dftDimensions_[i];
          }
       }
-      Field<fftw_complex>::allocate(size);
+      Field<FftwComplex>::allocate(size);
    }
 
    /*
@@ -151,7 +151,7 @@ namespace Pspc
    template <class Archive>
    void RFieldDft<D>::serialize(Archive& ar, const unsigned int version)
    {
-      Field<fftw_complex>::serialize(ar, version);
+      Field<FftwComplex>::serialize(ar, version);
       ar & meshDimensions_;
       ar & dftDimensions_;
    }
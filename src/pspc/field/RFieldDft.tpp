@@ -20,7 +20,7 @@ namespace Pspc {
    */
    template <int D>
    RFieldDft<D>::RFieldDft()
-    : Field<fftw_complex>()
+    : Field<FftwComplex>()
    {}
 
    /*
@@ -39,12 +39,12 @@ namespace Pspc {
    */
    template <int D>
    RFieldDft<D>::RFieldDft(const RFieldDft<D>& other)
-    : Field<fftw_complex>()
+    : Field<FftwComplex>()
    {
       if (!other.isAllocated()) {
          UTIL_THROW("Other Field must be allocated.");
       }
-      data_ = (fftw_complex*) fftw_malloc(sizeof(fftw_complex)*other.capacity_);
+      data_ = (FftwComplex*) PSPC_FFTW(malloc)(sizeof(FftwComplex)*other.capacity_);
       capacity_ = other.capacity_;
       for (int i = 0; i < capacity_; ++i) {
          data_[i][0] = other.data_[i][0];
@@ -0,0 +1,438 @@
+/*
+* PSCF++ Package
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "planCache.h"
+#include "threads.h"
+#include <util/global.h>
+#include <util/misc/Timer.h>
+#include <util/format/Int.h>
+
+#include <iterator>
+#include <vector>
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+
+   namespace {
+
+      /*
+      * Description of a plan, used to find a matching plan.
+      */
+      struct PlanKey
+      {
+         int direction;  // +1 for r2c, -1 for c2r
+         int rank;
+         int n[3];       // mesh dimensions, 0 if j >= rank
+         int batchSize;
+         int nThread;    // value of nThread() when requested
+      };
+
+      bool operator == (PlanKey const & a, PlanKey const & b)
+      {
+         if (a.direction != b.direction) return false;
+         if (a.rank != b.rank) return false;
+         if (a.batchSize != b.batchSize) return false;
+         if (a.nThread != b.nThread) return false;
+         for (int j = 0; j < 3; ++j) {
+            if (a.n[j] != b.n[j]) return false;
+         }
+         return true;
+      }
+
+      /*
+      * A cached plan, with its number of users.
+      */
+      struct CachedPlan
+      {
+         PlanKey key;
+         FftwPlan plan;
+         int nUser;
+      };
+
+      /*
+      * Number of threads chosen by autotuning for one kind of plan.
+      */
+      struct TunedPlan
+      {
+         PlanKey key;
+         int nThreadPlan;
+      };
+
+      std::vector<CachedPlan> plans_;
+      std::vector<TunedPlan> tunedPlans_;
+      unsigned int rigor_ = FFTW_ESTIMATE;
+      bool autotune_ = false;
+
+      PlanKey makeKey(int direction, int rank, int const * n,
+                      int batchSize)
+      {
+         PlanKey key;
+         key.direction = direction;
+         key.rank = rank;
+         for (int j = 0; j < 3; ++j) {
+            key.n[j] = (j < rank) ? n[j] : 0;
+         }
+         key.batchSize = batchSize;
+         key.nThread = nThread();
+         return key;
+      }
+
+      /*
+      * Number of r-grid and k-grid elements in one field.
+      */
+      void getSizes(PlanKey const & key, int& rSize, int& kSize)
+      {
+         rSize = 1;
+         kSize = 1;
+         for (int j = 0; j < key.rank; ++j) {
+            rSize *= key.n[j];
+            if (j < key.rank - 1) {
+               kSize *= key.n[j];
+            } else {
+               kSize *= (key.n[j]/2 + 1);
+            }
+         }
+      }
+
+      /*
+      * Create a plan for contiguous fields of unit stride.
+      */
+      FftwPlan createPlan(PlanKey const & key, int nThreadPlan,
+                          Real* rFields, FftwComplex* kFields)
+      {
+         int rSize, kSize;
+         getSizes(key, rSize, kSize);
+         setFftwPlanThreads(nThreadPlan);
+         if (key.direction > 0) {
+            return PSPC_FFTW(plan_many_dft_r2c)(key.rank, key.n,
+                                        key.batchSize,
+                                        rFields, NULL, 1, rSize,
+                                        kFields, NULL, 1, kSize, rigor_);
+         } else {
+            return PSPC_FFTW(plan_many_dft_c2r)(key.rank, key.n,
+                                        key.batchSize,
+                                        kFields, NULL, 1, kSize,
+                                        rFields, NULL, 1, rSize, rigor_);
+         }
+      }
+
+      /*
+      * Average time per execution of a plan on zeroed arrays, in seconds.
+      */
+      double timePlan(PlanKey const & key, FftwPlan plan,
+                      Real* rFields, FftwComplex* kFields)
+      {
+         int rSize, kSize;
+         getSizes(key, rSize, kSize);
+         int i;
+         for (i = 0; i < rSize*key.batchSize; ++i) {
+            rFields[i] = 0.0;
+         }
+         for (i = 0; i < kSize*key.batchSize; ++i) {
+            kFields[i][0] = 0.0;
+            kFields[i][1] = 0.0;
+         }
+
+         // Execute once before timing, then repeat for at least 0.02 s
+         Timer timer;
+         int nExecute = -1;
+         while (nExecute < 3 || timer.time() < 0.02) {
+            if (nExecute >= 0) timer.start();
+            if (key.direction > 0) {
+               PSPC_FFTW(execute_dft_r2c)(plan, rFields, kFields);
+            } else {
+               PSPC_FFTW(execute_dft_c2r)(plan, kFields, rFields);
+            }
+            if (nExecute >= 0) timer.stop();
+            ++nExecute;
+         }
+         return timer.time()/double(nExecute);
+      }
+
+      /*
+      * Find a matching plan, or create one. Not thread safe.
+      */
+      FftwPlan findOrCreate(PlanKey const & key)
+      {
+         int i;
+         for (i = 0; i < (int)plans_.size(); ++i) {
+            if (plans_[i].key == key) {
+               ++plans_[i].nUser;
+               return plans_[i].plan;
+            }
+         }
+
+         // Allocate temporary arrays, which the planner may overwrite
+         int rSize, kSize;
+         getSizes(key, rSize, kSize);
+         Real* rFields = (Real*)
+            PSPC_FFTW(malloc)(sizeof(Real)*rSize*key.batchSize);
+         FftwComplex* kFields = (FftwComplex*)
+            PSPC_FFTW(malloc)(sizeof(FftwComplex)*kSize*key.batchSize);
+
+         // Choose the number of threads per plan
+         FftwPlan plan = 0;
+         int nThreadPlan = key.nThread;
+         if (autotune_ && key.nThread > 1) {
+            bool isTuned = false;
+            for (i = 0; i < (int)tunedPlans_.size(); ++i) {
+               if (tunedPlans_[i].key == key) {
+                  nThreadPlan = tunedPlans_[i].nThreadPlan;
+                  isTuned = true;
+                  break;
+               }
+            }
+            if (!isTuned) {
+
+               // Time plans for 1, 2, 4, ... and key.nThread threads
+               double time, bestTime = 0.0;
+               FftwPlan trial;
+               int nt = 1;
+               while (nt > 0) {
+                  trial = createPlan(key, nt, rFields, kFields);
+                  if (trial) {
+                     time = timePlan(key, trial, rFields, kFields);
+                     if (!plan || time < bestTime) {
+                        if (plan) PSPC_FFTW(destroy_plan)(plan);
+                        plan = trial;
+                        bestTime = time;
+                        nThreadPlan = nt;
+                     } else {
+                        PSPC_FFTW(destroy_plan)(trial);
+                     }
+                  }
+                  if (nt == key.nThread) {
+                     nt = 0;
+                  } else {
+                     nt = (2*nt < key.nThread) ? 2*nt : key.nThread;
+                  }
+               }
+               TunedPlan tuned;
+               tuned.key = key;
+               tuned.nThreadPlan = nThreadPlan;
+               tunedPlans_.push_back(tuned);
+
+            }
+         }
+         if (!plan) {
+            plan = createPlan(key, nThreadPlan, rFields, kFields);
+         }
+         PSPC_FFTW(free)(rFields);
+         PSPC_FFTW(free)(kFields);
+
+         if (plan) {
+            CachedPlan entry;
+            entry.key = key;
+            entry.plan = plan;
+            entry.nUser = 1;
+            plans_.push_back(entry);
+         }
+         return plan;
+      }
+
+   }
+
+   /*
+   * Get a shared real-to-complex plan.
+   */
+   FftwPlan acquireR2cPlan(int rank, int const * n, int batchSize)
+   {
+      UTIL_CHECK(rank > 0 && rank <= 3);
+      UTIL_CHECK(batchSize > 0);
+      PlanKey key = makeKey(1, rank, n, batchSize);
+      FftwPlan plan;
+      #ifdef PSPC_OPENMP
+      #pragma omp critical(PspcPlanCache)
+      #endif
+      {
+         plan = findOrCreate(key);
+      }
+      UTIL_CHECK(plan);
+      return plan;
+   }
+
+   /*
+   * Get a shared complex-to-real plan.
+   */
+   FftwPlan acquireC2rPlan(int rank, int const * n, int batchSize)
+   {
+      UTIL_CHECK(rank > 0 && rank <= 3);
+      UTIL_CHECK(batchSize > 0);
+      PlanKey key = makeKey(-1, rank, n, batchSize);
+      FftwPlan plan;
+      #ifdef PSPC_OPENMP
+      #pragma omp critical(PspcPlanCache)
+      #endif
+      {
+         plan = findOrCreate(key);
+      }
+      UTIL_CHECK(plan);
+      return plan;
+   }
+
+   /*
+   * Release a plan, and destroy it if it has no remaining users.
+   */
+   void releasePlan(FftwPlan plan)
+   {
+      bool found = false;
+      #ifdef PSPC_OPENMP
+      #pragma omp critical(PspcPlanCache)
+      #endif
+      {
+         for (int i = 0; i < (int)plans_.size(); ++i) {
+            if (plans_[i].plan == plan) {
+               found = true;
+               --plans_[i].nUser;
+               if (plans_[i].nUser == 0) {
+                  PSPC_FFTW(destroy_plan)(plan);
+                  plans_.erase(plans_.begin() + i);
+               }
+               break;
+            }
+         }
+      }
+      UTIL_CHECK(found);
+   }
+
+   /*
+   * Number of distinct cached plans.
+   */
+   int nCachedPlan()
+   {
+      int n;
+      #ifdef PSPC_OPENMP
+      #pragma omp critical(PspcPlanCache)
+      #endif
+      {
+         n = (int)plans_.size();
+      }
+      return n;
+   }
+
+   /*
+   * Set planner rigor by name.
+   */
+   void setPlanRigor(std::string const & rigor)
+   {
+      if (rigor == "estimate") {
+         rigor_ = FFTW_ESTIMATE;
+      } else
+      if (rigor == "measure") {
+         rigor_ = FFTW_MEASURE;
+      } else
+      if (rigor == "patient") {
+         rigor_ = FFTW_PATIENT;
+      } else
+      if (rigor == "exhaustive") {
+         rigor_ = FFTW_EXHAUSTIVE;
+      } else {
+         UTIL_THROW("Unknown FFTW planner rigor");
+      }
+   }
+
+   /*
+   * Get planner rigor flag.
+   */
+   unsigned int planRigor()
+   {  return rigor_; }
+
+   /*
+   * Enable or disable autotuning.
+   */
+   void setPlanAutotune(bool autotune)
+   {  autotune_ = autotune; }
+
+   /*
+   * Read autotuning results and FFTW wisdom.
+   */
+   void readWisdom(std::istream& in)
+   {
+      std::string label;
+      int nTuned;
+      in >> label >> nTuned;
+      if (label != "nTunedPlan" || nTuned < 0) {
+         UTIL_THROW("Invalid FFTW wisdom file header");
+      }
+
+      // Read autotuning results
+      std::vector<TunedPlan> tunedPlans;
+      TunedPlan tuned;
+      int i, j;
+      for (i = 0; i < nTuned; ++i) {
+         PlanKey& key = tuned.key;
+         in >> label >> key.rank;
+         key.direction = (label == "r2c") ? 1 : -1;
+         for (j = 0; j < 3; ++j) {
+            in >> key.n[j];
+         }
+         in >> key.batchSize >> key.nThread >> tuned.nThreadPlan;
+         tunedPlans.push_back(tuned);
+      }
+      in >> label;
+      if (in.fail() || label != "wisdom") {
+         UTIL_THROW("Invalid FFTW wisdom file");
+      }
+      in >> std::ws;
+      std::string wisdom((std::istreambuf_iterator<char>(in)),
+                          std::istreambuf_iterator<char>());
+
+      int success;
+      #ifdef PSPC_OPENMP
+      #pragma omp critical(PspcPlanCache)
+      #endif
+      {
+         for (i = 0; i < (int)tunedPlans.size(); ++i) {
+            bool isNew = true;
+            for (j = 0; j < (int)tunedPlans_.size(); ++j) {
+               if (tunedPlans_[j].key == tunedPlans[i].key) {
+                  tunedPlans_[j] = tunedPlans[i];
+                  isNew = false;
+               }
+            }
+            if (isNew) {
+               tunedPlans_.push_back(tunedPlans[i]);
+            }
+         }
+         success = PSPC_FFTW(import_wisdom_from_string)(wisdom.c_str());
+      }
+      if (!success) {
+         UTIL_THROW("Failure to import FFTW wisdom");
+      }
+   }
+
+   /*
+   * Write autotuning results and FFTW wisdom.
+   */
+   void writeWisdom(std::ostream& out)
+   {
+      char* wisdom;
+      #ifdef PSPC_OPENMP
+      #pragma omp critical(PspcPlanCache)
+      #endif
+      {
+         out << "nTunedPlan  " << tunedPlans_.size() << std::endl;
+         for (int i = 0; i < (int)tunedPlans_.size(); ++i) {
+            PlanKey const & key = tunedPlans_[i].key;
+            out << ((key.direction > 0) ? "r2c" : "c2r")
+                << Int(key.rank, 3)
+                << Int(key.n[0], 6) << Int(key.n[1], 6) << Int(key.n[2], 6)
+                << Int(key.batchSize, 4) << Int(key.nThread, 5)
+                << Int(tunedPlans_[i].nThreadPlan, 5) << std::endl;
+         }
+         out << "wisdom" << std::endl;
+         wisdom = PSPC_FFTW(export_wisdom_to_string)();
+      }
+      UTIL_CHECK(wisdom);
+      out << wisdom;
+      PSPC_FFTW(free)(wisdom);
+   }
+
+}
+}
@@ -0,0 +1,137 @@
+#ifndef PSPC_PLAN_CACHE_H
+#define PSPC_PLAN_CACHE_H
+
+/*
+* PSCF++ Package
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "precision.h"
+
+#include <iostream>
+#include <string>
+
+namespace Pscf {
+namespace Pspc {
+
+   /**
+   * Get a shared plan for a batch of real-to-complex transforms.
+   *
+   * Plans are stored in a process-wide cache, and are shared by all
+   * callers that request the same rank, mesh dimensions and batch size
+   * while the same number of threads is in use (nThread()). A new plan
+   * is created only if no matching plan exists, with the planner rigor
+   * set by setPlanRigor. The fields of a batch must be contiguous, with
+   * unit stride.
+   *
+   * New plans are created using temporary arrays allocated by the FFTW
+   * malloc function, because planners other than FFTW_ESTIMATE overwrite
+   * their arrays. Shared plans must only be executed by the FFTW
+   * new-array execute functions, which are thread safe, with arrays of
+   * the same alignment, as are all arrays allocated by Field::allocate.
+   *
+   * Creation and destruction of plans are serialized, so this function
+   * and releasePlan may be called from concurrent threads.
+   *
+   * \ingroup Pspc_Field_Module
+   *
+   * \param rank  number of dimensions of the mesh (1, 2 or 3)
+   * \param n  array of rank mesh dimensions
+   * \param batchSize  number of fields transformed together
+   */
+   FftwPlan acquireR2cPlan(int rank, int const * n, int batchSize);
+
+   /**
+   * Get a shared plan for a batch of complex-to-real transforms.
+   *
+   * See acquireR2cPlan for a description of plan sharing.
+   *
+   * \ingroup Pspc_Field_Module
+   *
+   * \param rank  number of dimensions of the mesh (1, 2 or 3)
+   * \param n  array of rank mesh dimensions
+   * \param batchSize  number of fields transformed together
+   */
+   FftwPlan acquireC2rPlan(int rank, int const * n, int batchSize);
+
+   /**
+   * Release a plan obtained from acquireR2cPlan or acquireC2rPlan.
+   *
+   * The plan is destroyed when it has been released by every caller
+   * that acquired it.
+   *
+   * \ingroup Pspc_Field_Module
+   *
+   * \param plan  plan to be released
+   */
+   void releasePlan(FftwPlan plan);
+
+   /**
+   * Return the number of distinct plans in the cache.
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   int nCachedPlan();
+
+   /**
+   * Set the rigor of the FFTW planner for plans created later.
+   *
+   * Allowed values are "estimate" (FFTW_ESTIMATE, the default),
+   * "measure" (FFTW_MEASURE), "patient" (FFTW_PATIENT) and "exhaustive"
+   * (FFTW_EXHAUSTIVE). Rigor other than "estimate" can take much longer
+   * to create a plan, a cost that is paid only once for each problem
+   * if wisdom is saved by writeWisdom and read by readWisdom in later
+   * runs.
+   *
+   * \ingroup Pspc_Field_Module
+   *
+   * \param rigor  name of planner rigor level
+   */
+   void setPlanRigor(std::string const & rigor);
+
+   /**
+   * Get the FFTW planner rigor flag used for new plans.
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   unsigned int planRigor();
+
+   /**
+   * Enable or disable autotuning of the number of threads per plan.
+   *
+   * When autotuning is enabled and nThread() > 1, the first request
+   * for each plan creates plans that use 1, 2, 4, ... and nThread()
+   * threads, times their execution, and keeps the fastest. The chosen
+   * number of threads is stored along with FFTW wisdom by writeWisdom,
+   * and is reused without timing if read by readWisdom. Autotuning
+   * has no effect if OpenMP is not enabled (PSPC_OPENMP undefined).
+   *
+   * \ingroup Pspc_Field_Module
+   *
+   * \param autotune  true to enable autotuning, false to disable
+   */
+   void setPlanAutotune(bool autotune);
+
+   /**
+   * Read FFTW wisdom and autotuning results written by writeWisdom.
+   *
+   * \ingroup Pspc_Field_Module
+   *
+   * \param in  input stream, open for reading
+   */
+   void readWisdom(std::istream& in);
+
+   /**
+   * Write accumulated FFTW wisdom and autotuning results.
+   *
+   * \ingroup Pspc_Field_Module
+   *
+   * \param out  output stream, open for writing
+   */
+   void writeWisdom(std::ostream& out);
+
+} // namespace Pscf::Pspc
+} // namespace Pscf
+#endif
@@ -0,0 +1,69 @@
+#ifndef PSPC_PRECISION_H
+#define PSPC_PRECISION_H
+
+/*
+* PSCF++ Package
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <fftw3.h>
+
+/*
+* Floating point precision of r-grid and k-grid fields in pspc.
+*
+* By default, RField<D> and RFieldDft<D> store double precision values,
+* and FFTs use the double precision FFTW library (fftw_ prefix). If the
+* preprocessor macro PSPC_FLOAT is defined (by the PSPC_FLOAT makefile
+* variable), fields store single precision values and FFTs use the
+* single precision FFTW library (fftwf_ prefix). Fields expanded in a
+* symmetry-adapted basis, and all spatial averages and sums used to
+* compute Q, stress and free energy, remain double precision.
+*
+* Usage: Call FFTW functions as PSPC_FFTW(name), e.g., PSPC_FFTW(malloc),
+* PSPC_FFTW(execute_dft_r2c), which expands to fftw_name or fftwf_name.
+*/
+#ifdef PSPC_FLOAT
+#define PSPC_FFTW(name) fftwf_##name
+#else
+#define PSPC_FFTW(name) fftw_##name
+#endif
+
+namespace Pscf {
+namespace Pspc {
+
+   #ifdef PSPC_FLOAT
+
+   /**
+   * Real type of r-grid field elements (float if PSPC_FLOAT is defined).
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   typedef float Real;
+
+   /**
+   * Complex type of k-grid field elements.
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   typedef fftwf_complex FftwComplex;
+
+   /**
+   * FFTW plan type.
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   typedef fftwf_plan FftwPlan;
+
+   #else
+
+   typedef double Real;
+   typedef fftw_complex FftwComplex;
+   typedef fftw_plan FftwPlan;
+
+   #endif
+
+} // namespace Pscf::Pspc
+} // namespace Pscf
+#endif
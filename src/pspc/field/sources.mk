@@ -1,9 +1,11 @@
 pspc_field_= \
   pspc/field/FFT.cpp \
+  pspc/field/FFTBatched.cpp \
   pspc/field/RField.cpp \
   pspc/field/RFieldDft.cpp \
-  pspc/field/FFT.cpp \
-  pspc/field/FieldIo.cpp 
+  pspc/field/FieldIo.cpp \
+  pspc/field/planCache.cpp \
+  pspc/field/threads.cpp 
 
 pspc_field_SRCS=\
      $(addprefix $(SRC_DIR)/, $(pspc_field_))
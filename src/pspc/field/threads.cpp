@@ -0,0 +1,83 @@
+/*
+* PSCF++ Package
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "threads.h"
+#include <util/global.h>
+
+#include "precision.h"
+#ifdef PSPC_OPENMP
+#include <omp.h>
+#endif
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+
+   #ifdef PSPC_OPENMP
+   namespace {
+
+      // Has PSPC_FFTW(init_threads)() been called?
+      bool fftwThreadsIsInitialized_ = false;
+
+   }
+   #endif
+
+   /*
+   * Set the number of threads.
+   */
+   void setNThread(int nThread)
+   {
+      UTIL_CHECK(nThread > 0);
+      #ifdef PSPC_OPENMP
+      omp_set_num_threads(nThread);
+      #else
+      if (nThread > 1) {
+         Log::file() << "Warning: Request for " << nThread
+                     << " threads ignored (OpenMP not enabled)"
+                     << std::endl;
+      }
+      #endif
+   }
+
+   /*
+   * Get the number of threads.
+   */
+   int nThread()
+   {
+      #ifdef PSPC_OPENMP
+      return omp_get_max_threads();
+      #else
+      return 1;
+      #endif
+   }
+
+   /*
+   * Initialize FFTW threads (once) and set number of threads per plan.
+   */
+   void setFftwPlanThreads()
+   {  setFftwPlanThreads(nThread()); }
+
+   /*
+   * Initialize FFTW threads (once) and set a number of threads per plan.
+   */
+   void setFftwPlanThreads(int nThread)
+   {
+      UTIL_CHECK(nThread > 0);
+      #ifdef PSPC_OPENMP
+      if (!fftwThreadsIsInitialized_) {
+         if (PSPC_FFTW(init_threads)() == 0) {
+            UTIL_THROW("Failure to initialize FFTW threads");
+         }
+         fftwThreadsIsInitialized_ = true;
+      }
+      PSPC_FFTW(plan_with_nthreads)(nThread);
+      #endif
+   }
+
+}
+}
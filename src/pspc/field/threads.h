@@ -0,0 +1,94 @@
+#ifndef PSPC_THREADS_H
+#define PSPC_THREADS_H
+
+/*
+* PSCF++ Package
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+/*
+* Macro used to multithread a pointwise loop over grid points.
+*
+* Usage: Place PSPC_OMP_PARALLEL_FOR on the line immediately preceding
+* a "for" loop with independent iterations. The macro expands to an
+* OpenMP "parallel for" directive if the PSPC_OPENMP preprocessor macro
+* is defined, and to nothing otherwise.
+*/
+#ifdef PSPC_OPENMP
+#define PSPC_OMP_PARALLEL_FOR _Pragma("omp parallel for schedule(static)")
+#else
+#define PSPC_OMP_PARALLEL_FOR
+#endif
+
+/*
+* Macro used to share a loop over grid points within a parallel region.
+*
+* Usage: Place PSPC_OMP_FOR_NOWAIT immediately before a "for" loop
+* inside an enclosing "omp parallel" region. Iterations are divided
+* statically, without a barrier at the end of the loop. Because static
+* schedules with equal iteration counts assign the same iterations to
+* the same threads, consecutive loops of this kind over the same grid
+* need no barrier between them when each iteration only touches its
+* own grid point.
+*/
+#ifdef PSPC_OPENMP
+#define PSPC_OMP_FOR_NOWAIT _Pragma("omp for schedule(static) nowait")
+#else
+#define PSPC_OMP_FOR_NOWAIT
+#endif
+
+namespace Pscf {
+namespace Pspc {
+
+   /**
+   * Set the number of threads used in multithreaded sections.
+   *
+   * This number of threads is used both by OpenMP parallel loops and
+   * by any FFTW plan created after this function is called. If the
+   * code was not compiled with OpenMP enabled (PSPC_OPENMP undefined),
+   * the request is ignored and a warning is written to Log::file()
+   * if nThread > 1.
+   *
+   * \ingroup Pspc_Field_Module
+   *
+   * \param nThread number of threads (must be > 0)
+   */
+   void setNThread(int nThread);
+
+   /**
+   * Return the number of threads used in multithreaded sections.
+   *
+   * Returns 1 if OpenMP is not enabled.
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   int nThread();
+
+   /**
+   * Prepare FFTW to create plans that use nThread() threads.
+   *
+   * This function must be called before any FFTW plan is created.
+   * On the first call it initializes the FFTW threads library. It
+   * does nothing if OpenMP is not enabled.
+   *
+   * \ingroup Pspc_Field_Module
+   */
+   void setFftwPlanThreads();
+
+   /**
+   * Prepare FFTW to create plans that use a specified number of threads.
+   *
+   * Identical to setFftwPlanThreads(), except that plans created later
+   * use nThread threads rather than nThread(). 
+   *
+   * \ingroup Pspc_Field_Module
+   *
+   * \param nThread number of threads per plan (must be > 0)
+   */
+   void setFftwPlanThreads(int nThread);
+
+} // namespace Pscf::Pspc
+} // namespace Pscf
+#endif
@@ -9,6 +9,8 @@
 */
 
 #include <pspc/iterator/Iterator.h> // base class
+#include <pspc/iterator/HistMat.h>  // member
+#include <pspc/iterator/RpaPreconditioner.h>  // member
 #include <pspc/solvers/Mixture.h>
 #include <pscf/math/LuSolver.h>
 #include <util/containers/DArray.h>
@@ -29,6 +31,26 @@ namespace Pspc
    /**
    * Anderson mixing iterator for the pseudo spectral method.
    *
+   * The inner products of differences of successive residuals needed 
+   * to construct the Anderson mixing matrix are cached in a HistMat, 
+   * so that only O(maxHist) inner products of full residual vectors 
+   * are computed in each iteration, rather than O(maxHist^2). 
+   *
+   * If the optional parameter useQr is true, the mixing coefficients
+   * are instead obtained by solving the equivalent least squares 
+   * problem for the differences of successive residuals, using a thin
+   * QR factorization of the matrix of these differences that is 
+   * updated by adding one column and, once maxHist columns are 
+   * stored, deleting the oldest column in each iteration. This avoids
+   * the loss of precision in forming the normal equations, at the cost
+   * of storing maxHist orthonormal vectors.
+   *
+   * If the optional parameter usePreconditioner is true, the residual
+   * of each star is multiplied by the inverse of the RPA response of
+   * the homogeneous state for the wavevectors of that star (see
+   * RpaPreconditioner) before it is used for mixing. The error used 
+   * to test convergence is always computed from the raw residual.
+   *
    * \ingroup Pspc_Iterator_Module
    */
    template <int D>
@@ -125,6 +147,33 @@ namespace Pspc
       /// Maximum number of iterations to attempt.
       int maxItr_;
 
+      /// If true, use QR-updated least squares rather than histMat_.
+      bool useQr_;
+
+      /// If true, precondition residuals with preconditioner_.
+      bool usePreconditioner_;
+
+      /// Cached inner products of differences of successive residuals.
+      HistMat histMat_;
+
+      /// RPA preconditioner (used only if usePreconditioner_).
+      RpaPreconditioner<D> preconditioner_;
+
+      /// Preconditioned residual (used only if usePreconditioner_).
+      DArray< DArray<double> > precDev_;
+
+      /// Orthonormal basis vectors Q of the QR factorization.
+      DArray< DArray<double> > qrBasis_;
+
+      /// Upper triangular factor R of the QR factorization.
+      DMatrix<double> qrR_;
+
+      /// Work vector for one residual difference (QR only).
+      DArray<double> qrWork_;
+
+      /// Number of columns in the QR factorization.
+      int nQr_;
+
       // Work Array for iterating on parameters 
       FSArray<double, 6> parameters;
 
@@ -164,8 +213,49 @@ namespace Pspc
 
       DArray< DArray<double> > tempDev;
 
+      /**
+      * Inner product (d(i) - d(i+1)).(d(j) - d(j+1)) of differences.
+      */
+      double dotDiff(int i, int j);
+
+      /**
+      * Inner product (d(i) - d(i+1)).d(j) of a difference and residual.
+      */
+      double dotDiffDev(int i, int j);
+
+      /**
+      * Compute difference d(0) - d(1) of the two newest residuals.
+      *
+      * \param v  output vector, of length nMonomer*(nStar-1) + nParameter
+      */
+      void differenceDev(DArray<double>& v);
+
+      /**
+      * Inner product of a vector with the residual of age i.
+      *
+      * \param v  vector, in the format produced by differenceDev
+      * \param i  age of residual
+      */
+      double dotDev(DArray<double> const & v, int i);
+
+      /**
+      * Delete the oldest column of the QR factorization.
+      */
+      void qrDeleteFirst();
+
+      /**
+      * Append a column to the QR factorization.
+      *
+      * Returns false, and does not append, if the column is linearly
+      * dependent on the existing columns to within roundoff.
+      *
+      * \param v  new column (modified on output)
+      */
+      bool qrAppend(DArray<double>& v);
+
       using Iterator<D>::setClassName;
       using Iterator<D>::systemPtr_;
+      using Iterator<D>::nIteration_;
       using Iterator<D>::system;
       using ParamComposite::read;
       using ParamComposite::readOptional;
@@ -31,7 +31,10 @@ namespace Pspc
       epsilon_(0),
       lambda_(0),
       nHist_(0),
-      maxHist_(0)
+      maxHist_(0),
+      useQr_(false),
+      usePreconditioner_(false),
+      nQr_(0)
    {  setClassName("AmIterator"); }
 
    /*
@@ -52,6 +55,10 @@ namespace Pspc
       read(in, "epsilon", epsilon_);
       read(in, "maxHist", maxHist_);
       readOptional(in, "isFlexible", isFlexible_);
+      useQr_ = false; // default value (normal equations)
+      readOptional(in, "useQr", useQr_);
+      usePreconditioner_ = false; // default value (no preconditioner)
+      readOptional(in, "usePreconditioner", usePreconditioner_);
   }
 
    /*
@@ -60,6 +67,9 @@ namespace Pspc
    template <int D>
    void AmIterator<D>::allocate()
    {
+      // This iterator acts on fields in a symmetry-adapted basis
+      UTIL_CHECK(system().hasBasis());
+
       devHists_.allocate(maxHist_+1);
       omHists_.allocate(maxHist_+1);
 
@@ -79,6 +89,29 @@ namespace Pspc
          dArrays_[i].allocate(nStar - 1);
          tempDev[i].allocate(nStar - 1);
       }
+
+      if (maxHist_ > 0) {
+         histMat_.allocate(maxHist_);
+      }
+      if (usePreconditioner_) {
+         preconditioner_.allocate(nMonomer, nStar);
+         precDev_.allocate(nMonomer);
+         for (int i = 0; i < nMonomer; ++i) {
+            precDev_[i].allocate(nStar - 1);
+         }
+      }
+      if (useQr_ && maxHist_ > 0) {
+         int nVector = nMonomer*(nStar - 1);
+         if (isFlexible_) {
+            nVector += systemPtr_->unitCell().nParameter();
+         }
+         qrBasis_.allocate(maxHist_);
+         for (int i = 0; i < maxHist_; ++i) {
+            qrBasis_[i].allocate(nVector);
+         }
+         qrR_.allocate(maxHist_, maxHist_);
+         qrWork_.allocate(nVector);
+      }
    }
 
    /*
@@ -111,6 +144,12 @@ namespace Pspc
       convertTimer.stop(now);
       #endif
 
+      // Compute RPA preconditioner for the initial unit cell
+      if (usePreconditioner_) {
+         preconditioner_.setup(system().mixture(), system().interaction(),
+                               system().basis());
+      }
+
       // Solve MDE for initial state
       solverTimer.start();
       system().mixture().compute(system().wFieldsRGrid(),
@@ -134,12 +173,14 @@ namespace Pspc
       }
 
       // Iterative loop
+      nIteration_ = 0;
       for (int itr = 1; itr <= maxItr_; ++itr) {
+         nIteration_ = itr;
 
          updateTimer.start(now);
 
-         Log::file()<<"---------------------"<<std::endl;
-         Log::file()<<" Iteration  "<<itr<<std::endl;
+         systemPtr_->log()<<"---------------------"<<std::endl;
+         systemPtr_->log()<<" Iteration  "<<itr<<std::endl;
 
          if (itr <= maxHist_) {
             lambda_ = 1.0 - pow(0.9, itr);
@@ -156,7 +197,7 @@ namespace Pspc
          if (done) {
 
             updateTimer.stop();
-            Log::file() << "----------CONVERGED----------"<< std::endl;
+            systemPtr_->log() << "----------CONVERGED----------"<< std::endl;
 
             // Output timing results
             double updateTime = updateTimer.time();
@@ -168,30 +209,30 @@ namespace Pspc
                stressTime = stressTimer.time();
                totalTime += stressTime;
             }
-            Log::file() << "\n";
-            Log::file() << "Iterator times contributions:\n";
-            Log::file() << "\n";
-            Log::file() << "solver time  = " << solverTime  << " s,  "
-                        << solverTime/totalTime << "\n";
-            Log::file() << "stress time  = " << stressTime  << " s,  "
-                        << stressTime/totalTime << "\n";
-            Log::file() << "convert time = " << convertTime << " s,  "
-                        << convertTime/totalTime << "\n";
-            Log::file() << "update time  = "  << updateTime  << " s,  "
-                        << updateTime/totalTime << "\n";
-            Log::file() << "total time   = "  << totalTime   << " s  ";
-            Log::file() << "\n\n";
+            systemPtr_->log() << "\n";
+            systemPtr_->log() << "Iterator times contributions:\n";
+            systemPtr_->log() << "\n";
+            systemPtr_->log() << "solver time  = " << solverTime  << " s,  "
+                              << solverTime/totalTime << "\n";
+            systemPtr_->log() << "stress time  = " << stressTime  << " s,  "
+                              << stressTime/totalTime << "\n";
+            systemPtr_->log() << "convert time = " << convertTime << " s,  "
+                              << convertTime/totalTime << "\n";
+            systemPtr_->log() << "update time  = "  << updateTime  << " s,  "
+                              << updateTime/totalTime << "\n";
+            systemPtr_->log() << "total time   = "  << totalTime   << " s  ";
+            systemPtr_->log() << "\n\n";
 
             // If the unit cell is rigid, compute and output final stress 
             if (!isFlexible_) {
                system().mixture().computeStress();
-               Log::file() << "Final stress:" << "\n";
+               systemPtr_->log() << "Final stress:" << "\n";
                for (int m=0; m<(systemPtr_->unitCell()).nParameter(); ++m){
-                  Log::file() << "Stress  "<< m << "   = "
-                              << Dbl(systemPtr_->mixture().stress(m)) 
-                              << "\n";
+                  systemPtr_->log() << "Stress  "<< m << "   = "
+                                    << Dbl(systemPtr_->mixture().stress(m)) 
+                                    << "\n";
                }
-               Log::file() << "\n";
+               systemPtr_->log() << "\n";
             }
 
             // Successful completion (i.e., converged within tolerance)
@@ -199,23 +240,9 @@ namespace Pspc
 
          } else {
 
-            if (itr <= maxHist_ + 1) {
-               if (nHist_ > 0) {
-                  invertMatrix_.allocate(nHist_, nHist_);
-                  coeffs_.allocate(nHist_);
-                  vM_.allocate(nHist_);
-               }
-            }
             minimizeCoeff(itr);
             buildOmega(itr);
 
-            if (itr <= maxHist_) {
-               if (nHist_ > 0) {
-                  invertMatrix_.deallocate();
-                  coeffs_.deallocate();
-                  vM_.deallocate();
-               }
-            }
             now = Timer::now();
             updateTimer.stop(now);
 
@@ -307,7 +334,17 @@ namespace Pspc
          }
       }
 
-      devHists_.append(tempDev);
+      if (usePreconditioner_) {
+         if (isFlexible_) {
+            preconditioner_.setup(systemPtr_->mixture(), 
+                                  systemPtr_->interaction(),
+                                  systemPtr_->basis());
+         }
+         preconditioner_.apply(tempDev, precDev_);
+         devHists_.append(precDev_);
+      } else {
+         devHists_.append(tempDev);
+      }
 
       if (isFlexible_){
          FArray<double, 6 > tempCp;
@@ -343,21 +380,21 @@ namespace Pspc
             wError +=  (systemPtr_->unitCell()).parameters() [i] * (systemPtr_->unitCell()).parameters() [i];
          }
       }
-      Log::file() << " dError :" << Dbl(dError)<<std::endl;
-      Log::file() << " wError :" << Dbl(wError)<<std::endl;
+      systemPtr_->log() << " dError :" << Dbl(dError)<<std::endl;
+      systemPtr_->log() << " wError :" << Dbl(wError)<<std::endl;
       error = sqrt(dError / wError);
       #endif
 
-      // Error by Max Residuals
+      // Error by Max Residuals (of the raw residual in tempDev)
       double temp1 = 0;
       double temp2 = 0;
       for ( int i = 0; i < systemPtr_->mixture().nMonomer(); i++) {
          for ( int j = 0; j < systemPtr_->basis().nStar() - 1; j++) {
-            if (temp1 < fabs (devHists_[0][i][j]))
-                temp1 = fabs (devHists_[0][i][j]);
+            if (temp1 < fabs (tempDev[i][j]))
+                temp1 = fabs (tempDev[i][j]);
          }
       }
-      Log::file() << "SCF Error   = " << Dbl(temp1) << std::endl;
+      systemPtr_->log() << "SCF Error   = " << Dbl(temp1) << std::endl;
       error = temp1;
 
       if (isFlexible_){
@@ -367,21 +404,21 @@ namespace Pspc
          }
          // Output current stress values
          for (int m=0; m<(systemPtr_->unitCell()).nParameter() ; ++m){
-            Log::file() << "Stress  "<< m << "   = "
-                        << Dbl(systemPtr_->mixture().stress(m)) <<"\n";
+            systemPtr_->log() << "Stress  "<< m << "   = "
+                              << Dbl(systemPtr_->mixture().stress(m)) <<"\n";
          }
          error = (temp1>(100*temp2)) ? temp1 : (100*temp2);
          // 100 is chose as stress rescale factor
          // TODO: Separate SCF and stress tolerance limits
       }
-      Log::file() << "Error       = " << Dbl(error) << std::endl;
+      systemPtr_->log() << "Error       = " << Dbl(error) << std::endl;
 
       // Output current unit cell parameter values
       if (isFlexible_){
          for (int m=0; m<(systemPtr_->unitCell()).nParameter() ; ++m){
-               Log::file() << "Parameter " << m << " = "
-                           << Dbl((systemPtr_->unitCell()).parameters()[m])
-                           << "\n";
+               systemPtr_->log() << "Parameter " << m << " = "
+                                 << Dbl((systemPtr_->unitCell()).parameters()[m])
+                                 << "\n";
          }
       }
 
@@ -396,66 +433,311 @@ namespace Pspc
    template <int D>
    void AmIterator<D>::minimizeCoeff(int itr)
    {
+      // Reallocate arrays only when the number of histories changes
+      int capacity = coeffs_.isAllocated() ? coeffs_.capacity() : 0;
+      if (capacity != nHist_) {
+         if (coeffs_.isAllocated()) {
+            invertMatrix_.deallocate();
+            coeffs_.deallocate();
+            vM_.deallocate();
+         }
+         if (nHist_ > 0) {
+            invertMatrix_.allocate(nHist_, nHist_);
+            coeffs_.allocate(nHist_);
+            vM_.allocate(nHist_);
+         }
+      }
+
+      // Clear cached values at the start of a solve
       if (itr == 1) {
-         //do nothing
+         histMat_.reset();
+         nQr_ = 0;
+      }
+      if (nHist_ == 0) {
+         return;
+      }
+
+      if (useQr_) {
+
+         // Update QR factorization of the matrix of differences of 
+         // successive residuals, stored from oldest to newest
+         if (nQr_ == maxHist_) {
+            qrDeleteFirst();
+         }
+         differenceDev(qrWork_);
+         if (!qrAppend(qrWork_)) {
+            // Newest difference is nearly dependent: Restart
+            nQr_ = 0;
+            differenceDev(qrWork_);
+            qrAppend(qrWork_);
+         }
+
+         // Solve R x = Q^T d(0) by back substitution, in place in vM_
+         int m = nQr_;
+         int i, j;
+         double sum;
+         for (j = 0; j < m; ++j) {
+            vM_[j] = dotDev(qrBasis_[j], 0);
+         }
+         for (j = m - 1; j >= 0; --j) {
+            sum = vM_[j];
+            for (i = j + 1; i < m; ++i) {
+               sum -= qrR_(j, i)*vM_[i];
+            }
+            vM_[j] = sum/qrR_(j, j);
+         }
+
+         // Coefficient x of the difference d(k) - d(k+1) is vM_[m-1-k].
+         // Convert to coefficients of d(0) - d(i+1), as used in
+         // buildOmega, which are x(i) - x(i+1).
+         double x, xNext;
+         for (i = 0; i < nHist_; ++i) {
+            x = (i < m) ? vM_[m - 1 - i] : 0.0;
+            xNext = (i + 1 < m) ? vM_[m - 2 - i] : 0.0;
+            coeffs_[i] = x - xNext;
+         }
+         return;
+      }
+
+      // Add inner products of the newest difference g(0) to the cache
+      histMat_.advance();
+      UTIL_CHECK(histMat_.size() == nHist_);
+      for (int i = 0; i < nHist_; ++i) {
+         histMat_.setDot(i, dotDiff(0, i));
+      }
+      histMat_.makeU(invertMatrix_);
+
+      // V(i) = (d(0) - d(i+1)).d(0) = sum_{k <= i} g(k).d(0)
+      double sum = 0.0;
+      for (int i = 0; i < nHist_; ++i) {
+         sum += dotDiffDev(i, 0);
+         vM_[i] = sum;
+      }
+
+      if (nHist_ == 1) {
+         coeffs_[0] = vM_[0] / invertMatrix_(0,0);
       } else {
+         LuSolver solver;
+         solver.allocate(nHist_);
+         solver.computeLU(invertMatrix_);
+         solver.solve(vM_, coeffs_);
+      }
+   }
 
-         int nMonomer = systemPtr_->mixture().nMonomer();
+   /*
+   * Inner product (d(i) - d(i+1)).(d(j) - d(j+1)) of differences.
+   */
+   template <int D>
+   double AmIterator<D>::dotDiff(int i, int j)
+   {
+      int nMonomer = systemPtr_->mixture().nMonomer();
+      int nStar = systemPtr_->basis().nStar();
+      double dot = 0.0;
+      double elm;
+      for (int k = 0; k < nMonomer; ++k) {
+         DArray<double> const & di = devHists_[i][k];
+         DArray<double> const & di1 = devHists_[i+1][k];
+         DArray<double> const & dj = devHists_[j][k];
+         DArray<double> const & dj1 = devHists_[j+1][k];
+         elm = 0.0;
+         for (int l = 0; l < nStar - 1; ++l) {
+            elm += (di[l] - di1[l])*(dj[l] - dj1[l]);
+         }
+         dot += elm;
+      }
+      if (isFlexible_) {
          int nParameter = systemPtr_->unitCell().nParameter();
-         int nStar = systemPtr_->basis().nStar();
-         double elm, elm_cp;
+         for (int m = 0; m < nParameter ; ++m) {
+            dot += (devCpHists_[i][m] - devCpHists_[i+1][m])
+                  *(devCpHists_[j][m] - devCpHists_[j+1][m]);
+         }
+      }
+      return dot;
+   }
 
-         for (int i = 0; i < nHist_; ++i) {
-            for (int j = i; j < nHist_; ++j) {
-
-               invertMatrix_(i,j) = 0;
-               for (int k = 0; k < nMonomer; ++k) {
-                  elm = 0;
-                  for (int l = 0; l < nStar - 1; ++l) {
-                     elm +=
-                            ((devHists_[0][k][l] - devHists_[i+1][k][l])*
-                             (devHists_[0][k][l] - devHists_[j+1][k][l]));
-                  }
-                  invertMatrix_(i,j) += elm;
-               }
+   /*
+   * Inner product (d(i) - d(i+1)).d(j) of a difference and a residual.
+   */
+   template <int D>
+   double AmIterator<D>::dotDiffDev(int i, int j)
+   {
+      int nMonomer = systemPtr_->mixture().nMonomer();
+      int nStar = systemPtr_->basis().nStar();
+      double dot = 0.0;
+      double elm;
+      for (int k = 0; k < nMonomer; ++k) {
+         DArray<double> const & di = devHists_[i][k];
+         DArray<double> const & di1 = devHists_[i+1][k];
+         DArray<double> const & dj = devHists_[j][k];
+         elm = 0.0;
+         for (int l = 0; l < nStar - 1; ++l) {
+            elm += (di[l] - di1[l])*dj[l];
+         }
+         dot += elm;
+      }
+      if (isFlexible_) {
+         int nParameter = systemPtr_->unitCell().nParameter();
+         for (int m = 0; m < nParameter ; ++m) {
+            dot += (devCpHists_[i][m] - devCpHists_[i+1][m])
+                  *devCpHists_[j][m];
+         }
+      }
+      return dot;
+   }
 
-               if (isFlexible_){
-                  elm_cp = 0;
-                  for (int m = 0; m < nParameter ; ++m){
-                     elm_cp += ((devCpHists_[0][m] - devCpHists_[i+1][m])*
-                                (devCpHists_[0][m] - devCpHists_[j+1][m]));
-                  }
-                  invertMatrix_(i,j) += elm_cp;
-               }
-               invertMatrix_(j,i) = invertMatrix_(i,j);
-            }
+   /*
+   * Compute difference d(0) - d(1) of the two newest residuals.
+   */
+   template <int D>
+   void AmIterator<D>::differenceDev(DArray<double>& v)
+   {
+      int nMonomer = systemPtr_->mixture().nMonomer();
+      int nStar = systemPtr_->basis().nStar();
+      int n = 0;
+      for (int k = 0; k < nMonomer; ++k) {
+         DArray<double> const & d0 = devHists_[0][k];
+         DArray<double> const & d1 = devHists_[1][k];
+         for (int l = 0; l < nStar - 1; ++l) {
+            v[n] = d0[l] - d1[l];
+            ++n;
+         }
+      }
+      if (isFlexible_) {
+         int nParameter = systemPtr_->unitCell().nParameter();
+         for (int m = 0; m < nParameter ; ++m) {
+            v[n] = devCpHists_[0][m] - devCpHists_[1][m];
+            ++n;
+         }
+      }
+      UTIL_CHECK(n == v.capacity());
+   }
 
-            vM_[i] = 0;
-            for (int j = 0; j < nMonomer; ++j) {
-               for (int k = 0; k < nStar - 1; ++k) {
-                  vM_[i] += ( (devHists_[0][j][k] - devHists_[i+1][j][k]) *
-                               devHists_[0][j][k] );
-               }
-            }
+   /*
+   * Inner product of a vector with the residual of age i.
+   */
+   template <int D>
+   double AmIterator<D>::dotDev(DArray<double> const & v, int i)
+   {
+      int nMonomer = systemPtr_->mixture().nMonomer();
+      int nStar = systemPtr_->basis().nStar();
+      double dot = 0.0;
+      int n = 0;
+      for (int k = 0; k < nMonomer; ++k) {
+         DArray<double> const & d = devHists_[i][k];
+         for (int l = 0; l < nStar - 1; ++l) {
+            dot += v[n]*d[l];
+            ++n;
+         }
+      }
+      if (isFlexible_) {
+         int nParameter = systemPtr_->unitCell().nParameter();
+         for (int m = 0; m < nParameter ; ++m) {
+            dot += v[n]*devCpHists_[i][m];
+            ++n;
+         }
+      }
+      return dot;
+   }
 
-            if (isFlexible_){
-               elm_cp = 0;
-               for (int m = 0; m < nParameter ; ++m){
-                  vM_[i] += ((devCpHists_[0][m] - devCpHists_[i+1][m]) *
-                             (devCpHists_[0][m]));
-               }
-            }
+   /*
+   * Delete the oldest (first) column of the QR factorization.
+   *
+   * Removing the first column of R leaves an upper Hessenberg matrix,
+   * which is restored to upper triangular form by Givens rotations of
+   * successive pairs of rows. The same rotations are applied to the
+   * corresponding pairs of columns of Q.
+   */
+   template <int D>
+   void AmIterator<D>::qrDeleteFirst()
+   {
+      int m = nQr_;
+      UTIL_CHECK(m > 0);
+      int n = qrWork_.capacity();
+      int i, j, k;
+      for (j = 0; j < m - 1; ++j) {
+         for (i = 0; i <= j + 1; ++i) {
+            qrR_(i, j) = qrR_(i, j + 1);
+         }
+      }
+      double a, b, r, c, s, t1, t2;
+      for (j = 0; j < m - 1; ++j) {
+         a = qrR_(j, j);
+         b = qrR_(j + 1, j);
+         r = sqrt(a*a + b*b);
+         if (r == 0.0) continue;
+         c = a/r;
+         s = b/r;
+         qrR_(j, j) = r;
+         qrR_(j + 1, j) = 0.0;
+         for (k = j + 1; k < m - 1; ++k) {
+            t1 = qrR_(j, k);
+            t2 = qrR_(j + 1, k);
+            qrR_(j, k) = c*t1 + s*t2;
+            qrR_(j + 1, k) = -s*t1 + c*t2;
+         }
+         DArray<double>& q1 = qrBasis_[j];
+         DArray<double>& q2 = qrBasis_[j + 1];
+         for (k = 0; k < n; ++k) {
+            t1 = q1[k];
+            t2 = q2[k];
+            q1[k] = c*t1 + s*t2;
+            q2[k] = -s*t1 + c*t2;
          }
+      }
+      nQr_ = m - 1;
+   }
 
-         if (itr == 2) {
-            coeffs_[0] = vM_[0] / invertMatrix_(0,0);
-         } else {
-            LuSolver solver;
-            solver.allocate(nHist_);
-            solver.computeLU(invertMatrix_);
-            solver.solve(vM_, coeffs_);
+   /*
+   * Append a column to the QR factorization, by Gram-Schmidt 
+   * orthogonalization with one reorthogonalization pass.
+   */
+   template <int D>
+   bool AmIterator<D>::qrAppend(DArray<double>& v)
+   {
+      int m = nQr_;
+      UTIL_CHECK(m < maxHist_);
+      int n = v.capacity();
+      int j, k;
+      double norm0 = 0.0;
+      for (k = 0; k < n; ++k) {
+         norm0 += v[k]*v[k];
+      }
+      norm0 = sqrt(norm0);
+      if (norm0 == 0.0) {
+         return false;
+      }
+      double h;
+      for (j = 0; j < m; ++j) {
+         qrR_(j, m) = 0.0;
+      }
+      for (int pass = 0; pass < 2; ++pass) {
+         for (j = 0; j < m; ++j) {
+            DArray<double> const & q = qrBasis_[j];
+            h = 0.0;
+            for (k = 0; k < n; ++k) {
+               h += q[k]*v[k];
+            }
+            qrR_(j, m) += h;
+            for (k = 0; k < n; ++k) {
+               v[k] -= h*q[k];
+            }
          }
       }
+      double norm = 0.0;
+      for (k = 0; k < n; ++k) {
+         norm += v[k]*v[k];
+      }
+      norm = sqrt(norm);
+      if (norm <= 1.0E-12*norm0) {
+         return false;
+      }
+      qrR_(m, m) = norm;
+      DArray<double>& q = qrBasis_[m];
+      for (k = 0; k < n; ++k) {
+         q[k] = v[k]/norm;
+      }
+      nQr_ = m + 1;
+      return true;
    }
 
    template <int D>
@@ -473,6 +755,7 @@ namespace Pspc
          }
 
          if (isFlexible_){
+            parameters.clear();
             for (int m = 0; m < unitCell.nParameter() ; ++m){
                parameters.append(CpHists_[0][m]
                               + lambda_* devCpHists_[0][m]);
@@ -0,0 +1,258 @@
+#ifndef PSPC_AM_ITERATOR_GRID_H
+#define PSPC_AM_ITERATOR_GRID_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <pspc/iterator/Iterator.h> // base class
+#include <pspc/iterator/HistMat.h>  // member
+#include <pspc/field/RField.h>      // member
+#include <util/containers/DArray.h>
+#include <util/containers/FArray.h>
+#include <util/containers/FSArray.h>
+#include <util/containers/DMatrix.h>
+#include <util/containers/RingBuffer.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /**
+   * Anderson mixing iterator acting on fields on a real space grid.
+   *
+   * This iterator is equivalent to AmIterator, except that the w
+   * fields are mixed directly in the r-grid representation
+   * (System::wFieldsRGrid), and residuals are computed there, so that
+   * no conversions to or from the symmetry-adapted basis are required
+   * in each iteration. It can thus be used without a basis, i.e., if
+   * the optional groupName parameter of the System is omitted, for
+   * example for exploratory runs with no imposed symmetry or with
+   * meshes for which a Basis is too large to construct. The residual
+   * is the r-grid analog of that used by AmIterator, with the spatial
+   * average removed, and inner products of residuals are spatial
+   * averages, which are equal to sums over basis functions for
+   * symmetric fields.
+   *
+   * If the optional parameter isSymmetric is true, the w fields are
+   * projected onto the space of fields that are invariant under the
+   * space group (which requires a groupName) at the start of solve
+   * and after each update, by averaging values over the orbits of
+   * grid points generated by the group. The fields in basis format
+   * are then also set on return from solve, whether or not the 
+   * iteration converged. If isSymmetric is false, the fields in basis
+   * format are not set by solve, and the stress is computed from sums
+   * over all wavevectors (see Mixture::clearBasis), since the fields 
+   * need not be symmetric.
+   *
+   * \ingroup Pspc_Iterator_Module
+   */
+   template <int D>
+   class AmIteratorGrid : public Iterator<D>
+   {
+   public:
+
+      /**
+      * Constructor
+      *
+      * \param system pointer to a parent System object
+      */
+      AmIteratorGrid(System<D>* system);
+
+      /**
+      * Destructor
+      */
+      ~AmIteratorGrid();
+
+      /**
+      * Read all parameters and initialize.
+      *
+      * \param in input filestream
+      */
+      void readParameters(std::istream& in);
+
+      /**
+      * Allocate all arrays
+      */
+      void allocate();
+
+      /**
+      * Iterate to a solution
+      */
+      int solve();
+
+      /**
+      * Are w fields symmetrized by averaging over orbits?
+      */
+      bool isSymmetric() const;
+
+      /**
+      * Get epsilon (error threshhold).
+      */
+      double epsilon();
+
+      /**
+      * Get the maximum number of field histories retained.
+      */
+      int maxHist();
+
+      /**
+      * Get the maximum number of iteration before convergence.
+      */
+      int maxItr();
+
+      /**
+      * Average each w field over orbits of grid points.
+      *
+      * Precondition: isSymmetric() must be true.
+      */
+      void symmetrize();
+
+   private:
+
+      /// Error tolerance
+      double epsilon_;
+
+      /// Free parameter for minimization
+      double lambda_;
+
+      /// Number of previous steps to use to compute next state. [0,maxHist_]
+      int nHist_;
+
+      /// Number of histories to retain.
+      int maxHist_;
+
+      /// Maximum number of iterations to attempt.
+      int maxItr_;
+
+      /// Flexible cell computation (true) or rigid (false)
+      bool isFlexible_;
+
+      /// Symmetrize w fields by orbit averaging?
+      bool isSymmetric_;
+
+      /// Cached inner products of differences of successive residuals.
+      HistMat histMat_;
+
+      /// History of w fields, indexed by age and monomer type.
+      RingBuffer< DArray< RField<D> > > omHists_;
+
+      /// History of residuals, indexed by age and monomer type.
+      RingBuffer< DArray< RField<D> > > devHists_;
+
+      /// History of unit cell parameters.
+      RingBuffer< FSArray<double, 6> > CpHists_;
+
+      /// History of residuals for unit cell parameters (negative stress).
+      RingBuffer< FArray<double, 6> > devCpHists_;
+
+      /// Anderson mixing matrix U.
+      DMatrix<double> invertMatrix_;
+
+      /// Anderson mixing coefficients.
+      DArray<double> coeffs_;
+
+      /// Anderson mixing vector V.
+      DArray<double> vM_;
+
+      /// Work arrays for residuals and mixed w fields.
+      DArray< RField<D> > tempDev_;
+      DArray< RField<D> > wArrays_;
+      DArray< RField<D> > dArrays_;
+
+      /// Work arrays for mixed unit cell parameters.
+      FSArray<double, 6> parameters_;
+      FArray<double, 6> wCpArrays_;
+      FArray<double, 6> dCpArrays_;
+
+      /// Orbit index of each grid point (if isSymmetric_).
+      DArray<int> orbitIds_;
+
+      /// Number of grid points in each orbit (if isSymmetric_).
+      DArray<int> orbitSizes_;
+
+      /// Work array for sums over orbits (if isSymmetric_).
+      DArray<double> orbitSums_;
+
+      /**
+      * Construct orbits of grid points under the space group.
+      */
+      void makeOrbits();
+
+      /**
+      * Compute residuals for the current fields and append to histories.
+      */
+      void computeDeviation();
+
+      /**
+      * Check if solution is converged within specified tolerance.
+      */
+      bool isConverged();
+
+      /**
+      * Determine the Anderson mixing coefficients.
+      */
+      void minimizeCoeff(int itr);
+
+      /**
+      * Rebuild w fields for the next iteration from the coefficients.
+      */
+      void buildOmega(int itr);
+
+      /**
+      * Set symmetric w and c fields in basis format from r-grid fields.
+      *
+      * Does nothing unless isSymmetric is true and the system has a basis.
+      */
+      void setBasisFields();
+
+      /**
+      * Inner product (d(i) - d(i+1)).(d(j) - d(j+1)) of differences.
+      */
+      double dotDiff(int i, int j);
+
+      /**
+      * Inner product (d(i) - d(i+1)).d(j) of a difference and residual.
+      */
+      double dotDiffDev(int i, int j);
+
+      using Iterator<D>::setClassName;
+      using Iterator<D>::systemPtr_;
+      using Iterator<D>::nIteration_;
+      using Iterator<D>::system;
+      using ParamComposite::read;
+      using ParamComposite::readOptional;
+
+   };
+
+   template<int D>
+   inline bool AmIteratorGrid<D>::isSymmetric() const
+   { return isSymmetric_; }
+
+   template<int D>
+   inline double AmIteratorGrid<D>::epsilon()
+   { return epsilon_; }
+
+   template<int D>
+   inline int AmIteratorGrid<D>::maxHist()
+   { return maxHist_; }
+
+   template<int D>
+   inline int AmIteratorGrid<D>::maxItr()
+   { return maxItr_; }
+
+   #ifndef PSPC_AM_ITERATOR_GRID_TPP
+   // Suppress implicit instantiation
+   extern template class AmIteratorGrid<1>;
+   extern template class AmIteratorGrid<2>;
+   extern template class AmIteratorGrid<3>;
+   #endif
+
+}
+}
+#endif
@@ -0,0 +1,652 @@
+#ifndef PSPC_AM_ITERATOR_GRID_TPP
+#define PSPC_AM_ITERATOR_GRID_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "AmIteratorGrid.h"
+#include <pspc/System.h>
+#include <pscf/inter/ChiInteraction.h>
+#include <pscf/crystal/SpaceGroup.h>
+#include <pscf/mesh/MeshIterator.h>
+#include <pscf/math/LuSolver.h>
+#include <util/containers/GArray.h>
+#include <util/format/Dbl.h>
+#include <util/misc/Timer.h>
+#include <cmath>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /*
+   * Constructor
+   */
+   template <int D>
+   AmIteratorGrid<D>::AmIteratorGrid(System<D>* system)
+    : Iterator<D>(system),
+      epsilon_(0),
+      lambda_(0),
+      nHist_(0),
+      maxHist_(0),
+      maxItr_(0),
+      isFlexible_(false),
+      isSymmetric_(false)
+   {  setClassName("AmIteratorGrid"); }
+
+   /*
+   * Destructor
+   */
+   template <int D>
+   AmIteratorGrid<D>::~AmIteratorGrid()
+   {}
+
+   /*
+   * Read parameter file block.
+   */
+   template <int D>
+   void AmIteratorGrid<D>::readParameters(std::istream& in)
+   {
+      read(in, "maxItr", maxItr_);
+      read(in, "epsilon", epsilon_);
+      read(in, "maxHist", maxHist_);
+      isFlexible_ = false; // default value (fixed cell)
+      readOptional(in, "isFlexible", isFlexible_);
+      isSymmetric_ = false; // default value (no symmetrization)
+      readOptional(in, "isSymmetric", isSymmetric_);
+      UTIL_CHECK(maxHist_ >= 0);
+   }
+
+   /*
+   * Allocate memory required by iterator.
+   */
+   template <int D>
+   void AmIteratorGrid<D>::allocate()
+   {
+      devHists_.allocate(maxHist_ + 1);
+      omHists_.allocate(maxHist_ + 1);
+      if (isFlexible_) {
+         devCpHists_.allocate(maxHist_ + 1);
+         CpHists_.allocate(maxHist_ + 1);
+      }
+
+      int nMonomer = system().mixture().nMonomer();
+      IntVec<D> const & dimensions = system().mesh().dimensions();
+      tempDev_.allocate(nMonomer);
+      wArrays_.allocate(nMonomer);
+      dArrays_.allocate(nMonomer);
+      for (int i = 0; i < nMonomer; ++i) {
+         tempDev_[i].allocate(dimensions);
+         wArrays_[i].allocate(dimensions);
+         dArrays_[i].allocate(dimensions);
+      }
+
+      if (maxHist_ > 0) {
+         histMat_.allocate(maxHist_);
+      }
+
+      if (isSymmetric_) {
+         if (system().groupName().empty()) {
+            UTIL_THROW("AmIteratorGrid with isSymmetric requires groupName");
+         }
+         makeOrbits();
+      } else {
+         // Fields need not be symmetric: Stress sums use all waves
+         system().mixture().clearBasis();
+      }
+   }
+
+   /*
+   * Construct orbits of grid points under the space group.
+   *
+   * A space group operation maps a point with reduced coordinates
+   * r(i) = n(i)/N(i) to R r + t, in which R is an integer matrix and
+   * t is a rational vector. The image of every grid point is a grid
+   * point if R(i,j)*N(i) is divisible by N(j) and t(i)*N(i) is an
+   * integer for all i and j.
+   */
+   template <int D>
+   void AmIteratorGrid<D>::makeOrbits()
+   {
+      SpaceGroup<D> group;
+      readGroup(system().groupName(), group);
+
+      Mesh<D> const & mesh = system().mesh();
+      IntVec<D> const & dimensions = mesh.dimensions();
+      int nOp = group.size();
+      int i, j, k, n;
+
+      // Integer matrices and translations in mesh units
+      DArray< FArray<int, D*D> > matrices;
+      DArray< IntVec<D> > shifts;
+      matrices.allocate(nOp);
+      shifts.allocate(nOp);
+      for (k = 0; k < nOp; ++k) {
+         for (i = 0; i < D; ++i) {
+            for (j = 0; j < D; ++j) {
+               n = group[k].R(i, j)*dimensions[i];
+               if (n % dimensions[j] != 0) {
+                  UTIL_THROW("Mesh is incompatible with space group");
+               }
+               matrices[k][i*D + j] = n/dimensions[j];
+            }
+            n = group[k].t(i).num()*dimensions[i];
+            if (n % group[k].t(i).den() != 0) {
+               UTIL_THROW("Mesh is incompatible with space group");
+            }
+            shifts[k][i] = n/group[k].t(i).den();
+         }
+      }
+
+      // Assign an orbit index to every grid point
+      int meshSize = mesh.size();
+      orbitIds_.allocate(meshSize);
+      for (k = 0; k < meshSize; ++k) {
+         orbitIds_[k] = -1;
+      }
+      GArray<int> sizes;
+      IntVec<D> position, image;
+      int orbitId, imageRank;
+      MeshIterator<D> iter;
+      iter.setDimensions(dimensions);
+      for (iter.begin(); !iter.atEnd(); ++iter) {
+         if (orbitIds_[iter.rank()] >= 0) continue;
+         orbitId = sizes.size();
+         sizes.append(0);
+         position = iter.position();
+         for (k = 0; k < nOp; ++k) {
+            for (i = 0; i < D; ++i) {
+               n = shifts[k][i];
+               for (j = 0; j < D; ++j) {
+                  n += matrices[k][i*D + j]*position[j];
+               }
+               n = n % dimensions[i];
+               if (n < 0) n += dimensions[i];
+               image[i] = n;
+            }
+            imageRank = mesh.rank(image);
+            if (orbitIds_[imageRank] < 0) {
+               orbitIds_[imageRank] = orbitId;
+               ++sizes[orbitId];
+            } else {
+               UTIL_CHECK(orbitIds_[imageRank] == orbitId);
+            }
+         }
+      }
+
+      int nOrbit = sizes.size();
+      orbitSizes_.allocate(nOrbit);
+      orbitSums_.allocate(nOrbit);
+      for (k = 0; k < nOrbit; ++k) {
+         orbitSizes_[k] = sizes[k];
+      }
+      systemPtr_->log() << "Number of grid point orbits = " << nOrbit
+                        << std::endl;
+   }
+
+   /*
+   * Average each w field over orbits of grid points.
+   */
+   template <int D>
+   void AmIteratorGrid<D>::symmetrize()
+   {
+      UTIL_CHECK(isSymmetric_);
+      int nMonomer = system().mixture().nMonomer();
+      int meshSize = orbitIds_.capacity();
+      int nOrbit = orbitSizes_.capacity();
+      int i, k;
+      for (i = 0; i < nMonomer; ++i) {
+         RField<D>& w = system().wFieldRGrid(i);
+         for (k = 0; k < nOrbit; ++k) {
+            orbitSums_[k] = 0.0;
+         }
+         for (k = 0; k < meshSize; ++k) {
+            orbitSums_[orbitIds_[k]] += w[k];
+         }
+         for (k = 0; k < nOrbit; ++k) {
+            orbitSums_[k] /= double(orbitSizes_[k]);
+         }
+         for (k = 0; k < meshSize; ++k) {
+            w[k] = orbitSums_[orbitIds_[k]];
+         }
+      }
+   }
+
+   /*
+   * Solve iteratively.
+   */
+   template <int D>
+   int AmIteratorGrid<D>::solve()
+   {
+      UTIL_CHECK(system().hasWFields());
+
+      Timer solverTimer;
+      Timer stressTimer;
+      Timer updateTimer;
+      Timer::TimePoint now;
+      bool done;
+
+      if (isSymmetric_) {
+         symmetrize();
+      }
+
+      // Solve MDE for initial state
+      solverTimer.start();
+      system().mixture().compute(system().wFieldsRGrid(),
+                                 system().cFieldsRGrid());
+      now = Timer::now();
+      solverTimer.stop(now);
+
+      // Compute initial stress if needed
+      if (isFlexible_) {
+         stressTimer.start(now);
+         system().mixture().computeStress();
+         now = Timer::now();
+         stressTimer.stop(now);
+      }
+
+      // Iterative loop
+      nIteration_ = 0;
+      for (int itr = 1; itr <= maxItr_; ++itr) {
+         nIteration_ = itr;
+
+         updateTimer.start(now);
+
+         systemPtr_->log()<<"---------------------"<<std::endl;
+         systemPtr_->log()<<" Iteration  "<<itr<<std::endl;
+
+         if (itr <= maxHist_) {
+            lambda_ = 1.0 - pow(0.9, itr);
+            nHist_ = itr-1;
+         } else {
+            lambda_ = 1.0;
+            nHist_ = maxHist_;
+         }
+         computeDeviation();
+
+         // Test for convergence
+         done = isConverged();
+
+         if (done) {
+
+            updateTimer.stop();
+            systemPtr_->log() << "----------CONVERGED----------"<< std::endl;
+
+            // Output timing results
+            double updateTime = updateTimer.time();
+            double solverTime = solverTimer.time();
+            double stressTime = 0.0;
+            double totalTime = updateTime + solverTime;
+            if (isFlexible_) {
+               stressTime = stressTimer.time();
+               totalTime += stressTime;
+            }
+            systemPtr_->log() << "\n";
+            systemPtr_->log() << "Iterator times contributions:\n";
+            systemPtr_->log() << "\n";
+            systemPtr_->log() << "solver time  = " << solverTime  << " s,  "
+                              << solverTime/totalTime << "\n";
+            systemPtr_->log() << "stress time  = " << stressTime  << " s,  "
+                              << stressTime/totalTime << "\n";
+            systemPtr_->log() << "update time  = "  << updateTime  << " s,  "
+                              << updateTime/totalTime << "\n";
+            systemPtr_->log() << "total time   = "  << totalTime   << " s  ";
+            systemPtr_->log() << "\n\n";
+
+            // If the unit cell is rigid, compute and output final stress
+            if (!isFlexible_) {
+               system().mixture().computeStress();
+               systemPtr_->log() << "Final stress:" << "\n";
+               for (int m=0; m<(systemPtr_->unitCell()).nParameter(); ++m){
+                  systemPtr_->log() << "Stress  "<< m << "   = "
+                                    << Dbl(systemPtr_->mixture().stress(m))
+                                    << "\n";
+               }
+               systemPtr_->log() << "\n";
+            }
+
+            // Set symmetric fields in basis format
+            setBasisFields();
+
+            // Successful completion (i.e., converged within tolerance)
+            return 0;
+
+         } else {
+
+            minimizeCoeff(itr);
+            buildOmega(itr);
+
+            now = Timer::now();
+            updateTimer.stop(now);
+
+            // Solve MDE
+            solverTimer.start(now);
+            system().mixture().compute(system().wFieldsRGrid(),
+                                       system().cFieldsRGrid());
+            now = Timer::now();
+            solverTimer.stop(now);
+
+            // Compute stress if needed
+            if (isFlexible_){
+               stressTimer.start(now);
+               system().mixture().computeStress();
+               now = Timer::now();
+               stressTimer.stop(now);
+            }
+
+         }
+
+      }
+
+      // Failure: iteration counter itr reached maxItr without converging
+      setBasisFields();
+      return 1;
+   }
+
+   /*
+   * Set symmetric w and c fields in basis format from r-grid fields.
+   */
+   template <int D>
+   void AmIteratorGrid<D>::setBasisFields()
+   {
+      if (isSymmetric_ && system().hasBasis()) {
+         FieldIo<D>& fieldIo = system().fieldIo();
+         fieldIo.convertRGridToBasis(system().wFieldsRGrid(),
+                                     system().wFields());
+         fieldIo.convertRGridToBasis(system().cFieldsRGrid(),
+                                     system().cFields());
+      }
+   }
+
+   /*
+   * Compute residuals for the current fields and append to histories.
+   *
+   * The residual for monomer type i is sum_j chi(i,j)c(j) - P(i,j)w(j),
+   * where P is the idempotent matrix of the interaction, with its
+   * spatial average removed. This is the r-grid analog of the residual
+   * used by AmIterator, which excludes the first (homogeneous) star.
+   */
+   template <int D>
+   void AmIteratorGrid<D>::computeDeviation()
+   {
+      omHists_.append(system().wFieldsRGrid());
+      if (isFlexible_) {
+         CpHists_.append(system().unitCell().parameters());
+      }
+
+      int nMonomer = system().mixture().nMonomer();
+      int meshSize = system().mesh().size();
+      double chi, idemp, average;
+      int i, j, k;
+      for (i = 0; i < nMonomer; ++i) {
+         RField<D>& dev = tempDev_[i];
+         for (k = 0; k < meshSize; ++k) {
+            dev[k] = 0.0;
+         }
+         for (j = 0; j < nMonomer; ++j) {
+            chi = system().interaction().chi(i,j);
+            idemp = system().interaction().idemp(i,j);
+            RField<D> const & c = system().cFieldRGrid(j);
+            RField<D> const & w = system().wFieldRGrid(j);
+            for (k = 0; k < meshSize; ++k) {
+               dev[k] += chi*c[k] - idemp*w[k];
+            }
+         }
+         average = 0.0;
+         for (k = 0; k < meshSize; ++k) {
+            average += dev[k];
+         }
+         average /= double(meshSize);
+         for (k = 0; k < meshSize; ++k) {
+            dev[k] -= average;
+         }
+      }
+      devHists_.append(tempDev_);
+
+      if (isFlexible_) {
+         FArray<double, 6 > tempCp;
+         for (i = 0; i < system().unitCell().nParameter(); ++i) {
+            tempCp[i] = -system().mixture().stress(i);
+         }
+         devCpHists_.append(tempCp);
+      }
+   }
+
+   /*
+   * Check if solution is converged within specified tolerance.
+   */
+   template <int D>
+   bool AmIteratorGrid<D>::isConverged()
+   {
+      int nMonomer = system().mixture().nMonomer();
+      int meshSize = system().mesh().size();
+      int nParameter = system().unitCell().nParameter();
+      double error;
+
+      // Error by max residuals
+      double temp1 = 0;
+      double temp2 = 0;
+      for (int i = 0; i < nMonomer; ++i) {
+         RField<D> const & dev = devHists_[0][i];
+         for (int k = 0; k < meshSize; ++k) {
+            if (temp1 < fabs(dev[k])) {
+               temp1 = fabs(dev[k]);
+            }
+         }
+      }
+      systemPtr_->log() << "SCF Error   = " << Dbl(temp1) << std::endl;
+      error = temp1;
+
+      if (isFlexible_) {
+         for (int i = 0; i < nParameter; ++i) {
+            if (temp2 < fabs(devCpHists_[0][i])) {
+               temp2 = fabs(devCpHists_[0][i]);
+            }
+         }
+         for (int m = 0; m < nParameter; ++m) {
+            systemPtr_->log() << "Stress  "<< m << "   = "
+                              << Dbl(system().mixture().stress(m)) <<"\n";
+         }
+         // 100 is the stress rescale factor used by AmIterator
+         error = (temp1 > (100*temp2)) ? temp1 : (100*temp2);
+      }
+      systemPtr_->log() << "Error       = " << Dbl(error) << std::endl;
+
+      if (isFlexible_) {
+         for (int m = 0; m < nParameter; ++m) {
+            systemPtr_->log() << "Parameter " << m << " = "
+                              << Dbl(system().unitCell().parameters()[m])
+                              << "\n";
+         }
+      }
+
+      return (error < epsilon_);
+   }
+
+   /*
+   * Determine the Anderson mixing coefficients.
+   */
+   template <int D>
+   void AmIteratorGrid<D>::minimizeCoeff(int itr)
+   {
+      // Reallocate arrays only when the number of histories changes
+      int capacity = coeffs_.isAllocated() ? coeffs_.capacity() : 0;
+      if (capacity != nHist_) {
+         if (coeffs_.isAllocated()) {
+            invertMatrix_.deallocate();
+            coeffs_.deallocate();
+            vM_.deallocate();
+         }
+         if (nHist_ > 0) {
+            invertMatrix_.allocate(nHist_, nHist_);
+            coeffs_.allocate(nHist_);
+            vM_.allocate(nHist_);
+         }
+      }
+
+      if (itr == 1) {
+         histMat_.reset();
+      }
+      if (nHist_ == 0) {
+         return;
+      }
+
+      // Add inner products of the newest difference g(0) to the cache
+      histMat_.advance();
+      UTIL_CHECK(histMat_.size() == nHist_);
+      for (int i = 0; i < nHist_; ++i) {
+         histMat_.setDot(i, dotDiff(0, i));
+      }
+      histMat_.makeU(invertMatrix_);
+
+      // V(i) = (d(0) - d(i+1)).d(0) = sum_{k <= i} g(k).d(0)
+      double sum = 0.0;
+      for (int i = 0; i < nHist_; ++i) {
+         sum += dotDiffDev(i, 0);
+         vM_[i] = sum;
+      }
+
+      if (nHist_ == 1) {
+         coeffs_[0] = vM_[0] / invertMatrix_(0,0);
+      } else {
+         LuSolver solver;
+         solver.allocate(nHist_);
+         solver.computeLU(invertMatrix_);
+         solver.solve(vM_, coeffs_);
+      }
+   }
+
+   /*
+   * Inner product (d(i) - d(i+1)).(d(j) - d(j+1)) of differences.
+   *
+   * The field contribution is a spatial average over grid points.
+   */
+   template <int D>
+   double AmIteratorGrid<D>::dotDiff(int i, int j)
+   {
+      int nMonomer = system().mixture().nMonomer();
+      int meshSize = system().mesh().size();
+      double dot = 0.0;
+      for (int k = 0; k < nMonomer; ++k) {
+         RField<D> const & di = devHists_[i][k];
+         RField<D> const & di1 = devHists_[i+1][k];
+         RField<D> const & dj = devHists_[j][k];
+         RField<D> const & dj1 = devHists_[j+1][k];
+         for (int l = 0; l < meshSize; ++l) {
+            dot += (di[l] - di1[l])*(dj[l] - dj1[l]);
+         }
+      }
+      dot /= double(meshSize);
+      if (isFlexible_) {
+         int nParameter = system().unitCell().nParameter();
+         for (int m = 0; m < nParameter ; ++m) {
+            dot += (devCpHists_[i][m] - devCpHists_[i+1][m])
+                  *(devCpHists_[j][m] - devCpHists_[j+1][m]);
+         }
+      }
+      return dot;
+   }
+
+   /*
+   * Inner product (d(i) - d(i+1)).d(j) of a difference and a residual.
+   */
+   template <int D>
+   double AmIteratorGrid<D>::dotDiffDev(int i, int j)
+   {
+      int nMonomer = system().mixture().nMonomer();
+      int meshSize = system().mesh().size();
+      double dot = 0.0;
+      for (int k = 0; k < nMonomer; ++k) {
+         RField<D> const & di = devHists_[i][k];
+         RField<D> const & di1 = devHists_[i+1][k];
+         RField<D> const & dj = devHists_[j][k];
+         for (int l = 0; l < meshSize; ++l) {
+            dot += (di[l] - di1[l])*dj[l];
+         }
+      }
+      dot /= double(meshSize);
+      if (isFlexible_) {
+         int nParameter = system().unitCell().nParameter();
+         for (int m = 0; m < nParameter ; ++m) {
+            dot += (devCpHists_[i][m] - devCpHists_[i+1][m])
+                  *devCpHists_[j][m];
+         }
+      }
+      return dot;
+   }
+
+   /*
+   * Rebuild w fields for the next iteration from the coefficients.
+   */
+   template <int D>
+   void AmIteratorGrid<D>::buildOmega(int itr)
+   {
+      UnitCell<D>& unitCell = system().unitCell();
+      Mixture<D>&  mixture = system().mixture();
+      int nMonomer = mixture.nMonomer();
+      int meshSize = system().mesh().size();
+      int nParameter = unitCell.nParameter();
+      int i, j, k, m;
+
+      for (j = 0; j < nMonomer; ++j) {
+         RField<D>& wArray = wArrays_[j];
+         RField<D>& dArray = dArrays_[j];
+         RField<D> const & om0 = omHists_[0][j];
+         RField<D> const & dev0 = devHists_[0][j];
+         for (k = 0; k < meshSize; ++k) {
+            wArray[k] = om0[k];
+            dArray[k] = dev0[k];
+         }
+         for (i = 0; i < nHist_; ++i) {
+            RField<D> const & om = omHists_[i+1][j];
+            RField<D> const & dev = devHists_[i+1][j];
+            for (k = 0; k < meshSize; ++k) {
+               wArray[k] += coeffs_[i]*(om[k] - om0[k]);
+               dArray[k] += coeffs_[i]*(dev[k] - dev0[k]);
+            }
+         }
+         RField<D>& w = system().wFieldRGrid(j);
+         for (k = 0; k < meshSize; ++k) {
+            w[k] = wArray[k] + lambda_*dArray[k];
+         }
+      }
+
+      if (isFlexible_) {
+         for (m = 0; m < nParameter; ++m) {
+            wCpArrays_[m] = CpHists_[0][m];
+            dCpArrays_[m] = devCpHists_[0][m];
+         }
+         for (i = 0; i < nHist_; ++i) {
+            for (m = 0; m < nParameter; ++m) {
+               wCpArrays_[m] += coeffs_[i]*(CpHists_[i+1][m] -
+                                            CpHists_[0][m]);
+               dCpArrays_[m] += coeffs_[i]*(devCpHists_[i+1][m] -
+                                            devCpHists_[0][m]);
+            }
+         }
+         parameters_.clear();
+         for (m = 0; m < nParameter; ++m) {
+            parameters_.append(wCpArrays_[m] + lambda_*dCpArrays_[m]);
+         }
+         unitCell.setParameters(parameters_);
+         unitCell.setLattice();
+         mixture.setupUnitCell(unitCell);
+         if (system().hasBasis()) {
+            system().basis().update();
+         }
+      }
+
+      if (isSymmetric_) {
+         symmetrize();
+      }
+   }
+
+}
+}
+#endif
@@ -0,0 +1,95 @@
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "HistMat.h"
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /*
+   * Constructor.
+   */
+   HistMat::HistMat()
+    : dots_(),
+      size_(0),
+      capacity_(0)
+   {}
+
+   /*
+   * Destructor.
+   */
+   HistMat::~HistMat()
+   {}
+
+   /*
+   * Allocate memory.
+   */
+   void HistMat::allocate(int capacity)
+   {
+      UTIL_CHECK(capacity > 0);
+      dots_.allocate(capacity, capacity);
+      capacity_ = capacity;
+      reset();
+   }
+
+   /*
+   * Clear all values.
+   */
+   void HistMat::reset()
+   {
+      for (int i = 0; i < capacity_; ++i) {
+         for (int j = 0; j < capacity_; ++j) {
+            dots_(i, j) = 0.0;
+         }
+      }
+      size_ = 0;
+   }
+
+   /*
+   * Shift all values by one in age, discarding the oldest if full.
+   */
+   void HistMat::advance()
+   {
+      UTIL_CHECK(capacity_ > 0);
+      int i, j;
+      for (i = capacity_ - 1; i > 0; --i) {
+         for (j = capacity_ - 1; j > 0; --j) {
+            dots_(i, j) = dots_(i - 1, j - 1);
+         }
+      }
+      for (i = 0; i < capacity_; ++i) {
+         dots_(0, i) = 0.0;
+         dots_(i, 0) = 0.0;
+      }
+      if (size_ < capacity_) {
+         ++size_;
+      }
+   }
+
+   /*
+   * Compute U(i,j) = sum_{k <= i, l <= j} g(k).g(l).
+   *
+   * Each row is obtained from the previous row by adding partial sums 
+   * of one row of cached values, so that no differences are taken.
+   */
+   void HistMat::makeU(DMatrix<double>& U) const
+   {
+      double rowSum;
+      for (int i = 0; i < size_; ++i) {
+         rowSum = 0.0;
+         for (int j = 0; j < size_; ++j) {
+            rowSum += dots_(i, j);
+            U(i, j) = (i > 0) ? U(i - 1, j) + rowSum : rowSum;
+         }
+      }
+   }
+
+}
+}
@@ -0,0 +1,139 @@
+#ifndef PSPC_HIST_MAT_H
+#define PSPC_HIST_MAT_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <util/containers/DMatrix.h>   // member
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /**
+   * Cache of inner products of residual differences for Anderson mixing.
+   *
+   * A HistMat stores the inner products g(k).g(l) of the differences
+   * g(k) = d(k) - d(k+1) of successive residual vectors d(k), for the
+   * most recent capacity() differences, indexed by age, such that g(0) 
+   * is the most recent difference. When a new residual is appended to
+   * the history, advance() shifts all stored values by one in age, 
+   * after which only the new row g(0).g(l) must be computed and set by
+   * setDot. This is similar to the Pspg::HistMat class used by the GPU 
+   * iterator, but caches inner products of differences rather than of
+   * residuals, to avoid cancellation near convergence.
+   *
+   * The Anderson mixing matrix U(i,j) = (d(0) - d(i+1)).(d(0) - d(j+1))
+   * is then obtained by makeU, using d(0) - d(i+1) = g(0) + ... + g(i).
+   *
+   * \ingroup Pspc_Iterator_Module
+   */
+   class HistMat
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      */
+      HistMat();
+
+      /**
+      * Destructor.
+      */
+      ~HistMat();
+
+      /**
+      * Allocate memory.
+      *
+      * \param capacity  maximum number of differences (maxHist)
+      */
+      void allocate(int capacity);
+
+      /**
+      * Clear all values (e.g., at the beginning of a solve).
+      */
+      void reset();
+
+      /**
+      * Shift all values by one in age, for a new difference g(0).
+      */
+      void advance();
+
+      /**
+      * Set the inner product g(0).g(i) of the newest difference.
+      *
+      * \param i  age of the other difference, 0 <= i < size()
+      * \param value  inner product g(0).g(i)
+      */
+      void setDot(int i, double value);
+
+      /**
+      * Get a cached inner product g(i).g(j).
+      *
+      * \param i  age of the first difference
+      * \param j  age of the second difference
+      */
+      double dot(int i, int j) const;
+
+      /**
+      * Compute the Anderson mixing matrix U from cached values.
+      *
+      * \param U  matrix with at least size() rows and columns (output)
+      */
+      void makeU(DMatrix<double>& U) const;
+
+      /**
+      * Number of differences in the history (at most capacity).
+      */
+      int size() const;
+
+      /**
+      * Maximum number of differences.
+      */
+      int capacity() const;
+
+   private:
+
+      /// Inner products g(i).g(j), indexed by age.
+      DMatrix<double> dots_;
+
+      /// Number of differences in the history.
+      int size_;
+
+      /// Maximum number of differences.
+      int capacity_;
+
+   };
+
+   // Inline member functions
+
+   inline
+   void HistMat::setDot(int i, double value)
+   {
+      UTIL_ASSERT(i >= 0 && i < size_);
+      dots_(0, i) = value;
+      dots_(i, 0) = value;
+   }
+
+   inline
+   double HistMat::dot(int i, int j) const
+   {  return dots_(i, j); }
+
+   inline
+   int HistMat::size() const
+   {  return size_; }
+
+   inline
+   int HistMat::capacity() const
+   {  return capacity_; }
+
+}
+}
+#endif
@@ -43,6 +43,11 @@ namespace Pspc
       */
       ~Iterator();
 
+      /**
+      * Allocate memory, after parameters and the mesh are known.
+      */
+      virtual void allocate() = 0;
+
       /**
       * Iterate to solution.
       *
@@ -50,11 +55,31 @@ namespace Pspc
       */
       virtual int solve() = 0;
 
+      /**
+      * Does this iterator preserve space group symmetry?
+      *
+      * If true, w and c fields remain invariant under the space group,
+      * and the fields expanded in the symmetry-adapted basis are updated 
+      * by solve() along with the fields on a grid. The default 
+      * implementation returns true.
+      */
+      virtual bool isSymmetric() const
+      {  return true; }
+
+      /**
+      * Get the number of iterations used by the most recent solve().
+      */
+      int nIteration() const
+      {  return nIteration_; }
+
    protected:
 
       /// Pointer to parent System object
       System<D>* systemPtr_;
 
+      /// Number of iterations in the most recent solve (set by solve).
+      int nIteration_;
+
       System<D>& system() 
       {  return *systemPtr_; }
 
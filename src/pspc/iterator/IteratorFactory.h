@@ -0,0 +1,66 @@
+#ifndef PSPC_ITERATOR_FACTORY_H
+#define PSPC_ITERATOR_FACTORY_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <util/param/Factory.h>  
+#include "Iterator.h"
+
+#include <string>
+
+namespace Pscf {
+namespace Pspc {
+
+   template <int D> class System;
+
+   using namespace Util;
+
+   /**
+   * Default Factory for subclasses of Iterator.
+   *
+   * \ingroup Pspc_Iterator_Module
+   */
+   template <int D>
+   class IteratorFactory : public Factory< Iterator<D> > 
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      *
+      * \param system parent System object
+      */
+      IteratorFactory(System<D>& system);
+
+      /**
+      * Method to create any Iterator subclass.
+      *
+      * \param className name of the Iterator subclass
+      * \return Iterator<D>* pointer to new instance of className
+      */
+      Iterator<D>* factory(std::string const & className) const;
+
+   private:
+
+      System<D>* systemPtr_;
+
+      using Factory< Iterator<D> >::trySubfactories;
+
+   };
+
+   #ifndef PSPC_ITERATOR_FACTORY_TPP
+   // Suppress implicit instantiation
+   extern template class IteratorFactory<1>;
+   extern template class IteratorFactory<2>;
+   extern template class IteratorFactory<3>;
+   #endif
+
+}
+}
+#endif
@@ -0,0 +1,57 @@
+#ifndef PSPC_ITERATOR_FACTORY_TPP
+#define PSPC_ITERATOR_FACTORY_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "IteratorFactory.h"  
+
+// Subclasses of Iterator 
+#include "AmIterator.h"
+#include "AmIteratorGrid.h"
+#include "NkIterator.h"
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+
+   template <int D>
+   IteratorFactory<D>::IteratorFactory(System<D>& system)
+    : systemPtr_(&system)
+   {}
+
+   /* 
+   * Return a pointer to a instance of Iterator subclass className.
+   */
+   template <int D>
+   Iterator<D>* IteratorFactory<D>::factory(const std::string &className) 
+   const
+   {
+      Iterator<D>* ptr = 0;
+
+      // First if name is known by any subfactories
+      ptr = trySubfactories(className);
+      if (ptr) return ptr;     
+
+      // Explicit class names
+      if (className == "AmIterator") {
+         ptr = new AmIterator<D>(systemPtr_);
+      } else
+      if (className == "AmIteratorGrid") {
+         ptr = new AmIteratorGrid<D>(systemPtr_);
+      } else
+      if (className == "NkIterator") {
+         ptr = new NkIterator<D>(systemPtr_);
+      }
+
+      return ptr;
+   }
+
+}
+}
+#endif
@@ -0,0 +1,16 @@
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "NkIterator.tpp"
+
+namespace Pscf {
+namespace Pspc {
+   template class NkIterator<1>;
+   template class NkIterator<2>;
+   template class NkIterator<3>;
+}
+}
@@ -0,0 +1,214 @@
+#ifndef PSPC_NK_ITERATOR_H
+#define PSPC_NK_ITERATOR_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <pspc/iterator/Iterator.h> // base class
+#include <util/containers/DArray.h>
+#include <util/containers/DMatrix.h>
+#include <util/containers/FSArray.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /**
+   * Jacobian-free Newton-Krylov iterator for the pseudo spectral method.
+   *
+   * The unknowns are the components of the w fields in the symmetry
+   * adapted basis, excluding the first (homogeneous) star, and, if
+   * isFlexible is true, the unit cell parameters. The residual vector
+   * is the same as that used by AmIterator, with the negative stress
+   * as the residual for each cell parameter.
+   *
+   * Each Newton step dx is obtained by solving J dx = -F approximately
+   * with GMRES, in which each product of the Jacobian J with a vector v
+   * is approximated by the finite difference (F(x + h v) - F(x))/h,
+   * which requires one extra solution of the modified diffusion
+   * equation (and one stress calculation, if isFlexible). The linear
+   * solve is stopped when the GMRES residual is less than eta |F|,
+   * with a forcing term eta = min(etaMax, |F|), which yields quadratic
+   * convergence near the solution. A backtracking line search on |F|
+   * is used to globalize each step.
+   *
+   * \ingroup Pspc_Iterator_Module
+   */
+   template <int D>
+   class NkIterator : public Iterator<D>
+   {
+   public:
+
+      /**
+      * Constructor
+      *
+      * \param system pointer to a parent System object
+      */
+      NkIterator(System<D>* system);
+
+      /**
+      * Destructor
+      */
+      ~NkIterator();
+
+      /**
+      * Read all parameters and initialize.
+      *
+      * \param in input filestream
+      */
+      void readParameters(std::istream& in);
+
+      /**
+      * Allocate all arrays
+      */
+      void allocate();
+
+      /**
+      * Iterate to a solution
+      *
+      * \return error code: 0 for success, 1 for failure.
+      */
+      int solve();
+
+      /**
+      * Get epsilon (error threshhold).
+      */
+      double epsilon();
+
+      /**
+      * Get the maximum number of Newton iterations.
+      */
+      int maxItr();
+
+      /**
+      * Get the maximum number of GMRES iterations per Newton step.
+      */
+      int maxKrylov();
+
+   private:
+
+      /// Error tolerance
+      double epsilon_;
+
+      /// Maximum forcing term for the inexact Newton step.
+      double etaMax_;
+
+      /// Relative step size for finite difference derivatives.
+      double fdStep_;
+
+      /// Maximum number of Newton iterations.
+      int maxItr_;
+
+      /// Maximum number of GMRES iterations (Krylov dimension).
+      int maxKrylov_;
+
+      /// Number of unknowns.
+      int nVector_;
+
+      /// Number of solutions of the MDE in the current solve.
+      int nCompute_;
+
+      /// Flexible cell computation (true) or rigid (false).
+      bool isFlexible_;
+
+      /// Current state and residual.
+      DArray<double> x_;
+      DArray<double> f_;
+
+      /// Newton step.
+      DArray<double> dx_;
+
+      /// Trial or perturbed state and residual.
+      DArray<double> xNew_;
+      DArray<double> fNew_;
+
+      /// Orthonormal Krylov basis vectors.
+      DArray< DArray<double> > krylov_;
+
+      /// Hessenberg matrix of the Arnoldi process (after rotations).
+      DMatrix<double> hessenberg_;
+
+      /// Givens rotation cosines and sines, and rotated rhs vector.
+      DArray<double> cs_;
+      DArray<double> sn_;
+      DArray<double> g_;
+
+      /// Work array for unit cell parameters.
+      FSArray<double, 6> parameters_;
+
+      /**
+      * Copy the current w fields and cell parameters to a vector.
+      */
+      void getState(DArray<double>& x);
+
+      /**
+      * Set the state, solve the MDE and compute the residual.
+      *
+      * \param x  state vector (input)
+      * \param f  residual vector (output)
+      */
+      void evaluate(DArray<double> const & x, DArray<double>& f);
+
+      /**
+      * Approximate the product of the Jacobian at x_ with a vector.
+      *
+      * \param v  vector (input)
+      * \param jv  product J v (output)
+      */
+      void multiplyJacobian(DArray<double> const & v, DArray<double>& jv);
+
+      /**
+      * Solve J dx = -f_ approximately by GMRES.
+      *
+      * \param eta  relative tolerance for the linear residual
+      * \return number of GMRES iterations
+      */
+      int solveLinear(double eta);
+
+      /**
+      * Compute the error used to test convergence, and log it.
+      */
+      double computeError(DArray<double> const & f);
+
+      /**
+      * Euclidean norm of a vector.
+      */
+      double norm(DArray<double> const & v) const;
+
+      using Iterator<D>::setClassName;
+      using Iterator<D>::systemPtr_;
+      using Iterator<D>::nIteration_;
+      using Iterator<D>::system;
+      using ParamComposite::read;
+      using ParamComposite::readOptional;
+
+   };
+
+   template<int D>
+   inline double NkIterator<D>::epsilon()
+   { return epsilon_; }
+
+   template<int D>
+   inline int NkIterator<D>::maxItr()
+   { return maxItr_; }
+
+   template<int D>
+   inline int NkIterator<D>::maxKrylov()
+   { return maxKrylov_; }
+
+   #ifndef PSPC_NK_ITERATOR_TPP
+   // Suppress implicit instantiation
+   extern template class NkIterator<1>;
+   extern template class NkIterator<2>;
+   extern template class NkIterator<3>;
+   #endif
+
+}
+}
+#endif
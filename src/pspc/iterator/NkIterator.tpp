@@ -0,0 +1,481 @@
+#ifndef PSPC_NK_ITERATOR_TPP
+#define PSPC_NK_ITERATOR_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "NkIterator.h"
+#include <pspc/System.h>
+#include <pscf/inter/ChiInteraction.h>
+#include <util/format/Dbl.h>
+#include <util/misc/Timer.h>
+#include <cmath>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /*
+   * Constructor
+   */
+   template <int D>
+   NkIterator<D>::NkIterator(System<D>* system)
+    : Iterator<D>(system),
+      epsilon_(0.0),
+      etaMax_(0.1),
+      fdStep_(1.0E-7),
+      maxItr_(0),
+      maxKrylov_(0),
+      nVector_(0),
+      nCompute_(0),
+      isFlexible_(false)
+   {  setClassName("NkIterator"); }
+
+   /*
+   * Destructor
+   */
+   template <int D>
+   NkIterator<D>::~NkIterator()
+   {}
+
+   /*
+   * Read parameter file block.
+   */
+   template <int D>
+   void NkIterator<D>::readParameters(std::istream& in)
+   {
+      read(in, "maxItr", maxItr_);
+      read(in, "epsilon", epsilon_);
+      read(in, "maxKrylov", maxKrylov_);
+      UTIL_CHECK(maxKrylov_ > 0);
+      isFlexible_ = false; // default value (fixed cell)
+      readOptional(in, "isFlexible", isFlexible_);
+      etaMax_ = 0.1;       // default maximum forcing term
+      readOptional(in, "etaMax", etaMax_);
+      fdStep_ = 1.0E-7;    // default finite difference step
+      readOptional(in, "fdStep", fdStep_);
+      UTIL_CHECK(fdStep_ > 0.0);
+   }
+
+   /*
+   * Allocate memory required by iterator.
+   */
+   template <int D>
+   void NkIterator<D>::allocate()
+   {
+      // This iterator acts on fields in a symmetry-adapted basis
+      UTIL_CHECK(system().hasBasis());
+
+      int nMonomer = system().mixture().nMonomer();
+      int nStar = system().basis().nStar();
+      nVector_ = nMonomer*(nStar - 1);
+      if (isFlexible_) {
+         nVector_ += system().unitCell().nParameter();
+      }
+
+      x_.allocate(nVector_);
+      f_.allocate(nVector_);
+      dx_.allocate(nVector_);
+      xNew_.allocate(nVector_);
+      fNew_.allocate(nVector_);
+
+      krylov_.allocate(maxKrylov_ + 1);
+      for (int i = 0; i <= maxKrylov_; ++i) {
+         krylov_[i].allocate(nVector_);
+      }
+      hessenberg_.allocate(maxKrylov_ + 1, maxKrylov_);
+      cs_.allocate(maxKrylov_);
+      sn_.allocate(maxKrylov_);
+      g_.allocate(maxKrylov_ + 1);
+   }
+
+   /*
+   * Solve by inexact Newton iteration.
+   */
+   template <int D>
+   int NkIterator<D>::solve()
+   {
+      // Preconditions
+      UTIL_CHECK(system().hasWFields());
+      UTIL_CHECK(nVector_ > 0);
+
+      Timer timer;
+      timer.start();
+      nCompute_ = 0;
+
+      // Evaluate residual of initial state
+      getState(x_);
+      evaluate(x_, f_);
+      double fNorm = norm(f_);
+
+      int nKrylov, i, k;
+      double error, eta, lambda, fNewNorm;
+      bool accept;
+      nIteration_ = 0;
+      for (int itr = 1; itr <= maxItr_; ++itr) {
+         nIteration_ = itr;
+
+         systemPtr_->log()<<"---------------------"<<std::endl;
+         systemPtr_->log()<<" Iteration  "<<itr<<std::endl;
+
+         error = computeError(f_);
+         if (error < epsilon_) {
+            timer.stop();
+            systemPtr_->log() << "----------CONVERGED----------"<< std::endl;
+            systemPtr_->log() << "\n";
+            systemPtr_->log() << "MDE solutions = " << nCompute_ << "\n";
+            systemPtr_->log() << "total time    = " << timer.time() << " s  ";
+            systemPtr_->log() << "\n\n";
+
+            // If the unit cell is rigid, compute and output final stress
+            if (!isFlexible_) {
+               system().mixture().computeStress();
+               systemPtr_->log() << "Final stress:" << "\n";
+               for (int m=0; m<system().unitCell().nParameter(); ++m) {
+                  systemPtr_->log() << "Stress  "<< m << "   = "
+                                    << Dbl(system().mixture().stress(m))
+                                    << "\n";
+               }
+               systemPtr_->log() << "\n";
+            }
+            return 0;
+         }
+
+         // Inexact Newton step, with forcing term eta
+         eta = (fNorm < etaMax_) ? fNorm : etaMax_;
+         nKrylov = solveLinear(eta);
+         systemPtr_->log() << "GMRES iterations = " << nKrylov << std::endl;
+
+         // Backtracking line search on the residual norm
+         lambda = 1.0;
+         accept = false;
+         for (k = 0; k < 10; ++k) {
+            for (i = 0; i < nVector_; ++i) {
+               xNew_[i] = x_[i] + lambda*dx_[i];
+            }
+            evaluate(xNew_, fNew_);
+            fNewNorm = norm(fNew_);
+            if (fNewNorm <= (1.0 - 1.0E-4*lambda)*fNorm) {
+               accept = true;
+               break;
+            }
+            lambda *= 0.5;
+         }
+         if (!accept) {
+            systemPtr_->log() << "Line search failed" << std::endl;
+            // Restore the system state of the last accepted point
+            evaluate(x_, f_);
+            return 1;
+         }
+         if (lambda < 1.0) {
+            systemPtr_->log() << "Step length = " << Dbl(lambda) << std::endl;
+         }
+
+         // The system state is that of the accepted point
+         for (i = 0; i < nVector_; ++i) {
+            x_[i] = xNew_[i];
+            f_[i] = fNew_[i];
+         }
+         fNorm = fNewNorm;
+      }
+
+      // Failure: iteration counter itr reached maxItr without converging
+      return 1;
+   }
+
+   /*
+   * Copy the current w fields and unit cell parameters to vector x.
+   */
+   template <int D>
+   void NkIterator<D>::getState(DArray<double>& x)
+   {
+      int nMonomer = system().mixture().nMonomer();
+      int nStar = system().basis().nStar();
+      int i, j;
+      int k = 0;
+      for (i = 0; i < nMonomer; ++i) {
+         DArray<double> const & w = system().wField(i);
+         for (j = 1; j < nStar; ++j) {
+            x[k] = w[j];
+            ++k;
+         }
+      }
+      if (isFlexible_) {
+         UnitCell<D> const & unitCell = system().unitCell();
+         for (i = 0; i < unitCell.nParameter(); ++i) {
+            x[k] = unitCell.parameters()[i];
+            ++k;
+         }
+      }
+   }
+
+   /*
+   * Set the system state, solve the MDE and compute the residual.
+   */
+   template <int D>
+   void NkIterator<D>::evaluate(DArray<double> const & x,
+                                DArray<double>& f)
+   {
+      Mixture<D>& mixture = system().mixture();
+      int nMonomer = mixture.nMonomer();
+      int nStar = system().basis().nStar();
+      int i, j, l;
+      int k = 0;
+
+      // Set w fields (the homogeneous component is not modified)
+      for (i = 0; i < nMonomer; ++i) {
+         DArray<double>& w = system().wField(i);
+         for (j = 1; j < nStar; ++j) {
+            w[j] = x[k];
+            ++k;
+         }
+      }
+
+      // Set unit cell parameters
+      if (isFlexible_) {
+         UnitCell<D>& unitCell = system().unitCell();
+         parameters_.clear();
+         for (i = 0; i < unitCell.nParameter(); ++i) {
+            parameters_.append(x[k + i]);
+         }
+         unitCell.setParameters(parameters_);
+         unitCell.setLattice();
+         mixture.setupUnitCell(unitCell);
+         system().basis().update();
+      }
+
+      // Solve the modified diffusion equation
+      FieldIo<D>& fieldIo = system().fieldIo();
+      fieldIo.convertBasisToRGrid(system().wFields(),
+                                  system().wFieldsRGrid());
+      mixture.compute(system().wFieldsRGrid(), system().cFieldsRGrid());
+      fieldIo.convertRGridToBasis(system().cFieldsRGrid(),
+                                  system().cFields());
+      if (isFlexible_) {
+         mixture.computeStress();
+      }
+      ++nCompute_;
+
+      // Residuals of the self-consistent field equations
+      ChiInteraction& interaction = system().interaction();
+      double sum;
+      k = 0;
+      for (i = 0; i < nMonomer; ++i) {
+         for (j = 1; j < nStar; ++j) {
+            sum = 0.0;
+            for (l = 0; l < nMonomer; ++l) {
+               sum += interaction.chi(i, l)*system().cField(l)[j]
+                    - interaction.idemp(i, l)*system().wField(l)[j];
+            }
+            f[k] = sum;
+            ++k;
+         }
+      }
+
+      // Residuals for unit cell parameters (negative stress)
+      if (isFlexible_) {
+         for (i = 0; i < system().unitCell().nParameter(); ++i) {
+            f[k] = -mixture.stress(i);
+            ++k;
+         }
+      }
+   }
+
+   /*
+   * Forward difference approximation of J v, with J evaluated at x_.
+   */
+   template <int D>
+   void NkIterator<D>::multiplyJacobian(DArray<double> const & v,
+                                        DArray<double>& jv)
+   {
+      int i;
+      double vNorm = norm(v);
+      if (vNorm == 0.0) {
+         for (i = 0; i < nVector_; ++i) {
+            jv[i] = 0.0;
+         }
+         return;
+      }
+      double h = fdStep_*(1.0 + norm(x_))/vNorm;
+      for (i = 0; i < nVector_; ++i) {
+         xNew_[i] = x_[i] + h*v[i];
+      }
+      evaluate(xNew_, jv);
+      for (i = 0; i < nVector_; ++i) {
+         jv[i] = (jv[i] - f_[i])/h;
+      }
+   }
+
+   /*
+   * Solve J dx_ = -f_ by GMRES, starting from dx_ = 0.
+   *
+   * The Arnoldi process uses modified Gram-Schmidt orthogonalization,
+   * and the Hessenberg least squares problem is updated by Givens
+   * rotations, so the residual norm is known at each iteration.
+   */
+   template <int D>
+   int NkIterator<D>::solveLinear(double eta)
+   {
+      int i, j, k;
+      double beta = norm(f_);
+
+      for (i = 0; i < nVector_; ++i) {
+         dx_[i] = 0.0;
+      }
+      if (beta == 0.0) {
+         return 0;
+      }
+
+      // Initial Krylov vector r0/|r0|, with r0 = -f_
+      for (i = 0; i < nVector_; ++i) {
+         krylov_[0][i] = -f_[i]/beta;
+      }
+      g_[0] = beta;
+      for (i = 1; i <= maxKrylov_; ++i) {
+         g_[i] = 0.0;
+      }
+
+      double h, t, r;
+      int m = 0;
+      for (j = 0; j < maxKrylov_; ++j) {
+
+         // Arnoldi step
+         DArray<double>& w = krylov_[j+1];
+         multiplyJacobian(krylov_[j], w);
+         for (k = 0; k <= j; ++k) {
+            DArray<double> const & q = krylov_[k];
+            h = 0.0;
+            for (i = 0; i < nVector_; ++i) {
+               h += q[i]*w[i];
+            }
+            hessenberg_(k, j) = h;
+            for (i = 0; i < nVector_; ++i) {
+               w[i] -= h*q[i];
+            }
+         }
+         h = norm(w);
+         hessenberg_(j+1, j) = h;
+         if (h > 0.0) {
+            for (i = 0; i < nVector_; ++i) {
+               w[i] /= h;
+            }
+         }
+
+         // Apply previous rotations to the new column
+         for (k = 0; k < j; ++k) {
+            t = cs_[k]*hessenberg_(k, j) + sn_[k]*hessenberg_(k+1, j);
+            hessenberg_(k+1, j) = -sn_[k]*hessenberg_(k, j)
+                                + cs_[k]*hessenberg_(k+1, j);
+            hessenberg_(k, j) = t;
+         }
+
+         // Compute and apply a new rotation to zero H(j+1, j)
+         r = sqrt(hessenberg_(j, j)*hessenberg_(j, j) + h*h);
+         UTIL_CHECK(r > 0.0);
+         cs_[j] = hessenberg_(j, j)/r;
+         sn_[j] = h/r;
+         hessenberg_(j, j) = r;
+         hessenberg_(j+1, j) = 0.0;
+         g_[j+1] = -sn_[j]*g_[j];
+         g_[j] = cs_[j]*g_[j];
+
+         m = j + 1;
+         if (fabs(g_[j+1]) <= eta*beta || h == 0.0) {
+            break;
+         }
+      }
+
+      // Back substitution for the coefficients y (stored in g_)
+      for (k = m - 1; k >= 0; --k) {
+         t = g_[k];
+         for (j = k + 1; j < m; ++j) {
+            t -= hessenberg_(k, j)*g_[j];
+         }
+         g_[k] = t/hessenberg_(k, k);
+      }
+
+      // dx_ = sum of y_k times Krylov vector k
+      for (k = 0; k < m; ++k) {
+         DArray<double> const & q = krylov_[k];
+         t = g_[k];
+         for (i = 0; i < nVector_; ++i) {
+            dx_[i] += t*q[i];
+         }
+      }
+      return m;
+   }
+
+   /*
+   * Compute and log the convergence error, defined as in AmIterator.
+   */
+   template <int D>
+   double NkIterator<D>::computeError(DArray<double> const & f)
+   {
+      int nField = nVector_;
+      int nParameter = 0;
+      if (isFlexible_) {
+         nParameter = system().unitCell().nParameter();
+         nField -= nParameter;
+      }
+
+      double scfError = 0.0;
+      int i;
+      for (i = 0; i < nField; ++i) {
+         if (scfError < fabs(f[i])) {
+            scfError = fabs(f[i]);
+         }
+      }
+      systemPtr_->log() << "SCF Error   = " << Dbl(scfError) << std::endl;
+      double error = scfError;
+
+      if (isFlexible_) {
+         double stressError = 0.0;
+         for (i = 0; i < nParameter; ++i) {
+            if (stressError < fabs(f[nField + i])) {
+               stressError = fabs(f[nField + i]);
+            }
+         }
+         for (int m = 0; m < nParameter; ++m) {
+            systemPtr_->log() << "Stress  "<< m << "   = "
+                              << Dbl(system().mixture().stress(m)) <<"\n";
+         }
+         // 100 is the stress rescale factor used by AmIterator
+         if (error < 100.0*stressError) {
+            error = 100.0*stressError;
+         }
+      }
+      systemPtr_->log() << "Error       = " << Dbl(error) << std::endl;
+
+      if (isFlexible_) {
+         for (int m = 0; m < nParameter; ++m) {
+            systemPtr_->log() << "Parameter " << m << " = "
+                              << Dbl(system().unitCell().parameters()[m])
+                              << "\n";
+         }
+      }
+
+      return error;
+   }
+
+   /*
+   * Euclidean norm of a vector.
+   */
+   template <int D>
+   double NkIterator<D>::norm(DArray<double> const & v) const
+   {
+      double sum = 0.0;
+      for (int i = 0; i < nVector_; ++i) {
+         sum += v[i]*v[i];
+      }
+      return sqrt(sum);
+   }
+
+}
+}
+#endif
@@ -0,0 +1,133 @@
+#ifndef PSPC_RPA_PRECONDITIONER_H
+#define PSPC_RPA_PRECONDITIONER_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <util/containers/DArray.h>
+#include <util/containers/DMatrix.h>
+
+namespace Pscf {
+
+   class ChiInteraction;
+   template <int D> class Basis;
+
+namespace Pspc
+{
+
+   template <int D> class Mixture;
+
+   using namespace Util;
+
+   /**
+   * Preconditioner for SCFT residuals based on the RPA response.
+   *
+   * For each star of a symmetry-adapted basis, this class computes the
+   * inverse of the linear response of the AmIterator residual
+   * r = chi c - idemp w to a perturbation of the w fields about the
+   * homogeneous state, in which c = - S w, where S(q) is the matrix of
+   * ideal single-chain correlation functions. Each element of S is a
+   * sum of Debye functions for pairs of blocks, evaluated with the
+   * eigenvalue |G|^2 of the star.
+   *
+   * The response matrix is chi (S + K), where K = chiInverse - a a^T
+   * / (a.e), with a_j = sum_i chiInverse(i,j), is symmetric. The
+   * symmetric matrix S + K is inverted by diagonalization, after
+   * eigenvalues of magnitude less than 0.03 times the largest
+   * eigenvalue magnitude of K are replaced by this bound, with the
+   * same sign. This avoids the divergence of the inverse at the RPA
+   * spinodal, which is crossed for ordered phases, and bounds the
+   * amplification of short-wavelength residuals. The preconditioned
+   * residual (S + K)^{-1} chiInverse r is thus the Newton step for the
+   * homogeneous state, in which the component of r that violates 
+   * incompressibility is divided by the total correlation function.
+   *
+   * \ingroup Pspc_Iterator_Module
+   */
+   template <int D>
+   class RpaPreconditioner
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      */
+      RpaPreconditioner();
+
+      /**
+      * Destructor.
+      */
+      ~RpaPreconditioner();
+
+      /**
+      * Allocate memory.
+      *
+      * \param nMonomer  number of monomer types
+      * \param nStar  number of stars in the basis
+      */
+      void allocate(int nMonomer, int nStar);
+
+      /**
+      * Compute the preconditioning matrix for every star.
+      *
+      * This must be called again if the unit cell changes.
+      *
+      * \param mixture  Mixture of polymer species
+      * \param interaction  excess free energy model
+      * \param basis  symmetry-adapted basis (eigen values of stars)
+      */
+      void setup(Mixture<D>& mixture, ChiInteraction& interaction,
+                 Basis<D> const & basis);
+
+      /**
+      * Apply the preconditioner to residuals in basis format.
+      *
+      * The residuals are indexed by monomer type and star, excluding
+      * the first (homogeneous) star, as in AmIterator.
+      *
+      * \param in  residual (input)
+      * \param out  preconditioned residual (output)
+      */
+      void apply(DArray< DArray<double> > const & in,
+                 DArray< DArray<double> >& out) const;
+
+   private:
+
+      /// Preconditioning matrices, indexed by star (excluding star 0).
+      DArray< DMatrix<double> > matrices_;
+
+      /// Work arrays for an nMonomer x nMonomer eigenvalue problem.
+      DMatrix<double> work_;
+      DMatrix<double> vectors_;
+
+      /// Number of monomer types.
+      int nMonomer_;
+
+      /// Number of stars.
+      int nStar_;
+
+      /**
+      * Diagonalize work_ in place, by the cyclic Jacobi method.
+      *
+      * On return the diagonal of work_ holds the eigenvalues, and
+      * the columns of vectors_ hold the eigenvectors.
+      */
+      void diagonalize();
+
+   };
+
+   #ifndef PSPC_RPA_PRECONDITIONER_TPP
+   // Suppress implicit instantiation
+   extern template class RpaPreconditioner<1>;
+   extern template class RpaPreconditioner<2>;
+   extern template class RpaPreconditioner<3>;
+   #endif
+
+}
+}
+#endif
@@ -0,0 +1,328 @@
+#ifndef PSPC_RPA_PRECONDITIONER_TPP
+#define PSPC_RPA_PRECONDITIONER_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "RpaPreconditioner.h"
+#include <pspc/solvers/Mixture.h>
+#include <pscf/inter/ChiInteraction.h>
+#include <pscf/crystal/Basis.h>
+#include <cmath>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   namespace {
+
+      /*
+      * Double integral of exp(-x|s-s'|) over one block of length L.
+      */
+      double debyeSelf(double x, double L)
+      {
+         double xL = x*L;
+         if (xL < 1.0E-5) {
+            return L*L*(1.0 - xL/3.0);
+         }
+         return 2.0*(xL - 1.0 + exp(-xL))/(x*x);
+      }
+
+      /*
+      * Integral of exp(-x s) over one block of length L.
+      */
+      double debyeEnd(double x, double L)
+      {
+         double xL = x*L;
+         if (xL < 1.0E-5) {
+            return L*(1.0 - 0.5*xL);
+         }
+         return (1.0 - exp(-xL))/x;
+      }
+
+   }
+
+   /*
+   * Constructor.
+   */
+   template <int D>
+   RpaPreconditioner<D>::RpaPreconditioner()
+    : nMonomer_(0),
+      nStar_(0)
+   {}
+
+   /*
+   * Destructor.
+   */
+   template <int D>
+   RpaPreconditioner<D>::~RpaPreconditioner()
+   {}
+
+   /*
+   * Allocate memory.
+   */
+   template <int D>
+   void RpaPreconditioner<D>::allocate(int nMonomer, int nStar)
+   {
+      UTIL_CHECK(nMonomer > 0);
+      UTIL_CHECK(nStar > 0);
+      nMonomer_ = nMonomer;
+      nStar_ = nStar;
+      matrices_.allocate(nStar);
+      for (int i = 1; i < nStar; ++i) {
+         matrices_[i].allocate(nMonomer, nMonomer);
+      }
+      work_.allocate(nMonomer, nMonomer);
+      vectors_.allocate(nMonomer, nMonomer);
+   }
+
+   /*
+   * Compute preconditioning matrices for all stars.
+   */
+   template <int D>
+   void RpaPreconditioner<D>::setup(Mixture<D>& mixture,
+                                    ChiInteraction& interaction,
+                                    Basis<D> const & basis)
+   {
+      UTIL_CHECK(nMonomer_ == mixture.nMonomer());
+      UTIL_CHECK(nStar_ == basis.nStar());
+      int nm = nMonomer_;
+      int nPolymer = mixture.nPolymer();
+      int i, j, k, l, p;
+
+      // Matrix K = chiInverse - a a^T/(a.e), and its largest eigenvalue
+      // magnitude, which sets the scale of the eigenvalue floor
+      DArray<double> a;
+      a.allocate(nm);
+      double sumA = 0.0;
+      for (j = 0; j < nm; ++j) {
+         a[j] = 0.0;
+         for (i = 0; i < nm; ++i) {
+            a[j] += interaction.chiInverse(i, j);
+         }
+         sumA += a[j];
+      }
+      DMatrix<double> kMatrix;
+      kMatrix.allocate(nm, nm);
+      for (i = 0; i < nm; ++i) {
+         for (j = 0; j < nm; ++j) {
+            kMatrix(i, j) = interaction.chiInverse(i, j) - a[i]*a[j]/sumA;
+            work_(i, j) = kMatrix(i, j);
+         }
+      }
+      diagonalize();
+      double floor = 0.0;
+      for (i = 0; i < nm; ++i) {
+         if (floor < fabs(work_(i, i))) {
+            floor = fabs(work_(i, i));
+         }
+      }
+      UTIL_CHECK(floor > 0.0);
+      floor *= 0.03;
+
+      // Sum of b^2 L over the blocks on the path between each pair
+      // of blocks, excluding the two blocks themselves.
+      DArray< DMatrix<double> > paths;
+      paths.allocate(nPolymer);
+      for (p = 0; p < nPolymer; ++p) {
+         Polymer<D>& polymer = mixture.polymer(p);
+         int nBlock = polymer.nBlock();
+         int nVertex = polymer.nVertex();
+
+         // Distances between vertices (Floyd-Warshall on the tree)
+         DMatrix<double> dist;
+         dist.allocate(nVertex, nVertex);
+         double huge = 1.0E300;
+         for (i = 0; i < nVertex; ++i) {
+            for (j = 0; j < nVertex; ++j) {
+               dist(i, j) = (i == j) ? 0.0 : huge;
+            }
+         }
+         for (k = 0; k < nBlock; ++k) {
+            Block<D>& block = polymer.block(k);
+            double step = mixture.monomer(block.monomerId()).step();
+            double var = step*step*block.length();
+            i = block.vertexId(0);
+            j = block.vertexId(1);
+            dist(i, j) = var;
+            dist(j, i) = var;
+         }
+         for (k = 0; k < nVertex; ++k) {
+            for (i = 0; i < nVertex; ++i) {
+               for (j = 0; j < nVertex; ++j) {
+                  if (dist(i, k) + dist(k, j) < dist(i, j)) {
+                     dist(i, j) = dist(i, k) + dist(k, j);
+                  }
+               }
+            }
+         }
+
+         // Shortest distance between ends of distinct blocks
+         paths[p].allocate(nBlock, nBlock);
+         for (k = 0; k < nBlock; ++k) {
+            for (l = 0; l < nBlock; ++l) {
+               double d = huge;
+               for (i = 0; i < 2; ++i) {
+                  for (j = 0; j < 2; ++j) {
+                     int vk = polymer.block(k).vertexId(i);
+                     int vl = polymer.block(l).vertexId(j);
+                     if (dist(vk, vl) < d) d = dist(vk, vl);
+                  }
+               }
+               paths[p](k, l) = d;
+            }
+         }
+      }
+
+      double ksq, prefactor, xk, xl, value;
+      for (int s = 1; s < nStar_; ++s) {
+         ksq = basis.star(s).eigen;
+
+         // work_ = S + K, where S is the ideal correlation matrix
+         for (i = 0; i < nm; ++i) {
+            for (j = 0; j < nm; ++j) {
+               work_(i, j) = kMatrix(i, j);
+            }
+         }
+         for (p = 0; p < nPolymer; ++p) {
+            Polymer<D>& polymer = mixture.polymer(p);
+            prefactor = polymer.phi()/polymer.length();
+            int nBlock = polymer.nBlock();
+            for (k = 0; k < nBlock; ++k) {
+               Block<D>& blockK = polymer.block(k);
+               double stepK = mixture.monomer(blockK.monomerId()).step();
+               xk = ksq*stepK*stepK/6.0;
+               i = blockK.monomerId();
+               work_(i, i) += prefactor*debyeSelf(xk, blockK.length());
+               for (l = k + 1; l < nBlock; ++l) {
+                  Block<D>& blockL = polymer.block(l);
+                  double stepL = mixture.monomer(blockL.monomerId()).step();
+                  xl = ksq*stepL*stepL/6.0;
+                  j = blockL.monomerId();
+                  value = prefactor*exp(-ksq*paths[p](k, l)/6.0)
+                        * debyeEnd(xk, blockK.length())
+                        * debyeEnd(xl, blockL.length());
+                  work_(i, j) += value;
+                  work_(j, i) += value;
+               }
+            }
+         }
+
+         // Regularized inverse of S + K, multiplied by chiInverse
+         diagonalize();
+         DMatrix<double>& matrix = matrices_[s];
+         for (i = 0; i < nm; ++i) {
+            for (j = 0; j < nm; ++j) {
+               value = 0.0;
+               for (k = 0; k < nm; ++k) {
+                  double lambda = work_(k, k);
+                  if (fabs(lambda) < floor) {
+                     lambda = (lambda < 0.0) ? -floor : floor;
+                  }
+                  value += vectors_(i, k)*vectors_(j, k)/lambda;
+               }
+               matrix(i, j) = value;
+            }
+         }
+         for (i = 0; i < nm; ++i) {
+            for (j = 0; j < nm; ++j) {
+               vectors_(i, j) = 0.0;
+               for (k = 0; k < nm; ++k) {
+                  vectors_(i, j) += matrix(i, k)*interaction.chiInverse(k, j);
+               }
+            }
+         }
+         for (i = 0; i < nm; ++i) {
+            for (j = 0; j < nm; ++j) {
+               matrix(i, j) = vectors_(i, j);
+            }
+         }
+      }
+   }
+
+   /*
+   * Apply preconditioner.
+   */
+   template <int D>
+   void RpaPreconditioner<D>::apply(DArray< DArray<double> > const & in,
+                                    DArray< DArray<double> >& out) const
+   {
+      int i, j, s;
+      double value;
+      for (s = 1; s < nStar_; ++s) {
+         DMatrix<double> const & matrix = matrices_[s];
+         for (i = 0; i < nMonomer_; ++i) {
+            value = 0.0;
+            for (j = 0; j < nMonomer_; ++j) {
+               value += matrix(i, j)*in[j][s-1];
+            }
+            out[i][s-1] = value;
+         }
+      }
+   }
+
+   /*
+   * Cyclic Jacobi diagonalization of the symmetric matrix work_.
+   */
+   template <int D>
+   void RpaPreconditioner<D>::diagonalize()
+   {
+      int n = nMonomer_;
+      int i, j, k;
+      for (i = 0; i < n; ++i) {
+         for (j = 0; j < n; ++j) {
+            vectors_(i, j) = (i == j) ? 1.0 : 0.0;
+         }
+      }
+
+      double off, diag, theta, t, c, s, x, y;
+      for (int sweep = 0; sweep < 50; ++sweep) {
+         off = 0.0;
+         diag = 0.0;
+         for (i = 0; i < n; ++i) {
+            diag += work_(i, i)*work_(i, i);
+            for (j = i + 1; j < n; ++j) {
+               off += work_(i, j)*work_(i, j);
+            }
+         }
+         if (off <= 1.0E-30*diag || off == 0.0) break;
+         for (i = 0; i < n - 1; ++i) {
+            for (j = i + 1; j < n; ++j) {
+               if (work_(i, j) == 0.0) continue;
+               theta = (work_(j, j) - work_(i, i))/(2.0*work_(i, j));
+               t = 1.0/(fabs(theta) + sqrt(theta*theta + 1.0));
+               if (theta < 0.0) t = -t;
+               c = 1.0/sqrt(t*t + 1.0);
+               s = t*c;
+               for (k = 0; k < n; ++k) {
+                  x = work_(k, i);
+                  y = work_(k, j);
+                  work_(k, i) = c*x - s*y;
+                  work_(k, j) = s*x + c*y;
+               }
+               for (k = 0; k < n; ++k) {
+                  x = work_(i, k);
+                  y = work_(j, k);
+                  work_(i, k) = c*x - s*y;
+                  work_(j, k) = s*x + c*y;
+               }
+               for (k = 0; k < n; ++k) {
+                  x = vectors_(k, i);
+                  y = vectors_(k, j);
+                  vectors_(k, i) = c*x - s*y;
+                  vectors_(k, j) = s*x + c*y;
+               }
+            }
+         }
+      }
+   }
+
+}
+}
+#endif
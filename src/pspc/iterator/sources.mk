@@ -1,6 +1,11 @@
 pspc_iterator_= \
+  pspc/iterator/HistMat.cpp \
   pspc/iterator/Iterator.cpp \
-  pspc/iterator/AmIterator.cpp 
+  pspc/iterator/AmIterator.cpp \
+  pspc/iterator/AmIteratorGrid.cpp \
+  pspc/iterator/NkIterator.cpp \
+  pspc/iterator/RpaPreconditioner.cpp \
+  pspc/iterator/IteratorFactory.cpp 
 
   
 
@@ -25,7 +25,31 @@ LIBS+=$(GSL_LIB)
 
 # Add paths to FFTW Fast Fourier transform library
 INCLUDES+=$(FFTW_INC)
+ifdef PSPC_FLOAT
+ifdef PSPC_OPENMP
+LIBS+=$(FFTW_FLOAT_OMP_LIB) 
+endif
+LIBS+=$(FFTW_FLOAT_LIB) 
+else
+ifdef PSPC_OPENMP
+LIBS+=$(FFTW_OMP_LIB) 
+endif
 LIBS+=$(FFTW_LIB) 
+endif
+
+# Add compiler and linker flags for OpenMP multithreading
+ifdef PSPC_OPENMP
+CXXFLAGS+=$(OPENMP_FLAGS)
+TESTFLAGS+=$(OPENMP_FLAGS)
+LDFLAGS+=$(OPENMP_FLAGS)
+endif
+
+# Link with OpenMP if the pscf library is multithreaded
+ifdef PSCF_OPENMP
+ifndef PSPC_OPENMP
+LDFLAGS+=$(OPENMP_FLAGS)
+endif
+endif
 
 # List of all preprocessor macro definitions needed in src/pspc
 # Variables $(PSPC_DEFS) etc are initialized in namespace config.mk files
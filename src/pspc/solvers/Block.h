@@ -9,13 +9,19 @@
 */
 
 #include "Propagator.h"                   // base class argument
+#include "StepAlgorithm.h"                // member
+#include "OperatorTables.h"               // member
+#include "WaveList.h"                     // member
 #include <pscf/solvers/BlockTmpl.h>       // base class template
 #include <pscf/mesh/Mesh.h>               // member
 #include <pscf/crystal/UnitCell.h>        // member
+#include <pscf/crystal/Basis.h>           // pointer member
 #include <pspc/field/RField.h>            // member
 #include <pspc/field/RFieldDft.h>         // member
 #include <pspc/field/FFT.h>               // member
+#include <pspc/field/FFTBatched.h>        // member
 #include <util/containers/FArray.h>       // member template
+#include <util/containers/DArray.h>       // member template
 #include <util/containers/DMatrix.h>      // member template
 
 namespace Pscf { 
@@ -69,6 +75,96 @@ namespace Pspc {
       */
       ~Block();
 
+      /**
+      * Choose the algorithm used to integrate one contour step.
+      *
+      * This must be called before setDiscretization, which allocates
+      * only the work arrays required by the chosen algorithm. The 
+      * default algorithm is StepAlgorithm::Richardson.
+      *
+      * \param algorithm contour step algorithm
+      */
+      void setStepAlgorithm(StepAlgorithm::Type algorithm);
+
+      /**
+      * Set the propagator checkpoint interval.
+      *
+      * If interval == 1 (the default), propagators store q-fields at
+      * all contour grid points. If interval > 1, they store only every
+      * interval-th slice, and recompute the others when needed (see 
+      * Propagator). If interval == 0, an interval near sqrt(ns) is 
+      * chosen. This must be called before setDiscretization.
+      *
+      * \param interval checkpoint interval (>= 0)
+      */
+      void setCheckpointInterval(int interval);
+
+      /**
+      * Choose a propagator to be streamed, or none.
+      *
+      * If directionId is 0 or 1, propagator(directionId) is allocated
+      * as a streamed propagator (see Propagator), which stores only a
+      * few slices and accumulates the block concentration while it is 
+      * solved. It must then always be solved after propagator 
+      * 1 - directionId, and must not be an alias or aliased. If 
+      * directionId is -1 (the default), both propagators store their 
+      * slices. This must be called before setDiscretization.
+      *
+      * \param directionId  direction id of streamed propagator, or -1
+      */
+      void setStreamDirection(int directionId);
+
+      /**
+      * Number of contour grid points that would be used for a given ds.
+      *
+      * \param ds desired (optimal) value for contour length step
+      */
+      int computeNs(double ds) const;
+
+      /**
+      * Contour step size that would be used for a given ds.
+      *
+      * \param ds desired (optimal) value for contour length step
+      */
+      double computeDs(double ds) const;
+
+      /**
+      * Use operator tables shared with other blocks.
+      *
+      * The tables must have been allocated with the same monomer id,
+      * statistical segment length, step algorithm and contour step as
+      * this block, and must be kept up to date by their owner (usually
+      * a Mixture<D>): Upon return, setupUnitCell and setupSolver no 
+      * longer modify any tables. Must be called before setDiscretization, 
+      * which then allocates no tables of its own.
+      *
+      * \param tables  shared tables of exponential operators
+      */
+      void setOperatorTables(OperatorTables<D>& tables);
+
+      /**
+      * Does this block use tables shared with other blocks?
+      */
+      bool hasSharedTables() const;
+
+      /**
+      * Use a wave list shared with other blocks.
+      *
+      * The wave list must have been allocated for the same mesh as
+      * this block, and must be kept up to date by its owner (usually 
+      * a Mixture<D>), by calling WaveList<D>::setupUnitCell before
+      * setupUnitCell is called for this block. Must be called before 
+      * setDiscretization, which then allocates no wave list of its own.
+      *
+      * \param waveList  shared list of minimum images and |G|^2
+      */
+      void setWaveList(WaveList<D> const & waveList);
+
+      /**
+      * Does this block use a wave list shared with other blocks?
+      */
+      bool hasSharedWaveList() const;
+
       /**
       * Initialize discretization and allocate required memory.
       *
@@ -77,21 +173,65 @@ namespace Pspc {
       */
       void setDiscretization(double ds, const Mesh<D>& mesh);
 
+      /**
+      * Set the length of this block.
+      *
+      * After setDiscretization, the number of contour grid points ns 
+      * is unchanged, and the contour step is rescaled to length/(ns-1). 
+      * The block then uses operator tables of its own, which are 
+      * recomputed immediately for the current unit cell (if any). The
+      * propagators of this block must then be neither aliases nor 
+      * aliased by others, since these are equivalent only if their
+      * blocks have equal lengths.
+      *
+      * \param length  new block length
+      */
+      virtual void setLength(double length);
+
       /**
       * Setup parameters that depend on the unit cell.
       *
       * This should be called once after every change in unit cell
-      * parameters.
+      * parameters. Shared operator tables and wave lists are not 
+      * modified.
       *
       * \param unitCell unit cell, defining cell dimensions
       */
       void setupUnitCell(const UnitCell<D>& unitCell);
 
+      /**
+      * Associate a symmetry-adapted basis, for star-reduced stress.
+      *
+      * After this is called, computeStress sums over uncancelled stars
+      * of the basis, with one representative wave per star, rather 
+      * than over all waves of the discrete Fourier transform. The
+      * contribution of each star is weighted by the sum over its waves
+      * of the derivatives of |G|^2. This is valid only if all w
+      * fields are invariant under the space group of the basis. Must 
+      * be called after setDiscretization, with a basis constructed 
+      * for the same mesh.
+      *
+      * \param basis  symmetry-adapted basis
+      */
+      void setBasis(Basis<D> const & basis);
+
+      /**
+      * Remove any association with a basis (sum stress over all waves).
+      */
+      void clearBasis();
+
+      /**
+      * Is a basis set (i.e., is the stress computed by star reduction)?
+      */
+      bool hasBasis() const;
+
       /**
       * Set solver for this block.
       *
       * This should be called once after every change in w fields, before
       * entering the loop used to solve the MDE for either propagator.
+      * It does nothing if the block uses shared operator tables, which
+      * must then be updated by their owner.
       *
       * \param w chemical potential field for this monomer type
       */
@@ -100,6 +240,8 @@ namespace Pspc {
       /**
       * Compute one step of solution of MDE, from i to i+1.
       *
+      * The algorithm is chosen by setStepAlgorithm.
+      *
       * \param q  input value of QField, from step i
       * \param qNew  ouput value of QField, from step i+1
       */
@@ -121,16 +263,42 @@ namespace Pspc {
       * spatial average of q(r,L). This function is called by 
       * Polymer<D>::compute().
       *
+      * If one propagator is streamed, the integral has already been
+      * accumulated by accumulateConcentration during its solution, 
+      * and this function only multiplies it by the prefactor.
+      *
       * \param prefactor constant multiplying integral
       */ 
       void computeConcentration(double prefactor);
 
+      /**
+      * Add the contribution of one slice of a streamed propagator.
+      *
+      * Adds the Simpson's rule weighted product of slice i of the 
+      * streamed propagator(directionId) and slice ns-1-i of its partner
+      * to the unnormalized integral in cField(). The partner must be 
+      * solved. Called by Propagator<D> for each slice, for i = 0, ..., 
+      * ns-1 in order. The array cField() is zeroed when i == 0.
+      *
+      * \param directionId  direction id of streamed propagator
+      * \param i  contour step index of slice q
+      * \param q  slice i of propagator(directionId)
+      */
+      void accumulateConcentration(int directionId, int i, QField const & q);
+
       /** 
       * Compute stress contribution for this block.
       *
       * This function is called by Polymer<D>::computeStress. The
       * prefactor parameter should be the same as that passed to 
       * function computeConcentration.   
+      *
+      * Each propagator slice is Fourier transformed once (in batched 
+      * pairs), and the contour integral is accumulated separately for
+      * each wavevector before contraction with the derivatives of |G|^2 
+      * with respect to the unit cell parameters, which are computed 
+      * only once after each call to setupUnitCell. If a basis has been
+      * set by setBasis, both steps use one wave per star.
       *   
       * \param prefactor constant multiplying integral
       */  
@@ -151,6 +319,11 @@ namespace Pspc {
       */
       int ns() const;
 
+      /**
+      * Get the contour step algorithm.
+      */
+      StepAlgorithm::Type stepAlgorithm() const;
+
       /**
       * Get derivative of free energy w/ respect to unit cell parameter n.
       *
@@ -169,7 +342,6 @@ namespace Pspc {
       using BlockDescriptor::setId;
       using BlockDescriptor::setVertexIds;
       using BlockDescriptor::setMonomerId;
-      using BlockDescriptor::setLength;
       using BlockDescriptor::id;
       using BlockDescriptor::monomerId;
       using BlockDescriptor::vertexIds;
@@ -181,28 +353,56 @@ namespace Pspc {
       /// Matrix to store derivatives of plane waves 
       DMatrix<double> dGsq_;
 
+      /// Is dGsq_ current for the present unit cell?
+      bool hasdGsq_;
+
       /**
       * Compute dGsq_.
       */
       void computedGsq();
 
+      /**
+      * Compute concentration in checkpoint mode, using slice().
+      *
+      * \param prefactor constant multiplying integral
+      */
+      void computeConcentrationCheckpoint(double prefactor);
+
+      /**
+      * Take one second-order Strang splitting step.
+      */
+      void stepStrang(QField const& q, QField& qNew);
+
+      /**
+      * Take one Richardson extrapolated (fourth-order) step.
+      */
+      void stepRichardson(QField const& q, QField& qNew);
+
+      /**
+      * Take one fourth-order ETDRK4 step.
+      */
+      void stepEtdrk4(QField const& q, QField& qNew);
+
       /// Stress arising from this block
       FSArray<double, 6> stress_;
 
       // Fourier transform plan
       FFT<D> fft_;
 
-      // Array of elements containing exp(-K^2 b^2 ds/6)
-      RField<D> expKsq_;
+      // Fourier transform plan for pairs of fields (Richardson, ETDRK4)
+      FFTBatched<D> fftBatched_;
+
+      // Tables of exponential operators owned by this block
+      OperatorTables<D> tables_;
 
-      // Array of elements containing exp(-W[i] ds/2)
-      RField<D> expW_;
+      // Pointer to tables in use (either tables_ or shared tables)
+      OperatorTables<D>* tablesPtr_;
 
-      // Array of elements containing exp(-K^2 b^2 ds/(6*2))
-      RField<D> expKsq2_;
+      // Minimum images and |G|^2 of wavevectors, owned by this block
+      WaveList<D> waveList_;
 
-      // Array of elements containing exp(-W[i] (ds/2)*0.5)
-      RField<D> expW2_;
+      // Pointer to wave list in use (either waveList_ or shared list)
+      WaveList<D> const * waveListPtr_;
 
       // Work array for real-space field.
       RField<D> qf_;
@@ -219,6 +419,30 @@ namespace Pspc {
       // Work array for wavevector space field.
       RFieldDft<D> qk2_;
 
+      // Work array for wavevector space field (ETDRK4 only).
+      RFieldDft<D> qk3_;
+
+      // Work array for wavevector space field (ETDRK4 only).
+      RFieldDft<D> qk4_;
+
+      // Work array for a pair of real-space fields, for fftBatched_.
+      Pspc::Field<Real> rBatch_;
+
+      // Work array for a pair of wavevector space fields, for fftBatched_.
+      Pspc::Field<FftwComplex> kBatch_;
+
+      // Contour integral of q0(k,s)q1(-k,L-s), at each wavevector (stress)
+      DArray<double> stressK_;
+
+      // Ranks in k-space mesh of one wave per star (star-reduced stress)
+      DArray<int> starRanks_;
+
+      // Basis star ids of the waves in starRanks_ (star-reduced stress)
+      DArray<int> starIds_;
+
+      /// Pointer to associated Basis<D>, or null if stress uses all waves.
+      Basis<D> const* basisPtr_;
+
       /// Pointer to associated Mesh<D> object.
       Mesh<D> const* meshPtr_;
 
@@ -234,6 +458,15 @@ namespace Pspc {
       /// Number of contour length steps = # grid points - 1.
       int ns_;
 
+      /// Algorithm used to integrate one contour step.
+      StepAlgorithm::Type stepAlgorithm_;
+
+      /// Requested propagator checkpoint interval (0 = automatic).
+      int checkpointInterval_;
+
+      /// Direction id of streamed propagator, or -1 if none.
+      int streamDirectionId_;
+
       /** 
       * Access associated UnitCell<D> as reference.
       */  
@@ -243,6 +476,21 @@ namespace Pspc {
 
    // Inline member functions
 
+   /// Does this block use shared operator tables?
+   template <int D>
+   inline bool Block<D>::hasSharedTables() const
+   {  return (tablesPtr_ != 0 && tablesPtr_ != &tables_); }
+
+   /// Does this block use a shared wave list?
+   template <int D>
+   inline bool Block<D>::hasSharedWaveList() const
+   {  return (waveListPtr_ != 0 && waveListPtr_ != &waveList_); }
+
+   /// Is a basis set?
+   template <int D>
+   inline bool Block<D>::hasBasis() const
+   {  return (basisPtr_ != 0); }
+
    /// Get number of contour steps.
    template <int D>
    inline int Block<D>::ns() const
@@ -253,6 +501,11 @@ namespace Pspc {
    inline double Block<D>::ds() const
    {  return ds_; }
 
+   /// Get the contour step algorithm.
+   template <int D>
+   inline StepAlgorithm::Type Block<D>::stepAlgorithm() const
+   {  return stepAlgorithm_; }
+
    /// Stress with respect to unit cell parameter n.
    template <int D>
    inline double Block<D>::stress(int n) const
@@ -10,15 +10,16 @@
 
 #include "Block.h"
 #include <pscf/mesh/Mesh.h>
-#include <pscf/mesh/MeshIterator.h>
 #include <pscf/crystal/UnitCell.h>
-#include <pscf/crystal/shiftToMinimum.h>
 #include <pscf/math/IntVec.h>
+#include <pspc/field/threads.h>
 #include <util/containers/DMatrix.h>      
 #include <util/containers/DArray.h>      
 #include <util/containers/FArray.h>      
 #include <util/containers/FSArray.h>
 
+#include <complex>
+
 namespace Pscf { 
 namespace Pspc {
 
@@ -29,10 +30,18 @@ namespace Pspc {
    */
    template <int D>
    Block<D>::Block()
-    : meshPtr_(0),
+    : hasdGsq_(false),
+      tablesPtr_(0),
+      waveListPtr_(0),
+      basisPtr_(0),
+      meshPtr_(0),
+      unitCellPtr_(0),
       kMeshDimensions_(0),
       ds_(0.0),
-      ns_(0)
+      ns_(0),
+      stepAlgorithm_(StepAlgorithm::Richardson),
+      checkpointInterval_(1),
+      streamDirectionId_(-1)
    {
       propagator(0).setBlock(*this);
       propagator(1).setBlock(*this);
@@ -45,6 +54,86 @@ namespace Pspc {
    Block<D>::~Block()
    {}
 
+   /*
+   * Choose the contour step algorithm.
+   */
+   template <int D>
+   void Block<D>::setStepAlgorithm(StepAlgorithm::Type algorithm)
+   {
+      // Work arrays are allocated by setDiscretization
+      UTIL_CHECK(!qr_.isAllocated());
+      stepAlgorithm_ = algorithm;
+   }
+
+   /*
+   * Set the propagator checkpoint interval.
+   */
+   template <int D>
+   void Block<D>::setCheckpointInterval(int interval)
+   {
+      UTIL_CHECK(interval >= 0);
+      UTIL_CHECK(!propagator(0).isAllocated());
+      checkpointInterval_ = interval;
+   }
+
+   /*
+   * Choose a propagator to be streamed, or none.
+   */
+   template <int D>
+   void Block<D>::setStreamDirection(int directionId)
+   {
+      UTIL_CHECK(directionId >= -1 && directionId < 2);
+      UTIL_CHECK(!propagator(0).isAllocated());
+      streamDirectionId_ = directionId;
+   }
+
+   /*
+   * Number of contour grid points for a given ds (as in setDiscretization).
+   */
+   template <int D>
+   int Block<D>::computeNs(double ds) const
+   {
+      double dsBlock = computeDs(ds);
+      return (length()/dsBlock) + 1;
+   }
+
+   /*
+   * Contour step size that would be used for a given ds.
+   */
+   template <int D>
+   double Block<D>::computeDs(double ds) const
+   {
+      UTIL_CHECK(ds > 0.0);
+      int tempNs;
+      tempNs = (floor(length()/(2.0 *ds) + 0.5));
+      if (tempNs == 0) {
+         tempNs = 1;
+      } 
+      return length()/double(tempNs * 2.0);
+   }
+
+   /*
+   * Use operator tables shared with other blocks.
+   */
+   template <int D>
+   void Block<D>::setOperatorTables(OperatorTables<D>& tables)
+   {
+      UTIL_CHECK(tables.isAllocated());
+      UTIL_CHECK(!tables_.isAllocated());
+      tablesPtr_ = &tables;
+   }
+
+   /*
+   * Use a wave list shared with other blocks.
+   */
+   template <int D>
+   void Block<D>::setWaveList(WaveList<D> const & waveList)
+   {
+      UTIL_CHECK(waveList.isAllocated());
+      UTIL_CHECK(!waveList_.isAllocated());
+      waveListPtr_ = &waveList;
+   }
+
    template <int D>
    void Block<D>::setDiscretization(double ds, const Mesh<D>& mesh)
    {  
@@ -65,12 +154,8 @@ namespace Pspc {
       ds_ = length()/double(ns_ - 1);
       #endif
 
-      int tempNs;
-      tempNs = (floor(length()/(2.0 *ds) + 0.5));
-      if (tempNs == 0) {
-         tempNs = 1;
-      } 
-      ds_ = (length()/double(tempNs * 2.0));
+      // Set contour step size and number of contour grid points
+      ds_ = computeDs(ds);
       ns_ = (length()/ds_)  + 1;
 
       // Compute Fourier space kMeshDimensions_ 
@@ -87,25 +172,164 @@ namespace Pspc {
            kSize_ *= kMeshDimensions_[i];   
       }   
 
-      // Allocate work arrays
-      expKsq_.allocate(kMeshDimensions_);
-      expW_.allocate(mesh.dimensions());
-      expKsq2_.allocate(kMeshDimensions_);
-      expW2_.allocate(mesh.dimensions());
+      // Allocate work arrays used by all algorithms
       qr_.allocate(mesh.dimensions());
       qk_.allocate(mesh.dimensions());
       qr2_.allocate(mesh.dimensions());
       qk2_.allocate(mesh.dimensions());
-      qf_.allocate(mesh.dimensions());
+
+      // Allocate work arrays specific to the contour step algorithm
+      if (stepAlgorithm_ == StepAlgorithm::Richardson) {
+         qf_.allocate(mesh.dimensions());
+      } else
+      if (stepAlgorithm_ == StepAlgorithm::ETDRK4) {
+         qk3_.allocate(mesh.dimensions());
+         qk4_.allocate(mesh.dimensions());
+      }
+
+      // Allocate operator tables, unless shared tables are set
+      if (tablesPtr_) {
+         UTIL_CHECK(tablesPtr_->matches(monomerId(), kuhn(), ds_, 
+                                        stepAlgorithm_));
+      } else {
+         tables_.allocate(monomerId(), kuhn(), ds_, stepAlgorithm_, mesh);
+         tablesPtr_ = &tables_;
+      }
+
+      // Allocate a wave list, unless a shared list is set
+      if (waveListPtr_) {
+         UTIL_CHECK(waveListPtr_->kMeshDimensions() == kMeshDimensions_);
+      } else {
+         waveList_.allocate(mesh);
+         waveListPtr_ = &waveList_;
+      }
 
       dGsq_.allocate(kSize_, 6);
 
-      propagator(0).allocate(ns_, mesh);
-      propagator(1).allocate(ns_, mesh);
+      // Make FFT plans here, rather than in the first transform, 
+      // because FFTW planning is not thread safe, and propagators of
+      // different blocks may be solved concurrently.
+      fft_.setup(qr_, qk_);
+
+      // Twinned transforms of pairs of fields (step and stress)
+      rBatch_.allocate(2*mesh.size());
+      kBatch_.allocate(2*kSize_);
+      fftBatched_.setup(mesh.dimensions(), 2, rBatch_, kBatch_);
+      stressK_.allocate(kSize_);
+
+      int interval = checkpointInterval_;
+      if (interval == 0) {
+         interval = (int) floor(sqrt(double(ns_)) + 0.5);
+      }
+      propagator(0).allocate(ns_, mesh, interval, 
+                             streamDirectionId_ == 0);
+      propagator(1).allocate(ns_, mesh, interval, 
+                             streamDirectionId_ == 1);
       cField().allocate(mesh.dimensions());
 
    }
 
+   /*
+   * Associate a basis, and choose one representative wave per star.
+   */
+   template <int D>
+   void Block<D>::setBasis(Basis<D> const & basis)
+   {
+      UTIL_CHECK(meshPtr_);
+      UTIL_CHECK(basis.nWave() == mesh().size());
+
+      // Count stars in reduced sum. Uncancelled stars that are not 
+      // closed under inversion (invertFlag = -1) are omitted, and 
+      // counted instead with their partner star (invertFlag = +1).
+      int nStar = basis.nStar();
+      int nReduced = 0;
+      int i, j;
+      for (i = 0; i < nStar; ++i) {
+         if (!basis.star(i).cancel && basis.star(i).invertFlag != -1) {
+            ++nReduced;
+         }
+      }
+      UTIL_CHECK(nReduced <= dGsq_.capacity1());
+      if (starRanks_.isAllocated()) {
+         starRanks_.deallocate();
+         starIds_.deallocate();
+      }
+      starRanks_.allocate(nReduced);
+      starIds_.allocate(nReduced);
+
+      // Choose a wave in each star that is explicitly represented in
+      // the k-space mesh, or else the inverse -G of an implicit wave.
+      IntVec<D> meshDimensions = mesh().dimensions();
+      IntVec<D> vec;
+      int k = 0;
+      int waveId, rank;
+      for (i = 0; i < nStar; ++i) {
+         typename Basis<D>::Star const & star = basis.star(i);
+         if (star.cancel || star.invertFlag == -1) continue;
+         waveId = star.beginId;
+         for (j = star.beginId; j < star.endId; ++j) {
+            if (!basis.wave(j).implicit) {
+               waveId = j;
+               break;
+            }
+         }
+         vec = basis.wave(waveId).indicesDft;
+         if (basis.wave(waveId).implicit) {
+            for (j = 0; j < D; ++j) {
+               vec[j] = (meshDimensions[j] - vec[j]) % meshDimensions[j];
+            }
+         }
+         rank = 0;
+         for (j = 0; j < D; ++j) {
+            UTIL_CHECK(vec[j] < kMeshDimensions_[j]);
+            rank = rank*kMeshDimensions_[j] + vec[j];
+         }
+         starRanks_[k] = rank;
+         starIds_[k] = i;
+         ++k;
+      }
+      UTIL_CHECK(k == nReduced);
+
+      basisPtr_ = &basis;
+      hasdGsq_ = false;
+   }
+
+   /*
+   * Remove association with a basis.
+   */
+   template <int D>
+   void Block<D>::clearBasis()
+   {
+      basisPtr_ = 0;
+      hasdGsq_ = false;
+   }
+
+   /*
+   * Set block length, rescaling the contour step if discretized.
+   */
+   template <int D>
+   void Block<D>::setLength(double length)
+   {
+      BlockDescriptor::setLength(length);
+      if (ns_ == 0) return;
+
+      // Keep ns_, and hence the allocated propagators
+      UTIL_CHECK(length > 0.0);
+      ds_ = length/double(ns_ - 1);
+
+      // Tables shared with other blocks no longer match ds_
+      if (hasSharedTables()) {
+         tables_.allocate(monomerId(), kuhn(), ds_, stepAlgorithm_,
+                          mesh());
+         tablesPtr_ = &tables_;
+      } else {
+         tables_.setDs(ds_);
+      }
+      if (unitCellPtr_) {
+         tables_.setupUnitCell(*waveListPtr_);
+      }
+   }
+
    /*
    * Setup data that depend on the unit cell parameters.
    */
@@ -116,28 +340,16 @@ namespace Pspc {
 
       // Set association to unitCell
       unitCellPtr_ = &unitCell;
+      hasdGsq_ = false;
 
-      MeshIterator<D> iter;
-      // std::cout << "kDimensions = " << kMeshDimensions_ << std::endl;
-      iter.setDimensions(kMeshDimensions_);
-      IntVec<D> G, Gmin;
-      double Gsq;
-      double factor = -1.0*kuhn()*kuhn()*ds_/6.0;
-      // std::cout << "factor      = " << factor << std::endl;
-      int i;
-      for (iter.begin(); !iter.atEnd(); ++iter) {
-         i = iter.rank(); 
-         G = iter.position();
-         Gmin = shiftToMinimum(G, mesh().dimensions(), unitCell);
-         Gsq = unitCell.ksq(Gmin);
-         expKsq_[i] = exp(Gsq*factor);
-         expKsq2_[i] = exp(Gsq*factor*0.5);
-         //std::cout << i    << "  " 
-         //         << Gmin << "  " 
-         //          << Gsq  << "  "
-         //          << expKsq_[i] << std::endl;
+      // Shared wave lists and tables are updated by their owners
+      UTIL_CHECK(waveListPtr_);
+      if (!hasSharedWaveList()) {
+         waveList_.setupUnitCell(unitCell);
+      }
+      if (!hasSharedTables()) {
+         tables_.setupUnitCell(*waveListPtr_);
       }
-
    }
       
    /*
@@ -151,40 +363,10 @@ namespace Pspc {
       int nx = mesh().size();
       UTIL_CHECK(nx > 0);
       
-      // Populate expW_
-      int i;
-      // std::cout << std::endl;
-      for (i = 0; i < nx; ++i) {
-         expW_[i] = exp(-0.5*w[i]*ds_);
-         expW2_[i] = exp(-0.5*0.5*w[i]*ds_);
-         // std::cout << "i = " << i 
-         //           << " expW_[i] = " << expW_[i]
-         //          << std::endl;
-      }
-
-      #if 0
-      MeshIterator<D> iter;
-      IntVec<D> G;
-      IntVec<D> Gmin;
-      double Gsq;
-      double factor = -1.0*kuhn()*kuhn()*ds_/6.0;
-      // std::cout << "kDimensions = " << kMeshDimensions_ << std::endl;
-      // std::cout << "factor      = " << factor << std::endl;
-      iter.setDimensions(kMeshDimensions_);
-      for (iter.begin(); !iter.atEnd(); ++iter) {
-         i = iter.rank(); 
-         G = iter.position();
-         Gmin = shiftToMinimum(G, mesh().dimensions(), unitCell);
-         Gsq = unitCell.ksq(Gmin);
-         expKsq_[i] = exp(Gsq*factor);
-         expKsq2_[i] = exp(Gsq*factor*0.5);
-         //std::cout << i    << "  " 
-         //          << Gmin << "  " 
-         //          << Gsq  << "  "
-         //          << expKsq_[i] << std::endl;
+      // Populate expW and expW2, or copy w for ETDRK4, unless shared
+      if (!hasSharedTables()) {
+         tables_.setupSolver(w);
       }
-      #endif
-      
    }
 
    /*
@@ -202,40 +384,125 @@ namespace Pspc {
       UTIL_CHECK(propagator(1).isAllocated());
       UTIL_CHECK(cField().capacity() == nx) 
 
-      // Initialize cField to zero at all points
-      int i;
-      for (i = 0; i < nx; ++i) {
-         cField()[i] = 0.0;
+      // Integral was accumulated while solving a streamed propagator
+      if (streamDirectionId_ >= 0) {
+         UTIL_CHECK(propagator(streamDirectionId_).isSolved());
+         prefactor *= ds_ / 3.0;
+         int i;
+         PSPC_OMP_PARALLEL_FOR
+         for (i = 0; i < nx; ++i) {
+            cField()[i] *= prefactor;
+         }
+         return;
+      }
+
+      if (propagator(0).checkpointInterval() > 1) {
+         computeConcentrationCheckpoint(prefactor);
+         return;
       }
 
       Propagator<D> const & p0 = propagator(0);
       Propagator<D> const & p1 = propagator(1);
+      prefactor *= ds_ / 3.0;
 
-      // Evaluate unnormalized integral
-      for(i = 0; i < nx; ++i) {
-         cField()[i] += p0.q(0)[i]*p1.q(ns_ - 1)[i];
-         cField()[i] += p0.q(ns_ -1)[i]*p1.q(0)[i];
-      }
+      // Evaluate Simpson's rule integral at each grid point.
+      // The outer loop is over grid points, so that each thread
+      // accumulates the contour integral for a contiguous range of 
+      // points in a private sum, with no concurrent writes.
+      int i;
+      PSPC_OMP_PARALLEL_FOR
+      for (i = 0; i < nx; ++i) {
+         double sum;
+         sum  = p0.q(0)[i]*p1.q(ns_ - 1)[i];
+         sum += p0.q(ns_ -1)[i]*p1.q(0)[i];
 
-      //odd indices
-      for(int j = 1; j < (ns_ -1); j += 2) {
-         for(int i = 0; i < nx; ++i) {
-            cField()[i] += p0.q(j)[i] * p1.q(ns_ - 1 - j)[i] * 4.0;   
+         //odd indices
+         for (int j = 1; j < (ns_ -1); j += 2) {
+            sum += p0.q(j)[i] * p1.q(ns_ - 1 - j)[i] * 4.0;   
          }
-      }
 
-      //even indices
-      for(int j = 2; j < (ns_ -2); j += 2) {
-         for(int i = 0; i < nx; ++i) {
-            cField()[i] += p0.q(j)[i] * p1.q(ns_ - 1 - j)[i] * 2.0;   
+         //even indices
+         for (int j = 2; j < (ns_ -2); j += 2) {
+            sum += p0.q(j)[i] * p1.q(ns_ - 1 - j)[i] * 2.0;   
          }
+
+         cField()[i] = sum*prefactor;
       }
 
+   }
+
+   /*
+   * Integrate to calculate concentration, recomputing propagator slices.
+   */
+   template <int D>
+   void Block<D>::computeConcentrationCheckpoint(double prefactor)
+   {
+      int nx = mesh().size();
+      Propagator<D>& p0 = propagator(0);
+      Propagator<D>& p1 = propagator(1);
       prefactor *= ds_ / 3.0;
+
+      // The contour loop is outermost, so that each segment of each
+      // propagator is recomputed only once.
+      int i, j;
+      for (i = 0; i < nx; ++i) {
+         cField()[i] = 0.0;
+      }
+      double weight;
+      for (j = 0; j < ns_; ++j) {
+         if (j == 0 || j == ns_ - 1) {
+            weight = 1.0;
+         } else 
+         if (j % 2 == 1) {
+            weight = 4.0;
+         } else {
+            weight = 2.0;
+         }
+         QField const & q0 = p0.slice(j);
+         QField const & q1 = p1.slice(ns_ - 1 - j);
+         PSPC_OMP_PARALLEL_FOR
+         for (i = 0; i < nx; ++i) {
+            cField()[i] += q0[i] * q1[i] * weight;
+         }
+      }
+      PSPC_OMP_PARALLEL_FOR
       for (i = 0; i < nx; ++i) {
          cField()[i] *= prefactor;
       }
+   }
 
+   /*
+   * Add one slice of a streamed propagator to the concentration integral.
+   */
+   template <int D>
+   void Block<D>::accumulateConcentration(int directionId, int i, 
+                                          QField const & q)
+   {
+      UTIL_CHECK(directionId == streamDirectionId_);
+      Propagator<D>& partner = propagator(1 - directionId);
+      UTIL_CHECK(partner.isSolved());
+      QField const & qp = partner.slice(ns_ - 1 - i);
+      int nx = mesh().size();
+      int k;
+      if (i == 0) {
+         PSPC_OMP_PARALLEL_FOR
+         for (k = 0; k < nx; ++k) {
+            cField()[k] = 0.0;
+         }
+      }
+      double weight;
+      if (i == 0 || i == ns_ - 1) {
+         weight = 1.0;
+      } else 
+      if (i % 2 == 1) {
+         weight = 4.0;
+      } else {
+         weight = 2.0;
+      }
+      PSPC_OMP_PARALLEL_FOR
+      for (k = 0; k < nx; ++k) {
+         cField()[k] += q[k] * qp[k] * weight;
+      }
    }
 
    /*
@@ -259,6 +526,9 @@ namespace Pspc {
  
       normal = 3.0*6.0;
 
+      // Normalization of forward transforms
+      double scale = 1.0/double(nx);
+
       int kSize_ = 1;
       for (int i = 0; i < D; ++i) {
            kSize_ *= kMeshDimensions_[i];   
@@ -275,19 +545,52 @@ namespace Pspc {
          stress_.append(0.0);
       }   
 
-      computedGsq();
+      // Compute derivatives of |G|^2 only once per unit cell
+      if (!hasdGsq_) {
+         computedGsq();
+         hasdGsq_ = true;
+      }
 
-      Propagator<D> const & p0 = propagator(0);
-      Propagator<D> const & p1 = propagator(1);
+      Propagator<D>& p0 = propagator(0);
+      Propagator<D>& p1 = propagator(1);
+
+      // Real-space and Fourier-space fields of the batched pair
+      Real* r1 = &rBatch_[0];
+      Real* r2 = &rBatch_[nx];
+      FftwComplex* k1 = &kBatch_[0];
+      FftwComplex* k2 = &kBatch_[c];
+
+      // Number of terms in the sum over waves, and their k-space ranks
+      int const * ranks = 0;
+      if (basisPtr_) {
+         c = starRanks_.capacity();
+         ranks = &starRanks_[0];
+      }
 
-      // Evaluate unnormalized integral   
-      for (int j = 0; j < ns_ ; ++j) {
-           
-           qr_ = p0.q(j);
-           fft_.forwardTransform(qr_, qk_);
-           
-           qr2_ = p1.q(ns_ - 1 - j);
-           fft_.forwardTransform(qr2_, qk2_); 
+      for (m = 0; m < c; ++m) {
+         stressK_[m] = 0.0;
+      }
+
+      // Accumulate contour integral at each wavevector (Simpson's rule).
+      // Traverse the contour backwards if propagator(1) is streamed, so
+      // that its slices are recomputed in order of increasing index.
+      bool isReversed = (streamDirectionId_ == 1);
+      for (int jStep = 0; jStep < ns_ ; ++jStep) {
+
+           int j = isReversed ? ns_ - 1 - jStep : jStep;
+
+           // Obtain both slices before using the work arrays, which
+           // are also used to recompute slices in checkpoint mode.
+           QField const & q0 = p0.slice(j);
+           QField const & q1 = p1.slice(ns_ - 1 - j);
+
+           // Transform both slices together, normalizing while copying
+           PSPC_OMP_PARALLEL_FOR
+           for (i = 0; i < nx; ++i) {
+              r1[i] = q0[i]*scale;
+              r2[i] = q1[i]*scale;
+           }
+           fftBatched_.forwardTransformUnscaled(rBatch_, kBatch_);
 
            dels = ds_;
 
@@ -299,19 +602,31 @@ namespace Pspc {
               }           
            }
 
-           for (int n = 0; n < r ; ++n) {
-              increment = 0;
-
+           if (ranks) {
+              PSPC_OMP_PARALLEL_FOR
               for (m = 0; m < c ; ++m) {
-                 double prod = 0;
-                 prod = (qk2_[m][0] * qk_[m][0]) + (qk2_[m][1] * qk_[m][1]);
-                 prod *= dGsq_(m,n); 
-                 increment += prod; 
+                 int q = ranks[m];
+                 stressK_[m] += dels*(double(k2[q][0])*double(k1[q][0])
+                                    + double(k2[q][1])*double(k1[q][1]));
               }
-              increment = (increment * kuhn() * kuhn() * dels)/normal;
-              dQ [n] = dQ[n]-increment; 
-           }    
+           } else {
+              PSPC_OMP_PARALLEL_FOR
+              for (m = 0; m < c ; ++m) {
+                 stressK_[m] += dels*(double(k2[m][0])*double(k1[m][0])
+                                    + double(k2[m][1])*double(k1[m][1]));
+              }
+           }
       }   
+
+      // Contract with derivatives of |G|^2 for each cell parameter
+      for (int n = 0; n < r ; ++n) {
+         increment = 0;
+         for (m = 0; m < c ; ++m) {
+            increment += stressK_[m]*dGsq_(m,n); 
+         }
+         increment = (increment * kuhn() * kuhn())/normal;
+         dQ [n] = dQ[n]-increment; 
+      }    
       
       // Normalize
       for (i = 0; i < r; ++i) {
@@ -326,26 +641,51 @@ namespace Pspc {
    template <int D>
    void Block<D>::computedGsq()
    {
-      IntVec<D> temp;
-      IntVec<D> vec;
-      IntVec<D> Partner;
-      MeshIterator<D> iter;
-      iter.setDimensions(kMeshDimensions_);
-
-      for (int n = 0; n < unitCellPtr_->nParameter() ; ++n) {
-         for (iter.begin(); !iter.atEnd(); ++iter) {
-            temp = iter.position();
-            vec = shiftToMinimum(temp, mesh().dimensions(), *unitCellPtr_);
-            dGsq_(iter.rank(), n) = unitCellPtr_->dksq(vec, n);
-            for (int p = 0; p < D; ++p) {
-               if (temp [p] != 0) {
-                  Partner[p] = mesh().dimensions()[p] - temp[p];
-               } else {
-                  Partner[p] = 0;
+      int nParameter = unitCellPtr_->nParameter();
+      int n;
+
+      // Star-reduced sum: Row k is the sum of derivatives over all waves
+      // of star starIds_[k] (doubled for a star that is not closed under
+      // inversion, to include its partner star). The derivatives of 
+      // waves in one star are not equal if the unit cell has more free
+      // parameters than the lattice system of the space group requires.
+      if (basisPtr_) {
+         double sum;
+         int j;
+         for (int k = 0; k < starIds_.capacity(); ++k) {
+            typename Basis<D>::Star const & star 
+                                          = basisPtr_->star(starIds_[k]);
+            for (n = 0; n < nParameter; ++n) {
+               sum = 0.0;
+               for (j = star.beginId; j < star.endId; ++j) {
+                  sum += unitCellPtr_->dksq(basisPtr_->wave(j).indicesBz, n);
+               }
+               if (star.invertFlag == 1) {
+                  sum *= 2.0;
                }
+               dGsq_(k, n) = sum;
             }
-            if (Partner[D-1] > kMeshDimensions_[D-1]) {
-               dGsq_(iter.rank(), n) *= 2;
+         }
+         return;
+      }
+
+      // Copy derivatives of |G|^2 from the wave list. Waves with an 
+      // implicit partner -G that is absent from the k-space mesh are 
+      // counted twice.
+      UTIL_CHECK(waveListPtr_->hasKSq());
+      int kSize = waveListPtr_->kSize();
+      int nLast = mesh().dimensions()[D-1];
+      int kLast = kMeshDimensions_[D-1];
+      int rank, index, partner;
+      bool isDouble;
+      for (rank = 0; rank < kSize; ++rank) {
+         index = rank % kLast;
+         partner = (index != 0) ? nLast - index : 0;
+         isDouble = (partner > kLast);
+         for (n = 0; n < nParameter; ++n) {
+            dGsq_(rank, n) = waveListPtr_->dkSq(n)[rank];
+            if (isDouble) {
+               dGsq_(rank, n) *= 2;
             }
          }
       }
@@ -365,47 +705,226 @@ namespace Pspc {
       UTIL_CHECK(q.capacity() == nx);
       UTIL_CHECK(qNew.capacity() == nx);
       UTIL_CHECK(qr_.capacity() == nx);
-      UTIL_CHECK(expW_.capacity() == nx);
 
       // Fourier-space mesh sizes
       int nk = qk_.capacity();
-      UTIL_CHECK(expKsq_.capacity() == nk);
+      UTIL_CHECK(tablesPtr_);
+      UTIL_CHECK(tablesPtr_->expKsq().capacity() == nk);
+
+      switch (stepAlgorithm_) {
+      case StepAlgorithm::Strang:
+         stepStrang(q, qNew);
+         break;
+      case StepAlgorithm::Richardson:
+         stepRichardson(q, qNew);
+         break;
+      case StepAlgorithm::ETDRK4:
+         stepEtdrk4(q, qNew);
+         break;
+      default:
+         UTIL_THROW("Unknown step algorithm");
+      }
+   }
 
-      // Apply pseudo-spectral algorithm
+   /*
+   * Second-order Strang splitting step.
+   */
+   template <int D>
+   void Block<D>::stepStrang(const QField& q, QField& qNew)
+   {
+      int nx = mesh().size();
+      int nk = qk_.capacity();
+      RField<D> const & expW = tablesPtr_->expW();
+      RField<D> const & expKsq = tablesPtr_->expKsq();
+      double scale = 1.0/double(nx);
       int i;
+      PSPC_OMP_PARALLEL_FOR
       for (i = 0; i < nx; ++i) {
-         qr_[i] = q[i]*expW_[i];
-         qr2_[i] = q[i]*expW2_[i];
+         qr_[i] = q[i]*expW[i]*scale;
       }
-      fft_.forwardTransform(qr_, qk_);
-      fft_.forwardTransform(qr2_, qk2_);
+      fft_.forwardTransformUnscaled(qr_, qk_);
+      PSPC_OMP_PARALLEL_FOR
       for (i = 0; i < nk; ++i) {
-         qk_[i][0] *= expKsq_[i];
-         qk_[i][1] *= expKsq_[i];
-         qk2_[i][0] *= expKsq2_[i];
-         qk2_[i][1] *= expKsq2_[i];
+         qk_[i][0] *= expKsq[i];
+         qk_[i][1] *= expKsq[i];
       }
       fft_.inverseTransform(qk_, qr_);
-      fft_.inverseTransform(qk2_, qr2_);
+      PSPC_OMP_PARALLEL_FOR
       for (i = 0; i < nx; ++i) {
-         qf_[i] = qr_[i]*expW_[i];
-         qr2_[i] = qr2_[i]*expW_[i];
+         qNew[i] = qr_[i]*expW[i];
       }
+   }
 
-      fft_.forwardTransform(qr2_, qk2_);
+   /*
+   * Richardson extrapolation of one step of size ds and two of ds/2.
+   */
+   template <int D>
+   void Block<D>::stepRichardson(const QField& q, QField& qNew)
+   {
+      int nx = mesh().size();
+      int nk = qk_.capacity();
+      RField<D> const & expW = tablesPtr_->expW();
+      RField<D> const & expW2 = tablesPtr_->expW2();
+      RField<D> const & expKsq = tablesPtr_->expKsq();
+      RField<D> const & expKsq2 = tablesPtr_->expKsq2();
+      UTIL_CHECK(expW.capacity() == nx);
+      UTIL_CHECK(rBatch_.capacity() == 2*nx);
+
+      // The full step (ds) and the first half step (ds/2) are taken 
+      // together, using batched transforms of the pair of fields stored
+      // in rBatch_ and kBatch_ (full step first, half step second).
+      Real* r1 = &rBatch_[0];
+      Real* r2 = &rBatch_[nx];
+      FftwComplex* k1 = &kBatch_[0];
+      FftwComplex* k2 = &kBatch_[nk];
+
+      // Apply pseudo-spectral algorithm. Forward transforms are
+      // normalized by scaling their input in the preceding loops.
+      double scale = 1.0/double(nx);
+      int i;
+      PSPC_OMP_PARALLEL_FOR
+      for (i = 0; i < nx; ++i) {
+         r1[i] = q[i]*expW[i]*scale;
+         r2[i] = q[i]*expW2[i]*scale;
+      }
+      fftBatched_.forwardTransformUnscaled(rBatch_, kBatch_);
+      PSPC_OMP_PARALLEL_FOR
       for (i = 0; i < nk; ++i) {
-         qk2_[i][0] *= expKsq2_[i];
-         qk2_[i][1] *= expKsq2_[i];
+         k1[i][0] *= expKsq[i];
+         k1[i][1] *= expKsq[i];
+         k2[i][0] *= expKsq2[i];
+         k2[i][1] *= expKsq2[i];
       }
-      fft_.inverseTransform(qk2_, qr2_);
+      fftBatched_.inverseTransform(kBatch_, rBatch_);
+      PSPC_OMP_PARALLEL_FOR
       for (i = 0; i < nx; ++i) {
-         qr2_[i] = qr2_[i]*expW2_[i];
+         qf_[i] = r1[i]*expW[i];
+         qr2_[i] = r2[i]*expW[i]*scale;
       }
+
+      fft_.forwardTransformUnscaled(qr2_, qk2_);
+      PSPC_OMP_PARALLEL_FOR
+      for (i = 0; i < nk; ++i) {
+         qk2_[i][0] *= expKsq2[i];
+         qk2_[i][1] *= expKsq2[i];
+      }
+      fft_.inverseTransform(qk2_, qr2_);
+      PSPC_OMP_PARALLEL_FOR
       for (i = 0; i < nx; ++i) {
+         qr2_[i] = qr2_[i]*expW2[i];
          qNew[i] = (4.0*qr2_[i] - qf_[i])/3.0;
       }
    }
 
+   /*
+   * Fourth-order exponential time differencing Runge-Kutta step.
+   *
+   * Algorithm ETDRK4 of Cox and Matthews (J. Comput. Phys. 176, 430, 
+   * 2002) for dq/ds = Lq + N(q), with the linear operator L = b^2 
+   * Laplacian/6 applied exactly in Fourier space, and the nonlinear
+   * (here linear but non-diagonal) term N(q) = -w(r)q evaluated on the
+   * real space grid. In the notation of Cox and Matthews:
+   *
+   *   a = E2*u + Q*Nu
+   *   b = E2*u + Q*Na
+   *   c = E2*a + Q*(2*Nb - Nu)
+   *   u(s+ds) = E*u + F1*Nu + 2*F2*(Na + Nb) + F3*Nc
+   *
+   * where u is the Fourier transform of q, E = expKsq, E2 = expKsq2,
+   * and Q, F1-F3 are etdQ and etdF1-etdF3 of the operator tables. 
+   * Intermediate stages are recomputed rather than stored, because 
+   * complex-to-real transforms overwrite their input. Each forward 
+   * transform is normalized by scaling its input in the preceding loop.
+   */
+   template <int D>
+   void Block<D>::stepEtdrk4(const QField& q, QField& qNew)
+   {
+      int nx = mesh().size();
+      int nk = qk_.capacity();
+      RField<D> const & w = tablesPtr_->w();
+      RField<D> const & expKsq = tablesPtr_->expKsq();
+      RField<D> const & expKsq2 = tablesPtr_->expKsq2();
+      RField<D> const & etdQ = tablesPtr_->etdQ();
+      RField<D> const & etdF1 = tablesPtr_->etdF1();
+      RField<D> const & etdF2 = tablesPtr_->etdF2();
+      RField<D> const & etdF3 = tablesPtr_->etdF3();
+      UTIL_CHECK(w.capacity() == nx);
+      UTIL_CHECK(etdQ.capacity() == nk);
+      double scale = 1.0/double(nx);
+      int i;
+
+      // u and Nu are transformed together, using batched transforms
+      // of the pair of fields in rBatch_ and kBatch_
+      Real* r1 = &rBatch_[0];
+      Real* r2 = &rBatch_[nx];
+      FftwComplex* u = &kBatch_[0];
+      FftwComplex* nu = &kBatch_[nk];
+
+      // u = transform of q, nu = Nu = transform of -w*q
+      PSPC_OMP_PARALLEL_FOR
+      for (i = 0; i < nx; ++i) {
+         r1[i] = q[i]*scale;
+         r2[i] = -w[i]*q[i]*scale;
+      }
+      fftBatched_.forwardTransformUnscaled(rBatch_, kBatch_);
+
+      // qk4_ = a -> Na
+      PSPC_OMP_PARALLEL_FOR
+      for (i = 0; i < nk; ++i) {
+         for (int j = 0; j < 2; ++j) {
+            qk4_[i][j] = expKsq2[i]*u[i][j] + etdQ[i]*nu[i][j];
+         }
+      }
+      fft_.inverseTransform(qk4_, qr_);
+      PSPC_OMP_PARALLEL_FOR
+      for (i = 0; i < nx; ++i) {
+         qr_[i] = qr_[i]*(-w[i])*scale;
+      }
+      fft_.forwardTransformUnscaled(qr_, qk4_);
+
+      // qk3_ = E*u + F1*Nu + 2*F2*Na, then qk4_ = b -> Nb
+      PSPC_OMP_PARALLEL_FOR
+      for (i = 0; i < nk; ++i) {
+         for (int j = 0; j < 2; ++j) {
+            qk3_[i][j] = expKsq[i]*u[i][j] + etdF1[i]*nu[i][j]
+                       + 2.0*etdF2[i]*qk4_[i][j];
+            qk4_[i][j] = expKsq2[i]*u[i][j] + etdQ[i]*qk4_[i][j];
+         }
+      }
+      fft_.inverseTransform(qk4_, qr_);
+      PSPC_OMP_PARALLEL_FOR
+      for (i = 0; i < nx; ++i) {
+         qr_[i] = qr_[i]*(-w[i])*scale;
+      }
+      fft_.forwardTransformUnscaled(qr_, qk4_);
+
+      // qk3_ += 2*F2*Nb, then qk_ = c -> Nc 
+      PSPC_OMP_PARALLEL_FOR
+      for (i = 0; i < nk; ++i) {
+         for (int j = 0; j < 2; ++j) {
+            qk3_[i][j] += 2.0*etdF2[i]*qk4_[i][j];
+            double a = expKsq2[i]*u[i][j] + etdQ[i]*nu[i][j];
+            qk_[i][j] = expKsq2[i]*a
+                      + etdQ[i]*(2.0*qk4_[i][j] - nu[i][j]);
+         }
+      }
+      fft_.inverseTransform(qk_, qr_);
+      PSPC_OMP_PARALLEL_FOR
+      for (i = 0; i < nx; ++i) {
+         qr_[i] = qr_[i]*(-w[i])*scale;
+      }
+      fft_.forwardTransformUnscaled(qr_, qk_);
+
+      // qNew = inverse transform of qk3_ + F3*Nc
+      PSPC_OMP_PARALLEL_FOR
+      for (i = 0; i < nk; ++i) {
+         for (int j = 0; j < 2; ++j) {
+            qk3_[i][j] += etdF3[i]*qk_[i][j];
+         }
+      }
+      fft_.inverseTransform(qk3_, qNew);
+   }
+
 }
 }
 #endif
@@ -17,6 +17,7 @@
 
 namespace Pscf { 
    template <int D> class Mesh; 
+   template <int D> class Basis;
 }
  
 namespace Pscf {
@@ -77,7 +78,18 @@ namespace Pspc
       *
       * This function reads in a complete description of the structure of
       * all species and the composition of the mixture, as well as the
-      * target contour length step size ds.
+      * target contour length step size ds, an optional choice of
+      * contour step algorithm (stepAlgorithm, default Richardson), and
+      * an optional flag isSpeciesParallel (default false) that enables
+      * concurrent solution of different species, an optional flag
+      * isLevelParallel (default false) that enables concurrent solution
+      * of independent propagators of each polymer (see 
+      * PolymerTmpl::setIsLevelParallel), optional parameters
+      * checkpointInterval and propagatorMemory that control propagator 
+      * checkpointing (see Propagator), and an optional flag 
+      * isSingleStorage (default false) that enables streaming of one
+      * propagator per block where possible (see Block::setStreamDirection
+      * and PolymerTmpl::streamDirectionId).
       *
       * \param in input parameter stream
       */
@@ -105,6 +117,24 @@ namespace Pspc
       */
       void setupUnitCell(const UnitCell<D>& unitCell);
 
+      /**
+      * Associate a symmetry-adapted basis with every block.
+      *
+      * After this is called, computeStress uses sums over stars of the 
+      * basis rather than over all wavevectors (see Block::setBasis). 
+      * This requires that all w fields passed to compute be invariant
+      * under the space group. Must be called after setMesh, with a 
+      * basis constructed for the same mesh.
+      *
+      * \param basis  symmetry-adapted basis for the mesh
+      */
+      void setBasis(Basis<D> const & basis);
+
+      /**
+      * Remove association with a basis, so stress sums use all waves.
+      */
+      void clearBasis();
+
       /**
       * Compute partition functions and concentrations.
       *
@@ -123,6 +153,14 @@ namespace Pspc
       * The arrays wFields and cFields must each have capacity nMonomer(),
       * and contain fields that are indexed by monomer type index. 
       *
+      * If isSpeciesParallel() is true and OpenMP is enabled, the MDE 
+      * solutions for different species are computed concurrently, 
+      * using one thread per species at a time. Otherwise, species are
+      * solved one after another, and threads are used within each 
+      * solution. In either case, the sum over blocks is evaluated in
+      * parallel over grid points, in the same order for each point, so
+      * the result does not depend on the number of threads.
+      *
       * \param wFields array of chemical potential fields (input)
       * \param cFields array of monomer concentration fields (output)
       */
@@ -131,6 +169,10 @@ namespace Pspc
       
       /**
       * Compute derivatives of free energy w/ respect to cell parameters.
+      *
+      * Stress contributions of different species are computed 
+      * concurrently if isSpeciesParallel() is true and OpenMP is 
+      * enabled.
       */
       void computeStress();
 
@@ -152,6 +194,36 @@ namespace Pspc
       */
       double vMonomer() const;
 
+      /**
+      * Get the algorithm used to integrate one contour step.
+      */
+      StepAlgorithm::Type stepAlgorithm() const;
+
+      /**
+      * Are different species solved concurrently?
+      */
+      bool isSpeciesParallel() const;
+
+      /**
+      * Are independent propagators of each polymer solved concurrently?
+      */
+      bool isLevelParallel() const;
+
+      /**
+      * Get the propagator checkpoint interval parameter.
+      *
+      * A value of 1 indicates that all slices are stored, and 0 that an
+      * interval near sqrt(ns) is chosen separately for each block. If 
+      * a propagatorMemory budget was given, this is the interval chosen
+      * by setMesh to satisfy it.
+      */
+      int checkpointInterval() const;
+
+      /**
+      * Is one propagator of each block streamed, where possible?
+      */
+      bool isSingleStorage() const;
+
       // Inherited public member functions with non-dependent names
       using MixtureTmpl< Polymer<D>, Solvent<D> >::nMonomer;
       using MixtureTmpl< Polymer<D>, Solvent<D> >::nPolymer;
@@ -173,6 +245,30 @@ namespace Pspc
       /// Optimal contour length step size.
       double ds_;
 
+      /// Algorithm used to integrate one contour step.
+      StepAlgorithm::Type stepAlgorithm_;
+
+      /// If true, solve different species concurrently.
+      bool isSpeciesParallel_;
+
+      /// If true, solve independent propagators of a polymer concurrently.
+      bool isLevelParallel_;
+
+      /// Propagator checkpoint interval (1 = all, 0 = automatic).
+      int checkpointInterval_;
+
+      /// Propagator memory budget, in Mbytes (ignored if <= 0).
+      double propagatorMemory_;
+
+      /// If true, stream one propagator of each block, where possible.
+      bool isSingleStorage_;
+
+      /// Operator tables shared by blocks with the same (monomerId, kuhn, ds)
+      DArray< OperatorTables<D> > tables_;
+
+      /// Minimum images and |G|^2 of wavevectors, shared by all blocks
+      WaveList<D> waveList_;
+
       /// Array to store total stress
       FArray<double, 6> stress_;
 
@@ -185,6 +281,13 @@ namespace Pspc
       /// Return associated domain by reference.
       Mesh<D> const & mesh() const;
 
+      /**
+      * Choose the smallest checkpoint interval within propagatorMemory_.
+      *
+      * \param mesh spatial discretization mesh
+      */
+      int chooseCheckpointInterval(Mesh<D> const & mesh);
+
    };
 
    // Inline member function
@@ -194,6 +297,31 @@ namespace Pspc
    inline double Mixture<D>::vMonomer() const
    {  return vMonomer_; }
 
+   // Get contour step algorithm (public).
+   template <int D>
+   inline StepAlgorithm::Type Mixture<D>::stepAlgorithm() const
+   {  return stepAlgorithm_; }
+
+   // Are different species solved concurrently? (public).
+   template <int D>
+   inline bool Mixture<D>::isSpeciesParallel() const
+   {  return isSpeciesParallel_; }
+
+   // Are independent propagators of each polymer solved concurrently?
+   template <int D>
+   inline bool Mixture<D>::isLevelParallel() const
+   {  return isLevelParallel_; }
+
+   // Get propagator checkpoint interval (public).
+   template <int D>
+   inline int Mixture<D>::checkpointInterval() const
+   {  return checkpointInterval_; }
+
+   // Is one propagator of each block streamed, where possible? (public).
+   template <int D>
+   inline bool Mixture<D>::isSingleStorage() const
+   {  return isSingleStorage_; }
+
    // Stress with respect to unit cell parameter n.
    template <int D>
    inline double Mixture<D>::stress(int n) const
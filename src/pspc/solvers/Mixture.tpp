@@ -10,8 +10,12 @@
 
 #include "Mixture.h"
 #include <pscf/mesh/Mesh.h>
+#include <pspc/field/threads.h>
+#include <util/containers/GArray.h>
+#include <util/misc/Log.h>
 
 #include <cmath>
+#include <string>
 
 namespace Pscf {
 namespace Pspc
@@ -21,6 +25,12 @@ namespace Pspc
    Mixture<D>::Mixture()
     : vMonomer_(1.0),
       ds_(-1.0),
+      stepAlgorithm_(StepAlgorithm::Richardson),
+      isSpeciesParallel_(false),
+      isLevelParallel_(false),
+      checkpointInterval_(1),
+      propagatorMemory_(0.0),
+      isSingleStorage_(false),
       meshPtr_(0),
       unitCellPtr_(0)
    {  setClassName("Mixture"); }
@@ -36,7 +46,29 @@ namespace Pspc
       vMonomer_ = 1.0; // Default value
       readOptional(in, "vMonomer", vMonomer_);
       read(in, "ds", ds_);
+      stepAlgorithm_ = StepAlgorithm::Richardson; // Default value
+      readOptional(in, "stepAlgorithm", stepAlgorithm_);
+      isSpeciesParallel_ = false; // Default value
+      readOptional(in, "isSpeciesParallel", isSpeciesParallel_);
+      #ifndef PSPC_OPENMP
+      if (isSpeciesParallel_) {
+         Log::file() << "Warning: isSpeciesParallel ignored"
+                     << " (OpenMP not enabled)" << std::endl;
+      }
+      #endif
+      isLevelParallel_ = false; // Default value
+      readOptional(in, "isLevelParallel", isLevelParallel_);
+      for (int i = 0; i < nPolymer(); ++i) {
+         polymer(i).setIsLevelParallel(isLevelParallel_);
+      }
+      checkpointInterval_ = 1; // Default value
+      readOptional(in, "checkpointInterval", checkpointInterval_);
+      propagatorMemory_ = 0.0; // Default value (no budget)
+      readOptional(in, "propagatorMemory", propagatorMemory_);
+      isSingleStorage_ = false; // Default value
+      readOptional(in, "isSingleStorage", isSingleStorage_);
 
+      UTIL_CHECK(checkpointInterval_ >= 0);
       UTIL_CHECK(nMonomer() > 0);
       UTIL_CHECK(nPolymer()+ nSolvent() > 0);
       UTIL_CHECK(ds_ > 0);
@@ -51,14 +83,138 @@ namespace Pspc
 
       meshPtr_ = &mesh;
 
-      // Set discretization for all blocks
-      int i, j;
+      // Choose a checkpoint interval from the memory budget, if any
+      if (propagatorMemory_ > 0.0) {
+         checkpointInterval_ = chooseCheckpointInterval(mesh);
+         Log::file() << "Propagator checkpoint interval = " 
+                     << checkpointInterval_ << std::endl;
+      }
+
+      // Find distinct (monomerId, kuhn, ds) keys of all blocks
+      GArray<int> blockTableIds;
+      GArray<int> keyMonomerIds;
+      GArray<double> keyKuhns;
+      GArray<double> keyDs;
+      int i, j, k, monomerId, nKey;
+      double kuhn, ds;
+      for (i = 0; i < nPolymer(); ++i) {
+         for (j = 0; j < polymer(i).nBlock(); ++j) {
+            Block<D>& block = polymer(i).block(j);
+            monomerId = block.monomerId();
+            kuhn = block.kuhn();
+            ds = block.computeDs(ds_);
+            nKey = keyMonomerIds.size();
+            for (k = 0; k < nKey; ++k) {
+               if (keyMonomerIds[k] == monomerId && keyKuhns[k] == kuhn 
+                   && keyDs[k] == ds) break;
+            }
+            if (k == nKey) {
+               keyMonomerIds.append(monomerId);
+               keyKuhns.append(kuhn);
+               keyDs.append(ds);
+            }
+            blockTableIds.append(k);
+         }
+      }
+
+      // Allocate one set of shared operator tables for each key
+      nKey = keyMonomerIds.size();
+      if (tables_.isAllocated()) {
+         tables_.deallocate();
+      }
+      tables_.allocate(nKey);
+      for (k = 0; k < nKey; ++k) {
+         tables_[k].allocate(keyMonomerIds[k], keyKuhns[k], keyDs[k], 
+                             stepAlgorithm_, mesh);
+      }
+
+      // Allocate one wave list, shared by all blocks
+      waveList_.allocate(mesh);
+
+      // Set step algorithm, tables and discretization for all blocks
+      int blockId = 0;
+      for (i = 0; i < nPolymer(); ++i) {
+         for (j = 0; j < polymer(i).nBlock(); ++j) {
+            Block<D>& block = polymer(i).block(j);
+            block.setStepAlgorithm(stepAlgorithm_);
+            block.setCheckpointInterval(checkpointInterval_);
+            if (isSingleStorage_) {
+               block.setStreamDirection(polymer(i).streamDirectionId(j));
+            }
+            block.setOperatorTables(tables_[blockTableIds[blockId]]);
+            block.setWaveList(waveList_);
+            block.setDiscretization(ds_, mesh);
+            ++blockId;
+         }
+      }
+
+   }
+
+   /*
+   * Choose the smallest checkpoint interval that fits the memory budget.
+   */
+   template <int D>
+   int Mixture<D>::chooseCheckpointInterval(Mesh<D> const & mesh)
+   {
+      UTIL_CHECK(propagatorMemory_ > 0.0);
+      double sliceSize = double(mesh.size())*double(sizeof(Real));
+      double budget = propagatorMemory_*1048576.0;
+
+      // Find maximum number of contour grid points in any block
+      int i, j, nsMax;
+      nsMax = 2;
       for (i = 0; i < nPolymer(); ++i) {
          for (j = 0; j < polymer(i).nBlock(); ++j) {
-            polymer(i).block(j).setDiscretization(ds_, mesh);
+            int ns = polymer(i).block(j).computeNs(ds_);
+            if (ns > nsMax) nsMax = ns;
          }
       }
 
+      // Return the smallest interval that fits, if any
+      int interval, intervalMin;
+      double memory, memoryMin;
+      intervalMin = 1;
+      memoryMin = -1.0;
+      for (interval = 1; interval < nsMax; ++interval) {
+         memory = 0.0;
+         for (i = 0; i < nPolymer(); ++i) {
+            for (j = 0; j < polymer(i).nBlock(); ++j) {
+               Block<D>& block = polymer(i).block(j);
+               int ns = block.computeNs(ds_);
+               int streamId = -1;
+               if (isSingleStorage_) {
+                  streamId = polymer(i).streamDirectionId(j);
+               }
+               for (int k = 0; k < 2; ++k) {
+                  if (k == streamId) {
+                     // Head, tail and a rolling pair of slices
+                     memory += sliceSize*4;
+                  } else
+                  if (block.propagator(k).isAlias()) {
+                     // An alias stores only a segment buffer
+                     int c = (interval < ns - 1) ? interval : ns - 1;
+                     memory += sliceSize*(c - 1);
+                  } else {
+                     memory += sliceSize
+                               *Propagator<D>::nStoredSlice(ns, interval);
+                  }
+               }
+            }
+         }
+         if (memory <= budget) {
+            return interval;
+         }
+         if (memoryMin < 0.0 || memory < memoryMin) {
+            memoryMin = memory;
+            intervalMin = interval;
+         }
+      }
+
+      // Otherwise, use the interval that requires the least memory
+      Log::file() << "Warning: propagatorMemory budget cannot be met, "
+                  << "minimum is " << memoryMin/1048576.0 
+                  << " Mbytes" << std::endl;
+      return intervalMin;
    }
 
    template <int D>
@@ -68,9 +224,44 @@ namespace Pspc
       // Set association to unitCell
       unitCellPtr_ = &unitCell;
 
+      // Update shared wave list, before blocks and tables that use it
+      waveList_.setupUnitCell(unitCell);
+
       for (int i = 0; i < nPolymer(); ++i) {
          polymer(i).setupUnitCell(unitCell);
       }
+
+      // Update shared operator tables (once for each key)
+      for (int k = 0; k < tables_.capacity(); ++k) {
+         tables_[k].setupUnitCell(waveList_);
+      }
+   }
+
+   /*
+   * Associate a basis with all blocks, for star-reduced stress.
+   */
+   template <int D>
+   void Mixture<D>::setBasis(Basis<D> const & basis)
+   {
+      UTIL_CHECK(meshPtr_);
+      for (int i = 0; i < nPolymer(); ++i) {
+         for (int j = 0; j < polymer(i).nBlock(); ++j) {
+            polymer(i).block(j).setBasis(basis);
+         }
+      }
+   }
+
+   /*
+   * Remove association of all blocks with a basis.
+   */
+   template <int D>
+   void Mixture<D>::clearBasis()
+   {
+      for (int i = 0; i < nPolymer(); ++i) {
+         for (int j = 0; j < polymer(i).nBlock(); ++j) {
+            polymer(i).block(j).clearBasis();
+         }
+      }
    }
 
    /*
@@ -89,34 +280,77 @@ namespace Pspc
 
       int nx = mesh().size();
       int nm = nMonomer();
-      int i, j, k;
+      int np = nPolymer();
+      int i, j;
 
-      // Clear all monomer concentration fields
       for (i = 0; i < nm; ++i) {
          UTIL_CHECK(cFields[i].capacity() == nx);
          UTIL_CHECK(wFields[i].capacity() == nx);
-         for (j = 0; j < nx; ++j) {
-            cFields[i][j] = 0.0;
+      }
+      for (i = 0; i < np; ++i) {
+         for (j = 0; j < polymer(i).nBlock(); ++j) {
+            UTIL_CHECK(polymer(i).block(j).monomerId() >= 0);
+            UTIL_CHECK(polymer(i).block(j).monomerId() < nm);
          }
       }
 
-      // Solve MDE for all polymers
-      for (i = 0; i < nPolymer(); ++i) {
-         polymer(i).compute(wFields);
+      // Update shared operator tables (once for each key)
+      for (int k = 0; k < tables_.capacity(); ++k) {
+         tables_[k].setupSolver(wFields[tables_[k].monomerId()]);
       }
 
-      // Accumulate monomer concentration fields
-      double phi;
-      for (i = 0; i < nPolymer(); ++i) {
-         phi = polymer(i).phi();
-         for (j = 0; j < polymer(i).nBlock(); ++j) {
-            int monomerId = polymer(i).block(j).monomerId();
-            UTIL_CHECK(monomerId >= 0);
-            UTIL_CHECK(monomerId < nm);
-            CField& monomerField = cFields[monomerId];
-            CField& blockField = polymer(i).block(j).cField();
-            for (k = 0; k < nx; ++k) {
-               monomerField[k] += phi * blockField[k];
+      // Solve MDE for all polymers (concurrently if isSpeciesParallel_)
+      // Exceptions cannot leave a parallel region, so the message of
+      // the first failure is kept and rethrown after the loop.
+      int nFail = 0;
+      std::string failMessage;
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel for schedule(dynamic) reduction(+:nFail) \
+              if (isSpeciesParallel_)
+      #endif
+      for (int ip = 0; ip < np; ++ip) {
+         try {
+            polymer(ip).compute(wFields);
+         } catch (Exception& e) {
+            #ifdef PSPC_OPENMP
+            #pragma omp critical
+            #endif
+            {
+               if (failMessage.empty()) {
+                  failMessage = e.message();
+               }
+            }
+            ++nFail;
+         }
+      }
+      if (nFail > 0) {
+         UTIL_THROW(("Failure to solve polymer: " + failMessage).c_str());
+      }
+
+      // Clear and accumulate monomer concentration fields. Each thread
+      // handles the same range of grid points in every loop, so no 
+      // barrier is needed between loops.
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel
+      #endif
+      {
+         for (int im = 0; im < nm; ++im) {
+            CField& monomerField = cFields[im];
+            PSPC_OMP_FOR_NOWAIT
+            for (int k = 0; k < nx; ++k) {
+               monomerField[k] = 0.0;
+            }
+         }
+         for (int ip = 0; ip < np; ++ip) {
+            Polymer<D>& poly = polymer(ip);
+            double phi = poly.phi();
+            for (int jb = 0; jb < poly.nBlock(); ++jb) {
+               CField& monomerField = cFields[poly.block(jb).monomerId()];
+               CField const & blockField = poly.block(jb).cField();
+               PSPC_OMP_FOR_NOWAIT
+               for (int k = 0; k < nx; ++k) {
+                  monomerField[k] += phi * blockField[k];
+               }
             }
          }
       }
@@ -138,8 +372,32 @@ namespace Pspc
       }
 
       // Compute stress for all polymers, after solving MDE
-      for (i = 0; i < nPolymer(); ++i) {
-         polymer(i).computeStress();
+      int np = nPolymer();
+      // Exceptions cannot leave a parallel region, so the message of
+      // the first failure is kept and rethrown after the loop.
+      int nFail = 0;
+      std::string failMessage;
+      #ifdef PSPC_OPENMP
+      #pragma omp parallel for schedule(dynamic) reduction(+:nFail) \
+              if (isSpeciesParallel_)
+      #endif
+      for (int ip = 0; ip < np; ++ip) {
+         try {
+            polymer(ip).computeStress();
+         } catch (Exception& e) {
+            #ifdef PSPC_OPENMP
+            #pragma omp critical
+            #endif
+            {
+               if (failMessage.empty()) {
+                  failMessage = e.message();
+               }
+            }
+            ++nFail;
+         }
+      }
+      if (nFail > 0) {
+         UTIL_THROW(("Failure to compute polymer stress: " + failMessage).c_str());
       }
 
       // Accumulate stress for all the polymer chains
@@ -0,0 +1,18 @@
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "OperatorTables.tpp"
+
+namespace Pscf { 
+namespace Pspc {
+
+   template class OperatorTables<1>;
+   template class OperatorTables<2>;
+   template class OperatorTables<3>;
+
+}
+}
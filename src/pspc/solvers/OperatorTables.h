@@ -0,0 +1,224 @@
+#ifndef PSPC_OPERATOR_TABLES_H
+#define PSPC_OPERATOR_TABLES_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "StepAlgorithm.h"                // member
+#include "WaveList.h"                     // argument
+#include <pspc/field/RField.h>            // member
+#include <pscf/math/IntVec.h>             // member
+
+namespace Pscf {
+   template <int D> class Mesh;
+}
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+
+   /**
+   * Tables of exponential operators used to integrate the MDE.
+   *
+   * An OperatorTables<D> holds the arrays of Fourier-space factors
+   * exp(-K^2 b^2 ds/6) and real-space factors exp(-W ds/2) used by
+   * the contour step algorithms of Block<D>, together with any ETDRK4
+   * coefficients. These depend only on the monomer type (through W
+   * and the statistical segment length b), the contour step ds, the
+   * step algorithm and the unit cell. Blocks with the same values of
+   * these parameters can thus share one OperatorTables<D> object.
+   *
+   * Each Block<D> owns an OperatorTables<D> that it uses by default.
+   * A Mixture<D> instead creates one shared OperatorTables<D> object
+   * for each distinct (monomerId, kuhn, ds) key, and updates each of
+   * these shared tables only once per change in unit cell or w field.
+   *
+   * \ingroup Pspc_Solver_Module
+   */
+   template <int D>
+   class OperatorTables
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      */
+      OperatorTables();
+
+      /**
+      * Destructor.
+      */
+      ~OperatorTables();
+
+      /**
+      * Set key parameters and allocate all tables.
+      *
+      * \param monomerId  monomer type id
+      * \param kuhn  statistical segment length
+      * \param ds  contour step size
+      * \param algorithm  contour step algorithm
+      * \param mesh  spatial discretization mesh
+      */
+      void allocate(int monomerId, double kuhn, double ds,
+                    StepAlgorithm::Type algorithm, Mesh<D> const & mesh);
+
+      /**
+      * Change the contour step size of allocated tables.
+      *
+      * All tables must then be recomputed by setupUnitCell and 
+      * setupSolver before they are used.
+      *
+      * \param ds  contour step size
+      */
+      void setDs(double ds);
+
+      /**
+      * Compute Fourier-space tables for a new unit cell.
+      *
+      * \param waveList  values of |G|^2, updated for the new unit cell
+      */
+      void setupUnitCell(WaveList<D> const & waveList);
+
+      /**
+      * Compute real-space tables for a new w field.
+      *
+      * \param w  chemical potential field for this monomer type
+      */
+      void setupSolver(RField<D> const & w);
+
+      /**
+      * Do the key parameters match those given?
+      *
+      * \param monomerId  monomer type id
+      * \param kuhn  statistical segment length
+      * \param ds  contour step size
+      * \param algorithm  contour step algorithm
+      */
+      bool matches(int monomerId, double kuhn, double ds,
+                   StepAlgorithm::Type algorithm) const;
+
+      /// Array of elements containing exp(-K^2 b^2 ds/6).
+      RField<D> const & expKsq() const
+      {  return expKsq_; }
+
+      /// Array of elements containing exp(-K^2 b^2 ds/(6*2)).
+      RField<D> const & expKsq2() const
+      {  return expKsq2_; }
+
+      /// Array of elements containing exp(-W[i] ds/2).
+      RField<D> const & expW() const
+      {  return expW_; }
+
+      /// Array of elements containing exp(-W[i] (ds/2)*0.5).
+      RField<D> const & expW2() const
+      {  return expW2_; }
+
+      /// Copy of chemical potential field W (ETDRK4 only).
+      RField<D> const & w() const
+      {  return w_; }
+
+      /// ETDRK4 coefficient ds*(exp(z/2)-1)/z, with z = -K^2 b^2 ds/6.
+      RField<D> const & etdQ() const
+      {  return etdQ_; }
+
+      /// ETDRK4 coefficient ds*(-4-z+exp(z)(4-3z+z^2))/z^3.
+      RField<D> const & etdF1() const
+      {  return etdF1_; }
+
+      /// ETDRK4 coefficient ds*(2+z+exp(z)(z-2))/z^3.
+      RField<D> const & etdF2() const
+      {  return etdF2_; }
+
+      /// ETDRK4 coefficient ds*(-4-3z-z^2+exp(z)(4-z))/z^3.
+      RField<D> const & etdF3() const
+      {  return etdF3_; }
+
+      /// Monomer type id.
+      int monomerId() const
+      {  return monomerId_; }
+
+      /// Statistical segment length.
+      double kuhn() const
+      {  return kuhn_; }
+
+      /// Contour step size.
+      double ds() const
+      {  return ds_; }
+
+      /// Contour step algorithm.
+      StepAlgorithm::Type stepAlgorithm() const
+      {  return stepAlgorithm_; }
+
+      /// Have the tables been allocated?
+      bool isAllocated() const
+      {  return isAllocated_; }
+
+   private:
+
+      // Array of elements containing exp(-K^2 b^2 ds/6)
+      RField<D> expKsq_;
+
+      // Array of elements containing exp(-K^2 b^2 ds/(6*2))
+      RField<D> expKsq2_;
+
+      // Array of elements containing exp(-W[i] ds/2)
+      RField<D> expW_;
+
+      // Array of elements containing exp(-W[i] (ds/2)*0.5)
+      RField<D> expW2_;
+
+      // Copy of chemical potential field W[i] (ETDRK4 only)
+      RField<D> w_;
+
+      // ETDRK4 coefficients
+      RField<D> etdQ_;
+      RField<D> etdF1_;
+      RField<D> etdF2_;
+      RField<D> etdF3_;
+
+      /// Dimensions of real space mesh.
+      IntVec<D> meshDimensions_;
+
+      /// Dimensions of wavevector mesh in real-to-complex transform.
+      IntVec<D> kMeshDimensions_;
+
+      /// Monomer type id.
+      int monomerId_;
+
+      /// Statistical segment length.
+      double kuhn_;
+
+      /// Contour step size.
+      double ds_;
+
+      /// Contour step algorithm.
+      StepAlgorithm::Type stepAlgorithm_;
+
+      /// Have the tables been allocated?
+      bool isAllocated_;
+
+      /**
+      * Compute ETDRK4 coefficients for one wavevector.
+      *
+      * \param i  rank of wavevector in the k-space mesh
+      * \param z  value of -K^2 b^2 ds/6 for this wavevector
+      */
+      void setEtdCoefficients(int i, double z);
+
+   };
+
+   #ifndef PSPC_OPERATOR_TABLES_TPP
+   extern template class OperatorTables<1>;
+   extern template class OperatorTables<2>;
+   extern template class OperatorTables<3>;
+   #endif
+
+}
+}
+#endif
@@ -0,0 +1,221 @@
+#ifndef PSPC_OPERATOR_TABLES_TPP
+#define PSPC_OPERATOR_TABLES_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "OperatorTables.h"
+#include <pscf/mesh/Mesh.h>
+#include <pspc/field/threads.h>
+
+#include <complex>
+#include <cmath>
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+
+   /*
+   * Constructor.
+   */
+   template <int D>
+   OperatorTables<D>::OperatorTables()
+    : meshDimensions_(0),
+      kMeshDimensions_(0),
+      monomerId_(-1),
+      kuhn_(0.0),
+      ds_(0.0),
+      stepAlgorithm_(StepAlgorithm::Richardson),
+      isAllocated_(false)
+   {}
+
+   /*
+   * Destructor.
+   */
+   template <int D>
+   OperatorTables<D>::~OperatorTables()
+   {}
+
+   /*
+   * Set key parameters and allocate the tables needed by the algorithm.
+   */
+   template <int D>
+   void OperatorTables<D>::allocate(int monomerId, double kuhn, double ds,
+                                    StepAlgorithm::Type algorithm,
+                                    Mesh<D> const & mesh)
+   {
+      UTIL_CHECK(!isAllocated_);
+      UTIL_CHECK(ds > 0.0);
+      UTIL_CHECK(mesh.size() > 1);
+
+      monomerId_ = monomerId;
+      kuhn_ = kuhn;
+      ds_ = ds;
+      stepAlgorithm_ = algorithm;
+      meshDimensions_ = mesh.dimensions();
+      for (int i = 0; i < D; ++i) {
+         if (i < D - 1) {
+            kMeshDimensions_[i] = meshDimensions_[i];
+         } else {
+            kMeshDimensions_[i] = meshDimensions_[i]/2 + 1;
+         }
+      }
+
+      expKsq_.allocate(kMeshDimensions_);
+      if (algorithm == StepAlgorithm::Strang) {
+         expW_.allocate(meshDimensions_);
+      } else
+      if (algorithm == StepAlgorithm::Richardson) {
+         expW_.allocate(meshDimensions_);
+         expKsq2_.allocate(kMeshDimensions_);
+         expW2_.allocate(meshDimensions_);
+      } else
+      if (algorithm == StepAlgorithm::ETDRK4) {
+         expKsq2_.allocate(kMeshDimensions_);
+         w_.allocate(meshDimensions_);
+         etdQ_.allocate(kMeshDimensions_);
+         etdF1_.allocate(kMeshDimensions_);
+         etdF2_.allocate(kMeshDimensions_);
+         etdF3_.allocate(kMeshDimensions_);
+      }
+      isAllocated_ = true;
+   }
+
+   /*
+   * Change the contour step size.
+   */
+   template <int D>
+   void OperatorTables<D>::setDs(double ds)
+   {
+      UTIL_CHECK(isAllocated_);
+      UTIL_CHECK(ds > 0.0);
+      ds_ = ds;
+   }
+
+   /*
+   * Compute Fourier-space tables, which depend on the unit cell.
+   */
+   template <int D>
+   void OperatorTables<D>::setupUnitCell(WaveList<D> const & waveList)
+   {
+      UTIL_CHECK(isAllocated_);
+      UTIL_CHECK(waveList.hasKSq());
+      UTIL_CHECK(waveList.kMeshDimensions() == kMeshDimensions_);
+
+      RField<D> const & kSq = waveList.kSq();
+      int nk = waveList.kSize();
+      double factor = -1.0*kuhn_*kuhn_*ds_/6.0;
+      bool hasHalfStep = (stepAlgorithm_ != StepAlgorithm::Strang);
+      bool isEtdrk4 = (stepAlgorithm_ == StepAlgorithm::ETDRK4);
+      PSPC_OMP_PARALLEL_FOR
+      for (int i = 0; i < nk; ++i) {
+         double Gsq = kSq[i];
+         expKsq_[i] = exp(Gsq*factor);
+         if (hasHalfStep) {
+            expKsq2_[i] = exp(Gsq*factor*0.5);
+         }
+         if (isEtdrk4) {
+            setEtdCoefficients(i, Gsq*factor);
+         }
+      }
+   }
+
+   /*
+   * Compute real-space tables, which depend on the w field.
+   *
+   * Each loop evaluates a single exponential of a contiguous array,
+   * with no branches, so that the compiler may vectorize it.
+   */
+   template <int D>
+   void OperatorTables<D>::setupSolver(RField<D> const & w)
+   {
+      UTIL_CHECK(isAllocated_);
+      int nx = w.capacity();
+      int i;
+      if (stepAlgorithm_ == StepAlgorithm::Strang) {
+         UTIL_CHECK(expW_.capacity() == nx);
+         double factor = -0.5*ds_;
+         PSPC_OMP_PARALLEL_FOR
+         for (i = 0; i < nx; ++i) {
+            expW_[i] = exp(factor*w[i]);
+         }
+      } else
+      if (stepAlgorithm_ == StepAlgorithm::Richardson) {
+         UTIL_CHECK(expW_.capacity() == nx);
+         double factor = -0.5*ds_;
+         double factor2 = -0.5*0.5*ds_;
+         PSPC_OMP_PARALLEL_FOR
+         for (i = 0; i < nx; ++i) {
+            expW_[i] = exp(factor*w[i]);
+         }
+         PSPC_OMP_PARALLEL_FOR
+         for (i = 0; i < nx; ++i) {
+            expW2_[i] = exp(factor2*w[i]);
+         }
+      } else
+      if (stepAlgorithm_ == StepAlgorithm::ETDRK4) {
+         UTIL_CHECK(w_.capacity() == nx);
+         PSPC_OMP_PARALLEL_FOR
+         for (i = 0; i < nx; ++i) {
+            w_[i] = w[i];
+         }
+      }
+   }
+
+   /*
+   * Do the key parameters match?
+   */
+   template <int D>
+   bool OperatorTables<D>::matches(int monomerId, double kuhn, double ds,
+                                   StepAlgorithm::Type algorithm) const
+   {
+      return (monomerId == monomerId_ && kuhn == kuhn_
+              && ds == ds_ && algorithm == stepAlgorithm_);
+   }
+
+   /*
+   * Compute ETDRK4 coefficients for one wavevector.
+   *
+   * Uses the contour integral method of Kassam and Trefethen (SIAM
+   * J. Sci. Comput. 26, 1214, 2005) to avoid cancellation errors for
+   * small |z|: Each coefficient function is averaged over nPoint
+   * points on a semicircle of unit radius centered on z in the upper
+   * half of the complex plane, and the real part is retained.
+   */
+   template <int D>
+   void OperatorTables<D>::setEtdCoefficients(int i, double z)
+   {
+      const int nPoint = 32;
+      const double pi = 3.14159265358979323846;
+      std::complex<double> zr, ez, ez2, zr3;
+      std::complex<double> q(0.0, 0.0);
+      std::complex<double> f1(0.0, 0.0);
+      std::complex<double> f2(0.0, 0.0);
+      std::complex<double> f3(0.0, 0.0);
+      double theta;
+      for (int j = 0; j < nPoint; ++j) {
+         theta = pi*(double(j) + 0.5)/double(nPoint);
+         zr = z + std::complex<double>(cos(theta), sin(theta));
+         ez = exp(zr);
+         ez2 = exp(0.5*zr);
+         zr3 = zr*zr*zr;
+         q  += (ez2 - 1.0)/zr;
+         f1 += (-4.0 - zr + ez*(4.0 - 3.0*zr + zr*zr))/zr3;
+         f2 += (2.0 + zr + ez*(zr - 2.0))/zr3;
+         f3 += (-4.0 - 3.0*zr - zr*zr + ez*(4.0 - zr))/zr3;
+      }
+      double scale = ds_/double(nPoint);
+      etdQ_[i]  = scale*q.real();
+      etdF1_[i] = scale*f1.real();
+      etdF2_[i] = scale*f2.real();
+      etdF3_[i] = scale*f3.real();
+   }
+
+}
+}
+#endif
@@ -127,6 +127,7 @@ namespace Pspc {
    protected:
 
       using ParamComposite::setClassName;
+      using Base::setIsAliasEnabled;
 
    private: 
 
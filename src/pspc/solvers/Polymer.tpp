@@ -15,7 +15,10 @@ namespace Pspc {
 
    template <int D>
    Polymer<D>::Polymer()
-   {  setClassName("Polymer");}
+   {  
+      setClassName("Polymer");
+      setIsAliasEnabled(true);
+   }
 
    template <int D>
    Polymer<D>::~Polymer()
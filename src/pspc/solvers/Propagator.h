@@ -25,6 +25,28 @@ namespace Pspc
    /**
    * MDE solver for one-direction of one block.
    *
+   * By default, a Propagator stores the q-field at every one of the ns
+   * contour grid points of its block. If a checkpoint interval c > 1 is
+   * passed to allocate(), the propagator instead stores only the head,
+   * the tail, and every c-th slice (the checkpoints), plus a buffer of
+   * c - 1 slices. Slices between checkpoints are then recomputed from
+   * the nearest preceding checkpoint, one segment of c steps at a time,
+   * when they are requested through the slice() function. Choosing c 
+   * near sqrt(ns) reduces memory use from ns to about 2 sqrt(ns) slices,
+   * at the cost of about one extra MDE solution per traversal.
+   *
+   * A Propagator that is an alias of an equivalent propagator (see
+   * PropagatorTmpl::setAlias) stores no slices of its own, except for
+   * the segment buffer in checkpoint mode, and returns slices of the
+   * aliased propagator from head(), tail(), q() and slice().
+   *
+   * A "streamed" Propagator (see allocate) stores only its head, its
+   * tail and a rolling pair of slices. Each slice is passed to the
+   * Block::accumulateConcentration function as soon as it is computed,
+   * which requires that the partner propagator already be solved. 
+   * Slices requested later through slice() are recomputed from the 
+   * head, and are most efficiently traversed in order of increasing i.
+   *
    * \ingroup Pspc_Solver_Module
    */
    template <int D>
@@ -79,8 +101,11 @@ namespace Pspc
       * 
       * \param ns number of contour length steps
       * \param mesh spatial discretization mesh
+      * \param interval checkpoint interval (1 = store all slices)
+      * \param isStreamed store only the head, tail and two other slices
       */ 
-      void allocate(int ns, const Mesh<D>& mesh);
+      void allocate(int ns, const Mesh<D>& mesh, int interval = 1, 
+                    bool isStreamed = false);
 
       /**
       * Solve the modified diffusion equation (MDE) for this block.
@@ -117,10 +142,31 @@ namespace Pspc
       /**
       * Return q-field at specified step.
       *
+      * This function may only be used if all slices are stored, i.e.,
+      * if checkpointInterval() == 1 and !isStreamed(). Otherwise, use 
+      * slice().
+      *
       * \param i step index
       */
       const QField& q(int i) const;
 
+      /**
+      * Return q-field at specified step, recomputing it if necessary.
+      *
+      * If all slices are stored, this returns q(i). Otherwise, it 
+      * recomputes the segment of slices containing step i from the 
+      * preceding checkpoint (unless that segment is already in the
+      * buffer) and returns a reference into the buffer, which remains
+      * valid only until the next call to this function. Slices are 
+      * thus most efficiently traversed in order of increasing or 
+      * decreasing i. Recomputation uses the current state of the
+      * associated Block solver, so this must be called before the
+      * next call to Block::setupSolver.
+      *
+      * \param i step index
+      */
+      const QField& slice(int i);
+
       /**
       * Return q-field at beginning of block (initial condition).
       */
@@ -141,6 +187,24 @@ namespace Pspc
       */
       bool isAllocated() const;
 
+      /**
+      * Get the checkpoint interval (1 if all slices are stored).
+      */
+      int checkpointInterval() const;
+
+      /**
+      * Is this a streamed propagator?
+      */
+      bool isStreamed() const;
+
+      /**
+      * Number of QField slices stored for a given ns and interval.
+      *
+      * \param ns number of contour grid points
+      * \param interval checkpoint interval
+      */
+      static int nStoredSlice(int ns, int interval);
+
       // Inherited public functions with non-dependent names
 
       using PropagatorTmpl< Propagator<D> >::nSource;
@@ -149,6 +213,8 @@ namespace Pspc
       using PropagatorTmpl< Propagator<D> >::setIsSolved;
       using PropagatorTmpl< Propagator<D> >::isSolved;
       using PropagatorTmpl< Propagator<D> >::hasPartner;
+      using PropagatorTmpl< Propagator<D> >::isAlias;
+      using PropagatorTmpl< Propagator<D> >::alias;
 
    protected:
 
@@ -159,9 +225,16 @@ namespace Pspc
 
    private:
      
-      // Array of statistical weight fields 
+      // Array of statistical weight fields (all slices, or checkpoints)
       DArray<QField> qFields_;
 
+      // Tail slice (used only if interval_ > 1 or isStreamed_)
+      QField tail_;
+
+      // Buffer for slices between checkpoints (if interval_ > 1), or
+      // rolling pair of slices (if isStreamed_)
+      DArray<QField> segment_;
+
       // Workspace
       QField work_;
 
@@ -174,9 +247,35 @@ namespace Pspc
       /// Number of contour length steps = # grid points - 1.
       int ns_;
 
+      /// Checkpoint interval (1 if all slices are stored).
+      int interval_;
+
+      /// Index of segment held in segment_ buffer (-1 if none), or 
+      /// index of the last slice computed in the buffer if isStreamed_.
+      int segmentId_;
+
+      /// Number of times the MDE has been solved (incremented by propagate).
+      int solveId_;
+
+      /// Value of solveId_ of the storing propagator for segment_ contents.
+      int segmentSolveId_;
+
+      /// Is this a streamed propagator?
+      bool isStreamed_;
+
       /// Is this propagator allocated?
       bool isAllocated_;
 
+      /**
+      * Integrate the MDE from the head slice to the tail.
+      */
+      void propagate();
+
+      /**
+      * Integrate the MDE, accumulating the block concentration.
+      */
+      void propagateStreamed();
+
    };
 
    // Inline member functions
@@ -187,7 +286,7 @@ namespace Pspc
    template <int D>
    inline 
    typename Propagator<D>::QField const& Propagator<D>::head() const
-   {  return qFields_[0]; }
+   {  return isAlias() ? alias().head() : qFields_[0]; }
 
    /*
    * Return q-field at end of block, after solution.
@@ -195,7 +294,10 @@ namespace Pspc
    template <int D>
    inline 
    typename Propagator<D>::QField const& Propagator<D>::tail() const
-   {  return qFields_[ns_-1]; }
+   {
+      if (isAlias()) return alias().tail();
+      return (interval_ > 1 || isStreamed_) ? tail_ : qFields_[ns_-1]; 
+   }
 
    /*
    * Return q-field at specified step.
@@ -203,7 +305,11 @@ namespace Pspc
    template <int D>
    inline 
    typename Propagator<D>::QField const& Propagator<D>::q(int i) const
-   {  return qFields_[i]; }
+   {
+      UTIL_ASSERT(interval_ == 1);
+      UTIL_ASSERT(!isStreamed_);
+      return isAlias() ? alias().q(i) : qFields_[i]; 
+   }
 
    /*
    * Get the associated Block object.
@@ -221,6 +327,16 @@ namespace Pspc
    bool Propagator<D>::isAllocated() const
    {  return isAllocated_; }
 
+   template <int D>
+   inline 
+   int Propagator<D>::checkpointInterval() const
+   {  return interval_; }
+
+   template <int D>
+   inline 
+   bool Propagator<D>::isStreamed() const
+   {  return isStreamed_; }
+
    /*
    * Associate this propagator with a block and direction
    */
@@ -26,6 +26,11 @@ namespace Pspc {
     : blockPtr_(0),
       meshPtr_(0),
       ns_(0),
+      interval_(1),
+      segmentId_(-1),
+      solveId_(0),
+      segmentSolveId_(-1),
+      isStreamed_(false),
       isAllocated_(false)
    {}
 
@@ -36,19 +41,82 @@ namespace Pspc {
    Propagator<D>::~Propagator()
    {}
 
+   /*
+   * Allocate all slices, or only checkpoints, tail and segment buffer,
+   * or only head, tail and a rolling pair of slices.
+   */
    template <int D>
-   void Propagator<D>::allocate(int ns, const Mesh<D>& mesh)
+   void Propagator<D>::allocate(int ns, const Mesh<D>& mesh, int interval,
+                                bool isStreamed)
    {
+      UTIL_CHECK(ns > 1);
+      UTIL_CHECK(interval > 0);
       ns_ = ns;
       meshPtr_ = &mesh;
+      isStreamed_ = isStreamed;
 
-      qFields_.allocate(ns);
-      for (int i = 0; i < ns; ++i) {
-         qFields_[i].allocate(mesh.dimensions());
+      // Interval ns - 1 already stores every slice once
+      interval_ = (interval < ns - 1) ? interval : ns - 1;
+      if (isStreamed_) {
+         UTIL_CHECK(!isAlias());
+         interval_ = 1;
+         qFields_.allocate(1);
+         qFields_[0].allocate(mesh.dimensions());
+         tail_.allocate(mesh.dimensions());
+         segment_.allocate(2);
+         for (int i = 0; i < 2; ++i) {
+            segment_[i].allocate(mesh.dimensions());
+         }
+      } else
+      if (isAlias()) {
+         // Slices are stored by the aliased propagator
+         if (alias().isAllocated()) {
+            UTIL_CHECK(alias().ns_ == ns_);
+            UTIL_CHECK(alias().interval_ == interval_);
+         }
+         if (interval_ > 1) {
+            segment_.allocate(interval_ - 1);
+            for (int i = 0; i < interval_ - 1; ++i) {
+               segment_[i].allocate(mesh.dimensions());
+            }
+         }
+      } else
+      if (interval_ == 1) {
+         qFields_.allocate(ns);
+         for (int i = 0; i < ns; ++i) {
+            qFields_[i].allocate(mesh.dimensions());
+         }
+      } else {
+         int nCheckpoint = (ns - 2)/interval_ + 1;
+         qFields_.allocate(nCheckpoint);
+         for (int i = 0; i < nCheckpoint; ++i) {
+            qFields_[i].allocate(mesh.dimensions());
+         }
+         tail_.allocate(mesh.dimensions());
+         segment_.allocate(interval_ - 1);
+         for (int i = 0; i < interval_ - 1; ++i) {
+            segment_[i].allocate(mesh.dimensions());
+         }
       }
+      segmentId_ = -1;
       isAllocated_ = true;
    }
 
+   /*
+   * Number of slices stored for given ns and checkpoint interval.
+   */
+   template <int D>
+   int Propagator<D>::nStoredSlice(int ns, int interval)
+   {
+      UTIL_CHECK(ns > 1);
+      UTIL_CHECK(interval > 0);
+      if (interval >= ns - 1 || interval == 1) {
+         return ns;
+      }
+      // Checkpoints, tail, and segment buffer
+      return (ns - 2)/interval + 1 + 1 + (interval - 1);
+   }
+
    /*
    * Compute initial head QField from final tail QFields of sources.
    */
@@ -85,9 +153,12 @@ namespace Pspc {
    void Propagator<D>::solve()
    {
       UTIL_CHECK(isAllocated());
+      UTIL_CHECK(!isAlias());
       computeHead();
-      for (int iStep = 0; iStep < ns_ - 1; ++iStep) {
-         block().step(qFields_[iStep], qFields_[iStep + 1]);
+      if (isStreamed_) {
+         propagateStreamed();
+      } else {
+         propagate();
       }
       setIsSolved(true);
    }
@@ -100,6 +171,7 @@ namespace Pspc {
    {
       int nx = meshPtr_->size();
       UTIL_CHECK(head.capacity() == nx);
+      UTIL_CHECK(!isAlias());
 
       // Initialize initial (head) field
       QField& qh = qFields_[0];
@@ -107,13 +179,140 @@ namespace Pspc {
          qh[i] = head[i];
       }
 
-      // Setup solver and solve
-      for (int iStep = 0; iStep < ns_ - 1; ++iStep) {
-         block().step(qFields_[iStep], qFields_[iStep + 1]);
+      if (isStreamed_) {
+         propagateStreamed();
+      } else {
+         propagate();
       }
       setIsSolved(true);
    }
 
+   /*
+   * Integrate the MDE from head to tail, storing slices or checkpoints.
+   */
+   template <int D>
+   void Propagator<D>::propagate()
+   {
+      ++solveId_;
+      if (interval_ == 1) {
+         for (int iStep = 0; iStep < ns_ - 1; ++iStep) {
+            block().step(qFields_[iStep], qFields_[iStep + 1]);
+         }
+         return;
+      }
+
+      // Step through checkpoints, using segment_ for other slices
+      QField const * qPtr = &qFields_[0];
+      QField* qNewPtr;
+      int i, r;
+      for (i = 1; i < ns_; ++i) {
+         r = i % interval_;
+         if (i == ns_ - 1) {
+            qNewPtr = &tail_;
+         } else
+         if (r == 0) {
+            qNewPtr = &qFields_[i/interval_];
+         } else {
+            qNewPtr = &segment_[r - 1];
+         }
+         block().step(*qPtr, *qNewPtr);
+         qPtr = qNewPtr;
+      }
+
+      // The buffer now holds the last segment
+      segmentId_ = (ns_ - 2)/interval_;
+      segmentSolveId_ = solveId_;
+   }
+
+   /*
+   * Integrate the MDE from head to tail, keeping only a rolling pair of
+   * slices, and pass each slice to the block as it is computed.
+   */
+   template <int D>
+   void Propagator<D>::propagateStreamed()
+   {
+      ++solveId_;
+      Block<D>& b = block();
+      int directionId = (&b.propagator(0) == this) ? 0 : 1;
+      b.accumulateConcentration(directionId, 0, qFields_[0]);
+      QField const * qPtr = &qFields_[0];
+      QField* qNewPtr;
+      for (int i = 1; i < ns_; ++i) {
+         qNewPtr = (i == ns_ - 1) ? &tail_ : &segment_[i % 2];
+         b.step(*qPtr, *qNewPtr);
+         b.accumulateConcentration(directionId, i, *qNewPtr);
+         qPtr = qNewPtr;
+      }
+      segmentId_ = ns_ - 2;
+      segmentSolveId_ = solveId_;
+   }
+
+   /*
+   * Return slice i, recomputing its segment from a checkpoint if needed.
+   */
+   template <int D>
+   typename Propagator<D>::QField const& Propagator<D>::slice(int i)
+   {
+      UTIL_CHECK(i >= 0 && i < ns_);
+
+      // Streamed: Step forward from the last slice in the rolling 
+      // pair if it precedes slice i, or otherwise from the head.
+      if (isStreamed_) {
+         if (i == 0) {
+            return qFields_[0];
+         }
+         if (i == ns_ - 1) {
+            return tail_;
+         }
+         if (segmentSolveId_ != solveId_ || segmentId_ > i) {
+            segmentId_ = 0;
+            segmentSolveId_ = solveId_;
+         }
+         QField const * qPtr;
+         while (segmentId_ < i) {
+            if (segmentId_ == 0) {
+               qPtr = &qFields_[0];
+            } else {
+               qPtr = &segment_[segmentId_ % 2];
+            }
+            block().step(*qPtr, segment_[(segmentId_ + 1) % 2]);
+            ++segmentId_;
+         }
+         return segment_[i % 2];
+      }
+
+      // Checkpoints are stored by the aliased propagator, if any, but
+      // segments are recomputed in the buffer of this one.
+      DArray<QField> const & checkpoints 
+                            = isAlias() ? alias().qFields_ : qFields_;
+      int solveId = isAlias() ? alias().solveId_ : solveId_;
+      if (interval_ == 1) {
+         return checkpoints[i];
+      }
+      if (i == ns_ - 1) {
+         return tail();
+      }
+      int k = i/interval_;
+      int r = i % interval_;
+      if (r == 0) {
+         return checkpoints[k];
+      }
+      if (k != segmentId_ || segmentSolveId_ != solveId) {
+         int begin = k*interval_;
+         int end = begin + interval_;
+         if (end > ns_ - 1) {
+            end = ns_ - 1;
+         }
+         block().step(checkpoints[k], segment_[0]);
+         for (int j = begin + 2; j < end; ++j) {
+            block().step(segment_[j - begin - 2], segment_[j - begin - 1]);
+         }
+         segmentId_ = k;
+         segmentSolveId_ = solveId;
+      }
+      return segment_[r - 1];
+   }
+
    /*
    * Integrate to calculate monomer concentration for this block
    */
@@ -137,9 +336,10 @@ namespace Pspc {
       UTIL_CHECK(qh.capacity() == nx);
 
       // Take inner product of head and partner tail fields
+      // (in double precision, even if fields are single precision)
       double Q = 0;
       for (int i =0; i < nx; ++i) {
-         Q += qh[i]*qt[i];
+         Q += double(qh[i])*double(qt[i]);
       }
       Q /= double(nx);
       return Q;
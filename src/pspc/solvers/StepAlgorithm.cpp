@@ -0,0 +1,59 @@
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "StepAlgorithm.h"
+#include <string>
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+
+   /*
+   * Extract a StepAlgorithm::Type from an istream as a string.
+   */
+   std::istream& operator >> (std::istream& in,
+                              StepAlgorithm::Type& algorithm)
+   {
+      std::string buffer;
+      in >> buffer;
+      if (buffer == "Strang" || buffer == "strang") {
+         algorithm = StepAlgorithm::Strang;
+      } else
+      if (buffer == "Richardson" || buffer == "richardson") {
+         algorithm = StepAlgorithm::Richardson;
+      } else
+      if (buffer == "ETDRK4" || buffer == "etdrk4") {
+         algorithm = StepAlgorithm::ETDRK4;
+      } else {
+         UTIL_THROW("Invalid StepAlgorithm::Type string in operator >>");
+      }
+      return in;
+   }
+
+   /*
+   * Insert a StepAlgorithm::Type to an ostream as a string.
+   */
+   std::ostream& operator << (std::ostream& out,
+                              StepAlgorithm::Type algorithm)
+   {
+      if (algorithm == StepAlgorithm::Strang) {
+         out << "Strang";
+      } else
+      if (algorithm == StepAlgorithm::Richardson) {
+         out << "Richardson";
+      } else
+      if (algorithm == StepAlgorithm::ETDRK4) {
+         out << "ETDRK4";
+      } else {
+         UTIL_THROW("Unrecognized value for StepAlgorithm::Type");
+      }
+      return out;
+   }
+
+}
+}
@@ -0,0 +1,83 @@
+#ifndef PSPC_STEP_ALGORITHM_H
+#define PSPC_STEP_ALGORITHM_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <util/global.h>
+#include <iostream>
+
+namespace Pscf {
+namespace Pspc {
+
+   /**
+   * Algorithm used to integrate the MDE over one contour step.
+   *
+   * The allowed values of StepAlgorithm::Type are:
+   *
+   *  - Strang: Second-order operator splitting, with a half step in
+   *    the field term on either side of a full step in the Laplacian
+   *    term. Requires 2 FFTs per contour step.
+   *
+   *  - Richardson: Fourth-order Richardson extrapolation of the Strang
+   *    scheme, using one step of size ds and two steps of size ds/2.
+   *    Requires 6 FFTs per contour step. This is the default.
+   *
+   *  - ETDRK4: Fourth-order exponential time differencing Runge-Kutta
+   *    scheme of Cox and Matthews, with coefficients evaluated by the
+   *    contour integral method of Kassam and Trefethen. Requires 9
+   *    FFTs per contour step, but has a much smaller error prefactor,
+   *    and so allows a larger ds for a specified accuracy.
+   *
+   * \ingroup Pspc_Solver_Module
+   */
+   class StepAlgorithm
+   {
+   public:
+
+      /**
+      * Enumeration of contour step algorithms.
+      */
+      enum Type {Strang, Richardson, ETDRK4};
+
+   };
+
+   /**
+   * istream extractor for a StepAlgorithm::Type.
+   *
+   * \param  in  input stream
+   * \param  algorithm  StepAlgorithm::Type to be read
+   * \return modified input stream
+   */
+   std::istream& operator >> (std::istream& in,
+                              StepAlgorithm::Type& algorithm);
+
+   /**
+   * ostream inserter for a StepAlgorithm::Type.
+   *
+   * \param  out  output stream
+   * \param  algorithm  StepAlgorithm::Type to be written
+   * \return modified output stream
+   */
+   std::ostream& operator << (std::ostream& out,
+                              StepAlgorithm::Type algorithm);
+
+   /**
+   * Serialize a StepAlgorithm::Type.
+   *
+   * \param ar  archive object
+   * \param algorithm  object to be serialized
+   * \param version  archive version id
+   */
+   template <class Archive>
+   void serialize(Archive& ar, StepAlgorithm::Type& algorithm,
+                  const unsigned int version)
+   {  serializeEnum(ar, algorithm, version); }
+
+}
+}
+#endif
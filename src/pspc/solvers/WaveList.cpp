@@ -0,0 +1,18 @@
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "WaveList.tpp"
+
+namespace Pscf { 
+namespace Pspc {
+
+   template class WaveList<1>;
+   template class WaveList<2>;
+   template class WaveList<3>;
+
+}
+}
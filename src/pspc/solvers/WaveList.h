@@ -0,0 +1,160 @@
+#ifndef PSPC_WAVE_LIST_H
+#define PSPC_WAVE_LIST_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <pspc/field/RField.h>            // member
+#include <pscf/crystal/MinimumImage.h>    // member
+#include <pscf/math/IntVec.h>             // member
+#include <util/containers/DArray.h>       // member
+#include <util/containers/FArray.h>       // member
+
+namespace Pscf {
+   template <int D> class Mesh;
+   template <int D> class UnitCell;
+}
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+
+   /**
+   * Minimum images and |G|^2 of all wavevectors of a k-space mesh.
+   *
+   * A WaveList<D> stores the minimum image of each wavevector in the
+   * k-space mesh of a real-to-complex transform, and contiguous arrays
+   * of the square magnitude |G|^2 of each image and of its derivatives
+   * with respect to each unit cell parameter. These are used to compute
+   * the Fourier-space operator tables (OperatorTables<D>) and the stress
+   * (Block<D>). This is the analog of Pspg::WaveList.
+   *
+   * Minimum images are found by a MinimumImage<D> object. They depend
+   * on the mesh alone if the reciprocal basis vectors are orthogonal,
+   * and are then computed only once. Otherwise, they are recomputed
+   * along with |G|^2 after each change in unit cell parameters.
+   *
+   * Each Block<D> owns a WaveList<D> that it uses by default. A
+   * Mixture<D> instead creates one WaveList<D> that is shared by all
+   * blocks, and updates it once per change in unit cell.
+   *
+   * \ingroup Pspc_Solver_Module
+   */
+   template <int D>
+   class WaveList
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      */
+      WaveList();
+
+      /**
+      * Destructor.
+      */
+      ~WaveList();
+
+      /**
+      * Allocate memory for all arrays.
+      *
+      * \param mesh  spatial discretization mesh
+      */
+      void allocate(Mesh<D> const & mesh);
+
+      /**
+      * Compute minimum images (if needed), |G|^2 and its derivatives.
+      *
+      * \param unitCell  unit cell, defining cell dimensions
+      */
+      void setupUnitCell(UnitCell<D> const & unitCell);
+
+      /**
+      * Get the minimum image of a wavevector.
+      *
+      * \param i  rank of wavevector in the k-space mesh
+      */
+      IntVec<D> const & minImage(int i) const
+      {  return minImages_[i]; }
+
+      /// Array of values of |G|^2, indexed by rank in k-space mesh.
+      RField<D> const & kSq() const
+      {  return kSq_; }
+
+      /**
+      * Array of derivatives of |G|^2 with respect to a cell parameter.
+      *
+      * \param n  index of unit cell parameter
+      */
+      RField<D> const & dkSq(int n) const
+      {  return dkSq_[n]; }
+
+      /// Dimensions of wavevector mesh in real-to-complex transform.
+      IntVec<D> const & kMeshDimensions() const
+      {  return kMeshDimensions_; }
+
+      /// Number of wavevectors in the k-space mesh.
+      int kSize() const
+      {  return kSize_; }
+
+      /// Has memory been allocated?
+      bool isAllocated() const
+      {  return isAllocated_; }
+
+      /// Have values been computed for a unit cell?
+      bool hasKSq() const
+      {  return hasKSq_; }
+
+   private:
+
+      // Minimum images of wavevectors
+      DArray< IntVec<D> > minImages_;
+
+      // Values of |G|^2
+      RField<D> kSq_;
+
+      // Derivatives of |G|^2 with respect to each unit cell parameter
+      FArray< RField<D>, 6> dkSq_;
+
+      // Finder of minimum images
+      MinimumImage<D> minimumImage_;
+
+      /// Dimensions of real space mesh.
+      IntVec<D> meshDimensions_;
+
+      /// Dimensions of wavevector mesh in real-to-complex transform.
+      IntVec<D> kMeshDimensions_;
+
+      /// Number of wavevectors in the k-space mesh.
+      int kSize_;
+
+      /// Has memory been allocated?
+      bool isAllocated_;
+
+      /// Have values been computed for a unit cell?
+      bool hasKSq_;
+
+      /**
+      * Compute the minimum images of all wavevectors.
+      *
+      * \param unitCell  unit cell, defining cell dimensions
+      */
+      void computeMinimumImages(UnitCell<D> const & unitCell);
+
+   };
+
+   #ifndef PSPC_WAVE_LIST_TPP
+   extern template class WaveList<1>;
+   extern template class WaveList<2>;
+   extern template class WaveList<3>;
+   #endif
+
+}
+}
+#endif
@@ -0,0 +1,148 @@
+#ifndef PSPC_WAVE_LIST_TPP
+#define PSPC_WAVE_LIST_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "WaveList.h"
+#include <pscf/mesh/Mesh.h>
+#include <pscf/crystal/UnitCell.h>
+#include <pspc/field/threads.h>
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+
+   /*
+   * Constructor.
+   */
+   template <int D>
+   WaveList<D>::WaveList()
+    : meshDimensions_(0),
+      kMeshDimensions_(0),
+      kSize_(0),
+      isAllocated_(false),
+      hasKSq_(false)
+   {}
+
+   /*
+   * Destructor.
+   */
+   template <int D>
+   WaveList<D>::~WaveList()
+   {}
+
+   /*
+   * Allocate arrays for the k-space mesh of a real-to-complex transform.
+   */
+   template <int D>
+   void WaveList<D>::allocate(Mesh<D> const & mesh)
+   {
+      UTIL_CHECK(!isAllocated_);
+      UTIL_CHECK(mesh.size() > 1);
+
+      meshDimensions_ = mesh.dimensions();
+      kSize_ = 1;
+      for (int i = 0; i < D; ++i) {
+         if (i < D - 1) {
+            kMeshDimensions_[i] = meshDimensions_[i];
+         } else {
+            kMeshDimensions_[i] = meshDimensions_[i]/2 + 1;
+         }
+         kSize_ *= kMeshDimensions_[i];
+      }
+      minImages_.allocate(kSize_);
+      kSq_.allocate(kMeshDimensions_);
+      isAllocated_ = true;
+   }
+
+   /*
+   * Compute all values that depend on the unit cell parameters.
+   */
+   template <int D>
+   void WaveList<D>::setupUnitCell(UnitCell<D> const & unitCell)
+   {
+      UTIL_CHECK(isAllocated_);
+
+      // Images of orthogonal cells do not depend on cell parameters
+      if (!minimumImage_.isSetup() || !minimumImage_.isOrthogonal()) {
+         computeMinimumImages(unitCell);
+      }
+
+      // Copy basis vectors and their derivatives, to avoid virtual
+      // function calls within loops over wavevectors
+      int nParameter = unitCell.nParameter();
+      FArray<RealVec<D>, D> kBasis;
+      double dkkBasis[6][D][D];
+      int n, p, q;
+      for (p = 0; p < D; ++p) {
+         kBasis[p] = unitCell.kBasis(p);
+      }
+      for (n = 0; n < nParameter; ++n) {
+         if (!dkSq_[n].isAllocated()) {
+            dkSq_[n].allocate(kMeshDimensions_);
+         }
+         for (p = 0; p < D; ++p) {
+            for (q = 0; q < D; ++q) {
+               dkkBasis[n][p][q] = unitCell.dkkBasis(n, p, q);
+            }
+         }
+      }
+
+      // Compute |G|^2 and its derivatives, using the same operations
+      // as UnitCellBase<D>::ksq and UnitCellBase<D>::dksq
+      PSPC_OMP_PARALLEL_FOR
+      for (int i = 0; i < kSize_; ++i) {
+         IntVec<D> const & v = minImages_[i];
+         RealVec<D> g(0.0);
+         RealVec<D> r;
+         int j, k, m;
+         for (j = 0; j < D; ++j) {
+            r.multiply(kBasis[j], v[j]);
+            g += r;
+         }
+         double value = 0.0;
+         for (j = 0; j < D; ++j) {
+            value += g[j]*g[j];
+         }
+         kSq_[i] = value;
+         for (m = 0; m < nParameter; ++m) {
+            value = 0.0;
+            for (j = 0; j < D; ++j) {
+               for (k = 0; k < D; ++k) {
+                  value += v[j]*v[k]*dkkBasis[m][j][k];
+               }
+            }
+            dkSq_[m][i] = value;
+         }
+      }
+      hasKSq_ = true;
+   }
+
+   /*
+   * Compute minimum images of all wavevectors of the k-space mesh.
+   */
+   template <int D>
+   void WaveList<D>::computeMinimumImages(UnitCell<D> const & unitCell)
+   {
+      minimumImage_.setup(meshDimensions_, unitCell);
+      PSPC_OMP_PARALLEL_FOR
+      for (int i = 0; i < kSize_; ++i) {
+         IntVec<D> v;
+         int rank = i;
+         for (int j = D - 1; j >= 0; --j) {
+            v[j] = rank % kMeshDimensions_[j];
+            rank /= kMeshDimensions_[j];
+         }
+         minImages_[i] = minimumImage_.shift(v);
+      }
+   }
+
+}
+}
+#endif
@@ -1,9 +1,12 @@
 
 pspc_solvers_= \
+  pspc/solvers/WaveList.cpp \
+  pspc/solvers/OperatorTables.cpp \
   pspc/solvers/Block.cpp \
   pspc/solvers/Propagator.cpp \
   pspc/solvers/Polymer.cpp \
-  pspc/solvers/Mixture.cpp 
+  pspc/solvers/Mixture.cpp \
+  pspc/solvers/StepAlgorithm.cpp 
 
 pspc_solvers_SRCS=\
      $(addprefix $(SRC_DIR)/, $(pspc_solvers_))
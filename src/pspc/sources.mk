@@ -1,12 +1,15 @@
 include $(SRC_DIR)/pspc/field/sources.mk
 include $(SRC_DIR)/pspc/iterator/sources.mk
 include $(SRC_DIR)/pspc/solvers/sources.mk
+include $(SRC_DIR)/pspc/sweep/sources.mk
 
 pspc_= \
   $(pspc_field_) \
   $(pspc_solvers_) \
   $(pspc_iterator_) \
-  pspc/System.cpp 
+  $(pspc_sweep_) \
+  pspc/System.cpp \
+  pspc/SystemSet.cpp 
 
 pspc_SRCS=\
      $(addprefix $(SRC_DIR)/, $(pspc_))
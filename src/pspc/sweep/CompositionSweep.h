@@ -0,0 +1,91 @@
+#ifndef PSPC_COMPOSITION_SWEEP_H
+#define PSPC_COMPOSITION_SWEEP_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "Sweep.h"                        // base class
+#include <util/containers/DArray.h>       // member
+
+namespace Pscf {
+namespace Pspc
+{
+
+   template <int D> class System;
+
+   using namespace Util;
+
+   /**
+   * Sweep in which polymer volume fractions vary linearly with s.
+   *
+   * All polymer species must be in the closed ensemble. The array dPhi
+   * gives the change in the volume fraction of each polymer species
+   * over the sweep, and so must sum to zero.
+   *
+   * \ingroup Pspc_Sweep_Module
+   */
+   template <int D>
+   class CompositionSweep : public Sweep<D>
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      *
+      * \param system parent System object
+      */
+      CompositionSweep(System<D>& system);
+
+      /**
+      * Destructor.
+      */
+      ~CompositionSweep();
+
+      /**
+      * Read parameters.
+      *
+      * \param in input stream
+      */
+      virtual void readParameters(std::istream& in);
+
+      /**
+      * Initialization at beginning sweep.
+      */
+      virtual void setup();
+
+      /**
+      * Set polymer volume fractions for a value of s.
+      *
+      * \param s path length coordinate, in [0,1]
+      */
+      virtual void setState(double s);
+
+   private:
+
+      /// Polymer volume fractions at beginning of sweep (s=0).
+      DArray<double> phi0_;
+
+      /// Change in polymer volume fractions over sweep s=[0,1].
+      DArray<double> dPhi_;
+
+      using Sweep<D>::system;
+      using Sweep<D>::setClassName;
+      using ParamComposite::readDArray;
+
+   };
+
+   #ifndef PSPC_COMPOSITION_SWEEP_TPP
+   // Suppress implicit instantiation
+   extern template class CompositionSweep<1>;
+   extern template class CompositionSweep<2>;
+   extern template class CompositionSweep<3>;
+   #endif
+
+} // namespace Pspc
+} // namespace Pscf
+#endif
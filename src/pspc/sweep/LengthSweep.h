@@ -0,0 +1,99 @@
+#ifndef PSPC_LENGTH_SWEEP_H
+#define PSPC_LENGTH_SWEEP_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "Sweep.h"                        // base class
+
+namespace Pscf {
+namespace Pspc
+{
+
+   template <int D> class System;
+
+   using namespace Util;
+
+   /**
+   * Sweep in which the length of one block varies linearly with s.
+   *
+   * Parameters polymerId and blockId identify the block, and dLength
+   * is the change in its length over the sweep. The number of contour
+   * grid points of the block is held fixed, so that its contour step
+   * varies in proportion to its length (see Block::setLength). The
+   * propagators of this block may thus not be aliases of equivalent
+   * propagators, or be aliased by others.
+   *
+   * \ingroup Pspc_Sweep_Module
+   */
+   template <int D>
+   class LengthSweep : public Sweep<D>
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      *
+      * \param system parent System object
+      */
+      LengthSweep(System<D>& system);
+
+      /**
+      * Destructor.
+      */
+      ~LengthSweep();
+
+      /**
+      * Read parameters.
+      *
+      * \param in input stream
+      */
+      virtual void readParameters(std::istream& in);
+
+      /**
+      * Initialization at beginning sweep.
+      */
+      virtual void setup();
+
+      /**
+      * Set the block length for a value of s.
+      *
+      * \param s path length coordinate, in [0,1]
+      */
+      virtual void setState(double s);
+
+   private:
+
+      /// Index of the polymer species.
+      int polymerId_;
+
+      /// Index of the block within the polymer.
+      int blockId_;
+
+      /// Block length at beginning of sweep (s=0).
+      double length0_;
+
+      /// Change in block length over sweep s=[0,1].
+      double dLength_;
+
+      using Sweep<D>::system;
+      using Sweep<D>::setClassName;
+      using ParamComposite::read;
+
+   };
+
+   #ifndef PSPC_LENGTH_SWEEP_TPP
+   // Suppress implicit instantiation
+   extern template class LengthSweep<1>;
+   extern template class LengthSweep<2>;
+   extern template class LengthSweep<3>;
+   #endif
+
+} // namespace Pspc
+} // namespace Pscf
+#endif
@@ -0,0 +1,94 @@
+#ifndef PSPC_LENGTH_SWEEP_TPP
+#define PSPC_LENGTH_SWEEP_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "LengthSweep.h"
+#include <pspc/System.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   template <int D>
+   LengthSweep<D>::LengthSweep(System<D>& system)
+    : Sweep<D>(system),
+      polymerId_(-1),
+      blockId_(-1),
+      length0_(0.0),
+      dLength_(0.0)
+   {  setClassName("LengthSweep"); }
+
+   template <int D>
+   LengthSweep<D>::~LengthSweep()
+   {}
+
+   /*
+   * Read parameters.
+   */
+   template <int D>
+   void LengthSweep<D>::readParameters(std::istream& in)
+   {
+      // Read ns, baseFileName and optional parameters
+      Sweep<D>::readParameters(in);
+
+      read(in, "polymerId", polymerId_);
+      read(in, "blockId", blockId_);
+      read(in, "dLength", dLength_);
+      UTIL_CHECK(polymerId_ >= 0);
+      UTIL_CHECK(polymerId_ < system().mixture().nPolymer());
+      UTIL_CHECK(blockId_ >= 0);
+      int nBlock = system().mixture().polymer(polymerId_).nBlock();
+      UTIL_CHECK(blockId_ < nBlock);
+   }
+
+   /*
+   * Initialization at beginning sweep. Set length0 to current length.
+   */
+   template <int D>
+   void LengthSweep<D>::setup()
+   {
+      Polymer<D>& polymer = system().mixture().polymer(polymerId_);
+      Block<D>& block = polymer.block(blockId_);
+      length0_ = block.length();
+
+      // Propagators of the block may not be aliases, or be aliased
+      for (int i = 0; i < 2; ++i) {
+         if (block.propagator(i).isAlias()) {
+            UTIL_THROW("Swept block has an aliased propagator");
+         }
+      }
+      for (int j = 0; j < polymer.nPropagator(); ++j) {
+         Propagator<D> const & propagator = polymer.propagator(j);
+         if (propagator.isAlias()) {
+            for (int i = 0; i < 2; ++i) {
+               if (&propagator.alias() == &block.propagator(i)) {
+                  UTIL_THROW("Swept block has an aliased propagator");
+               }
+            }
+         }
+      }
+   }
+
+   /*
+   * Set state for specified value of s.
+   */
+   template <int D>
+   void LengthSweep<D>::setState(double s)
+   {
+      double length = length0_ + s*dLength_;
+      UTIL_CHECK(length > 0.0);
+      system().mixture().polymer(polymerId_).block(blockId_)
+                                             .setLength(length);
+   }
+
+} // namespace Pspc
+} // namespace Pscf
+#endif
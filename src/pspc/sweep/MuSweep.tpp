@@ -0,0 +1,72 @@
+#ifndef PSPC_MU_SWEEP_TPP
+#define PSPC_MU_SWEEP_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "MuSweep.h"
+#include <pspc/System.h>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   template <int D>
+   MuSweep<D>::MuSweep(System<D>& system)
+    : Sweep<D>(system)
+   {  setClassName("MuSweep"); }
+
+   template <int D>
+   MuSweep<D>::~MuSweep()
+   {}
+
+   /*
+   * Read parameters.
+   */
+   template <int D>
+   void MuSweep<D>::readParameters(std::istream& in)
+   {
+      // Read ns, baseFileName and optional parameters
+      Sweep<D>::readParameters(in);
+
+      int np = system().mixture().nPolymer();
+      mu0_.allocate(np);
+      dMu_.allocate(np);
+      readDArray(in, "dMu", dMu_, np);
+   }
+
+   /*
+   * Initialization at beginning sweep. Set mu0 to current values.
+   */
+   template <int D>
+   void MuSweep<D>::setup()
+   {
+      int np = system().mixture().nPolymer();
+      for (int i = 0; i < np; ++i) {
+         UTIL_CHECK(system().mixture().polymer(i).ensemble() 
+                    == Species::Open);
+         mu0_[i] = system().mixture().polymer(i).mu();
+      }
+   }
+
+   /*
+   * Set state for specified value of s.
+   */
+   template <int D>
+   void MuSweep<D>::setState(double s)
+   {
+      int np = system().mixture().nPolymer();
+      for (int i = 0; i < np; ++i) {
+         system().mixture().polymer(i).setMu(mu0_[i] + s*dMu_[i]);
+      }
+   }
+
+} // namespace Pspc
+} // namespace Pscf
+#endif
@@ -0,0 +1,182 @@
+#ifndef PSPC_SWEEP_H
+#define PSPC_SWEEP_H
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include <util/param/ParamComposite.h>      // base class
+#include <pspc/field/RField.h>              // member
+#include <util/containers/DArray.h>         // member
+#include <util/containers/FSArray.h>        // member
+
+#include <string>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   template <int D> class System;
+
+   using namespace Util;
+
+   /**
+   * Solve a sequence of problems along a line in parameter space.
+   *
+   * A sweep varies system parameters along a path parameterized by a
+   * contour variable s, from s = 0 (the initial state) to s = 1. The
+   * dependence of the parameters on s is defined by a subclass, by
+   * implementing setState(s).
+   *
+   * The initial guess for each new state is obtained by Lagrange
+   * polynomial extrapolation of the w fields (on the r-space grid) and
+   * the unit cell parameters from up to historyCapacity previous
+   * converged solutions. A polynomial of degree n - 1 is used when n
+   * previous solutions are available, which reduces to a copy of the
+   * last solution when n = 1.
+   *
+   * The step size ds is initially 1/ns. If the iterator fails to
+   * converge, ds is halved and the step is retried. If the optional
+   * parameter targetItr is positive, ds is also adjusted after each
+   * successful step by a factor sqrt(targetItr/nIteration), restricted
+   * to the range [0.5, 2.0], where nIteration is the number of
+   * iterations required by the last solution, and ds is never allowed
+   * to exceed 4/ns.
+   *
+   * \ingroup Pspc_Sweep_Module
+   */
+   template <int D>
+   class Sweep : public ParamComposite
+   {
+
+   public:
+
+      /**
+      * Constructor.
+      *
+      * \param system parent System object.
+      */
+      Sweep(System<D>& system);
+
+      /**
+      * Destructor.
+      */
+      ~Sweep();
+
+      /**
+      * Read ns, baseFileName and optional parameters.
+      *
+      * \param in input stream
+      */
+      virtual void readParameters(std::istream& in);
+
+      /**
+      * Setup operation at beginning sweep.
+      */
+      virtual void setup()
+      {}
+
+      /**
+      * Set system parameters.
+      *
+      * \param s path length coordinate, in range [0,1]
+      */
+      virtual void setState(double s) = 0;
+
+      /**
+      * Output information after obtaining a converged solution.
+      *
+      * \param stateFileName base name of output files
+      * \param s value of path length parameter s
+      */
+      virtual void outputSolution(std::string const & stateFileName,
+                                  double s);
+
+      /**
+      * Output data to a running summary.
+      *
+      * \param out  output file, open for writing
+      * \param i  integer index
+      * \param s  value of path length parameter s
+      */
+      virtual void outputSummary(std::ostream& out, int i, double s);
+
+      /**
+      * Solve for all states along the path.
+      */
+      virtual void solve();
+
+   protected:
+
+      /// Number of steps (initial step size ds = 1/ns).
+      int ns_;
+
+      /// Maximum number of previous solutions used for extrapolation.
+      int historyCapacity_;
+
+      /// Desired number of iterations per step (<= 0 -> fixed steps).
+      int targetItr_;
+
+      /// Base name for output files
+      std::string baseFileName_;
+
+      /**
+      * Get parent System by reference.
+      */
+      System<D>& system()
+      {  return *systemPtr_; }
+
+   private:
+
+      /// Values of s for stored solutions, indexed by slot.
+      DArray<double> sHistory_;
+
+      /// W fields on r-grid for stored solutions, indexed by slot.
+      DArray< DArray< RField<D> > > wHistory_;
+
+      /// Unit cell parameters for stored solutions, indexed by slot.
+      DArray< FSArray<double, 6> > cellHistory_;
+
+      /// Lagrange extrapolation coefficients.
+      DArray<double> coefficients_;
+
+      /// Number of stored solutions.
+      int nHistory_;
+
+      /// Slot of the most recent stored solution.
+      int head_;
+
+      /// Pointer to parent System
+      System<D>* systemPtr_;
+
+      /**
+      * Slot index of the k-th most recent solution (k=0 for last).
+      */
+      int slot(int k) const
+      {  return (head_ - k + historyCapacity_) % historyCapacity_; }
+
+      /**
+      * Store current converged solution for path variable s.
+      */
+      void storeSolution(double s);
+
+      /**
+      * Set w fields and unit cell to an extrapolation to s.
+      */
+      void setGuess(double s);
+
+   };
+
+   #ifndef PSPC_SWEEP_TPP
+   // Suppress implicit instantiation
+   extern template class Sweep<1>;
+   extern template class Sweep<2>;
+   extern template class Sweep<3>;
+   #endif
+
+} // namespace Pspc
+} // namespace Pscf
+#endif
@@ -0,0 +1,340 @@
+#ifndef PSPC_SWEEP_TPP
+#define PSPC_SWEEP_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "Sweep.h"
+#include <pspc/System.h>
+#include <pspc/iterator/Iterator.h>
+#include <util/misc/ioUtil.h>
+#include <util/format/Int.h>
+#include <util/format/Dbl.h>
+
+#include <cmath>
+
+namespace Pscf {
+namespace Pspc
+{
+
+   using namespace Util;
+
+   /*
+   * Constructor.
+   */
+   template <int D>
+   Sweep<D>::Sweep(System<D>& system)
+    : ns_(0),
+      historyCapacity_(3),
+      targetItr_(0),
+      baseFileName_(),
+      nHistory_(0),
+      head_(0),
+      systemPtr_(&system)
+   {  setClassName("Sweep"); }
+
+   /*
+   * Destructor.
+   */
+   template <int D>
+   Sweep<D>::~Sweep()
+   {}
+
+   /*
+   * Read parameters.
+   */
+   template <int D>
+   void Sweep<D>::readParameters(std::istream& in)
+   {
+      read<int>(in, "ns", ns_);
+      UTIL_CHECK(ns_ > 0);
+      read<std::string>(in, "baseFileName", baseFileName_);
+
+      historyCapacity_ = 3; // default value
+      readOptional<int>(in, "historyCapacity", historyCapacity_);
+      if (historyCapacity_ < 1 || historyCapacity_ > 4) {
+         UTIL_THROW("historyCapacity must be in the range [1,4]");
+      }
+
+      targetItr_ = 0; // default value (fixed step size)
+      readOptional<int>(in, "targetItr", targetItr_);
+   }
+
+   /*
+   * Solve for all states along the path.
+   */
+   template <int D>
+   void Sweep<D>::solve()
+   {
+      UTIL_CHECK(system().hasWFields());
+      int nm = system().mixture().nMonomer();
+      IntVec<D> const & dimensions = system().mesh().dimensions();
+      UTIL_CHECK(nm > 0);
+
+      // Allocate memory for stored solutions
+      if (!sHistory_.isAllocated()) {
+         sHistory_.allocate(historyCapacity_);
+         cellHistory_.allocate(historyCapacity_);
+         coefficients_.allocate(historyCapacity_);
+         wHistory_.allocate(historyCapacity_);
+         for (int k = 0; k < historyCapacity_; ++k) {
+            wHistory_[k].allocate(nm);
+            for (int i = 0; i < nm; ++i) {
+               wHistory_[k][i].allocate(dimensions);
+            }
+         }
+      }
+      nHistory_ = 0;
+      head_ = historyCapacity_ - 1;
+
+      // Compute and output ds
+      double ds = 1.0/double(ns_);
+      double ds0 = ds;
+      system().log() << std::endl;
+      system().log() << "ns = " << ns_ << std::endl;
+      system().log() << "ds = " << ds  << std::endl;
+
+      // Set Sweep object
+      setup();
+
+      // Open summary file
+      std::ofstream outFile;
+      std::string fileName = baseFileName_;
+      fileName += "log";
+      system().fileMaster().openOutputFile(fileName, outFile);
+
+      // Solve for initial state of sweep
+      double s = 0.0;
+      int i = 0;
+      int error;
+      system().log() << std::endl;
+      system().log() << "Begin s = " << s << std::endl;
+      error = system().iterator().solve();
+      if (error) {
+         UTIL_THROW("Failure to converge initial state of sweep");
+      }
+      system().computeFreeEnergy();
+      storeSolution(s);
+      fileName = baseFileName_;
+      fileName += toString(i);
+      outputSolution(fileName, s);
+      outputSummary(outFile, i, s);
+
+      // Loop over states on path
+      double factor;
+      while (s < 1.0 - 1.0E-10) {
+         if (s + ds > 1.0) {
+            ds = 1.0 - s;
+         }
+
+         system().log() << std::endl;
+         system().log() << "Attempt s = " << s + ds << std::endl;
+         system().log() << "Extrapolation order = " << nHistory_ - 1
+                        << std::endl;
+
+         // Set initial guess, then parameters for the new state
+         setGuess(s + ds);
+         setState(s + ds);
+         error = system().iterator().solve();
+
+         if (error) {
+
+            // Decrease ds by half, and retry from stored solutions
+            ds *= 0.50;
+            if (ds < 0.1*ds0) {
+               setGuess(s);
+               setState(s);
+               UTIL_THROW("Step size too small in sweep");
+            }
+
+         } else {
+
+            // Upon success, store and output new solution
+            system().computeFreeEnergy();
+            s += ds;
+            ++i;
+            storeSolution(s);
+            fileName = baseFileName_;
+            fileName += toString(i);
+            outputSolution(fileName, s);
+            outputSummary(outFile, i, s);
+
+            // Adjust ds to approach the target number of iterations
+            if (targetItr_ > 0) {
+               int nItr = system().iterator().nIteration();
+               if (nItr < 1) nItr = 1;
+               factor = sqrt(double(targetItr_)/double(nItr));
+               if (factor < 0.5) factor = 0.5;
+               if (factor > 2.0) factor = 2.0;
+               ds *= factor;
+               if (ds > 4.0*ds0) ds = 4.0*ds0;
+            }
+
+         }
+      }
+      outFile.close();
+   }
+
+   /*
+   * Store the current solution for value s of the path variable.
+   */
+   template <int D>
+   void Sweep<D>::storeSolution(double s)
+   {
+      head_ = (head_ + 1) % historyCapacity_;
+      if (nHistory_ < historyCapacity_) {
+         ++nHistory_;
+      }
+
+      int nm = system().mixture().nMonomer();
+      int nx = system().mesh().size();
+      int i, j;
+      for (i = 0; i < nm; ++i) {
+         RField<D> const & w = system().wFieldRGrid(i);
+         RField<D>& stored = wHistory_[head_][i];
+         for (j = 0; j < nx; ++j) {
+            stored[j] = w[j];
+         }
+      }
+      cellHistory_[head_] = system().unitCell().parameters();
+      sHistory_[head_] = s;
+   }
+
+   /*
+   * Set w fields and unit cell by Lagrange extrapolation to s.
+   *
+   * If s is equal to that of the most recent stored solution, the
+   * coefficients are exactly 1 for this solution and 0 for others,
+   * so this restores that solution.
+   */
+   template <int D>
+   void Sweep<D>::setGuess(double s)
+   {
+      UTIL_CHECK(nHistory_ > 0);
+      int n = nHistory_;
+      int i, j, k;
+
+      // Lagrange polynomial coefficients, for nodes s_k
+      double sk, sj;
+      for (k = 0; k < n; ++k) {
+         sk = sHistory_[slot(k)];
+         coefficients_[k] = 1.0;
+         for (j = 0; j < n; ++j) {
+            if (j == k) continue;
+            sj = sHistory_[slot(j)];
+            coefficients_[k] *= (s - sj)/(sk - sj);
+         }
+      }
+
+      // Extrapolate w fields on r-space grid
+      int nm = system().mixture().nMonomer();
+      int nx = system().mesh().size();
+      double value;
+      for (i = 0; i < nm; ++i) {
+         RField<D>& w = system().wFieldRGrid(i);
+         for (j = 0; j < nx; ++j) {
+            value = 0.0;
+            for (k = 0; k < n; ++k) {
+               value += coefficients_[k]*wHistory_[slot(k)][i][j];
+            }
+            w[j] = value;
+         }
+      }
+
+      // Extrapolate unit cell parameters, if they have changed
+      UnitCell<D>& unitCell = system().unitCell();
+      int nParameter = unitCell.nParameter();
+      FSArray<double, 6> parameters = cellHistory_[slot(0)];
+      bool isVariable = false;
+      for (k = 1; k < n; ++k) {
+         for (i = 0; i < nParameter; ++i) {
+            if (cellHistory_[slot(k)][i] != parameters[i]) {
+               isVariable = true;
+            }
+         }
+      }
+      if (isVariable) {
+         for (i = 0; i < nParameter; ++i) {
+            value = 0.0;
+            for (k = 0; k < n; ++k) {
+               value += coefficients_[k]*cellHistory_[slot(k)][i];
+            }
+            parameters[i] = value;
+         }
+      }
+      FSArray<double, 6> current = unitCell.parameters();
+      bool isChanged = false;
+      for (i = 0; i < nParameter; ++i) {
+         if (current[i] != parameters[i]) {
+            isChanged = true;
+         }
+      }
+      if (isChanged) {
+         unitCell.setParameters(parameters);
+         system().mixture().setupUnitCell(unitCell);
+         if (system().hasBasis()) {
+            system().basis().update();
+         }
+      }
+
+      // Set consistent basis components
+      if (system().hasSymmetricFields()) {
+         system().fieldIo().convertRGridToBasis(system().wFieldsRGrid(),
+                                                system().wFields());
+      }
+   }
+
+   /*
+   * Output parameters, thermodynamic properties and fields.
+   */
+   template <int D>
+   void Sweep<D>::outputSolution(std::string const & fileName, double s)
+   {
+      std::ofstream out;
+      std::string outFileName;
+
+      // Write parameter file, with thermodynamic properties at end
+      outFileName = fileName;
+      outFileName += ".prm";
+      system().fileMaster().openOutputFile(outFileName, out);
+      system().writeParam(out);
+      out << std::endl;
+      system().outputThermo(out);
+      out.close();
+
+      // Write w and c fields
+      FieldIo<D>& fieldIo = system().fieldIo();
+      if (system().hasSymmetricFields()) {
+         fieldIo.writeFieldsBasis(fileName + "_w.bf", system().wFields());
+         fieldIo.writeFieldsBasis(fileName + "_c.bf", system().cFields());
+      } else {
+         fieldIo.writeFieldsRGrid(fileName + "_w.rf",
+                                  system().wFieldsRGrid());
+         fieldIo.writeFieldsRGrid(fileName + "_c.rf",
+                                  system().cFieldsRGrid());
+      }
+   }
+
+   /*
+   * Output state index, s, free energy, pressure and cell parameters.
+   */
+   template <int D>
+   void Sweep<D>::outputSummary(std::ostream& out, int i, double s)
+   {
+      out << Int(i,5) << Dbl(s)
+          << Dbl(system().fHelmholtz(), 20, 10)
+          << Dbl(system().pressure(), 20, 10);
+      FSArray<double, 6> parameters = system().unitCell().parameters();
+      for (int m = 0; m < parameters.size(); ++m) {
+         out << Dbl(parameters[m], 20, 10);
+      }
+      out << std::endl;
+   }
+
+} // namespace Pspc
+} // namespace Pscf
+#endif
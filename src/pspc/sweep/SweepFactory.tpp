@@ -0,0 +1,60 @@
+#ifndef PSPC_SWEEP_FACTORY_TPP
+#define PSPC_SWEEP_FACTORY_TPP
+
+/*
+* PSCF - Polymer Self-Consistent Field Theory
+*
+* Copyright 2016 - 2019, The Regents of the University of Minnesota
+* Distributed under the terms of the GNU General Public License.
+*/
+
+#include "SweepFactory.h"  
+
+// Subclasses of Sweep 
+#include "ChiSweep.h"
+#include "CompositionSweep.h"
+#include "LengthSweep.h"
+#include "MuSweep.h"
+
+namespace Pscf {
+namespace Pspc {
+
+   using namespace Util;
+
+   template <int D>
+   SweepFactory<D>::SweepFactory(System<D>& system)
+    : systemPtr_(&system)
+   {}
+
+   /* 
+   * Return a pointer to a instance of Sweep subclass className.
+   */
+   template <int D>
+   Sweep<D>* SweepFactory<D>::factory(const std::string &className) const
+   {
+      Sweep<D>* ptr = 0;
+
+      // First if name is known by any subfactories
+      ptr = trySubfactories(className);
+      if (ptr) return ptr;     
+
+      // Explicit class names
+      if (className == "ChiSweep") {
+         ptr = new ChiSweep<D>(*systemPtr_);
+      } else
+      if (className == "CompositionSweep") {
+         ptr = new CompositionSweep<D>(*systemPtr_);
+      } else
+      if (className == "LengthSweep") {
+         ptr = new LengthSweep<D>(*systemPtr_);
+      } else
+      if (className == "MuSweep") {
+         ptr = new MuSweep<D>(*systemPtr_);
+      }
+
+      return ptr;
+   }
+
+}
+}
+#endif
@@ -0,0 +1,13 @@
+pspc_sweep_= \
+  pspc/sweep/Sweep.cpp \
+  pspc/sweep/ChiSweep.cpp \
+  pspc/sweep/CompositionSweep.cpp \
+  pspc/sweep/LengthSweep.cpp \
+  pspc/sweep/MuSweep.cpp \
+  pspc/sweep/SweepFactory.cpp 
+
+pspc_sweep_SRCS=\
+     $(addprefix $(SRC_DIR)/, $(pspc_sweep_))
+pspc_sweep_OBJS=\
+     $(addprefix $(BLD_DIR)/, $(pspc_sweep_:.cpp=.o))
+
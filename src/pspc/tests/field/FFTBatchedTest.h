@@ -0,0 +1,149 @@
+#ifndef PSPC_FFT_BATCHED_TEST_H
+#define PSPC_FFT_BATCHED_TEST_H
+
+#include <test/UnitTest.h>
+#include <test/UnitTestRunner.h>
+
+#include <pspc/field/FFTBatched.h>
+#include <pspc/field/FFT.h>
+#include <pspc/field/RField.h>
+#include <pspc/field/RFieldDft.h>
+
+#include <util/math/Constants.h>
+
+using namespace Util;
+using namespace Pscf::Pspc;
+
+class FFTBatchedTest : public UnitTest 
+{
+public:
+
+   void setUp() {}
+   void tearDown() {}
+
+   void testConstructor();
+   void testTransform1D();
+   void testTransform3D();
+
+};
+
+void FFTBatchedTest::testConstructor()
+{
+   printMethod(TEST_FUNC);
+   {
+      FFTBatched<1> v;
+      TEST_ASSERT(!v.isSetup());
+   }
+} 
+
+void FFTBatchedTest::testTransform1D() 
+{
+   printMethod(TEST_FUNC);
+
+   int n = 10;
+   int batchSize = 2;
+   IntVec<1> d;
+   d[0] = n;
+   int nk = n/2 + 1;
+
+   Pscf::Pspc::Field<Real> in, inCopy;
+   Pscf::Pspc::Field<FftwComplex> out;
+   in.allocate(batchSize*n);
+   inCopy.allocate(batchSize*n);
+   out.allocate(batchSize*nk);
+
+   FFTBatched<1> v;
+   v.setup(d, batchSize, in, out);
+   TEST_ASSERT(v.isSetup());
+   TEST_ASSERT(v.rSize() == n);
+   TEST_ASSERT(v.kSize() == nk);
+
+   // Initialize input data: cos(x) and sin(2x)
+   double x;
+   double twoPi = 2.0*Constants::Pi;
+   for (int i = 0; i < n; ++i) {
+      x = twoPi*double(i)/double(n); 
+      in[i] = cos(x);
+      in[n + i] = sin(2.0*x);
+   }
+   for (int i = 0; i < batchSize*n; ++i) {
+      inCopy[i] = in[i];
+   }
+
+   // Compare to single field transforms
+   RField<1> r;
+   RFieldDft<1> k;
+   r.allocate(d);
+   k.allocate(d);
+   FFT<1> single;
+   single.setup(r, k);
+
+   v.forwardTransform(in, out);
+   for (int b = 0; b < batchSize; ++b) {
+      for (int i = 0; i < n; ++i) {
+         r[i] = inCopy[b*n + i];
+      }
+      single.forwardTransform(r, k);
+      for (int i = 0; i < nk; ++i) {
+         TEST_ASSERT(eq(k[i][0], out[b*nk + i][0]));
+         TEST_ASSERT(eq(k[i][1], out[b*nk + i][1]));
+      }
+   }
+
+   // Inverse transform recovers input
+   v.inverseTransform(out, in);
+   for (int i = 0; i < batchSize*n; ++i) {
+      TEST_ASSERT(eq(in[i], inCopy[i]));
+   }
+}
+
+void FFTBatchedTest::testTransform3D() 
+{
+   printMethod(TEST_FUNC);
+
+   int batchSize = 3;
+   IntVec<3> d;
+   d[0] = 3;
+   d[1] = 4;
+   d[2] = 5;
+   int nr = d[0]*d[1]*d[2];
+   int nk = d[0]*d[1]*(d[2]/2 + 1);
+
+   Pscf::Pspc::Field<Real> in, inCopy;
+   Pscf::Pspc::Field<FftwComplex> out;
+   in.allocate(batchSize*nr);
+   inCopy.allocate(batchSize*nr);
+   out.allocate(batchSize*nk);
+
+   FFTBatched<3> v;
+   v.setup(d, batchSize, in, out);
+
+   for (int i = 0; i < batchSize*nr; ++i) {
+      in[i] = cos(0.37*double(i)) + 0.1*double(i % 7);
+      inCopy[i] = in[i];
+   }
+
+   v.forwardTransform(in, out);
+
+   // Average of each field is the zero wavevector component
+   for (int b = 0; b < batchSize; ++b) {
+      double sum = 0.0;
+      for (int i = 0; i < nr; ++i) {
+         sum += inCopy[b*nr + i];
+      }
+      TEST_ASSERT(eq(sum/double(nr), out[b*nk][0]));
+   }
+
+   v.inverseTransform(out, in);
+   for (int i = 0; i < batchSize*nr; ++i) {
+      TEST_ASSERT(eq(in[i], inCopy[i]));
+   }
+}
+
+TEST_BEGIN(FFTBatchedTest)
+TEST_ADD(FFTBatchedTest, testConstructor)
+TEST_ADD(FFTBatchedTest, testTransform1D)
+TEST_ADD(FFTBatchedTest, testTransform3D)
+TEST_END(FFTBatchedTest)
+
+#endif
@@ -5,12 +5,15 @@
 #include <test/UnitTestRunner.h>
 
 #include <pspc/field/FFT.h>
+#include <pspc/field/planCache.h>
 #include <pspc/field/RField.h>
 #include <pspc/field/RFieldDft.h>
 
 #include <util/math/Constants.h>
 #include <util/format/Dbl.h>
 
+#include <sstream>
+
 using namespace Util;
 using namespace Pscf::Pspc;
 
@@ -25,6 +28,9 @@ public:
    void testTransform1D();
    void testTransform2D();
    void testTransform3D();
+   void testSharedPlans();
+   void testWisdom();
+   void testUnscaled();
 
 };
 
@@ -157,11 +163,129 @@ void FftTest::testTransform3D() {
    }
 }
 
+void FftTest::testSharedPlans()
+{
+   printMethod(TEST_FUNC);
+
+   IntVec<2> d;
+   d[0] = 6;
+   d[1] = 5;
+   RField<2> in, inCopy;
+   RFieldDft<2> out;
+   in.allocate(d);
+   inCopy.allocate(d);
+   out.allocate(d);
+
+   double twoPi = 2.0*Constants::Pi;
+   int rank;
+   for (int i = 0; i < d[0]; i++) {
+      for (int j = 0; j < d[1]; j++) {
+         rank = j + i*d[1];
+         in[rank] = 1.0 + cos(twoPi*double(i)/double(d[0]))
+                        + 0.5*sin(twoPi*double(j)/double(d[1]));
+      }
+   }
+
+   int nPlan = nCachedPlan();
+   {
+      FFT<2> a;
+      FFT<2> b;
+      a.setup(in, out);
+      TEST_ASSERT(nCachedPlan() == nPlan + 2);
+      b.setup(in, out);
+      TEST_ASSERT(nCachedPlan() == nPlan + 2);
+
+      // Plans are shared, but work arrays are not
+      a.forwardTransform(in, out);
+      b.inverseTransform(out, inCopy);
+      for (int i = 0; i < in.capacity(); i++) {
+         TEST_ASSERT(eq(in[i], inCopy[i]));
+      }
+   }
+   TEST_ASSERT(nCachedPlan() == nPlan);
+}
+
+void FftTest::testWisdom()
+{
+   printMethod(TEST_FUNC);
+
+   IntVec<1> d;
+   d[0] = 12;
+   RField<1> in, inCopy;
+   RFieldDft<1> out;
+   in.allocate(d);
+   inCopy.allocate(d);
+   out.allocate(d);
+   double twoPi = 2.0*Constants::Pi;
+   for (int i = 0; i < d[0]; ++i) {
+      in[i] = 1.0 + sin(twoPi*double(i)/double(d[0]));
+   }
+
+   // Plans created with FFTW_MEASURE do not overwrite the input
+   setPlanRigor("measure");
+   TEST_ASSERT(planRigor() == FFTW_MEASURE);
+   {
+      FFT<1> v;
+      v.forwardTransform(in, out);
+      v.inverseTransform(out, inCopy);
+      for (int i = 0; i < d[0]; ++i) {
+         TEST_ASSERT(eq(in[i], inCopy[i]));
+      }
+   }
+   setPlanRigor("estimate");
+   TEST_ASSERT(planRigor() == FFTW_ESTIMATE);
+
+   // Written wisdom can be read back
+   std::stringstream buffer;
+   writeWisdom(buffer);
+   std::string label;
+   buffer >> label;
+   TEST_ASSERT(label == "nTunedPlan");
+   buffer.seekg(0);
+   readWisdom(buffer);
+}
+
+void FftTest::testUnscaled()
+{
+   printMethod(TEST_FUNC);
+
+   IntVec<1> d;
+   d[0] = 10;
+   RField<1> in, inCopy;
+   RFieldDft<1> out, outUnscaled;
+   in.allocate(d);
+   inCopy.allocate(d);
+   out.allocate(d);
+   outUnscaled.allocate(d);
+   double twoPi = 2.0*Constants::Pi;
+   for (int i = 0; i < d[0]; ++i) {
+      in[i] = 1.0 + cos(twoPi*double(i)/double(d[0]));
+      inCopy[i] = in[i];
+   }
+
+   FFT<1> v;
+   v.forwardTransform(in, out);
+   v.forwardTransformUnscaled(in, outUnscaled);
+
+   // Input is unmodified, output is larger by a factor of d[0]
+   double n = double(d[0]);
+   for (int i = 0; i < d[0]; ++i) {
+      TEST_ASSERT(in[i] == inCopy[i]);
+   }
+   for (int i = 0; i < out.capacity(); ++i) {
+      TEST_ASSERT(eq(outUnscaled[i][0], n*out[i][0]));
+      TEST_ASSERT(eq(outUnscaled[i][1], n*out[i][1]));
+   }
+}
+
 TEST_BEGIN(FftTest)
 TEST_ADD(FftTest, testConstructor)
 TEST_ADD(FftTest, testTransform1D)
 TEST_ADD(FftTest, testTransform2D)
 TEST_ADD(FftTest, testTransform3D)
+TEST_ADD(FftTest, testSharedPlans)
+TEST_ADD(FftTest, testWisdom)
+TEST_ADD(FftTest, testUnscaled)
 TEST_END(FftTest)
 
 #endif
@@ -7,6 +7,7 @@
 #include "RFieldTest.h"
 #include "RFieldDftTest.h"
 #include "FftTest.h"
+#include "FFTBatchedTest.h"
 //#include "FieldUtilTest.h"
 
 TEST_COMPOSITE_BEGIN(FieldTestComposite)
@@ -14,6 +15,7 @@ TEST_COMPOSITE_ADD_UNIT(FieldTest);
 TEST_COMPOSITE_ADD_UNIT(RFieldTest);
 TEST_COMPOSITE_ADD_UNIT(RFieldDftTest);
 TEST_COMPOSITE_ADD_UNIT(FftTest);
+TEST_COMPOSITE_ADD_UNIT(FFTBatchedTest);
 //TEST_COMPOSITE_ADD_UNIT(FieldUtilTest);
 TEST_COMPOSITE_END
 
@@ -10,6 +10,7 @@
 #include <pspc/solvers/Propagator.h>
 #include <pscf/mesh/Mesh.h>
 #include <pscf/crystal/UnitCell.h>
+#include <pscf/crystal/Basis.h>
 #include <pscf/math/IntVec.h>
 #include <util/math/Constants.h>
 
@@ -123,6 +124,278 @@ public:
       
    }
 
+   void testSolverBlend1D()
+   {
+      printMethod(TEST_FUNC);
+      Mixture<1> mixture;
+
+      std::ifstream in;
+      openInputFile("in/MixtureBlend", in);
+      mixture.readParam(in);
+      UnitCell<1> unitCell;
+      in >> unitCell;
+      IntVec<1> d;
+      in >> d;
+      in.close();
+      TEST_ASSERT(mixture.nPolymer() == 3);
+      TEST_ASSERT(mixture.isSpeciesParallel());
+
+      Mesh<1> mesh;
+      mesh.setDimensions(d);
+      mixture.setMesh(mesh);
+      mixture.setupUnitCell(unitCell);
+
+      int nMonomer = mixture.nMonomer();
+      DArray<Mixture<1>::WField> wFields;
+      DArray<Mixture<1>::CField> cFields;
+      wFields.allocate(nMonomer);
+      cFields.allocate(nMonomer);
+      int nx = mesh.size();
+      for (int i = 0; i < nMonomer; ++i) {
+         wFields[i].allocate(nx);
+         cFields[i].allocate(nx);
+      }
+
+      double cs;
+      for (int i = 0; i < nx; ++i) {
+         cs = cos(2.0*Constants::Pi*double(i)/double(nx));
+         wFields[0][i] = 0.5 + cs;
+         wFields[1][i] = 0.5 - cs;
+      }
+
+      mixture.compute(wFields, cFields);
+
+      // Compare monomer fields to serial sum over blocks
+      int i, j, k, monomerId;
+      double phi, sum;
+      for (k = 0; k < nx; ++k) {
+         for (monomerId = 0; monomerId < nMonomer; ++monomerId) {
+            sum = 0.0;
+            for (i = 0; i < mixture.nPolymer(); ++i) {
+               phi = mixture.polymer(i).phi();
+               for (j = 0; j < mixture.polymer(i).nBlock(); ++j) {
+                  Pspc::Block<1>& block = mixture.polymer(i).block(j);
+                  if (block.monomerId() == monomerId) {
+                     sum += phi*block.cField()[k];
+                  }
+               }
+            }
+            TEST_ASSERT(eq(sum, cFields[monomerId][k]));
+         }
+      }
+
+      // Stress is the sum of species contributions
+      mixture.computeStress();
+      sum = 0.0;
+      for (i = 0; i < mixture.nPolymer(); ++i) {
+         sum += mixture.polymer(i).stress(0);
+      }
+      TEST_ASSERT(eq(sum, mixture.stress(0)));
+   }
+
+   /*
+   * Read a 1D mixture, solve it in a fixed field, and compute stress.
+   */
+   void solve1D(const char* filename, Mixture<1>& mixture, Mesh<1>& mesh,
+                UnitCell<1>& unitCell, DArray< Mixture<1>::CField >& cFields)
+   {
+      std::ifstream in;
+      openInputFile(filename, in);
+      mixture.readParam(in);
+      in >> unitCell;
+      IntVec<1> d;
+      in >> d;
+      in.close();
+
+      mesh.setDimensions(d);
+      mixture.setMesh(mesh);
+      mixture.setupUnitCell(unitCell);
+
+      int nMonomer = mixture.nMonomer();
+      int nx = mesh.size();
+      DArray<Mixture<1>::WField> wFields;
+      wFields.allocate(nMonomer);
+      cFields.allocate(nMonomer);
+      for (int i = 0; i < nMonomer; ++i) {
+         wFields[i].allocate(nx);
+         cFields[i].allocate(nx);
+      }
+      double cs;
+      for (int i = 0; i < nx; ++i) {
+         cs = cos(2.0*Constants::Pi*double(i)/double(nx));
+         wFields[0][i] = 0.5 + cs;
+         wFields[1][i] = 0.5 - cs;
+      }
+
+      mixture.compute(wFields, cFields);
+      mixture.computeStress();
+   }
+
+   void testSharedTables1D()
+   {
+      printMethod(TEST_FUNC);
+
+      // Mixture with operator tables shared among blocks
+      Mixture<1> mixture;
+      std::ifstream in;
+      openInputFile("in/MixtureBlend", in);
+      mixture.readParam(in);
+      UnitCell<1> unitCell;
+      in >> unitCell;
+      IntVec<1> d;
+      in >> d;
+      in.close();
+      Mesh<1> mesh;
+      mesh.setDimensions(d);
+      mixture.setMesh(mesh);
+      mixture.setupUnitCell(unitCell);
+
+      // Identical mixture, with blocks that each own their tables
+      Mixture<1> mixtureB;
+      openInputFile("in/MixtureBlend", in);
+      mixtureB.readParam(in);
+      in.close();
+      int i, j, k;
+      for (i = 0; i < mixtureB.nPolymer(); ++i) {
+         for (j = 0; j < mixtureB.polymer(i).nBlock(); ++j) {
+            Pspc::Block<1>& block = mixtureB.polymer(i).block(j);
+            block.setDiscretization(0.01, mesh);
+            block.setupUnitCell(unitCell);
+            TEST_ASSERT(mixture.polymer(i).block(j).hasSharedTables());
+            TEST_ASSERT(!block.hasSharedTables());
+         }
+      }
+
+      int nMonomer = mixture.nMonomer();
+      DArray<Mixture<1>::WField> wFields;
+      DArray<Mixture<1>::CField> cFields;
+      wFields.allocate(nMonomer);
+      cFields.allocate(nMonomer);
+      int nx = mesh.size();
+      for (i = 0; i < nMonomer; ++i) {
+         wFields[i].allocate(nx);
+         cFields[i].allocate(nx);
+      }
+      double cs;
+      for (i = 0; i < nx; ++i) {
+         cs = cos(2.0*Constants::Pi*double(i)/double(nx));
+         wFields[0][i] = 0.5 + cs;
+         wFields[1][i] = 0.5 - cs;
+      }
+
+      mixture.compute(wFields, cFields);
+      for (i = 0; i < mixtureB.nPolymer(); ++i) {
+         mixtureB.polymer(i).compute(wFields);
+      }
+
+      // Block concentrations must be identical
+      for (i = 0; i < mixture.nPolymer(); ++i) {
+         for (j = 0; j < mixture.polymer(i).nBlock(); ++j) {
+            Pspc::Block<1>& blockA = mixture.polymer(i).block(j);
+            Pspc::Block<1>& blockB = mixtureB.polymer(i).block(j);
+            for (k = 0; k < nx; ++k) {
+               TEST_ASSERT(eq(blockA.cField()[k], blockB.cField()[k]));
+            }
+         }
+      }
+   }
+
+   void testCheckpoint1D()
+   {
+      printMethod(TEST_FUNC);
+
+      Mixture<1> mixture;
+      Mesh<1> mesh;
+      UnitCell<1> unitCell;
+      DArray< Mixture<1>::CField > cFields;
+      solve1D("in/Mixture", mixture, mesh, unitCell, cFields);
+
+      Mixture<1> mixtureC;
+      Mesh<1> meshC;
+      UnitCell<1> unitCellC;
+      DArray< Mixture<1>::CField > cFieldsC;
+      solve1D("in/MixtureCheckpoint", mixtureC, meshC, unitCellC, cFieldsC);
+      TEST_ASSERT(mixtureC.checkpointInterval() == 7);
+      TEST_ASSERT(mixtureC.polymer(0).block(0).propagator(0)
+                                         .checkpointInterval() == 7);
+
+      Mixture<1> mixtureM;
+      Mesh<1> meshM;
+      UnitCell<1> unitCellM;
+      DArray< Mixture<1>::CField > cFieldsM;
+      solve1D("in/MixtureMemory", mixtureM, meshM, unitCellM, cFieldsM);
+      TEST_ASSERT(mixtureM.checkpointInterval() > 1);
+
+      // Check that the budget of 0.5 Mbytes is respected
+      int i, j, ns;
+      double memory = 0.0;
+      for (j = 0; j < mixtureM.polymer(0).nBlock(); ++j) {
+         ns = mixtureM.polymer(0).block(j).ns();
+         memory += 2.0*meshM.size()*sizeof(double)
+                   *Propagator<1>::nStoredSlice(ns, 
+                                       mixtureM.checkpointInterval());
+      }
+      TEST_ASSERT(memory <= 0.5*1048576.0);
+
+      // Compare to results obtained with all slices stored
+      for (j = 0; j < mixture.nMonomer(); ++j) {
+         for (i = 0; i < mesh.size(); ++i) {
+            TEST_ASSERT(eq(cFields[j][i], cFieldsC[j][i]));
+            TEST_ASSERT(eq(cFields[j][i], cFieldsM[j][i]));
+         }
+      }
+      TEST_ASSERT(eq(mixture.stress(0), mixtureC.stress(0)));
+      TEST_ASSERT(eq(mixture.stress(0), mixtureM.stress(0)));
+   }
+
+   void testSingleStorage1D()
+   {
+      printMethod(TEST_FUNC);
+
+      Mixture<1> mixture;
+      Mesh<1> mesh;
+      UnitCell<1> unitCell;
+      DArray< Mixture<1>::CField > cFields;
+      solve1D("in/Mixture", mixture, mesh, unitCell, cFields);
+
+      Mixture<1> mixtureS;
+      Mesh<1> meshS;
+      UnitCell<1> unitCellS;
+      DArray< Mixture<1>::CField > cFieldsS;
+      solve1D("in/MixtureSingleStorage", mixtureS, meshS, unitCellS, 
+              cFieldsS);
+      TEST_ASSERT(mixtureS.isSingleStorage());
+
+      // One propagator of each block of the diblock is streamed
+      Polymer<1>& polymer = mixtureS.polymer(0);
+      TEST_ASSERT(polymer.nAlias() == 0);
+      for (int j = 0; j < polymer.nBlock(); ++j) {
+         int k = polymer.streamDirectionId(j);
+         TEST_ASSERT(k >= 0);
+         TEST_ASSERT(polymer.block(j).propagator(k).isStreamed());
+         TEST_ASSERT(!polymer.block(j).propagator(1 - k).isStreamed());
+      }
+
+      // Streamed propagators combined with checkpoints in the partner
+      Mixture<1> mixtureC;
+      Mesh<1> meshC;
+      UnitCell<1> unitCellC;
+      DArray< Mixture<1>::CField > cFieldsC;
+      solve1D("in/MixtureSingleCheckpoint", mixtureC, meshC, unitCellC, 
+              cFieldsC);
+
+      // Compare to results obtained with all slices stored
+      int i, j;
+      for (j = 0; j < mixture.nMonomer(); ++j) {
+         for (i = 0; i < mesh.size(); ++i) {
+            TEST_ASSERT(eq(cFields[j][i], cFieldsS[j][i]));
+            TEST_ASSERT(eq(cFields[j][i], cFieldsC[j][i]));
+         }
+      }
+      TEST_ASSERT(eq(mixture.stress(0), mixtureS.stress(0)));
+      TEST_ASSERT(eq(mixture.stress(0), mixtureC.stress(0)));
+   }
+
    void testSolver2D()
    {
       printMethod(TEST_FUNC);
@@ -302,6 +575,78 @@ public:
   
    }
     
+   /*
+   * Star-reduced stress for a rectangular cell with a = b and a square
+   * space group, for which waves in one star have different derivatives
+   * of |G|^2 with respect to each cell parameter.
+   */
+   void testStarStress2D_square()
+   {
+      printMethod(TEST_FUNC);
+      Mixture<2> mixture;
+
+      std::ifstream in;
+      openInputFile("in/Mixture2d_square", in);
+      mixture.readParam(in);
+      UnitCell<2> unitCell;
+      in >> unitCell;
+      IntVec<2> d;
+      in >> d;
+      in.close();
+      TEST_ASSERT(unitCell.nParameter() == 2);
+
+      Mesh<2> mesh;
+      mesh.setDimensions(d);
+      mixture.setMesh(mesh);
+      mixture.setupUnitCell(unitCell);
+
+      Basis<2> basis;
+      basis.makeBasis(mesh, unitCell, std::string("p_4_m_m"));
+
+      int nMonomer = mixture.nMonomer();
+      DArray<Mixture<2>::WField> wFields;
+      DArray<Mixture<2>::CField> cFields;
+      wFields.allocate(nMonomer);
+      cFields.allocate(nMonomer);
+      int nx = mesh.size();
+      for (int i = 0; i < nMonomer; ++i) {
+         wFields[i].allocate(nx);
+         cFields[i].allocate(nx);
+      }
+
+      // Generate a w field with p4mm symmetry
+      int dx = mesh.dimension(0);
+      int dy = mesh.dimension(1);
+      double fx = 2.0*Constants::Pi/double(dx);
+      double fy = 2.0*Constants::Pi/double(dy);
+      double cx, cy;
+      int k = 0;
+      for (int i = 0; i < dx; ++i) {
+         cx = cos(fx*double(i));
+         for (int j = 0; j < dy; ++j) {
+            cy = cos(fy*double(j));
+            wFields[0][k] = 0.5 + cx + cy + 0.5*cx*cy;
+            wFields[1][k] = 0.5 - cx - cy - 0.5*cx*cy;
+            ++k;
+         }
+      }
+      TEST_ASSERT(k == nx);
+
+      // Sum over all waves
+      mixture.compute(wFields, cFields);
+      mixture.computeStress();
+      double stress0 = mixture.stress(0);
+      double stress1 = mixture.stress(1);
+      TEST_ASSERT(std::abs(stress0 - stress1) < 1.0E-8);
+
+      // Sum over stars
+      mixture.setBasis(basis);
+      mixture.compute(wFields, cFields);
+      mixture.computeStress();
+      TEST_ASSERT(std::abs(mixture.stress(0) - stress0) < 1.0E-8);
+      TEST_ASSERT(std::abs(mixture.stress(1) - stress1) < 1.0E-8);
+   }
+    
    void testSolver3D()
    {
       printMethod(TEST_FUNC);
@@ -383,8 +728,13 @@ TEST_BEGIN(MixtureTest)
 TEST_ADD(MixtureTest, testConstructor1D)
 TEST_ADD(MixtureTest, testReadParameters1D)
 TEST_ADD(MixtureTest, testSolver1D)
+TEST_ADD(MixtureTest, testSolverBlend1D)
+TEST_ADD(MixtureTest, testSharedTables1D)
+TEST_ADD(MixtureTest, testCheckpoint1D)
+TEST_ADD(MixtureTest, testSingleStorage1D)
 TEST_ADD(MixtureTest, testSolver2D)
 TEST_ADD(MixtureTest, testSolver2D_hex)
+TEST_ADD(MixtureTest, testStarStress2D_square)
 TEST_ADD(MixtureTest, testSolver3D)
 TEST_END(MixtureTest)
 
@@ -7,12 +7,16 @@
 #include <pspc/solvers/Block.h>
 #include <pscf/mesh/MeshIterator.h>
 #include <pspc/solvers/Propagator.h>
+#include <pspc/solvers/WaveList.h>
+#include <pscf/crystal/shiftToMinimum.h>
 #include <pscf/mesh/Mesh.h>
 #include <pscf/crystal/UnitCell.h>
 #include <pscf/math/IntVec.h>
 #include <util/math/Constants.h>
 
 #include <fstream>
+#include <sstream>
+#include <cmath>
 
 using namespace Util;
 using namespace Pscf;
@@ -560,6 +564,164 @@ public:
 
    }
 
+   /*
+   * Solve for the tail of propagator(0) of a 1D block in an 
+   * inhomogeneous field, using a specified step algorithm and ds.
+   */
+   void computeTail1D(StepAlgorithm::Type algorithm, double ds, 
+                      RField<1>& tail)
+   {
+      Block<1> block;
+      setupBlock1D(block);
+      block.setStepAlgorithm(algorithm);
+      TEST_ASSERT(block.stepAlgorithm() == algorithm);
+
+      Mesh<1> mesh;
+      setupMesh1D(mesh);
+      block.setDiscretization(ds, mesh);
+
+      UnitCell<1> unitCell;
+      setupUnitCell1D(unitCell);
+
+      RField<1> w;
+      w.allocate(mesh.dimensions());
+      int nx = mesh.size();
+      double twoPi = 2.0*Constants::Pi;
+      for (int i=0; i < nx; ++i) {
+         w[i] = 0.5 + cos(twoPi*double(i)/double(nx));
+      }
+      block.setupUnitCell(unitCell);
+      block.setupSolver(w);
+      block.propagator(0).solve();
+
+      if (!tail.isAllocated()) {
+         tail.allocate(mesh.dimensions());
+      }
+      for (int i=0; i < nx; ++i) {
+         tail[i] = block.propagator(0).tail()[i];
+      }
+   }
+
+   /*
+   * Maximum absolute difference between two fields.
+   */
+   double maxError(RField<1> const & a, RField<1> const & b)
+   {
+      double error = 0.0;
+      for (int i=0; i < a.capacity(); ++i) {
+         if (std::abs(a[i] - b[i]) > error) {
+            error = std::abs(a[i] - b[i]);
+         }
+      }
+      return error;
+   }
+
+   /*
+   * Estimate the order of convergence of a step algorithm from the
+   * errors at ds = 0.1, 0.05 and 0.025, relative to a reference 
+   * solution computed with the Richardson algorithm and ds = 0.002.
+   */
+   void checkStepOrder1D(StepAlgorithm::Type algorithm, double order)
+   {
+      RField<1> reference;
+      computeTail1D(StepAlgorithm::Richardson, 0.002, reference);
+
+      RField<1> tail;
+      double ds = 0.1;
+      double error[3];
+      for (int i = 0; i < 3; ++i) {
+         computeTail1D(algorithm, ds, tail);
+         error[i] = maxError(tail, reference);
+         ds *= 0.5;
+      }
+      double p1 = log(error[0]/error[1])/log(2.0);
+      double p2 = log(error[1]/error[2])/log(2.0);
+      //std::cout << std::endl;
+      //std::cout << algorithm << " errors = " << error[0] << "  " 
+      //          << error[1] << "  " << error[2] << std::endl;
+      //std::cout << algorithm << " orders = " << p1 << "  " 
+      //          << p2 << std::endl;
+      TEST_ASSERT(std::abs(p1 - order) < 0.3);
+      TEST_ASSERT(std::abs(p2 - order) < 0.3);
+   }
+
+   void testStepOrderStrang1D()
+   {
+      printMethod(TEST_FUNC);
+      checkStepOrder1D(StepAlgorithm::Strang, 2.0);
+   }
+
+   void testStepOrderRichardson1D()
+   {
+      printMethod(TEST_FUNC);
+      checkStepOrder1D(StepAlgorithm::Richardson, 4.0);
+   }
+
+   void testStepOrderEtdrk41D()
+   {
+      printMethod(TEST_FUNC);
+      checkStepOrder1D(StepAlgorithm::ETDRK4, 4.0);
+   }
+
+   /*
+   * Compare WaveList<2> to shiftToMinimum, ksq and dksq of UnitCell<2>.
+   */
+   bool isWaveListValid(WaveList<2> const & waveList, 
+                        UnitCell<2> const & unitCell, Mesh<2> const & mesh)
+   {
+      MeshIterator<2> iter(waveList.kMeshDimensions());
+      IntVec<2> v, vmin;
+      int i, n;
+      for (iter.begin(); !iter.atEnd(); ++iter) {
+         i = iter.rank();
+         v = iter.position();
+         vmin = shiftToMinimum(v, mesh.dimensions(), unitCell);
+         if (!(vmin == waveList.minImage(i))) return false;
+         if (waveList.kSq()[i] != unitCell.ksq(vmin)) return false;
+         for (n = 0; n < unitCell.nParameter(); ++n) {
+            if (waveList.dkSq(n)[i] != unitCell.dksq(vmin, n)) {
+               return false;
+            }
+         }
+      }
+      return true;
+   }
+
+   void testWaveList2D()
+   {
+      printMethod(TEST_FUNC);
+
+      Mesh<2> mesh;
+      IntVec<2> d;
+      d[0] = 9;
+      d[1] = 12;
+      mesh.setDimensions(d);
+
+      WaveList<2> waveList;
+      waveList.allocate(mesh);
+      TEST_ASSERT(waveList.kSize() == 9*7);
+
+      // Non-orthogonal cell, before and after a change in parameters
+      UnitCell<2> hex;
+      std::istringstream in("hexagonal  1.8");
+      in >> hex;
+      waveList.setupUnitCell(hex);
+      TEST_ASSERT(isWaveListValid(waveList, hex, mesh));
+      FSArray<double, 6> parameters = hex.parameters();
+      parameters[0] = 2.1;
+      hex.setParameters(parameters);
+      waveList.setupUnitCell(hex);
+      TEST_ASSERT(isWaveListValid(waveList, hex, mesh));
+
+      // Orthogonal cell
+      WaveList<2> waveList2;
+      waveList2.allocate(mesh);
+      UnitCell<2> rectangular;
+      setupUnitCell2D(rectangular);
+      waveList2.setupUnitCell(rectangular);
+      TEST_ASSERT(isWaveListValid(waveList2, rectangular, mesh));
+   }
+
 };
 
 TEST_BEGIN(PropagatorTest)
@@ -571,6 +733,10 @@ TEST_ADD(PropagatorTest, testSetupSolver3D)
 TEST_ADD(PropagatorTest, testSolver1D)
 TEST_ADD(PropagatorTest, testSolver2D)
 TEST_ADD(PropagatorTest, testSolver3D)
+TEST_ADD(PropagatorTest, testStepOrderStrang1D)
+TEST_ADD(PropagatorTest, testStepOrderRichardson1D)
+TEST_ADD(PropagatorTest, testStepOrderEtdrk41D)
+TEST_ADD(PropagatorTest, testWaveList2D)
 TEST_END(PropagatorTest)
 
 #endif
@@ -5,11 +5,14 @@
 #include <test/UnitTestRunner.h>
 
 #include <pspc/System.h>
+#include <pspc/SystemSet.h>
 #include <pspc/iterator/AmIterator.h>
+#include <pscf/inter/ChiInteraction.h>
 #include <pscf/mesh/MeshIterator.h>
 //#include <util/format/Dbl.h>
 
 #include <fstream>
+#include <string>
 
 using namespace Util;
 using namespace Pscf;
@@ -38,6 +41,48 @@ public:
       Log::setFile(logFile_);
    }
 
+   /*
+   * Read w fields from in/domainOn/ReadOmega_hex, iterate with the
+   * commands in in/domainOn/Iterate2d, and check that the converged
+   * fields differ from the input by less than 5.0E-7. The parameter
+   * file must already have been read.
+   */
+   void checkIterate2D_hex(System<2>& system)
+   {
+      std::ifstream command;
+      openInputFile("in/domainOn/ReadOmega_hex", command);
+      system.readCommands(command);
+      command.close();
+
+      int nMonomer = system.mixture().nMonomer();
+      int ns = system.basis().nStar();
+      DArray< DArray<double> > wFields_check;
+      wFields_check.allocate(nMonomer);
+      for (int i = 0; i < nMonomer; ++i) {
+         wFields_check[i].allocate(ns);
+         for (int j = 0; j < ns; ++j) {
+            wFields_check[i][j] = system.wFields()[i][j];
+         }
+      }
+
+      std::ifstream command_2;
+      openInputFile("in/domainOn/Iterate2d", command_2);
+      system.readCommands(command_2);
+      command_2.close();
+
+      double maxDiff = 0.0;
+      double diff;
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 0; j < ns; ++j) {
+            diff = std::abs(wFields_check[i][j] - system.wFields()[i][j]);
+            if (diff > maxDiff) {
+               maxDiff = diff;
+            }
+         }
+      }
+      TEST_ASSERT(maxDiff < 5.0E-7);
+   }
+
    void testConstructor1D()
    {
       printMethod(TEST_FUNC);
@@ -168,6 +213,94 @@ public:
 
    }  
 
+   void testConversion2D_hex_binary() 
+   {   
+      printMethod(TEST_FUNC);
+      System<2> system;
+      openLogFile("out/testConversion2D_hex_binary.log"); 
+
+      // Read parameter file
+      std::ifstream in; 
+      openInputFile("in/domainOn/System2D", in);
+      system.readParam(in);
+      in.close();
+
+      // Read w fields
+      std::ifstream command;
+      openInputFile("in/conv/Conversion_2d_step1", command);
+      system.readCommands(command);
+      command.close();
+
+      // Store basis and r-grid fields for later comparison 
+      int nMonomer = system.mixture().nMonomer();
+      int nStar = system.basis().nStar();
+      int nx = system.mesh().size();
+      DArray< DArray<double> > wFields_check;
+      DArray< RField<2> > wFieldsRGrid_check;
+      wFields_check.allocate(nMonomer);
+      wFieldsRGrid_check.allocate(nMonomer);
+      for (int i = 0; i < nMonomer; ++i) {
+         wFields_check[i].allocate(nStar);
+         for (int j = 0; j < nStar; ++j){    
+            wFields_check[i][j] = system.wFields()[i][j];
+         }   
+         wFieldsRGrid_check[i].allocate(system.mesh().dimensions());
+         for (int j = 0; j < nx; ++j){    
+            wFieldsRGrid_check[i][j] = system.wFieldsRGrid()[i][j];
+         }   
+      }   
+
+      // Write binary files, convert k-grid text <-> binary
+      openInputFile("in/conv/Conversion_2d_bin_step2", command);
+      system.readCommands(command);
+      command.close();
+
+      // Text k-grid -> binary -> text round trip is unchanged
+      std::ifstream kFile1, kFile2;
+      openInputFile("out/omega/conv/omega_hex.kf", kFile1);
+      openInputFile("out/omega/conv/omega_hex_bin.kf", kFile2);
+      std::string line1, line2;
+      int nLine = 0;
+      while (std::getline(kFile1, line1)) {
+         TEST_ASSERT(std::getline(kFile2, line2));
+         TEST_ASSERT(line1 == line2);
+         ++nLine;
+      }
+      TEST_ASSERT(!std::getline(kFile2, line2));
+      TEST_ASSERT(nLine > 0);
+
+      // Binary r-grid round trip is exact
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 0; j < nx; ++j){    
+            system.wFieldsRGrid()[i][j] = 0.0;
+         }
+      }
+      openInputFile("in/conv/Conversion_2d_bin_step3", command);
+      system.readCommands(command);
+      command.close();
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 0; j < nx; ++j) {
+            TEST_ASSERT(wFieldsRGrid_check[i][j] 
+                        == system.wFieldsRGrid()[i][j]);
+         }
+      }
+
+      // Binary basis round trip is exact
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 0; j < nStar; ++j){    
+            system.wFields()[i][j] = 0.0;
+         }
+      }
+      openInputFile("in/conv/Conversion_2d_bin_step4", command);
+      system.readCommands(command);
+      command.close();
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 0; j < nStar; ++j) {
+            TEST_ASSERT(wFields_check[i][j] == system.wFields()[i][j]);
+         }
+      }
+   }
+
    void testConversion3D_bcc() 
    {   
       printMethod(TEST_FUNC);
@@ -351,6 +484,145 @@ public:
       TEST_ASSERT(diff);
    }
 
+   void testIterate1D_lam_flex_pc()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testIterate1D_lam_flex_pc.log"); 
+ 
+      System<1> system;
+      std::ifstream in; 
+      openInputFile("in/domainOn/System1D_pc", in);
+    
+      system.readParam(in);
+      in.close();
+      std::ifstream command;
+      openInputFile("in/domainOn/ReadOmega_lam", command);
+      system.readCommands(command);
+      command.close();
+ 
+      int nMonomer = system.mixture().nMonomer();
+      DArray<RField<1> > wFields_check;
+      DArray<RField<1> > wFields;
+      wFields_check.allocate(nMonomer);
+      wFields.allocate(nMonomer);
+      int ns = system.basis().nStar();
+      for (int i = 0; i < nMonomer; ++i) {
+          wFields_check[i].allocate(ns);
+      }   
+
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 0; j < ns; ++j) {    
+            wFields_check[i][j] = system.wFields() [i] [j];
+         }   
+      }   
+
+      std::ifstream command_2;
+      openInputFile("in/domainOn/Iterate1d", command_2);
+      system.readCommands(command_2);
+      command_2.close();
+
+      bool diff = true;
+      for (int j = 0; j < ns; ++j) {
+         for (int i = 0; i < nMonomer; ++i) {
+           if ((std::abs(wFields_check[i][j] - system.wFields()[i][j]) > 1.0E-8)) {
+               diff = false;
+               std::cout <<"\n This is error for break:"<< 
+                  (std::abs(wFields_check[i][j] - system.wFields()[i][j])) <<std::endl;
+               std::cout <<"star index = "<< j << std::endl;
+               break;
+            }   
+            else
+               diff = true;
+         }   
+         if (diff==false) {
+            break;
+         }
+      }   
+      TEST_ASSERT(diff);
+   }
+
+   void testSweep1D_lam_chi()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testSweep1D_lam_chi.log"); 
+ 
+      System<1> system;
+      std::ifstream in; 
+      openInputFile("in/domainOn/System1D_sweep_chi", in);
+      system.readParam(in);
+      in.close();
+      TEST_ASSERT(system.hasSweep());
+
+      std::ifstream command;
+      openInputFile("in/domainOn/Sweep1d", command);
+      system.readCommands(command);
+      command.close();
+
+      // Final state has chi = 12 + 1, and is converged
+      TEST_ASSERT(std::abs(system.interaction().chi(1, 0) - 13.0) < 1.0E-10);
+      TEST_ASSERT(std::abs(system.interaction().chi(0, 1) - 13.0) < 1.0E-10);
+      TEST_ASSERT(system.iterator().solve() == 0);
+      TEST_ASSERT(system.iterator().nIteration() == 1);
+   }
+
+   void testSweep1D_lam_length()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testSweep1D_lam_length.log"); 
+ 
+      System<1> system;
+      std::ifstream in; 
+      openInputFile("in/domainOn/System1D_sweep_length", in);
+      system.readParam(in);
+      in.close();
+      TEST_ASSERT(system.hasSweep());
+      int ns = system.mixture().polymer(0).block(0).ns();
+
+      std::ifstream command;
+      openInputFile("in/domainOn/Sweep1d", command);
+      system.readCommands(command);
+      command.close();
+
+      // Final state has block length 0.56 + 0.04, and is converged
+      Pspc::Block<1> const & block = system.mixture().polymer(0).block(0);
+      TEST_ASSERT(std::abs(block.length() - 0.60) < 1.0E-10);
+      TEST_ASSERT(block.ns() == ns);
+      TEST_ASSERT(std::abs(block.ds()*(ns - 1) - 0.60) < 1.0E-10);
+      TEST_ASSERT(system.iterator().solve() == 0);
+      TEST_ASSERT(system.iterator().nIteration() == 1);
+   }
+
+   void testSystemSet1D_lam()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testSystemSet1D_lam.log"); 
+
+      SystemSet<1> set;
+      std::string param = filePrefix() + "in/domainOn/System1D";
+      std::string command = filePrefix() + "in/domainOn/IterateSet1d";
+      set.addSystem(param, command, filePrefix(), "out/set0_");
+      set.addSystem(param, command, filePrefix(), "out/set1_");
+      TEST_ASSERT(set.nSystem() == 2);
+
+      TEST_ASSERT(set.run() == 0);
+      TEST_ASSERT(!set.isFailed(0));
+      TEST_ASSERT(!set.isFailed(1));
+
+      // Identical systems converge to identical solutions
+      double f0 = set.system(0).fHelmholtz();
+      double f1 = set.system(1).fHelmholtz();
+      TEST_ASSERT(std::abs(f0 - f1) < 1.0E-10);
+      TEST_ASSERT(set.system(0).iterator().solve() == 0);
+      TEST_ASSERT(set.system(0).iterator().nIteration() == 1);
+
+      // Each system writes its own log and field files
+      std::ifstream in;
+      openInputFile("out/set1_log", in);
+      in.close();
+      openInputFile("out/set1_omega_lam", in);
+      in.close();
+   }
+
    void testIterate2D_hex_rigid()
    {
       printMethod(TEST_FUNC);
@@ -430,51 +702,97 @@ public:
       system.readParam(in);
       in.close();
 
+      checkIterate2D_hex(system);
+   }
+
+   void testIterate2D_hex_flex_qr()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testIterate2D_hex_flex_qr.log"); 
+
+      System<2> system;
+      std::ifstream in;
+      openInputFile("in/domainOn/System2D_qr", in);
+      system.readParam(in);
+      in.close();
+
+      checkIterate2D_hex(system);
+   }
+
+   void testIterate2D_hex_flex_nk()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testIterate2D_hex_flex_nk.log"); 
+
+      System<2> system;
+      std::ifstream in;
+      openInputFile("in/domainOn/System2D_nk", in);
+      system.readParam(in);
+      in.close();
+
+      checkIterate2D_hex(system);
+
+      // Newton convergence from a nearly converged start takes only a 
+      // few steps (the Anderson mixing iterator needs about 20 here)
+      TEST_ASSERT(system.iterator().nIteration() <= 3);
+   }
+
+   void testIterate2D_hex_grid()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testIterate2D_hex_grid.log"); 
+
+      System<2> system;
+      std::ifstream in;
+      openInputFile("in/domainOn/System2D_grid", in);
+      system.readParam(in);
+      in.close();
+      TEST_ASSERT(system.hasSymmetricFields());
+
+      checkIterate2D_hex(system);
+   }
+
+   void testIterate1D_lam_grid()
+   {
+      printMethod(TEST_FUNC);
+      openLogFile("out/testIterate1D_lam_grid.log"); 
+
+      // No groupName, and thus no basis
+      System<1> system;
+      std::ifstream in;
+      openInputFile("in/domainOn/System1D_grid", in);
+      system.readParam(in);
+      in.close();
+      TEST_ASSERT(!system.hasBasis());
+      TEST_ASSERT(!system.hasSymmetricFields());
+
       std::ifstream command;
-      openInputFile("in/domainOn/ReadOmega_hex", command);
+      openInputFile("in/domainOn/ReadOmega_lam_rgrid", command);
       system.readCommands(command);
       command.close();
 
       int nMonomer = system.mixture().nMonomer();
-      DArray<RField<2> > wFields_check;
-      DArray<RField<2> > wFields;
-      wFields_check.allocate(nMonomer);
-      wFields.allocate(nMonomer);
-      int ns = system.basis().nStar();
-      for (int i = 0; i < nMonomer; ++i) {
-          wFields_check[i].allocate(ns);
-      }
-
-      for (int i = 0; i < nMonomer; ++i) {
-         for (int j = 0; j < ns; ++j) {
-            wFields_check[i][j] = system.wFields() [i] [j];
-         }
-      }
+      DArray<RField<1> > wFields_check;
+      wFields_check = system.wFieldsRGrid();
 
       std::ifstream command_2;
-      openInputFile("in/domainOn/Iterate2d", command_2);
+      openInputFile("in/domainOn/Iterate1d_rgrid", command_2);
       system.readCommands(command_2);
       command_2.close();
 
+      int nx = system.mesh().size();
       bool diff = true;
-      for (int j = 0; j < ns; ++j) {
-         for (int i = 0; i < nMonomer; ++i) {
-            // if ((std::abs(wFields_check[i][j] - system.wFields()[i][j]) >= 2.58007e-07)) {
-            if ((std::abs(wFields_check[i][j] - system.wFields()[i][j]) >= 5.0e-07)) {
-               // The above is the maximum error in the omega field.
-               // Occurs for the first star
+      for (int i = 0; i < nMonomer; ++i) {
+         for (int j = 0; j < nx; ++j) {
+            if (std::abs(wFields_check[i][j] 
+                         - system.wFieldsRGrid()[i][j]) >= 5.0e-07) {
                diff = false;
                std::cout <<"\n This is error for break:"<< 
-                  (std::abs(wFields_check[i][j] - system.wFields()[i][j])) <<std::endl;
-               std::cout <<"ns = "<< j << std::endl;
+                  (std::abs(wFields_check[i][j] 
+                            - system.wFieldsRGrid()[i][j])) <<std::endl;
                break;
-            } else {
-               diff = true;
             }
          }
-         if (diff==false) {
-            break;
-         }
       }
       TEST_ASSERT(diff);
    }
@@ -616,11 +934,20 @@ TEST_ADD(SystemTest, testConstructor1D)
 TEST_ADD(SystemTest, testReadParameters1D)
 TEST_ADD(SystemTest, testConversion1D_lam)
 TEST_ADD(SystemTest, testConversion2D_hex)
+TEST_ADD(SystemTest, testConversion2D_hex_binary)
 TEST_ADD(SystemTest, testConversion3D_bcc)
 TEST_ADD(SystemTest, testIterate1D_lam_rigid)
 TEST_ADD(SystemTest, testIterate1D_lam_flex)
+TEST_ADD(SystemTest, testIterate1D_lam_flex_pc)
+TEST_ADD(SystemTest, testSweep1D_lam_chi)
+TEST_ADD(SystemTest, testSweep1D_lam_length)
+TEST_ADD(SystemTest, testSystemSet1D_lam)
 TEST_ADD(SystemTest, testIterate2D_hex_rigid)
 TEST_ADD(SystemTest, testIterate2D_hex_flex)
+TEST_ADD(SystemTest, testIterate2D_hex_flex_qr)
+TEST_ADD(SystemTest, testIterate2D_hex_flex_nk)
+TEST_ADD(SystemTest, testIterate2D_hex_grid)
+TEST_ADD(SystemTest, testIterate1D_lam_grid)
 TEST_ADD(SystemTest, testIterate3D_bcc_rigid)
 TEST_ADD(SystemTest, testIterate3D_bcc_flex)
 
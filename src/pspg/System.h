@@ -69,6 +69,9 @@ namespace Pspg
 
       /**
       * Process command line options.
+      *
+      * Option -b dir names a directory of binary basis cache files
+      * (see Basis::makeBasis).
       */
       void setOptions(int argc, char **argv);
 
@@ -369,6 +372,11 @@ namespace Pspg
       */
       std::string groupName_;
 
+      /**
+      * Directory of binary basis cache files (empty if not used).
+      */
+      std::string basisCacheDir_;
+
       /**
       * Crystallographic unit cell (type and dimensions).
       */
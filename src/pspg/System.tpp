@@ -102,15 +102,17 @@ namespace Pspg
       bool oFlag = false;  // output prefix
       bool wFlag = false;  // GPU input 1 (# of blocks)
       bool tFlag = false;  // GPU input 2 (threads per block)
+      bool bFlag = false;  // basis cache directory
       char* pArg = 0;
       char* cArg = 0;
       char* iArg = 0;
       char* oArg = 0;
+      char* bArg = 0;
    
       // Read program arguments
       int c;
       opterr = 0;
-      while ((c = getopt(argc, argv, "er:p:c:i:o:f1:2:")) != -1) {
+      while ((c = getopt(argc, argv, "er:p:c:i:o:f1:2:b:")) != -1) {
          switch (c) {
          case 'e':
             eflag = true;
@@ -140,6 +142,10 @@ namespace Pspg
             tFlag = true;
             //something like this
             break;
+         case 'b': // basis cache directory
+            bFlag = true;
+            bArg  = optarg;
+            break;
          case '?':
            Log::file() << "Unknown option -" << optopt << std::endl;
            UTIL_THROW("Invalid command line option");
@@ -171,6 +177,11 @@ namespace Pspg
          fileMaster().setOutputPrefix(std::string(oArg));
       }
 
+      // If option -b, set directory of binary basis cache files
+      if (bFlag) {
+         basisCacheDir_ = std::string(bArg);
+      }
+
       if (!wFlag) {
          std::cout<<"Number of blocks not set " <<std::endl;
          exit(1);
@@ -222,7 +233,11 @@ namespace Pspg
 
       // Read group name, construct basis 
       read(in, "groupName", groupName_);
-      basis().makeBasis(mesh(), unitCell(), groupName_);
+      if (basisCacheDir_.empty()) {
+         basis().makeBasis(mesh(), unitCell(), groupName_);
+      } else {
+         basis().makeBasis(mesh(), unitCell(), groupName_, basisCacheDir_);
+      }
       fieldIo_.associate(unitCell_, mesh_, fft_, groupName_,
                          basis(), fileMaster_);
 
@@ -328,6 +343,23 @@ namespace Pspg
             fieldIo().readFieldsRGrid(filename, wFieldsRGrid());
             hasWFields_ = true;
 
+         } else 
+         if (command == "READ_W_BASIS_BIN") {
+            in >> filename;
+            Log::file() << " " << Str(filename, 20) <<std::endl;
+
+            fieldIo().readFieldsBasisBinary(filename, wFields());
+            fieldIo().convertBasisToRGrid(wFields(), wFieldsRGrid());
+            hasWFields_ = true;
+
+         } else 
+         if (command == "READ_W_RGRID_BIN") {
+            in >> filename;
+            Log::file() << " " << Str(filename, 20) <<std::endl;
+
+            fieldIo().readFieldsRGridBinary(filename, wFieldsRGrid());
+            hasWFields_ = true;
+
          } else 
          if (command == "ITERATE") {
             Log::file() << std::endl;
@@ -380,6 +412,32 @@ namespace Pspg
             Log::file() << "  " << Str(filename, 20) << std::endl;
             fieldIo().writeFieldsRGrid(filename, cFieldsRGrid());
          } else 
+         if (command == "WRITE_W_BASIS_BIN") {
+            UTIL_CHECK(hasWFields_);
+            in >> filename;
+            Log::file() << "  " << Str(filename, 20) << std::endl;
+            fieldIo().convertRGridToBasis(wFieldsRGrid(), wFields());
+            fieldIo().writeFieldsBasisBinary(filename, wFields());
+         } else 
+         if (command == "WRITE_W_RGRID_BIN") {
+            UTIL_CHECK(hasWFields_);
+            in >> filename;
+            Log::file() << "  " << Str(filename, 20) << std::endl;
+            fieldIo().writeFieldsRGridBinary(filename, wFieldsRGrid());
+         } else 
+         if (command == "WRITE_C_BASIS_BIN") {
+            UTIL_CHECK(hasCFields_);
+            in >> filename;
+            Log::file() << "  " << Str(filename, 20) << std::endl;
+            fieldIo().convertRGridToBasis(cFieldsRGrid(), cFields());
+            fieldIo().writeFieldsBasisBinary(filename, cFields());
+         } else 
+         if (command == "WRITE_C_RGRID_BIN") {
+            UTIL_CHECK(hasCFields_);
+            in >> filename;
+            Log::file() << "  " << Str(filename, 20) << std::endl;
+            fieldIo().writeFieldsRGridBinary(filename, cFieldsRGrid());
+         } else 
          if (command == "BASIS_TO_RGRID") {
             hasCFields_ = false;
 
@@ -432,6 +490,34 @@ namespace Pspg
             Log::file() << " " << Str(outFileName, 20) <<std::endl;
             fieldIo().writeFieldsRGrid(outFileName, cFieldsRGrid());
 
+         } else 
+         if (command == "KGRID_BIN_TO_KGRID") {
+            hasCFields_ = false;
+
+            std::string inFileName;
+            in >> inFileName;
+            Log::file() << " " << Str(inFileName, 20) <<std::endl;
+            fieldIo().readFieldsKGridBinary(inFileName, cFieldsKGrid());
+
+            std::string outFileName;
+            in >> outFileName;
+            Log::file() << " " << Str(outFileName, 20) <<std::endl;
+            fieldIo().writeFieldsKGrid(outFileName, cFieldsKGrid());
+
+         } else 
+         if (command == "KGRID_TO_KGRID_BIN") {
+            hasCFields_ = false;
+
+            std::string inFileName;
+            in >> inFileName;
+            Log::file() << " " << Str(inFileName, 20) <<std::endl;
+            fieldIo().readFieldsKGrid(inFileName, cFieldsKGrid());
+
+            std::string outFileName;
+            in >> outFileName;
+            Log::file() << " " << Str(outFileName, 20) <<std::endl;
+            fieldIo().writeFieldsKGridBinary(outFileName, cFieldsKGrid());
+
          } else 
          if (command == "RHO_TO_OMEGA") {
 
@@ -15,6 +15,7 @@
 #include <pscf/crystal/Basis.h>            // member
 #include <pscf/crystal/UnitCell.h>         // member
 #include <pscf/mesh/Mesh.h>                // member
+#include <pscf/math/FieldFile.h>           // function parameter
 
 #include <util/misc/FileMaster.h>          // member
 #include <util/containers/DArray.h>        // function parameter
@@ -232,6 +233,63 @@ namespace Pspg
       */
       void writeFieldHeader(std::ostream& out, int nMonomer) const;
 
+      /**
+      * Read field components in symmetry-adapted form from binary file.
+      *
+      * The file is mapped into memory (see Pscf::FieldFile). Stars are
+      * identified by their characteristic waves, as for text files.
+      *
+      * \param filename  name of input file
+      * \param fields  array of fields (symmetry adapted basis components)
+      */
+      void readFieldsBasisBinary(std::string filename, 
+                                 DArray< RDField<D> >& fields);
+
+      /**
+      * Write field components in symmetry-adapted form to binary file.
+      *
+      * \param filename  name of output file
+      * \param fields  array of fields (symmetry adapted basis components)
+      */
+      void writeFieldsBasisBinary(std::string filename, 
+                                  DArray< RDField<D> > const & fields);
+
+      /**
+      * Read array of RDField objects (r-space grid) from binary file.
+      *
+      * \param filename  name of input file
+      * \param fields  array of RDField fields (r-space grid)
+      */
+      void readFieldsRGridBinary(std::string filename, 
+                                 DArray< RDField<D> >& fields);
+
+      /**
+      * Write array of RDField objects (r-space grid) to binary file.
+      *
+      * \param filename  name of output file
+      * \param fields  array of RDField fields (r-space grid)
+      */
+      void writeFieldsRGridBinary(std::string filename, 
+                                  DArray< RDField<D> > const& fields);
+
+      /**
+      * Read array of RDFieldDft objects (k-space grid) from binary file.
+      *
+      * \param filename  name of input file
+      * \param fields  array of RDFieldDft fields (k-space grid)
+      */
+      void readFieldsKGridBinary(std::string filename, 
+                                 DArray< RDFieldDft<D> >& fields);
+
+      /**
+      * Write array of RDFieldDft objects (k-space grid) to binary file.
+      *
+      * \param filename  name of output file
+      * \param fields  array of RDFieldDft fields (k-space grid)
+      */
+      void writeFieldsKGridBinary(std::string filename, 
+                                  DArray< RDFieldDft<D> > const& fields);
+
       //@}
       /// \name Field Format Conversion
       //@{
@@ -396,6 +454,32 @@ namespace Pspg
       */
       void readFieldHeader(std::istream& in);
 
+      /**
+      * Initialize header of a binary field file.
+      *
+      * \param header  header (output)
+      * \param type  type of field data
+      * \param nMonomer  number of monomer types
+      * \param nValue  number of double values per monomer
+      */
+      void makeBinaryHeader(FieldFileHeader& header, FieldFile::Type type,
+                            int nMonomer, int nValue) const;
+
+      /**
+      * Check header of binary field file, and set unit cell parameters.
+      *
+      * \param file  binary field file, after a call to open()
+      * \param type  expected type of field data
+      * \param nMonomer  expected number of monomer types
+      */
+      void readBinaryHeader(FieldFile const & file, FieldFile::Type type,
+                            int nMonomer);
+
+      /**
+      * Get the number of wavevectors in the DFT k-grid.
+      */
+      int kSize() const;
+
       /**
       * Check state of work array, allocate if necessary.
       */
@@ -19,7 +19,9 @@
 #include <util/format/Dbl.h>
 
 #include <iomanip>
+#include <sstream>
 #include <string>
+#include <cstring>
 
 namespace Pscf {
 namespace Pspg
@@ -520,6 +522,307 @@ namespace Pspg
           << "          " << nMonomer << std::endl;
    }
 
+   template <int D>
+   void FieldIo<D>::readFieldsBasisBinary(std::string filename, 
+                                          DArray< RDField<D> >& fields)
+   {
+      int nMonomer = fields.capacity();
+      UTIL_CHECK(nMonomer > 0);
+
+      FieldFile file;
+      file.open(fileMaster().inputPrefix() + filename);
+      readBinaryHeader(file, FieldFile::Basis, nMonomer);
+      int nStarIn = file.header().nValue;
+
+      int i, j;
+      int nStar = basis().nStar();
+      DArray< DArray<cufftReal> > temp_out;
+      temp_out.allocate(nMonomer);
+      for (j = 0; j < nMonomer; ++j) {
+         UTIL_CHECK(fields[j].capacity() == nStar);
+         temp_out[j].allocate(nStar);
+         for (i = 0; i < nStar; ++i) {
+            temp_out[j][i] = 0.0;
+         }
+      }
+
+      // Loop over stars, identified by characteristic waves
+      IntVec<D> waveIn, waveBz, waveDft;
+      int waveId, starId;
+      for (i = 0; i < nStarIn; ++i) {
+         for (j = 0; j < D; ++j) {
+            waveIn[j] = file.star(i)[j];
+         }
+
+         // If wave is in FBZ, find in basis and set field components
+         waveBz = shiftToMinimum(waveIn, mesh().dimensions(), unitCell());
+         if (waveIn == waveBz) {
+            waveDft = waveBz;
+            mesh().shift(waveDft);
+            waveId = basis().waveId(waveDft);
+            starId = basis().wave(waveId).starId;
+            UTIL_CHECK(basis().star(starId).waveBz == waveBz);
+            if (!basis().star(starId).cancel) {
+               for (j = 0; j < nMonomer; ++j) {
+                  temp_out[j][starId] = file.data(j)[i];
+               }
+            }
+         }
+      }
+      file.close();
+
+      for (j = 0; j < nMonomer; ++j) {
+         cudaMemcpy(fields[j].cDField(), temp_out[j].cArray(),
+            nStar * sizeof(cufftReal), cudaMemcpyHostToDevice);
+      }
+   }
+
+   template <int D>
+   void 
+   FieldIo<D>::writeFieldsBasisBinary(std::string filename, 
+                                      DArray< RDField<D> > const& fields)
+   {
+      int nMonomer = fields.capacity();
+      UTIL_CHECK(nMonomer > 0);
+      int nStar = basis().nStar();
+      int nBasis = basis().nBasis();
+
+      std::ofstream out;
+      fileMaster().openOutputFile(filename, out, 
+                                  std::ios::out | std::ios::binary);
+      FieldFileHeader header;
+      makeBinaryHeader(header, FieldFile::Basis, nMonomer, nBasis);
+      FieldFile::writeHeader(out, header);
+
+      // Write characteristic waves of uncancelled stars
+      int i, j, k;
+      int wave[D];
+      for (i = 0; i < nStar; ++i) {
+         typename Basis<D>::Star const & star = basis().star(i);
+         if (!star.cancel) {
+            for (j = 0; j < D; ++j) {
+               wave[j] = star.waveBz[j];
+            }
+            FieldFile::writeStar(out, wave, D, star.size);
+         }
+      }
+
+      // Write components of uncancelled stars, for each monomer
+      DArray<cufftReal> temp_out;
+      DArray<double> temp;
+      temp_out.allocate(nStar);
+      temp.allocate(nBasis);
+      for (j = 0; j < nMonomer; ++j) {
+         cudaMemcpy(temp_out.cArray(), fields[j].cDField(),
+            nStar * sizeof(cufftReal), cudaMemcpyDeviceToHost);
+         k = 0;
+         for (i = 0; i < nStar; ++i) {
+            if (!basis().star(i).cancel) {
+               temp[k] = temp_out[i];
+               ++k;
+            }
+         }
+         FieldFile::writeData(out, temp.cArray(), nBasis);
+      }
+      out.close();
+   }
+
+   template <int D>
+   void FieldIo<D>::readFieldsRGridBinary(std::string filename, 
+                                          DArray< RDField<D> >& fields)
+   {
+      int nMonomer = fields.capacity();
+      UTIL_CHECK(nMonomer > 0);
+
+      FieldFile file;
+      file.open(fileMaster().inputPrefix() + filename);
+      readBinaryHeader(file, FieldFile::RGrid, nMonomer);
+      int nx = mesh().size();
+      UTIL_CHECK(file.header().nValue == nx);
+
+      // Values are stored in order of mesh rank, as in memory
+      DArray<cufftReal> temp_out;
+      temp_out.allocate(nx);
+      double const * data;
+      for (int i = 0; i < nMonomer; ++i) {
+         data = file.data(i);
+         for (int j = 0; j < nx; ++j) {
+            temp_out[j] = data[j];
+         }
+         cudaMemcpy(fields[i].cDField(), temp_out.cArray(),
+            nx * sizeof(cufftReal), cudaMemcpyHostToDevice);
+      }
+      file.close();
+   }
+
+   template <int D>
+   void 
+   FieldIo<D>::writeFieldsRGridBinary(std::string filename, 
+                                      DArray< RDField<D> > const& fields)
+   {
+      int nMonomer = fields.capacity();
+      UTIL_CHECK(nMonomer > 0);
+      int nx = mesh().size();
+
+      std::ofstream out;
+      fileMaster().openOutputFile(filename, out, 
+                                  std::ios::out | std::ios::binary);
+      FieldFileHeader header;
+      makeBinaryHeader(header, FieldFile::RGrid, nMonomer, nx);
+      FieldFile::writeHeader(out, header);
+
+      DArray<cufftReal> temp_out;
+      DArray<double> temp;
+      temp_out.allocate(nx);
+      temp.allocate(nx);
+      for (int i = 0; i < nMonomer; ++i) {
+         cudaMemcpy(temp_out.cArray(), fields[i].cDField(),
+            nx * sizeof(cufftReal), cudaMemcpyDeviceToHost);
+         for (int j = 0; j < nx; ++j) {
+            temp[j] = temp_out[j];
+         }
+         FieldFile::writeData(out, temp.cArray(), nx);
+      }
+      out.close();
+   }
+
+   template <int D>
+   void FieldIo<D>::readFieldsKGridBinary(std::string filename, 
+                                          DArray< RDFieldDft<D> >& fields)
+   {
+      int nMonomer = fields.capacity();
+      UTIL_CHECK(nMonomer > 0);
+
+      FieldFile file;
+      file.open(fileMaster().inputPrefix() + filename);
+      readBinaryHeader(file, FieldFile::KGrid, nMonomer);
+      int nk = kSize();
+      UTIL_CHECK(file.header().nValue == 2*nk);
+
+      // Each value is a (real, imaginary) pair, in order of rank
+      DArray<cufftComplex> temp_out;
+      temp_out.allocate(nk);
+      double const * data;
+      for (int i = 0; i < nMonomer; ++i) {
+         data = file.data(i);
+         for (int j = 0; j < nk; ++j) {
+            temp_out[j].x = data[2*j];
+            temp_out[j].y = data[2*j+1];
+         }
+         cudaMemcpy(fields[i].cDField(), temp_out.cArray(),
+            nk * sizeof(cufftComplex), cudaMemcpyHostToDevice);
+      }
+      file.close();
+   }
+
+   template <int D>
+   void 
+   FieldIo<D>::writeFieldsKGridBinary(std::string filename, 
+                                      DArray< RDFieldDft<D> > const& fields)
+   {
+      int nMonomer = fields.capacity();
+      UTIL_CHECK(nMonomer > 0);
+      int nk = kSize();
+
+      std::ofstream out;
+      fileMaster().openOutputFile(filename, out, 
+                                  std::ios::out | std::ios::binary);
+      FieldFileHeader header;
+      makeBinaryHeader(header, FieldFile::KGrid, nMonomer, 2*nk);
+      FieldFile::writeHeader(out, header);
+
+      DArray<cufftComplex> temp_out;
+      DArray<double> temp;
+      temp_out.allocate(nk);
+      temp.allocate(2*nk);
+      for (int i = 0; i < nMonomer; ++i) {
+         cudaMemcpy(temp_out.cArray(), fields[i].cDField(),
+            nk * sizeof(cufftComplex), cudaMemcpyDeviceToHost);
+         for (int j = 0; j < nk; ++j) {
+            temp[2*j] = temp_out[j].x;
+            temp[2*j+1] = temp_out[j].y;
+         }
+         FieldFile::writeData(out, temp.cArray(), 2*nk);
+      }
+      out.close();
+   }
+
+   /*
+   * Initialize header of a binary field file.
+   */
+   template <int D>
+   void FieldIo<D>::makeBinaryHeader(FieldFileHeader& header, 
+                                     FieldFile::Type type,
+                                     int nMonomer, int nValue) const
+   {
+      FieldFile::initHeader(header, type, D, nMonomer, nValue);
+      for (int i = 0; i < D; ++i) {
+         header.meshDimensions[i] = mesh().dimension(i);
+      }
+
+      // Name of lattice system: first item in unit cell output
+      std::ostringstream cellStream;
+      cellStream << unitCell();
+      std::istringstream latticeStream(cellStream.str());
+      std::string lattice;
+      latticeStream >> lattice;
+      strncpy(header.lattice, lattice.c_str(), sizeof(header.lattice)-1);
+      header.nParameter = unitCell().nParameter();
+      for (int i = 0; i < header.nParameter; ++i) {
+         header.parameters[i] = unitCell().parameter(i);
+      }
+
+      UTIL_CHECK(groupName().size() < sizeof(header.groupName));
+      strncpy(header.groupName, groupName().c_str(), 
+              sizeof(header.groupName)-1);
+   }
+
+   /*
+   * Check header of binary field file, and set unit cell parameters.
+   */
+   template <int D>
+   void FieldIo<D>::readBinaryHeader(FieldFile const & file, 
+                                     FieldFile::Type type, int nMonomer)
+   {
+      FieldFileHeader const & header = file.header();
+      UTIL_CHECK(header.type == type);
+      UTIL_CHECK(header.dimension == D);
+      UTIL_CHECK(header.nMonomer == nMonomer);
+      if (type != FieldFile::Basis) {
+         for (int i = 0; i < D; ++i) {
+            UTIL_CHECK(header.meshDimensions[i] == mesh().dimension(i));
+         }
+      }
+
+      // Set unit cell, with the same checks as for a text file header
+      std::ostringstream cellStream;
+      cellStream << "crystal_system " << header.lattice << std::endl
+                 << "N_cell_param " << header.nParameter << std::endl
+                 << "cell_param " << std::setprecision(17);
+      for (int i = 0; i < header.nParameter; ++i) {
+         cellStream << " " << header.parameters[i];
+      }
+      std::istringstream in(cellStream.str());
+      readUnitCellHeader(in, unitCell());
+   }
+
+   /*
+   * Get the number of wavevectors in the DFT k-grid.
+   */
+   template <int D>
+   int FieldIo<D>::kSize() const
+   {
+      int kSize = 1;
+      for (int i = 0; i < D; i++) {
+         if (i == D - 1) {
+            kSize *= (mesh().dimension(i) / 2 + 1);
+         } else {
+            kSize *= mesh().dimension(i);
+         }
+      }
+      return kSize;
+   }
+
    template <int D>
    void FieldIo<D>::convertBasisToKGrid(RDField<D> const& components, 
                                         RDFieldDft<D>& dft)
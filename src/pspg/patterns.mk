@@ -27,6 +27,11 @@ PSPG_DEFS+=-DPSPG_FFTW -DGPU_OUTER
 INCLUDES+=$(CUFFT_INC)
 LIBS+=$(CUFFT_LIB)
 
+# Link with OpenMP if the pscf library is multithreaded
+ifdef PSCF_OPENMP
+LDFLAGS+= -Xcompiler $(OPENMP_FLAGS)
+endif
+
 # Preprocessor macro definitions needed in src/pssp
 DEFINES=$(UTIL_DEFS) $(PSCF_DEFS) $(PSPG_DEFS) 
 